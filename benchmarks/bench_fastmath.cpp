@@ -0,0 +1,145 @@
+#include "fastmath.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+// Maximum error and throughput of fastmath.hpp approximations against std functions.
+//   Errors are absolute, measured against f64 std functions, ranges are the ones shapes use.
+// NOTE: Build it in Release, timings of Debug build are meaningless.
+
+
+using namespace pbr;
+
+namespace {
+
+constexpr i32 kValueCount = 1 << 20;
+constexpr i32 kRepetitions = 16;
+
+
+std::vector<f32> Uniform(f32 min, f32 max, i32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<f32> uniform(min, max);
+    std::vector<f32> values(kValueCount);
+    for (f32 &value : values)
+        value = uniform(rng);
+    return values;
+}
+
+// Returns time per value in nanoseconds, result is accumulated into out_sum so the loop is not thrown away.
+template<typename Function>
+f64 Time(const std::vector<f32> &a, const std::vector<f32> &b, Function function, f32 &out_sum)
+{
+    f32 sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition)
+        for (size_t i = 0; i < a.size(); ++i)
+            sum += function(a[i], b[i]);
+    auto end = std::chrono::steady_clock::now();
+    out_sum += sum;
+    return std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * a.size());
+}
+
+#if PBR_ENABLE_SSE == 1
+template<typename Function>
+f64 TimeSSE(const std::vector<f32> &a, const std::vector<f32> &b, Function function, f32 &out_sum)
+{
+    __m128 sum = _mm_setzero_ps();
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition)
+        for (size_t i = 0; i < a.size(); i += 4)
+            sum = _mm_add_ps(sum, function(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+    auto end = std::chrono::steady_clock::now();
+    alignas(16) f32 lanes[4];
+    _mm_store_ps(lanes, sum);
+    out_sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * a.size());
+}
+
+// Max difference between SSE and scalar results, they are expected to be the same.
+template<typename FunctionSSE, typename Function>
+f64 MaxDifferenceSSE(const std::vector<f32> &a, const std::vector<f32> &b, FunctionSSE functionSSE, Function function)
+{
+    f64 maxDifference = 0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        alignas(16) f32 lanes[4];
+        _mm_store_ps(lanes, functionSSE(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+        for (size_t lane = 0; lane < 4; ++lane)
+            maxDifference = std::max(maxDifference, std::abs(f64(lanes[lane]) - f64(function(a[i + lane], b[i + lane]))));
+    }
+    return maxDifference;
+}
+#endif
+
+template<typename Precise, typename Fast>
+f64 MaxError(const std::vector<f32> &a, const std::vector<f32> &b, Precise precise, Fast fast)
+{
+    f64 maxError = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        maxError = std::max(maxError, std::abs(precise(f64(a[i]), f64(b[i])) - f64(fast(a[i], b[i]))));
+    return maxError;
+}
+
+template<typename Precise, typename Std, typename Fast, typename FastSSE>
+void Benchmark(const char *name, const std::vector<f32> &a, const std::vector<f32> &b,
+               Precise precise, Std stdFunction, Fast fast, FastSSE fastSSE)
+{
+    f32 sum = 0;
+    f64 nsStd = Time(a, b, stdFunction, sum);
+    f64 nsFast = Time(a, b, fast, sum);
+#if PBR_ENABLE_SSE == 1
+    f64 nsSSE = TimeSSE(a, b, fastSSE, sum);
+    f64 differenceSSE = MaxDifferenceSSE(a, b, fastSSE, fast);
+#else
+    (void)fastSSE;
+    f64 nsSSE = 0, differenceSSE = 0;
+#endif
+
+    std::printf("%-7s | %8.2f ns %8.2f ns %8.2f ns | %10.3e %10.3e %10.3e | %g\n",
+                name, nsStd, nsFast, nsSSE,
+                MaxError(a, b, precise, stdFunction), MaxError(a, b, precise, fast), differenceSSE, sum);
+}
+
+} // namespace
+
+
+int main()
+{
+    // Random points on the plane and cosines of theta, as shapes use them, and angles in the range of phi and some more.
+    const std::vector<f32> x = Uniform(-1, 1, 1), y = Uniform(-1, 1, 2);
+    const std::vector<f32> angles = Uniform(-8 * constants::pi_t, 8 * constants::pi_t, 3);
+
+    std::printf("%d values, time per value and max error against f64 std function, SSE against scalar difference\n", kValueCount);
+    std::printf("%-7s | %11s %11s %11s | %10s %10s %10s | %s\n", "", "std", "fast", "fast SSE", "std", "fast", "SSE", "checksum");
+
+    Benchmark("ATan2", y, x,
+              [](f64 a, f64 b) { return std::atan2(a, b); },
+              [](f32 a, f32 b) { return pbr::ATan2(a, b); },
+              [](f32 a, f32 b) { return fastmath::ATan2(a, b); },
+              [](auto a, auto b) { return fastmath::ATan2(a, b); });
+    Benchmark("ACos", x, x,
+              [](f64 a, f64) { return std::acos(a); },
+              [](f32 a, f32) { return pbr::ACos(a); },
+              [](f32 a, f32) { return fastmath::ACos(a); },
+              [](auto a, auto) { return fastmath::ACos(a); });
+    Benchmark("Sin", angles, angles,
+              [](f64 a, f64) { return std::sin(a); },
+              [](f32 a, f32) { return pbr::Sin(a); },
+              [](f32 a, f32) { return fastmath::Sin(a); },
+              [](auto a, auto) { return fastmath::Sin(a); });
+    Benchmark("Cos", angles, angles,
+              [](f64 a, f64) { return std::cos(a); },
+              [](f32 a, f32) { return pbr::Cos(a); },
+              [](f32 a, f32) { return fastmath::Cos(a); },
+              [](auto a, auto) { return fastmath::Cos(a); });
+    Benchmark("SinCos", angles, angles,
+              [](f64 a, f64) { return std::sin(a) + std::cos(a); },
+              [](f32 a, f32) { f32 s, c; pbr::SinCos(a, s, c); return s + c; },
+              [](f32 a, f32) { f32 s, c; fastmath::SinCos(a, s, c); return s + c; },
+              [](auto a, auto) { decltype(a) s, c; fastmath::SinCos(a, s, c); return _mm_add_ps(s, c); });
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "transform.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+// Throughput of Matrix4x4 functions and the error of Inverse(), as scene setup composes and inverts instance transforms.
+//   Error is the largest element of |M * Inverse(M) - I|, computed in f64.
+//   Points and rays are transformed by Transform and AffineTransform of the same affine matrices.
+//   Mesh vertices are transformed one by one and in a batch, as TriangleMesh constructor does it.
+// NOTE: Build it in Release. Compare against the scalar fallback by building with PBR_ENABLE_SIMD_GEOMETRY=0.
+
+
+using namespace pbr;
+
+namespace {
+
+constexpr i32 kMatrixCount = 1 << 16;
+constexpr i32 kRepetitions = 64;
+
+
+// Translation, rotation around a random axis and non uniform scale, as instances are placed.
+std::vector<Matrix4x4> AffineMatrices(i32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<f32> uniform(-1, 1);
+    std::vector<Matrix4x4> matrices;
+    matrices.reserve(kMatrixCount);
+    for (i32 i = 0; i < kMatrixCount; ++i) {
+        Vector3_t axis(uniform(rng), uniform(rng), uniform(rng) + fp_t(1.5));
+        Transform t = Translate(Vector3_t(1000 * uniform(rng), 1000 * uniform(rng), 1000 * uniform(rng))) *
+                      Rotate(180 * uniform(rng), axis) *
+                      Scale(std::exp2(4 * uniform(rng)), std::exp2(4 * uniform(rng)), std::exp2(4 * uniform(rng)));
+        matrices.push_back(t.m);
+    }
+    return matrices;
+}
+
+// Random elements, the last row too, so it's not affine.
+std::vector<Matrix4x4> GeneralMatrices(i32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<f32> uniform(-1, 1);
+    std::vector<Matrix4x4> matrices(kMatrixCount);
+    for (Matrix4x4 &m : matrices)
+        for (i32 i = 0; i < 4; ++i)
+            for (i32 j = 0; j < 4; ++j)
+                m[i][j] = uniform(rng);
+    return matrices;
+}
+
+// Returns time per matrix in nanoseconds, first element of every result is summed, so the loop is not thrown away.
+template<typename Function>
+f64 Time(const std::vector<Matrix4x4> &matrices, Function function, f32 &out_sum)
+{
+    f32 sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition)
+        for (size_t i = 0; i < matrices.size(); ++i)
+            sum += function(matrices[i], matrices[(i + 1) % matrices.size()])[0][0];
+    auto end = std::chrono::steady_clock::now();
+    out_sum += sum;
+    return std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * matrices.size());
+}
+
+// Point with the error bounds and ray, as shapes transform them, time per transform in nanoseconds.
+template<typename TransformType>
+f64 TimeTransform(const std::vector<TransformType> &transforms, f32 &out_sum)
+{
+    f32 sum = 0;
+    Point3_t p(1, 2, 3);
+    const Ray ray(Point3_t(-1, 0, 2), Vector3_t(0.5f, 1, -1));
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition)
+        for (const TransformType &t : transforms) {
+            Vector3_t pError;
+            p = t(p, pError);
+            sum += pError.x + t(ray).origin.x;
+            p = Point3_t(p.x * fp_t(1e-3), p.y * fp_t(1e-3), p.z * fp_t(1e-3));
+        }
+    auto end = std::chrono::steady_clock::now();
+    out_sum += sum + p.x;
+    return std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * transforms.size());
+}
+
+f64 InverseError(const std::vector<Matrix4x4> &matrices)
+{
+    f64 maxError = 0;
+    for (const Matrix4x4 &m : matrices) {
+        const Matrix4x4 inverse = Inverse(m);
+        for (i32 i = 0; i < 4; ++i)
+            for (i32 j = 0; j < 4; ++j) {
+                f64 element = 0;
+                for (i32 k = 0; k < 4; ++k)
+                    element += f64(m[i][k]) * f64(inverse[k][j]);
+                maxError = std::max(maxError, std::abs(element - (i == j ? 1. : 0.)));
+            }
+    }
+    return maxError;
+}
+
+} // namespace
+
+
+int main()
+{
+    const std::vector<Matrix4x4> affine = AffineMatrices(1), general = GeneralMatrices(2);
+
+    std::printf("%d matrices, time per matrix, %s\n", kMatrixCount,
+                PBR_MATRIX4X4_SSE == 1 ? (PBR_ENABLE_AVX == 1 ? "SSE and AVX" : "SSE") : "scalar");
+    f32 sum = 0;
+    std::printf("Mul               | %6.2f ns\n", Time(affine, [](const Matrix4x4 &m1, const Matrix4x4 &m2) { return Mul(m1, m2); }, sum));
+    std::printf("Transpose         | %6.2f ns\n", Time(affine, [](const Matrix4x4 &m, const Matrix4x4 &) { return Transpose(m); }, sum));
+    std::printf("Inverse affine    | %6.2f ns | max error %10.3e\n",
+                Time(affine, [](const Matrix4x4 &m, const Matrix4x4 &) { return Inverse(m); }, sum), InverseError(affine));
+    std::printf("Inverse general   | %6.2f ns | max error %10.3e\n",
+                Time(general, [](const Matrix4x4 &m, const Matrix4x4 &) { return Inverse(m); }, sum), InverseError(general));
+    std::printf("Transform(m) * t  | %6.2f ns\n", Time(affine, [](const Matrix4x4 &m1, const Matrix4x4 &m2) {
+        return (Transform(m1) * Transform(m2)).mInv;
+    }, sum));
+
+    std::vector<Transform> transforms;
+    std::vector<AffineTransform> affineTransforms;
+    for (size_t i = 0; i < affine.size(); ++i) {
+        transforms.emplace_back(affine[i], affine[(i + 1) % affine.size()]);
+        affineTransforms.emplace_back(transforms.back());
+    }
+    std::printf("Point Transform   | %6.2f ns\n", TimeTransform(transforms, sum));
+    std::printf("Point Affine      | %6.2f ns\n", TimeTransform(affineTransforms, sum));
+
+    // Vertices of a large mesh by the general affine transform
+    const i32 nVertices = 1 << 24;
+    std::vector<Point3_t> vertices(nVertices), outVertices(nVertices);
+    for (i32 i = 0; i < nVertices; ++i)
+        vertices[i] = Point3_t(fp_t(i % 1024), fp_t(i / 1024 % 1024), fp_t(i / (1024 * 1024)));
+    const Transform &meshTransform = transforms[0];
+    auto start = std::chrono::steady_clock::now();
+    for (i32 i = 0; i < nVertices; ++i)
+        outVertices[i] = meshTransform(vertices[i]);
+    auto end = std::chrono::steady_clock::now();
+    sum += outVertices[nVertices / 2].x;
+    std::printf("Vertices loop     | %6.2f ns\n", std::chrono::duration<f64, std::nano>(end - start).count() / nVertices);
+    start = std::chrono::steady_clock::now();
+    meshTransform(std::span<const Point3_t>(vertices), std::span(outVertices));
+    end = std::chrono::steady_clock::now();
+    sum += outVertices[nVertices / 2].x;
+    std::printf("Vertices batched  | %6.2f ns\n", std::chrono::duration<f64, std::nano>(end - start).count() / nVertices);
+
+    std::printf("checksum %g\n", sum);
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "transform.hpp"
+#include "interaction.hpp"
+#include "sphere.h"
+#include "sphereset.h"
+#include "triangle.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+// Cost of fp_t precision. It's built twice, as bench_precision against pbr_lib (f32) and as bench_precision_f64
+//   against pbr_lib_f64, run both and compare the tables. Rays are generated in f64 from the same seed,
+//   so both binaries test the same rays, and the hit counts are comparable.
+// "Far" scenes are placed 1e5 units away from the origin, as parts of the large worlds are,
+//   their surface error is the mean distance of the hit points from the surface, relative to the radius.
+// NOTE: Build it in Release, and with PBR_ENABLE_PROFILING disabled, otherwise profiler dominates the timings.
+//       Debug EFloat keeps precise f64 values in both precisions, so compare them with PBR_EFLOAT_DEBUG disabled.
+
+
+using namespace pbr;
+
+namespace {
+
+constexpr i32 kRayCount = 1 << 19;
+constexpr i32 kRepetitions = 4;
+constexpr f64 kFarOffset = 1e5;
+
+
+// Rays from the sphere of radius 4 around the center to the random points in the unit ball around it.
+std::vector<Ray> GenerateRays(f64 centerX, i32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<f64> uniform(0, 1);
+
+    std::vector<Ray> rays;
+    rays.reserve(kRayCount);
+    for (i32 i = 0; i < kRayCount; ++i) {
+        f64 z = 1 - 2 * uniform(rng), r = std::sqrt(std::max(0., 1 - z * z)), phi = 2 * std::numbers::pi * uniform(rng);
+        f64 ox = centerX + 4 * r * std::cos(phi), oy = 4 * r * std::sin(phi), oz = 4 * z;
+        f64 tx = centerX + uniform(rng) - 0.5, ty = uniform(rng) - 0.5, tz = uniform(rng) - 0.5;
+        rays.emplace_back(Point3_t(fp_t(ox), fp_t(oy), fp_t(oz)), Vector3_t(fp_t(tx - ox), fp_t(ty - oy), fp_t(tz - oz)));
+    }
+    return rays;
+}
+
+// Unit sphere tessellated into nPhi * nTheta quads, split into triangles.
+std::shared_ptr<TriangleMesh> TessellateSphere(const Transform &ObjectToWorld, i32 nPhi, i32 nTheta)
+{
+    std::vector<Point3_t> positions;
+    std::vector<Normal3_t> normals;
+    std::vector<Point2_t> uv;
+    for (i32 j = 0; j <= nTheta; ++j)
+        for (i32 i = 0; i <= nPhi; ++i) {
+            f64 u = f64(i) / nPhi, v = f64(j) / nTheta;
+            f64 theta = std::numbers::pi * v, phi = 2 * std::numbers::pi * u;
+            Point3_t p(fp_t(std::sin(theta) * std::cos(phi)), fp_t(std::sin(theta) * std::sin(phi)), fp_t(std::cos(theta)));
+            positions.push_back(p);
+            normals.emplace_back(p.x, p.y, p.z);
+            uv.emplace_back(fp_t(u), fp_t(v));
+        }
+
+    std::vector<i32> indices;
+    for (i32 j = 0; j < nTheta; ++j)
+        for (i32 i = 0; i < nPhi; ++i) {
+            i32 v00 = j * (nPhi + 1) + i, v10 = v00 + 1, v01 = v00 + nPhi + 1, v11 = v01 + 1;
+            indices.insert(indices.end(), { v00, v01, v10, v10, v01, v11 });
+        }
+
+    return std::make_shared<TriangleMesh>(ObjectToWorld, static_cast<i32>(indices.size() / 3), indices.data(),
+                                          static_cast<i32>(positions.size()), positions.data(),
+                                          nullptr, normals.data(), uv.data());
+}
+
+struct Result
+{
+    f64 nsPerRay;
+    i32 nHits;
+    // Mean of |distance(hit, center) - radius| / radius
+    f64 surfaceError;
+};
+
+// Intersect() is timed, hit points r(tHit) are checked against the sphere (center, radius) after.
+// NOTE: Triangle::Intersect() doesn't fill the interaction yet, so hit points are taken from the ray.
+template<typename Query>
+Result Run(const std::vector<Ray> &rays, f64 centerX, f64 radius, Query query)
+{
+    SurfaceInteraction isect(Point3_t(0), Vector3_t(0), Point2_t(0, 0), Vector3_t(0, 0, 1),
+                             Vector3_t(1, 0, 0), Vector3_t(0, 1, 0), Normal3_t(0), Normal3_t(0), 0, nullptr);
+    Result result{};
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition) {
+        result.nHits = 0;
+        for (size_t i = 0; i < rays.size(); ++i)
+            if (fp_t tHit; query(rays[i], i, tHit, isect))
+                ++result.nHits;
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.nsPerRay = std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * rays.size());
+
+    f64 errorSum = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+        if (fp_t tHit; query(rays[i], i, tHit, isect)) {
+            Point3_t p = rays[i](tHit);
+            f64 dx = f64(p.x) - centerX, dy = f64(p.y), dz = f64(p.z);
+            errorSum += std::abs(std::sqrt(dx * dx + dy * dy + dz * dz) - radius) / radius;
+        }
+    result.surfaceError = result.nHits > 0 ? errorSum / result.nHits : 0;
+    return result;
+}
+
+void Print(const char *name, const Result &result)
+{
+    std::printf("%-3s %-16s | %9.1f ns | %8d | %10.3e\n",
+                sizeof(fp_t) == sizeof(f32) ? "f32" : "f64", name, result.nsPerRay, result.nHits, result.surfaceError);
+}
+
+void BenchmarkScene(const char *sphereName, const char *meshName, const char *setName, f64 centerX)
+{
+    const Transform ObjectToWorld = Translate(Vector3_t(fp_t(centerX), 0, 0));
+    const Transform WorldToObject = Inverse(ObjectToWorld);
+    const std::vector<Ray> rays = GenerateRays(centerX, 7);
+
+    const Sphere sphere(&ObjectToWorld, &WorldToObject, false, 1, -1, 1, 360);
+    Print(sphereName, Run(rays, centerX, 1, [&](const Ray &ray, size_t, fp_t &tHit, SurfaceInteraction &isect) {
+        return sphere.Intersect(ray, tHit, isect, false);
+    }));
+
+    // Every ray is tested against one triangle only, there is no accelerator for meshes, it's the cost of the test itself.
+    //   Mesh is fine enough, so its surface error is dominated by tessellation, compare it between precisions only.
+    const std::shared_ptr<TriangleMesh> mesh = TessellateSphere(ObjectToWorld, 256, 128);
+    std::vector<Triangle> triangles;
+    triangles.reserve(mesh->nTriangles);
+    for (i32 i = 0; i < mesh->nTriangles; ++i)
+        triangles.emplace_back(&ObjectToWorld, &WorldToObject, false, mesh, i);
+    std::vector<Ray> triangleRays;
+    triangleRays.reserve(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) {
+        Bounds3_t bounds = triangles[i % triangles.size()].WorldBound();
+        Point3_t target = bounds.pMin + fp_t(0.5) * bounds.Diagonal();
+        triangleRays.emplace_back(rays[i].origin, target - rays[i].origin);
+    }
+    Print(meshName, Run(triangleRays, centerX, 1, [&](const Ray &ray, size_t i, fp_t &tHit, SurfaceInteraction &isect) {
+        return triangles[i % triangles.size()].Intersect(ray, tHit, isect, false);
+    }));
+
+    // Particles of radius 0.01 filling the unit ball, surface error is measured against the one that was hit.
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<f64> uniform(-1, 1);
+    constexpr i32 nSpheres = 1 << 16;
+    std::vector<Point3_t> centers;
+    std::vector<fp_t> radii(nSpheres, fp_t(0.01));
+    while (static_cast<i32>(centers.size()) < nSpheres) {
+        f64 x = uniform(rng), y = uniform(rng), z = uniform(rng);
+        if (x * x + y * y + z * z <= 1)
+            centers.emplace_back(fp_t(x), fp_t(y), fp_t(z));
+    }
+    const SphereSet set(&ObjectToWorld, &WorldToObject, false, nSpheres, centers.data(), radii.data());
+    Result setResult = Run(rays, centerX, 1, [&](const Ray &ray, size_t, fp_t &tHit, SurfaceInteraction &isect) {
+        return set.Intersect(ray, tHit, isect, false);
+    });
+    // Nearest center search is brute force, a few thousands of hits are enough for the mean.
+    f64 errorSum = 0;
+    i32 nChecked = 0;
+    SurfaceInteraction isect(Point3_t(0), Vector3_t(0), Point2_t(0, 0), Vector3_t(0, 0, 1),
+                             Vector3_t(1, 0, 0), Vector3_t(0, 1, 0), Normal3_t(0), Normal3_t(0), 0, nullptr);
+    for (size_t i = 0; i < rays.size() && nChecked < 4096; ++i) {
+        fp_t tHit;
+        if (!set.Intersect(rays[i], tHit, isect, false))
+            continue;
+        f64 bestDistance = std::numeric_limits<f64>::infinity();
+        const Point3_t p = rays[i](tHit);
+        const f64 px = f64(p.x) - centerX, py = f64(p.y), pz = f64(p.z);
+        for (const Point3_t &c : centers) {
+            f64 dx = px - f64(c.x), dy = py - f64(c.y), dz = pz - f64(c.z);
+            bestDistance = std::min(bestDistance, std::abs(std::sqrt(dx * dx + dy * dy + dz * dz) - 0.01));
+        }
+        errorSum += bestDistance / 0.01;
+        ++nChecked;
+    }
+    setResult.surfaceError = nChecked > 0 ? errorSum / nChecked : 0;
+    Print(setName, setResult);
+}
+
+} // namespace
+
+
+int main()
+{
+    std::printf("fp_t is %s, memory of the common types and of the triangle mesh per vertex with normals and uv\n",
+                sizeof(fp_t) == sizeof(f32) ? "f32" : "f64");
+    std::printf("Ray %zu B, SurfaceInteraction %zu B, Transform %zu B, Bounds3_t %zu B, mesh vertex %zu B\n\n",
+                sizeof(Ray), sizeof(SurfaceInteraction), sizeof(Transform), sizeof(Bounds3_t),
+                sizeof(Point3_t) + sizeof(Normal3_t) + sizeof(Point2_t));
+
+    std::printf("%d rays, time per ray, number of hits and mean relative surface error of the hits\n", kRayCount);
+    std::printf("%-20s | %12s | %8s | %10s\n", "", "Intersect", "Hits", "Error");
+    BenchmarkScene("Sphere", "Triangle", "SphereSet", 0);
+    BenchmarkScene("Sphere far", "Triangle far", "SphereSet far", kFarOffset);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "efloat.hpp"
+#include "transform.hpp"
+#include "interaction.hpp"
+#include "sphere.h"
+#include "cylinder.h"
+#include "cone.h"
+#include "paraboloid.h"
+#include "hyperboloid.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+// Throughput of quadric shapes intersection with every arithmetic policy from efloat.hpp.
+//   Rays start on the sphere around the shape and go to the random points inside its bounds,
+//   so most of them hit, and some of them miss because of partial shapes and clipping.
+// NOTE: Build it in Release, and with PBR_ENABLE_PROFILING disabled, otherwise profiler dominates the timings.
+
+
+using namespace pbr;
+
+namespace {
+
+constexpr i32 kRayCount = 1 << 20;
+constexpr i32 kRepetitions = 4;
+
+
+std::vector<Ray> GenerateRays(const Bounds3_t &bounds)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<fp_t> uniform(0, 1);
+
+    const Point3_t center((bounds.pMin.x + bounds.pMax.x) / 2, (bounds.pMin.y + bounds.pMax.y) / 2, (bounds.pMin.z + bounds.pMax.z) / 2);
+    const fp_t distance = 4 * Distance(bounds.pMin, bounds.pMax);
+    std::vector<Ray> rays;
+    rays.reserve(kRayCount);
+    for (i32 i = 0; i < kRayCount; ++i) {
+        // Uniform direction to the origin
+        fp_t z = 1 - 2 * uniform(rng);
+        fp_t r = pbr::Sqrt(std::max(fp_t(0), 1 - z * z));
+        fp_t phi = 2 * constants::pi_t * uniform(rng);
+        Point3_t origin = center + distance * Vector3_t(r * std::cos(phi), r * std::sin(phi), z);
+        Vector3_t diagonal = bounds.Diagonal();
+        Point3_t target = bounds.pMin + Vector3_t(uniform(rng) * diagonal.x, uniform(rng) * diagonal.y, uniform(rng) * diagonal.z);
+        rays.emplace_back(origin, target - origin);
+    }
+    return rays;
+}
+
+// Returns number of hits, and time per ray in nanoseconds.
+template<typename Float, typename ShapeType>
+i32 Run(const ShapeType &shape, const std::vector<Ray> &rays, bool closestHit, f64 &out_nsPerRay)
+{
+    // NOTE: SurfaceInteraction has no empty constructor, so it's initialized with anything.
+    SurfaceInteraction isect(Point3_t(0), Vector3_t(0), Point2_t(0, 0), Vector3_t(0, 0, 1),
+                             Vector3_t(1, 0, 0), Vector3_t(0, 1, 0), Normal3_t(0), Normal3_t(0), 0, nullptr);
+    i32 nHits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (i32 repetition = 0; repetition < kRepetitions; ++repetition) {
+        nHits = 0;
+        for (const Ray &ray : rays) {
+            fp_t tHit;
+            if (closestHit ? shape.template IntersectWith<Float>(ray, tHit, isect) : shape.template IsIntersectingWith<Float>(ray))
+                ++nHits;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    out_nsPerRay = std::chrono::duration<f64, std::nano>(end - start).count() / (f64(kRepetitions) * rays.size());
+    return nHits;
+}
+
+template<typename ShapeType>
+void Benchmark(const char *name, const ShapeType &shape)
+{
+    std::vector<Ray> rays = GenerateRays(shape.WorldBound());
+
+    for (bool closestHit : { true, false }) {
+        f64 nsDebug, nsEFloat, nsRaw;
+        i32 hitsDebug = Run<EFloatT<true>>(shape, rays, closestHit, nsDebug);
+        i32 hitsEFloat = Run<EFloatT<false>>(shape, rays, closestHit, nsEFloat);
+        i32 hitsRaw = Run<RawFloat>(shape, rays, closestHit, nsRaw);
+
+        std::printf("%-11s %-14s | %9.1f ns %9.1f ns %9.1f ns | %8d %+6d %+6d\n",
+                    name, closestHit ? "Intersect" : "IsIntersecting",
+                    nsDebug, nsEFloat, nsRaw,
+                    hitsDebug, hitsEFloat - hitsDebug, hitsRaw - hitsDebug);
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    const Transform identity{Matrix4x4()};
+
+    std::printf("%d rays, time per ray and number of hits, hits of EFloat and RawFloat relative to EFloat debug\n", kRayCount);
+    std::printf("%-11s %-14s | %12s %12s %12s | %8s %6s %6s\n",
+                "Shape", "Query", "EFloat debug", "EFloat", "RawFloat", "Debug", "EFloat", "Raw");
+
+    Benchmark("Sphere", Sphere(&identity, &identity, false, 1, -0.5, 0.8, 270));
+    Benchmark("Cylinder", Cylinder(&identity, &identity, false, 1, -1, 1, 270));
+    Benchmark("Cone", Cone(&identity, &identity, false, 1, 2, 270));
+    Benchmark("Paraboloid", Paraboloid(&identity, &identity, false, 1, 0, 1, 270));
+    Benchmark("Hyperboloid", Hyperboloid(&identity, &identity, false, Point3_t(1, -0.5f, -1), Point3_t(0.5f, 1, 1), 270));
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "alphamask.h"
+#include "stats.h"
+
+
+PBR_NAMESPACE_BEGIN
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_STATS_MEMORY_COUNTER("Memory/Alpha masks", stats_AlphaMask_bytes)
+
+AlphaMask::AlphaMask(i32 width, i32 height, const fp_t *alpha, fp_t threshold)
+    : m_width(width)
+    , m_height(height)
+    , m_wordsPerRow((width + 63) / 64)
+    , m_bits(static_cast<std::size_t>(m_wordsPerRow) * height, 0)
+{
+    PBR_ASSERT(width > 0 && height > 0 && alpha != nullptr)
+    PBR_STATS_VARIABLE_ADD(stats_AlphaMask_bytes, sizeof(*this) + m_bits.size() * sizeof(ui64))
+
+    i64 nOpaque = 0;
+    for (i32 y = 0; y < height; ++y)
+        for (i32 x = 0; x < width; ++x)
+            if (alpha[static_cast<i64>(y) * width + x] >= threshold) {
+                m_bits[y * m_wordsPerRow + (x >> 6)] |= ui64(1) << (x & 63);
+                ++nOpaque;
+            }
+
+    if (nOpaque == 0)
+        m_coverage = AlphaCoverage::Transparent;
+    else if (nOpaque == static_cast<i64>(width) * height)
+        m_coverage = AlphaCoverage::Opaque;
+    else
+        m_coverage = AlphaCoverage::Partial;
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+AlphaCoverage AlphaMask::ClassifyRow(i32 y, i32 x0, i32 x1) const
+{
+    const ui64 *row = &m_bits[y * m_wordsPerRow];
+    bool anyOpaque = false, anyTransparent = false;
+    for (i32 word = x0 >> 6; word <= (x1 >> 6); ++word) {
+        // Bits of [x0, x1] inside of this word
+        i32 first = word == (x0 >> 6) ? (x0 & 63) : 0;
+        i32 last = word == (x1 >> 6) ? (x1 & 63) : 63;
+        ui64 mask = (last == 63 ? ~ui64(0) : (ui64(1) << (last + 1)) - 1) & (~ui64(0) << first);
+
+        anyOpaque |= (row[word] & mask) != 0;
+        anyTransparent |= (row[word] & mask) != mask;
+        if (anyOpaque && anyTransparent)
+            return AlphaCoverage::Partial;
+    }
+    return anyOpaque ? AlphaCoverage::Opaque : AlphaCoverage::Transparent;
+}
+
+AlphaCoverage AlphaMask::Classify(const Point2_arg<fp_t> uvMin, const Point2_arg<fp_t> uvMax) const
+{
+    if (m_coverage != AlphaCoverage::Partial)
+        return m_coverage;
+
+    i64 x0 = static_cast<i64>(pbr::Floor(uvMin.x * m_width));
+    i64 x1 = static_cast<i64>(pbr::Floor(uvMax.x * m_width));
+    i64 y0 = static_cast<i64>(pbr::Floor(uvMin.y * m_height));
+    i64 y1 = static_cast<i64>(pbr::Floor(uvMax.y * m_height));
+    // Rectangle covers the whole texture, and the texture is known to be partial
+    if (x1 - x0 + 1 >= m_width && y1 - y0 + 1 >= m_height)
+        return AlphaCoverage::Partial;
+
+    // Column range may wrap around the texture edge, then it's split into two
+    i32 xRanges[2][2];
+    i32 nXRanges = 1;
+    if (x1 - x0 + 1 >= m_width) {
+        xRanges[0][0] = 0;
+        xRanges[0][1] = m_width - 1;
+    }
+    else {
+        i32 wx0 = WrapTexel(static_cast<i32>(x0 % m_width), m_width);
+        i32 wx1 = WrapTexel(static_cast<i32>(x1 % m_width), m_width);
+        xRanges[0][0] = wx0;
+        xRanges[0][1] = wx0 <= wx1 ? wx1 : m_width - 1;
+        if (wx0 > wx1) {
+            xRanges[1][0] = 0;
+            xRanges[1][1] = wx1;
+            nXRanges = 2;
+        }
+    }
+
+    const i64 nRows = std::min<i64>(y1 - y0 + 1, m_height);
+    AlphaCoverage coverage = ClassifyRow(WrapTexel(static_cast<i32>(y0 % m_height), m_height), xRanges[0][0], xRanges[0][1]);
+    if (coverage == AlphaCoverage::Partial)
+        return coverage;
+    for (i64 i = 0; i < nRows; ++i) {
+        i32 y = WrapTexel(static_cast<i32>((y0 + i) % m_height), m_height);
+        for (i32 r = 0; r < nXRanges; ++r)
+            if (ClassifyRow(y, xRanges[r][0], xRanges[r][1]) != coverage)
+                return AlphaCoverage::Partial;
+    }
+    return coverage;
+}
+
+PBR_NAMESPACE_END
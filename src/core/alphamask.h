@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+#include <vector>
+
+
+// TODO: Texture is not implemented, so the mask is built straight from the texel values.
+// DIFFERENCE: pbrt evaluates full float alpha texture for every candidate hit,
+//             here the texture is thresholded once into 1 bit per texel, and lookup is a single bit test.
+
+
+PBR_NAMESPACE_BEGIN
+
+// Coverage of the texture area, used to skip mask lookups for primitives that are entirely on one side of the threshold.
+enum class AlphaCoverage : ui8
+{
+    Transparent,
+    Opaque,
+    Partial
+};
+
+
+class AlphaMask
+{
+public:
+    // alpha contains width * height values, row by row, first row is v = 0.
+    //   Texel is opaque if its alpha is >= threshold. Texture is repeated outside of [0,1]^2.
+    AlphaMask(i32 width, i32 height, const fp_t *alpha, fp_t threshold = fp_t(0.5));
+
+
+    // Nearest texel lookup.
+    bool IsOpaque(const Point2_arg<fp_t> uv) const
+    {
+        i32 x = WrapTexel(static_cast<i32>(pbr::Floor(uv.x * m_width)), m_width);
+        i32 y = WrapTexel(static_cast<i32>(pbr::Floor(uv.y * m_height)), m_height);
+        return (m_bits[y * m_wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    // Conservative coverage of every texel that can be looked up in [uvMin, uvMax] rectangle.
+    AlphaCoverage Classify(const Point2_arg<fp_t> uvMin, const Point2_arg<fp_t> uvMax) const;
+
+    i32 Width() const  { return m_width; }
+    i32 Height() const { return m_height; }
+
+
+private:
+    static i32 WrapTexel(i32 i, i32 size)
+    {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+
+    // Coverage of texels [x0, x1] in the row, x0 <= x1 < m_width.
+    AlphaCoverage ClassifyRow(i32 y, i32 x0, i32 x1) const;
+
+
+    const i32 m_width, m_height;
+    const i32 m_wordsPerRow;
+    // Every row is padded to the whole number of words, padding bits are zero.
+    std::vector<ui64> m_bits;
+    AlphaCoverage m_coverage;
+};
+
+PBR_NAMESPACE_END
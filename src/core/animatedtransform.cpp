@@ -0,0 +1,334 @@
+#include "animatedtransform.h"
+#include <algorithm>    // std::min, std::max, std::clamp
+
+
+PBR_NAMESPACE_BEGIN
+
+namespace {
+
+// Path derivative has at most a couple of zeros on [0, 1], zero at the split point is found once, see FindZeros().
+constexpr i32 maxZeros = 8;
+constexpr i32 zeroSearchDepth = 8;
+
+// Bounds of the expression over the range of t, no rounding, zeros are refined by Newton's method anyway.
+struct Interval
+{
+    explicit Interval(fp_t v) : low(v), high(v) {}
+    Interval(fp_t v0, fp_t v1) : low(std::min(v0, v1)), high(std::max(v0, v1)) {}
+
+    fp_t low, high;
+};
+
+Interval operator+(const Interval &a, const Interval &b) { return Interval(a.low + b.low, a.high + b.high); }
+
+Interval operator*(const Interval &a, const Interval &b)
+{
+    const fp_t ll = a.low * b.low, lh = a.low * b.high, hl = a.high * b.low, hh = a.high * b.high;
+    return Interval(std::min(std::min(ll, lh), std::min(hl, hh)), std::max(std::max(ll, lh), std::max(hl, hh)));
+}
+
+// NOTE: Only for the ranges within [0, 2 * pi].
+Interval Sin(const Interval &i)
+{
+    PBR_ASSERT(i.low >= 0 && i.high <= fp_t(2.0001) * constants::pi_t)
+    fp_t sinLow = std::sin(i.low), sinHigh = std::sin(i.high);
+    if (sinLow > sinHigh)
+        std::swap(sinLow, sinHigh);
+    if (i.low < constants::pi_t / 2 && i.high > constants::pi_t / 2)
+        sinHigh = 1;
+    if (i.low < fp_t(1.5) * constants::pi_t && i.high > fp_t(1.5) * constants::pi_t)
+        sinLow = -1;
+    return Interval(sinLow, sinHigh);
+}
+
+Interval Cos(const Interval &i)
+{
+    PBR_ASSERT(i.low >= 0 && i.high <= fp_t(2.0001) * constants::pi_t)
+    fp_t cosLow = std::cos(i.low), cosHigh = std::cos(i.high);
+    if (cosLow > cosHigh)
+        std::swap(cosLow, cosHigh);
+    if (i.low < constants::pi_t && i.high > constants::pi_t)
+        cosLow = -1;
+    return Interval(cosLow, cosHigh);
+}
+
+// Zeros found so far, in increasing order of t, end of the range the last one was found in.
+struct Zeros
+{
+    fp_t t[maxZeros];
+    i32 count = 0;
+    fp_t lastEnd = -1;
+};
+
+// Zeros of k0 + (k1 + k2 * t) * cos(2 * theta * t) + (k3 + k4 * t) * sin(2 * theta * t) over t.
+//   Ranges that may contain a zero are bisected, then zero in the last one is found by Newton's method.
+// NOTE: Adjacent ranges are merged, it's one zero at their common end, or the function is close to 0 across both
+//       and any point of them will do for the bounds.
+void FindZeros(const fp_t k[5], fp_t theta, Interval t, Zeros &inout_zeros, i32 depth)
+{
+    const Interval angle = Interval(2 * theta) * t;
+    const Interval range = Interval(k[0]) + (Interval(k[1]) + Interval(k[2]) * t) * Cos(angle) +
+                                            (Interval(k[3]) + Interval(k[4]) * t) * Sin(angle);
+    if (range.low > 0 || range.high < 0 || range.low == range.high)
+        return;
+
+    if (depth > 0) {
+        const fp_t mid = (t.low + t.high) / 2;
+        FindZeros(k, theta, Interval(t.low, mid), inout_zeros, depth - 1);
+        FindZeros(k, theta, Interval(mid, t.high), inout_zeros, depth - 1);
+        return;
+    }
+
+    const bool adjacent = inout_zeros.lastEnd == t.low;
+    inout_zeros.lastEnd = t.high;
+    if (adjacent)
+        return;
+
+    fp_t tNewton = (t.low + t.high) / 2;
+    for (i32 i = 0; i < 4; ++i) {
+        const fp_t cosT = std::cos(2 * theta * tNewton), sinT = std::sin(2 * theta * tNewton);
+        const fp_t f = k[0] + (k[1] + k[2] * tNewton) * cosT + (k[3] + k[4] * tNewton) * sinT;
+        const fp_t fPrime = (k[2] + 2 * theta * (k[3] + k[4] * tNewton)) * cosT +
+                            (k[4] - 2 * theta * (k[1] + k[2] * tNewton)) * sinT;
+        if (f == 0 || fPrime == 0)
+            break;
+        tNewton = std::clamp(tNewton - f / fPrime, t.low, t.high);
+    }
+    PBR_ASSERT_MSG(inout_zeros.count < maxZeros, "more separate zeros of the path derivative than it can have")
+    if (inout_zeros.count < maxZeros)
+        inout_zeros.t[inout_zeros.count++] = tNewton;
+}
+
+// Symmetric bilinear form of the rotation matrix, RotationForm(q, q) is the matrix of the unit quaternion q.
+//   Diagonal is written as w^2 + x^2 - y^2 - z^2 instead of 1 - 2 * (y^2 + z^2), so it's homogeneous.
+void RotationForm(const Quaternion &a, const Quaternion &b, fp_t out_m[3][3])
+{
+    const fp_t ww = a.w * b.w, xx = a.v.x * b.v.x, yy = a.v.y * b.v.y, zz = a.v.z * b.v.z;
+    const fp_t xy = a.v.x * b.v.y + a.v.y * b.v.x, xz = a.v.x * b.v.z + a.v.z * b.v.x, yz = a.v.y * b.v.z + a.v.z * b.v.y;
+    const fp_t wx = a.w * b.v.x + a.v.x * b.w,     wy = a.w * b.v.y + a.v.y * b.w,     wz = a.w * b.v.z + a.v.z * b.w;
+
+    out_m[0][0] = ww + xx - yy - zz;  out_m[0][1] = xy - wz;            out_m[0][2] = xz + wy;
+    out_m[1][0] = xy + wz;            out_m[1][1] = ww - xx + yy - zz;  out_m[1][2] = yz - wx;
+    out_m[2][0] = xz - wy;            out_m[2][1] = yz + wx;            out_m[2][2] = ww - xx - yy + zz;
+}
+
+// Product of 3x3 matrices, translation column of the result is zero.
+Matrix3x4 Mul3x3(const fp_t r[3][3], const fp_t s[3][3])
+{
+    Matrix3x4 result;
+    for (i32 i = 0; i < 3; ++i) {
+        for (i32 j = 0; j < 3; ++j)
+            result[i][j] = r[i][0] * s[0][j] + r[i][1] * s[1][j] + r[i][2] * s[2][j];
+        result[i][3] = 0;
+    }
+    return result;
+}
+
+Vector3_t Apply(const Matrix3x4 &m, const Point3_t &p)
+{
+    return Vector3_t(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                     m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                     m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]);
+}
+
+bool MatricesEqual(const Matrix4x4 &a, const Matrix4x4 &b)
+{
+    for (i32 i = 0; i < 4; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            if (a[i][j] != b[i][j])
+                return false;
+    return true;
+}
+
+} // namespace
+
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+AnimatedTransform::AnimatedTransform(const Transform *startTransform, fp_t startTime, const Transform *endTransform, fp_t endTime)
+    : m_startTransform(startTransform)
+    , m_endTransform(endTransform)
+    , m_startTime(startTime)
+    , m_endTime(endTime)
+    , m_actuallyAnimated(MatricesEqual(startTransform->m, endTransform->m) == false)
+{
+    PBR_ASSERT(startTime <= endTime)
+    if (m_actuallyAnimated == false)
+        return;
+
+    Decompose(startTransform->m, m_T[0], m_R[0], m_S[0]);
+    Decompose(endTransform->m, m_T[1], m_R[1], m_S[1]);
+    // q and -q are the same rotation, the one closer to the start is the shortest path.
+    if (Dot(m_R[0], m_R[1]) < 0)
+        m_R[1] = -m_R[1];
+    // NOTE: Same threshold as in Slerp(), below it rotation is interpolated linearly,
+    //       and the path of the point is close enough to the straight line between the ends.
+    const fp_t cosTheta = Dot(m_R[0], m_R[1]);
+    m_hasRotation = cosTheta <= fp_t(0.9995);
+    if (m_hasRotation == false)
+        return;
+
+    // Rotation matrix of Slerp() is R(t) = A + B * cos(2 * theta * t) + C * sin(2 * theta * t),
+    //   since q(t) = q0 * cos(theta * t) + qPerp * sin(theta * t) and the matrix is quadratic in q.
+    m_theta = std::acos(std::clamp(cosTheta, fp_t(-1), fp_t(1)));
+    const Quaternion qPerp = Normalize(m_R[1] - m_R[0] * cosTheta);
+    fp_t R0[3][3], RPerp[3][3], A[3][3], B[3][3], C[3][3];
+    RotationForm(m_R[0], m_R[0], R0);
+    RotationForm(qPerp, qPerp, RPerp);
+    RotationForm(m_R[0], qPerp, C);
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 3; ++j) {
+            A[i][j] = (R0[i][j] + RPerp[i][j]) / 2;
+            B[i][j] = (R0[i][j] - RPerp[i][j]) / 2;
+        }
+
+    // Scale is S(t) = S0 + dS * t, translation is T0 + dT * t, so for a0..c1 of the path
+    //   a1 = A * dS * p + dT, b0 = B * S0 * p, b1 = B * dS * p, c0 = C * S0 * p, c1 = C * dS * p.
+    fp_t S0[3][3], dS[3][3];
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 3; ++j) {
+            S0[i][j] = m_S[0][i][j];
+            dS[i][j] = m_S[1][i][j] - m_S[0][i][j];
+        }
+    Matrix3x4 a1 = Mul3x3(A, dS);
+    for (i32 i = 0; i < 3; ++i)
+        a1[i][3] = m_T[1][i] - m_T[0][i];
+    const Matrix3x4 b0 = Mul3x3(B, S0), b1 = Mul3x3(B, dS);
+    const Matrix3x4 c0 = Mul3x3(C, S0), c1 = Mul3x3(C, dS);
+
+    // p'(t) = a1 + (b1 + 2 * theta * (c0 + c1 * t)) * cos + (c1 - 2 * theta * (b0 + b1 * t)) * sin
+    const fp_t twoTheta = 2 * m_theta;
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 4; ++j) {
+            m_derivative[0][i][j] = a1[i][j];
+            m_derivative[1][i][j] = b1[i][j] + twoTheta * c0[i][j];
+            m_derivative[2][i][j] = twoTheta * c1[i][j];
+            m_derivative[3][i][j] = c1[i][j] - twoTheta * b0[i][j];
+            m_derivative[4][i][j] = -twoTheta * b1[i][j];
+        }
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+// NOTE: Rotation is found by averaging the matrix with its inverse transpose until it converges (Higham's method).
+//       Matrices with negative determinant give a reflection instead of rotation, quaternion of it is meaningless.
+void AnimatedTransform::Decompose(const Matrix4x4_arg m, Vector3_t &out_T, Quaternion &out_R, Matrix4x4 &out_S)
+{
+    PBR_ASSERT(m[3][0] == 0 && m[3][1] == 0 && m[3][2] == 0 && m[3][3] == 1)
+    out_T = Vector3_t(m[0][3], m[1][3], m[2][3]);
+
+    Matrix4x4 M = m;
+    for (i32 i = 0; i < 3; ++i)
+        M[i][3] = 0;
+
+    Matrix4x4 R = M;
+    for (i32 iteration = 0; iteration < 100; ++iteration) {
+        const Matrix4x4 RInverseTranspose = Inverse(Transpose(R));
+        Matrix4x4 RNext;
+        fp_t norm = 0;
+        for (i32 i = 0; i < 3; ++i) {
+            fp_t rowSum = 0;
+            for (i32 j = 0; j < 3; ++j) {
+                RNext[i][j] = fp_t(0.5) * (R[i][j] + RInverseTranspose[i][j]);
+                rowSum += std::abs(R[i][j] - RNext[i][j]);
+            }
+            norm = std::max(norm, rowSum);
+        }
+        R = RNext;
+        if (norm <= fp_t(0.0001))
+            break;
+    }
+
+    out_R = Quaternion(Transform(R, Transpose(R)));
+    // Scale is what's left after the rotation is removed
+    out_S = Mul(Transpose(R), M);
+}
+
+Transform AnimatedTransform::Interpolate(fp_t time) const
+{
+    if (m_actuallyAnimated == false || time <= m_startTime)
+        return *m_startTransform;
+    if (time >= m_endTime)
+        return *m_endTransform;
+
+    const fp_t dt = (time - m_startTime) / (m_endTime - m_startTime);
+    const Vector3_t translation = m_T[0] * (1 - dt) + m_T[1] * dt;
+    const Quaternion rotation = Slerp(dt, m_R[0], m_R[1]);
+    Matrix4x4 scale;
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 3; ++j)
+            scale[i][j] = Lerp(dt, m_S[0][i][j], m_S[1][i][j]);
+
+    return Translate(translation) * rotation.ToTransform() * Transform(scale);
+}
+
+Ray AnimatedTransform::operator()(const Ray_arg r) const
+{
+    if (m_actuallyAnimated == false || r.time <= m_startTime)
+        return (*m_startTransform)(r);
+    if (r.time >= m_endTime)
+        return (*m_endTransform)(r);
+    return Interpolate(r.time)(r);
+}
+
+Point3_t AnimatedTransform::operator()(fp_t time, const Point3_arg<fp_t> p) const
+{
+    if (m_actuallyAnimated == false || time <= m_startTime)
+        return (*m_startTransform)(p);
+    if (time >= m_endTime)
+        return (*m_endTransform)(p);
+    return Interpolate(time)(p);
+}
+
+Vector3_t AnimatedTransform::operator()(fp_t time, const Vector3_arg<fp_t> v) const
+{
+    if (m_actuallyAnimated == false || time <= m_startTime)
+        return (*m_startTransform)(v);
+    if (time >= m_endTime)
+        return (*m_endTransform)(v);
+    return Interpolate(time)(v);
+}
+
+// NOTE: Without rotation every point moves along the straight line, so the boxes at the ends are enough.
+Bounds3_t AnimatedTransform::MotionBounds(const Bounds3_arg<fp_t> b) const
+{
+    if (m_actuallyAnimated == false)
+        return (*m_startTransform)(b);
+    if (m_hasRotation == false)
+        return Union((*m_startTransform)(b), (*m_endTransform)(b));
+
+    // Box is convex, so the motion of its corners bounds the motion of the whole box.
+    Bounds3_t bounds;
+    for (i32 corner = 0; corner < 8; ++corner)
+        bounds = Union(bounds, BoundPointMotion(b.Corner(corner)));
+    return bounds;
+}
+
+Bounds3_t AnimatedTransform::BoundPointMotion(const Point3_arg<fp_t> p) const
+{
+    if (m_actuallyAnimated == false)
+        return Bounds3_t((*m_startTransform)(p));
+
+    Bounds3_t bounds((*m_startTransform)(p), (*m_endTransform)(p));
+    if (m_hasRotation == false)
+        return bounds;
+
+    Vector3_t k[5];
+    for (i32 i = 0; i < 5; ++i)
+        k[i] = Apply(m_derivative[i], p);
+    for (i32 axis = 0; axis < 3; ++axis) {
+        const fp_t kAxis[5] = { k[0][axis], k[1][axis], k[2][axis], k[3][axis], k[4][axis] };
+        Zeros zeros;
+        FindZeros(kAxis, m_theta, Interval(0, 1), zeros, zeroSearchDepth);
+        for (i32 i = 0; i < zeros.count; ++i)
+            bounds = Union(bounds, (*this)(Lerp(zeros.t[i], m_startTime, m_endTime), p));
+    }
+    return bounds;
+}
+
+PBR_NAMESPACE_END
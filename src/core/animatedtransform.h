@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core.hpp"
+#include "transform.hpp"
+#include "quaternion.hpp"
+
+
+PBR_NAMESPACE_BEGIN
+
+// Transform that moves from startTransform at startTime to endTransform at endTime, for motion blur.
+//   Both are decomposed into translation, rotation and scale, M = T * R * S, which are interpolated separately,
+//   translation and scale linearly and rotation by Slerp(), so rigid motion doesn't shear or shrink on the way.
+// NOTE: Times outside of [startTime, endTime] are clamped to the nearest end.
+class AnimatedTransform
+{
+public:
+    // NOTE: Transforms are not copied, they have to outlive AnimatedTransform, see TransformCache.
+    AnimatedTransform(const Transform *startTransform, fp_t startTime, const Transform *endTransform, fp_t endTime);
+
+    // M = T * R * S, where R is a rotation and S is a symmetric scale matrix, found by polar decomposition.
+    //   Matrix has to be affine.
+    static void Decompose(const Matrix4x4_arg m, Vector3_t &out_T, Quaternion &out_R, Matrix4x4 &out_S);
+
+    Transform Interpolate(fp_t time) const;
+
+    // Same as Interpolate(time)(x), but start and end are transformed without interpolation.
+    Ray operator()(const Ray_arg r) const;
+    Point3_t operator()(fp_t time, const Point3_arg<fp_t> p) const;
+    Vector3_t operator()(fp_t time, const Vector3_arg<fp_t> v) const;
+
+    bool IsAnimated() const { return m_actuallyAnimated; }
+
+    // Box that contains b at any time between startTime and endTime.
+    Bounds3_t MotionBounds(const Bounds3_arg<fp_t> b) const;
+    // Box of the path of the point between startTime and endTime, it's exact up to rounding:
+    //   besides the ends, path is evaluated only where its derivative is zero.
+    Bounds3_t BoundPointMotion(const Point3_arg<fp_t> p) const;
+
+private:
+    const Transform *m_startTransform, *m_endTransform;
+    const fp_t m_startTime, m_endTime;
+    const bool m_actuallyAnimated;
+    Vector3_t m_T[2];
+    Quaternion m_R[2];
+    Matrix4x4 m_S[2];
+    bool m_hasRotation = false;
+
+    // DIFFERENCE: Book hardcodes symbolic expressions of the path derivative, here they're computed numerically
+    //             from the decomposition. With normalized time t in [0, 1] the path of a point p is
+    //               p(t) = a0 + a1 * t + (b0 + b1 * t) * cos(2 * theta * t) + (c0 + c1 * t) * sin(2 * theta * t),
+    //             so its derivative is
+    //               p'(t) = k0 + (k1 + k2 * t) * cos(2 * theta * t) + (k3 + k4 * t) * sin(2 * theta * t),
+    //             and every coefficient is an affine function of p, ki = m_derivative[i] * p.
+    //             Only valid if m_hasRotation is set.
+    fp_t m_theta = 0;
+    Matrix3x4 m_derivative[5];
+};
+
+PBR_NAMESPACE_END
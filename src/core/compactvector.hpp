@@ -0,0 +1,165 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+#include <algorithm> // std::clamp
+#include <bit>       // std::bit_cast
+#include <cmath>
+
+#define PBR_CNSTEXPR constexpr
+#define PBR_INLINE inline
+
+
+// Compact storage forms of per vertex attributes, they are decoded back to fp_t when they are used.
+
+PBR_NAMESPACE_BEGIN
+
+// ******************************************************************************
+// ------------------------------- Half precision -------------------------------
+// ******************************************************************************
+
+#pragma region Half
+
+// IEEE 754 binary16, rounding to nearest even. Values too large for half become infinity.
+// NOTE: Conversions are done with integer arithmetic, so they are the same with and without F16C.
+PBR_CNSTEXPR PBR_INLINE
+ui16 FloatToHalf(f32 f)
+{
+    const ui32 bits = std::bit_cast<ui32>(f);
+    const ui16 sign = static_cast<ui16>((bits >> 16) & 0x8000);
+    const ui32 abs = bits & 0x7FFFFFFF;
+
+    // Infinity or NaN, NaN stays quiet NaN
+    if (abs >= 0x7F800000)
+        return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0);
+    // 65520 and more rounds to infinity, largest half is 65504
+    if (abs >= 0x477FF000)
+        return sign | 0x7C00;
+    // Less than 2^-14 is a half denormal, its integer part is the value in units of 2^-24
+    if (abs < 0x38800000) {
+        const i32 shift = 126 - static_cast<i32>(abs >> 23);
+        if (shift > 24)
+            return sign;
+        const ui32 mantissa = (abs & 0x7FFFFF) | 0x800000;
+        ui32 h = mantissa >> shift;
+        const ui32 remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (h & 1)))
+            ++h;
+        return sign | static_cast<ui16>(h);
+    }
+    // Exponent bias goes from 127 to 15, mantissa from 23 to 10 bits. Rounding carry to the exponent is correct.
+    const ui32 h = abs - 0x38000000;
+    return sign | static_cast<ui16>((h + 0xFFF + ((h >> 13) & 1)) >> 13);
+}
+
+PBR_CNSTEXPR PBR_INLINE
+f32 HalfToFloat(ui16 h)
+{
+    const ui32 sign = static_cast<ui32>(h & 0x8000) << 16;
+    const ui32 exponent = (h >> 10) & 0x1F;
+    const ui32 mantissa = h & 0x3FF;
+
+    if (exponent == 0x1F)
+        return std::bit_cast<f32>(sign | 0x7F800000 | (mantissa << 13));
+    // Zero or denormal, mantissa * 2^-24
+    if (exponent == 0) {
+        const f32 value = static_cast<f32>(mantissa) * 5.9604644775390625e-8f;
+        return sign != 0 ? -value : value;
+    }
+    return std::bit_cast<f32>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+// Texture coordinates in half precision, 4 bytes instead of 8(16 with f64).
+// NOTE: In [0.5, 1] the error is up to 2^-12, quarter of a texel of a 1024 texture, and it grows with the magnitude,
+//       meshes with coordinates far outside of [0, 1] should keep the full precision.
+struct HalfPoint2
+{
+    PBR_CNSTEXPR HalfPoint2() = default;
+    PBR_CNSTEXPR explicit HalfPoint2(const Point2_arg<fp_t> p)
+        : x(FloatToHalf(static_cast<f32>(p.x)))
+        , y(FloatToHalf(static_cast<f32>(p.y)))
+    {}
+
+    PBR_CNSTEXPR explicit operator Point2_t() const
+    {
+        return Point2_t(HalfToFloat(x), HalfToFloat(y));
+    }
+
+
+    ui16 x = 0, y = 0;
+};
+
+#pragma endregion Half
+
+
+// ******************************************************************************
+// ------------------------------ OctahedralVector ------------------------------
+// ******************************************************************************
+
+#pragma region OctahedralVector
+
+// Unit vector in 32 bits. Sphere is projected to the octahedron |x| + |y| + |z| = 1, lower half of it is folded over
+//   the upper one, and the resulting square is quantized with 16 bits per side. Error is less than 0.005 degrees.
+// NOTE: Only direction is stored, decoded vectors are normalized. Zero vector is decoded as +z.
+struct OctahedralVector
+{
+    PBR_CNSTEXPR OctahedralVector() = default;
+    PBR_INLINE explicit OctahedralVector(Vector3_t v);
+    PBR_INLINE explicit OctahedralVector(const Normal3_arg<fp_t> n) : OctahedralVector(Vector3_t(n.x, n.y, n.z)) {}
+
+    PBR_INLINE explicit operator Vector3_t() const;
+    PBR_INLINE explicit operator Normal3_t() const { return Normal3_t(Vector3_t(*this)); }
+
+
+    ui16 x = 0, y = 0;
+
+private:
+    static PBR_INLINE ui16 Encode(fp_t f)
+    {
+        return static_cast<ui16>(std::round(std::clamp((f + 1) / 2, fp_t(0), fp_t(1)) * 65535));
+    }
+    static PBR_CNSTEXPR fp_t Decode(ui16 u) { return fp_t(-1) + 2 * (u / fp_t(65535)); }
+};
+
+
+PBR_INLINE
+OctahedralVector::OctahedralVector(Vector3_t v)
+{
+    const fp_t l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    // Zero vector has no direction, it's stored as +z, so it still decodes to a unit vector.
+    if (l1 == 0) {
+        x = y = Encode(0);
+        return;
+    }
+
+    v /= l1;
+    if (v.z >= 0) {
+        x = Encode(v.x);
+        y = Encode(v.y);
+    }
+    else {
+        // Fold the lower half over the diagonals
+        x = Encode((1 - std::abs(v.y)) * std::copysign(fp_t(1), v.x));
+        y = Encode((1 - std::abs(v.x)) * std::copysign(fp_t(1), v.y));
+    }
+}
+
+PBR_INLINE
+OctahedralVector::operator Vector3_t() const
+{
+    Vector3_t v(Decode(x), Decode(y), 0);
+    v.z = 1 - (std::abs(v.x) + std::abs(v.y));
+    if (v.z < 0) {
+        const fp_t xo = v.x;
+        v.x = (1 - std::abs(v.y)) * std::copysign(fp_t(1), xo);
+        v.y = (1 - std::abs(xo)) * std::copysign(fp_t(1), v.y);
+    }
+    return Normalize(v);
+}
+
+#pragma endregion OctahedralVector
+
+PBR_NAMESPACE_END
+
+#undef PBR_CNSTEXPR
+#undef PBR_INLINE
@@ -1,19 +1,62 @@
 #pragma once
 
-#ifdef PBR_COMPILER_MSVC
+#if defined(PBR_COMPILER_MSVC)
     #define PBR_HAVE_ALIGNED_MALLOC
+#elif defined(PBR_COMPILER_GCC) || defined(PBR_COMPILER_Clang)
+    #define PBR_HAVE_POSIX_MEMALIGN
 #else
-    #error "Only MSVC is supported for now"
+    #error "Only MSVC, GCC and Clang are supported for now"
+#endif
+// NOTE: MemoryArena reserves its huge page blocks with mmap(), see memory.cpp.
+#if defined(__linux__) || defined(__APPLE__)
+    #define PBR_HAVE_MMAP
 #endif
 
 // NOTE: May be should be called PBR_ENABLE_ERROR_CORRECTION
-#define PBR_ENABLE_EFLOAT 1
-#define PBR_EFLOAT_DEBUG 1
+// NOTE: Both can be set from CMake, together they select arithmetic of quadric shapes, see efloat.hpp.
+#ifndef PBR_ENABLE_EFLOAT
+    #define PBR_ENABLE_EFLOAT 1
+#endif
+#ifndef PBR_EFLOAT_DEBUG
+    #define PBR_EFLOAT_DEBUG 1
+#endif
+// NOTE: Polynomial approximations for phi and theta of shape hits, see fastmath.hpp. Can be set from CMake.
+#ifndef PBR_ENABLE_FAST_MATH
+    #define PBR_ENABLE_FAST_MATH 0
+#endif
+
+// SSE2 is the baseline of x64, fastmath.hpp has SSE variants of its functions.
+#if defined(_M_X64) || defined(__SSE2__)
+    #define PBR_ENABLE_SSE 1
+#else
+    #define PBR_ENABLE_SSE 0
+#endif
+// AVX is enabled by compiler flags (/arch:AVX), without it 8 wide types of simd.hpp are pairs of SSE registers.
+#if PBR_ENABLE_SSE == 1 && defined(__AVX__)
+    #define PBR_ENABLE_AVX 1
+#else
+    #define PBR_ENABLE_AVX 0
+#endif
+// BMI2 comes with AVX2 (/arch:AVX2, -mbmi2), spacefillingcurve.h uses its pdep/pext for Morton codes.
+// NOTE: pdep/pext are microcoded and slow on AMD before Zen 3, define PBR_ENABLE_BMI2=0 for those.
+#ifndef PBR_ENABLE_BMI2
+    #if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+        #define PBR_ENABLE_BMI2 1
+    #else
+        #define PBR_ENABLE_BMI2 0
+    #endif
+#endif
+// NOTE: Vector3A of geometry.hpp is SSE register if it's set, can be disabled to compare with its scalar fallback.
+#ifndef PBR_ENABLE_SIMD_GEOMETRY
+    #define PBR_ENABLE_SIMD_GEOMETRY PBR_ENABLE_SSE
+#endif
 
 #define PBR_ENABLE_STATS_COUNT 1
 #define PBR_ENABLE_PROFILING 1
 
 #define PBR_L1_CACHE_LINE_SIZE 64
+// NOTE: Size of x64 huge pages, except the 1 GB ones.
+#define PBR_HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
 
 //#include "pbr_concepts.hpp"
@@ -25,13 +68,23 @@
 using i32  = std::int32_t;
 using i64  = std::int64_t;
 using ui8  = std::uint8_t;
+using ui16 = std::uint16_t;
 using ui32 = std::uint32_t;
 using ui64 = std::uint64_t;
 using f32  = float;
 using f64  = double;
 
 
+// NOTE: Precision of the whole library, set from CMake, which builds both pbr_lib (f32) and pbr_lib_f64.
+#ifndef PBR_FP_T_F64
+    #define PBR_FP_T_F64 0
+#endif
+
+#if PBR_FP_T_F64 == 1
+using fp_t = f64;
+#else
 using fp_t = f32;
+#endif
 
 
 #ifndef PBR_DISTRIBUTION
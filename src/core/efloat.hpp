@@ -3,9 +3,19 @@
 #include "core.hpp"
 #include "pbr_math.hpp"
 
+#if PBR_ENABLE_SSE == 1
+    #include "simd.hpp"
+#endif
+
 
 // TODO: This class got big improvement, compare to book version.
-// TODO: Write tests for it.
+// NOTE: Quadric shapes are templated on the arithmetic they use for quadratic coefficients, it's one of:
+//       EFloatT<true>  - EFloat which also keeps precise f64 value and checks that it's inside of error bounds,
+//       EFloatT<false> - EFloat without debug field and checks,
+//       RawFloat       - fp_t with the magnitude of the expression, bounds are fixed relative epsilon of the magnitude.
+//       Shapes use QuadricFloat, which is selected by PBR_ENABLE_EFLOAT and PBR_EFLOAT_DEBUG at build time.
+// NOTE: EFloat4 and EFloat8 are EFloat for packets of independent values, e.g. quadratic coefficients of several rays
+//       or several shapes, they compute exactly the same values and errors as scalar EFloatT<false> lane by lane.
 
 
 PBR_NAMESPACE_BEGIN
@@ -55,85 +65,103 @@ f32 NextFloatDown(f32 f)
 }
 */
 
-class EFloat
+// Debug variant keeps the precise value in this base, so non-debug EFloat is just two floats.
+template<bool Debug>
+struct EFloatPrecise {};
+
+template<>
+struct EFloatPrecise<true>
+{
+    f64 precise;
+};
+
+
+template<bool Debug>
+class EFloatT : private EFloatPrecise<Debug>
 {
 public:
-    EFloat() = default;
+    EFloatT() = default;
     // NOTE: What's the use of error argument, why do we need it ?
-    explicit EFloat(f32 value, f32 error = 0.f);
-#if PBR_EFLOAT_DEBUG == 1
-    explicit EFloat(f32 value, f32 error, f64 precise);
-#endif
+    explicit EFloatT(fp_t value, fp_t error = 0);
+    // NOTE: precise is ignored by non-debug variant.
+    explicit EFloatT(fp_t value, fp_t error, f64 precise);
 
-    friend bool operator==(EFloat ef1, EFloat ef2);
+    template<bool D> friend bool operator==(EFloatT<D> ef1, EFloatT<D> ef2);
 
-    friend EFloat operator-(EFloat ef);
+    template<bool D> friend EFloatT<D> operator-(EFloatT<D> ef);
 
-    friend EFloat operator+(EFloat ef1, EFloat ef2);
-    friend EFloat operator-(EFloat ef1, EFloat ef2);
-    friend EFloat operator*(EFloat ef1, EFloat ef2);
-    friend EFloat operator/(EFloat ef1, EFloat ef2);
+    template<bool D> friend EFloatT<D> operator+(EFloatT<D> ef1, EFloatT<D> ef2);
+    template<bool D> friend EFloatT<D> operator-(EFloatT<D> ef1, EFloatT<D> ef2);
+    template<bool D> friend EFloatT<D> operator*(EFloatT<D> ef1, EFloatT<D> ef2);
+    template<bool D> friend EFloatT<D> operator/(EFloatT<D> ef1, EFloatT<D> ef2);
 
-    explicit operator f32() const { return value; }
+    explicit operator fp_t() const { return value; }
 
 
-    f32 GetAbsoluteError() const {return error; }
+    fp_t GetAbsoluteError() const {return error; }
     // DIFFERENCE: I'm lazy, and I don't know if there is the difference between std and book implementation.
-    f32 UpperBound() const { return std::nexttowardf(value + error, std::numeric_limits<f64>::infinity()); }
-    f32 LowerBound() const { return std::nexttowardf(value - error, -std::numeric_limits<f64>::infinity()); }
+    fp_t UpperBound() const { return std::nextafter(value + error, std::numeric_limits<fp_t>::infinity()); }
+    fp_t LowerBound() const { return std::nextafter(value - error, -std::numeric_limits<fp_t>::infinity()); }
 
-#if PBR_EFLOAT_DEBUG == 1
-    f64 GetPreciseValue() const { return precise; }
-    f32 GetRelativeError() const { return std::abs((precise - value) / precise); }
-#endif
+    // NOTE: Non-debug variant doesn't know precise value, so it returns the value itself.
+    f64 GetPreciseValue() const
+    {
+        if constexpr (Debug)
+            return this->precise;
+        else
+            return value;
+    }
+    fp_t GetRelativeError() const { return static_cast<fp_t>(std::abs((GetPreciseValue() - value) / GetPreciseValue())); }
 
-    friend EFloat Sqrt(EFloat ef);
-    friend EFloat Abs(EFloat ef);
-    friend bool Quadratic(EFloat a, EFloat b, EFloat c, EFloat &out_t0, EFloat &out_t1);
+    template<bool D> friend EFloatT<D> Sqrt(EFloatT<D> ef);
+    template<bool D> friend EFloatT<D> Abs(EFloatT<D> ef);
+    template<bool D> friend bool Quadratic(EFloatT<D> a, EFloatT<D> b, EFloatT<D> c, EFloatT<D> &out_t0, EFloatT<D> &out_t1);
 
 
 private:
     inline void CheckCorrectness() const;
 
 
-    f32 value;
-    f32 error;
-#if PBR_EFLOAT_DEBUG == 1
-    f64 precise;
-#endif
+    fp_t value;
+    fp_t error;
 };
 
+using EFloat = EFloatT<PBR_EFLOAT_DEBUG == 1>;
+
 
 // ---------------------------------------
 // ------------ CONSTRUCTORS -------------
 // ---------------------------------------
 
-EFloat::EFloat(f32 value, f32 error = 0.f)
+template<bool Debug> inline
+EFloatT<Debug>::EFloatT(fp_t value, fp_t error)
     : value(value)
     , error(error)
 {
-#if PBR_EFLOAT_DEBUG == 1
-    precise = value;
-    CheckCorrectness();
-#endif
+    if constexpr (Debug) {
+        this->precise = value;
+        CheckCorrectness();
+    }
 }
 
-#if PBR_EFLOAT_DEBUG == 1
-EFloat::EFloat(f32 value, f32 error, f64 precise)
+template<bool Debug> inline
+EFloatT<Debug>::EFloatT(fp_t value, fp_t error, f64 precise)
     : value(value)
     , error(error)
-    , precise(precise)
 {
-    CheckCorrectness();
+    if constexpr (Debug) {
+        this->precise = precise;
+        CheckCorrectness();
+    }
 }
-#endif
 
 
 // ---------------------------------------
 // -------- COMPARISON OPERATORS ---------
 // ---------------------------------------
 
-bool operator==(EFloat ef1, EFloat ef2)
+template<bool D> inline
+bool operator==(EFloatT<D> ef1, EFloatT<D> ef2)
 {
     return ef1.value == ef2.value && ef1.error == ef2.error;
 }
@@ -143,14 +171,10 @@ bool operator==(EFloat ef1, EFloat ef2)
 // ----- UNARY ARITHMETIC OPERATORS ------
 // ---------------------------------------
 
-EFloat operator-(EFloat ef)
+template<bool D> inline
+EFloatT<D> operator-(EFloatT<D> ef)
 {
-    return EFloat(-ef.value,
-                  ef.error
-#if PBR_EFLOAT_DEBUG == 1
-                  , -ef.precise
-#endif
-                 );
+    return EFloatT<D>(-ef.value, ef.error, -ef.GetPreciseValue());
 }
 
 
@@ -158,77 +182,65 @@ EFloat operator-(EFloat ef)
 // ----- BINARY ARITHMETIC OPERATORS -----
 // ---------------------------------------
 
-EFloat operator+(EFloat ef1, EFloat ef2)
+// NOTE: Precise values are computed for non-debug variant too, but they're unused and will be thrown away by compiler.
+template<bool D> inline
+EFloatT<D> operator+(EFloatT<D> ef1, EFloatT<D> ef2)
 {
-    EFloat result(ef1.value + ef2.value,
-                  ef1.error + ef2.error + constants::machineEpsilon * (std::abs(ef1.value + ef2.value) + ef1.error + ef2.error)
-#if PBR_EFLOAT_DEBUG == 1
-                  , ef1.precise + ef2.precise
-#endif
-                  );
-    result.CheckCorrectness();
-
-    return result;
+    return EFloatT<D>(ef1.value + ef2.value,
+                      ef1.error + ef2.error + constants::machineEpsilon * (std::abs(ef1.value + ef2.value) + ef1.error + ef2.error),
+                      ef1.GetPreciseValue() + ef2.GetPreciseValue());
 }
 
-EFloat operator-(EFloat ef1, EFloat ef2)
+template<bool D> inline
+EFloatT<D> operator-(EFloatT<D> ef1, EFloatT<D> ef2)
 {
-    EFloat result(ef1.value - ef2.value,
-                  ef1.error + ef2.error + constants::machineEpsilon * (std::abs(ef1.value - ef2.value) + ef1.error + ef2.error)
-#if PBR_EFLOAT_DEBUG == 1
-                  , ef1.precise - ef2.precise
-#endif
-                  );
-    result.CheckCorrectness();
-
-    return result;
+    return EFloatT<D>(ef1.value - ef2.value,
+                      ef1.error + ef2.error + constants::machineEpsilon * (std::abs(ef1.value - ef2.value) + ef1.error + ef2.error),
+                      ef1.GetPreciseValue() - ef2.GetPreciseValue());
 }
 
-EFloat operator*(EFloat ef1, EFloat ef2)
+template<bool D> inline
+EFloatT<D> operator*(EFloatT<D> ef1, EFloatT<D> ef2)
 {
-    EFloat result(ef1.value * ef2.value,
-                  std::abs(ef1.value * ef2.error) + std::abs(ef2.value * ef1.error) + ef1.error * ef2.error + constants::machineEpsilon * std::abs(ef1.value * ef2.value)
-#if PBR_EFLOAT_DEBUG == 1
-                  , ef1.precise * ef2.precise
-#endif
-                  );
-    result.CheckCorrectness();
-
-    return result;
+    return EFloatT<D>(ef1.value * ef2.value,
+                      std::abs(ef1.value * ef2.error) + std::abs(ef2.value * ef1.error) + ef1.error * ef2.error + constants::machineEpsilon * std::abs(ef1.value * ef2.value),
+                      ef1.GetPreciseValue() * ef2.GetPreciseValue());
 }
 
-EFloat operator/(EFloat ef1, EFloat ef2)
+// NOTE: When interval of the divisor contains 0 the quotient isn't bounded, error is infinity then, not negative.
+template<bool D> inline
+EFloatT<D> operator/(EFloatT<D> ef1, EFloatT<D> ef2)
 {
-    EFloat result(ef1.value / ef2.value,
-                  (std::abs(ef1.value) + ef1.error) / (std::abs(ef2.value) - ef2.error) - std::abs(ef1.value / ef2.value) + constants::machineEpsilon * (std::abs(ef1.value) + ef1.error) / (std::abs(ef2.value) - ef2.error)
-#if PBR_EFLOAT_DEBUG == 1
-                  , ef1.precise / ef2.precise
-#endif
-                  );
-    result.CheckCorrectness();
-
-    return result;
+    const fp_t denominator = std::abs(ef2.value) - ef2.error;
+    return EFloatT<D>(ef1.value / ef2.value,
+                      denominator <= 0 ? constants::infinity :
+                      (std::abs(ef1.value) + ef1.error) / denominator - std::abs(ef1.value / ef2.value) + constants::machineEpsilon * (std::abs(ef1.value) + ef1.error) / denominator,
+                      ef1.GetPreciseValue() / ef2.GetPreciseValue());
 }
 
 
-EFloat operator+(f32 f, EFloat ef)
+template<bool D> inline
+EFloatT<D> operator+(fp_t f, EFloatT<D> ef)
 {
-    return EFloat(f) + ef;
+    return EFloatT<D>(f) + ef;
 }
 
-EFloat operator-(f32 f, EFloat ef)
+template<bool D> inline
+EFloatT<D> operator-(fp_t f, EFloatT<D> ef)
 {
-    return EFloat(f) - ef;
+    return EFloatT<D>(f) - ef;
 }
 
-EFloat operator*(f32 f, EFloat ef)
+template<bool D> inline
+EFloatT<D> operator*(fp_t f, EFloatT<D> ef)
 {
-    return EFloat(f) * ef;
+    return EFloatT<D>(f) * ef;
 }
 
-EFloat operator/(f32 f, EFloat ef)
+template<bool D> inline
+EFloatT<D> operator/(fp_t f, EFloatT<D> ef)
 {
-    return EFloat(f) / ef;
+    return EFloatT<D>(f) / ef;
 }
 
 
@@ -236,13 +248,16 @@ EFloat operator/(f32 f, EFloat ef)
 // --------------- METHODS ---------------
 // ---------------------------------------
 
-inline
-void EFloat::CheckCorrectness() const
+template<bool Debug> inline
+void EFloatT<Debug>::CheckCorrectness() const
 {
     // DIFFERENCE: In original they allow a value to be NaN or Inf, but why ?
     PBR_ASSERT(std::isfinite(value))
     PBR_ASSERT(error >= 0)
-    PBR_ASSERT(value - error <= precise && value + error >= precise)
+    if constexpr (Debug) {
+        // NOTE: Bounds are computed in f64, in f32 their rounding can be bigger than the error itself.
+        PBR_ASSERT(f64(value) - error <= this->precise && f64(value) + error >= this->precise)
+    }
 }
 
 
@@ -251,42 +266,39 @@ void EFloat::CheckCorrectness() const
 // ---------------------------------------
 
 // NOTE: std::sqrt should be good enough
-EFloat Sqrt(EFloat ef)
+// NOTE: Interval may reach below zero, when value is close to it, lower bound is clamped then.
+template<bool D> inline
+EFloatT<D> Sqrt(EFloatT<D> ef)
 {
-    return EFloat(pbr::Sqrt(ef.value),
-                  pbr::Sqrt(ef.value + ef.error) - pbr::Sqrt(ef.value - ef.error) + constants::machineEpsilon * pbr::Sqrt(ef.value + ef.error)
-#if PBR_EFLOAT_DEBUG == 1
-                  , ef.precise / ef.precise
-#endif
-                 );
+    return EFloatT<D>(pbr::Sqrt(ef.value),
+                      pbr::Sqrt(ef.value + ef.error) - pbr::Sqrt(std::max(fp_t(0), ef.value - ef.error)) + constants::machineEpsilon * pbr::Sqrt(ef.value + ef.error),
+                      std::sqrt(std::max(0., ef.GetPreciseValue())));
 }
 
-EFloat Abs(EFloat ef)
+template<bool D> inline
+EFloatT<D> Abs(EFloatT<D> ef)
 {
-    return EFloat(std::abs(ef.value),
-                  ef.error
-#if PBR_EFLOAT_DEBUG == 1
-                  , std::abs(ef.precise)
-#endif
-                 );
+    return EFloatT<D>(std::abs(ef.value), ef.error, std::abs(ef.GetPreciseValue()));
 }
 
-// DIFFERENCE: Discriminant was double
+// DIFFERENCE: Discriminant was double, and only the rounding of its square root was included into the error.
+//             Here error of the discriminant is tracked too, otherwise the bounds are too tight
+//             when a, b and c are exact, e.g. when the ray wasn't transformed.
 // If there is solution, out_t0 will be <= out_t1
-bool Quadratic(EFloat a, EFloat b, EFloat c, EFloat &out_t0, EFloat &out_t1)
+template<bool D> inline
+bool Quadratic(EFloatT<D> a, EFloatT<D> b, EFloatT<D> c, EFloatT<D> &out_t0, EFloatT<D> &out_t1)
 {
-    fp_t discriminant = b.value * b.value - 4.f * a.value * c.value;
-    if(discriminant < 0.f)
+    EFloatT<D> discriminant = b * b - fp_t(4) * a * c;
+    if(discriminant.value < 0)
         return false;
 
-    fp_t rootD = pbr::Sqrt(discriminant);
-    EFloat efD(rootD, constants::machineEpsilon * rootD);
+    EFloatT<D> efD = Sqrt(discriminant);
 
-    EFloat q;
-    if(b.value < 0.f)
-        q = -.5f * (b - efD);
+    EFloatT<D> q;
+    if(b.value < 0)
+        q = fp_t(-0.5) * (b - efD);
     else
-        q = -.5f * (b + efD);
+        q = fp_t(-0.5) * (b + efD);
 
     out_t0 = q / a;
     out_t1 = c / q;
@@ -297,4 +309,221 @@ bool Quadratic(EFloat a, EFloat b, EFloat c, EFloat &out_t0, EFloat &out_t1)
     return true;
 }
 
+
+// ******************************************************************************
+// --------------------------------- RawFloat -----------------------------------
+// ******************************************************************************
+
+// Float with the same interface as EFloat. Error isn't tracked, only the magnitude of the expression, it's the same
+//   expression evaluated with absolute values of all operands, so there is no cancellation in it. Error of n operations
+//   is at most Gamma(n) times the magnitude, so it costs one more operation per operation, and bounds are wider than of EFloat.
+// NOTE: Magnitude keeps the error when value cancels out, e.g. c of the ray starting on the quadric surface is close to 0,
+//       but its error is still relative to the squared radius, and so is the error of the root close to 0.
+class RawFloat
+{
+public:
+    // NOTE: Quadric coefficients and roots of Quadratic() take less than 16 operations on every path.
+    static constexpr fp_t relativeError = Gamma(16);
+
+    RawFloat() = default;
+    // Initial error is a part of the magnitude, it's where the expression evaluated with absolute values would be off by it.
+    explicit RawFloat(fp_t value, fp_t error = 0) : value(value), magnitude(std::abs(value) + error / relativeError) {}
+
+    friend bool operator==(RawFloat f1, RawFloat f2) { return f1.value == f2.value; }
+
+    friend RawFloat operator-(RawFloat f) { return WithMagnitude(-f.value, f.magnitude); }
+
+    friend RawFloat operator+(RawFloat f1, RawFloat f2) { return WithMagnitude(f1.value + f2.value, f1.magnitude + f2.magnitude); }
+    friend RawFloat operator-(RawFloat f1, RawFloat f2) { return WithMagnitude(f1.value - f2.value, f1.magnitude + f2.magnitude); }
+    friend RawFloat operator*(RawFloat f1, RawFloat f2) { return WithMagnitude(f1.value * f2.value, f1.magnitude * f2.magnitude); }
+    // NOTE: First order, |f1 / f2| * (e1 / |f1| + e2 / |f2|), unbounded when interval of the divisor contains 0, as in EFloat.
+    friend RawFloat operator/(RawFloat f1, RawFloat f2)
+    {
+        const fp_t quotient = f1.value / f2.value;
+        if (std::abs(f2.value) <= f2.GetAbsoluteError())
+            return WithMagnitude(quotient, constants::infinity);
+        return WithMagnitude(quotient, (f1.magnitude + std::abs(quotient) * f2.magnitude) / std::abs(f2.value));
+    }
+
+    friend RawFloat operator+(fp_t f1, RawFloat f2) { return RawFloat(f1) + f2; }
+    friend RawFloat operator-(fp_t f1, RawFloat f2) { return RawFloat(f1) - f2; }
+    friend RawFloat operator*(fp_t f1, RawFloat f2) { return RawFloat(f1) * f2; }
+    friend RawFloat operator/(fp_t f1, RawFloat f2) { return RawFloat(f1) / f2; }
+
+    explicit operator fp_t() const { return value; }
+
+
+    fp_t GetAbsoluteError() const { return relativeError * magnitude; }
+    fp_t UpperBound() const { return value + GetAbsoluteError(); }
+    fp_t LowerBound() const { return value - GetAbsoluteError(); }
+
+    // NOTE: Square root isn't linear near 0, so its error is computed as in EFloat and turned back into the magnitude.
+    friend RawFloat Sqrt(RawFloat f)
+    {
+        const fp_t error = f.GetAbsoluteError();
+        const fp_t upper = pbr::Sqrt(f.value + error);
+        const fp_t sqrtError = upper - pbr::Sqrt(std::max(fp_t(0), f.value - error)) + constants::machineEpsilon * upper;
+        const fp_t root = pbr::Sqrt(f.value);
+        return WithMagnitude(root, std::max(root, sqrtError / relativeError));
+    }
+    friend RawFloat Abs(RawFloat f) { return WithMagnitude(std::abs(f.value), f.magnitude); }
+    // Same expressions as Quadratic() of EFloat, so the magnitude of the root close to 0 keeps the one of c.
+    // If there is solution, out_t0 will be <= out_t1
+    friend bool Quadratic(RawFloat a, RawFloat b, RawFloat c, RawFloat &out_t0, RawFloat &out_t1)
+    {
+        const RawFloat discriminant = b * b - fp_t(4) * a * c;
+        if (discriminant.value < 0)
+            return false;
+
+        const RawFloat rootD = Sqrt(discriminant);
+        const RawFloat q = b.value < 0 ? fp_t(-0.5) * (b - rootD) : fp_t(-0.5) * (b + rootD);
+        out_t0 = q / a;
+        out_t1 = c / q;
+        if (out_t0.value > out_t1.value)
+            std::swap(out_t0, out_t1);
+
+        return true;
+    }
+
+
+private:
+    static RawFloat WithMagnitude(fp_t value, fp_t magnitude)
+    {
+        RawFloat f;
+        f.value = value;
+        f.magnitude = magnitude;
+        return f;
+    }
+
+    fp_t value;
+    fp_t magnitude;
+};
+
+
+// ******************************************************************************
+// ---------------------------- EFloat4 / EFloat8 -------------------------------
+// ******************************************************************************
+
+#if PBR_ENABLE_SSE == 1
+
+// EFloat over SIMD lanes, Pack is f32x4 or f32x8 from simd.hpp.
+//   Every operation is the same expression as in scalar EFloatT, in the same order, so lanes are bit exact with it.
+// DIFFERENCE: There is no debug variant, precise f64 lanes would cost more than the rest of it,
+//             lanes can be checked by converting them to EFloatT<true> with Lane().
+// NOTE: Values of the lanes are not checked for being finite, unlike scalar EFloat.
+template<typename Pack>
+class EFloatN
+{
+public:
+    static constexpr i32 width = Pack::width;
+    // NOTE: Lanes are f32 whatever fp_t is.
+    static constexpr f32 machineEpsilon = 0.5f * std::numeric_limits<f32>::epsilon();
+
+    EFloatN() = default;
+    explicit EFloatN(Pack value, Pack error = Pack(0.f)) : value(value), error(error) {}
+    explicit EFloatN(f32 value, f32 error = 0.f) : value(value), error(error) {}
+    template<bool D>
+    explicit EFloatN(const EFloatT<D> (&lanes)[width])
+    {
+        alignas(32) f32 values[width], errors[width];
+        for (i32 i = 0; i < width; ++i) {
+            values[i] = static_cast<f32>(static_cast<fp_t>(lanes[i]));
+            errors[i] = static_cast<f32>(lanes[i].GetAbsoluteError());
+        }
+        value = Pack::Load(values);
+        error = Pack::Load(errors);
+    }
+
+    friend EFloatN operator-(EFloatN ef) { return EFloatN(-ef.value, ef.error); }
+
+    friend EFloatN operator+(EFloatN ef1, EFloatN ef2)
+    {
+        const Pack sum = ef1.value + ef2.value;
+        return EFloatN(sum, ef1.error + ef2.error + Pack(machineEpsilon) * (Abs(sum) + ef1.error + ef2.error));
+    }
+    friend EFloatN operator-(EFloatN ef1, EFloatN ef2)
+    {
+        const Pack difference = ef1.value - ef2.value;
+        return EFloatN(difference, ef1.error + ef2.error + Pack(machineEpsilon) * (Abs(difference) + ef1.error + ef2.error));
+    }
+    friend EFloatN operator*(EFloatN ef1, EFloatN ef2)
+    {
+        const Pack product = ef1.value * ef2.value;
+        return EFloatN(product, Abs(ef1.value * ef2.error) + Abs(ef2.value * ef1.error) + ef1.error * ef2.error + Pack(machineEpsilon) * Abs(product));
+    }
+    friend EFloatN operator/(EFloatN ef1, EFloatN ef2)
+    {
+        const Pack quotient = ef1.value / ef2.value;
+        const Pack numerator = Abs(ef1.value) + ef1.error;
+        const Pack denominator = Abs(ef2.value) - ef2.error;
+        const Pack error = numerator / denominator - Abs(quotient) + Pack(machineEpsilon) * numerator / denominator;
+        return EFloatN(quotient, Select(denominator <= Pack(0.f), Pack(std::numeric_limits<f32>::infinity()), error));
+    }
+
+    friend EFloatN operator+(f32 f, EFloatN ef) { return EFloatN(f) + ef; }
+    friend EFloatN operator-(f32 f, EFloatN ef) { return EFloatN(f) - ef; }
+    friend EFloatN operator*(f32 f, EFloatN ef) { return EFloatN(f) * ef; }
+    friend EFloatN operator/(f32 f, EFloatN ef) { return EFloatN(f) / ef; }
+
+
+    Pack Value() const { return value; }
+    Pack GetAbsoluteError() const { return error; }
+    Pack UpperBound() const { return NextFloatUp(value + error); }
+    Pack LowerBound() const { return NextFloatDown(value - error); }
+
+    template<bool D>
+    EFloatT<D> Lane(i32 i) const { return EFloatT<D>(value[i], error[i]); }
+
+
+    friend EFloatN Sqrt(EFloatN ef)
+    {
+        const Pack rootUpper = Sqrt(ef.value + ef.error);
+        return EFloatN(Sqrt(ef.value),
+                       rootUpper - Sqrt(Max(Pack(0.f), ef.value - ef.error)) + Pack(machineEpsilon) * rootUpper);
+    }
+
+    friend EFloatN Abs(EFloatN ef) { return EFloatN(Abs(ef.value), ef.error); }
+
+    // Batched Quadratic() of scalar EFloat, returns mask of the lanes that have solution.
+    //   out_t0 <= out_t1 in these lanes, other lanes have unspecified values.
+    friend Pack Quadratic(EFloatN a, EFloatN b, EFloatN c, EFloatN &out_t0, EFloatN &out_t1)
+    {
+        const EFloatN discriminant = b * b - 4.f * a * c;
+        const Pack hasSolution = discriminant.value >= Pack(0.f);
+
+        const EFloatN efD = Sqrt(discriminant);
+        const EFloatN q = -.5f * Select(b.value < Pack(0.f), b - efD, b + efD);
+        const EFloatN t0 = q / a;
+        const EFloatN t1 = c / q;
+
+        const Pack swap = t0.value > t1.value;
+        out_t0 = Select(swap, t1, t0);
+        out_t1 = Select(swap, t0, t1);
+
+        return hasSolution;
+    }
+
+    friend EFloatN Select(Pack mask, EFloatN ef1, EFloatN ef2)
+    {
+        return EFloatN(pbr::Select(mask, ef1.value, ef2.value), pbr::Select(mask, ef1.error, ef2.error));
+    }
+
+
+private:
+    Pack value;
+    Pack error;
+};
+
+using EFloat4 = EFloatN<f32x4>;
+using EFloat8 = EFloatN<f32x8>;
+
+#endif
+
+
+#if PBR_ENABLE_EFLOAT == 1
+using QuadricFloat = EFloat;
+#else
+using QuadricFloat = RawFloat;
+#endif
+
 PBR_NAMESPACE_END
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "core.hpp"
+#include "pbr_math.hpp"
+
+#include <bit>
+
+#if PBR_ENABLE_SSE == 1
+    #include <emmintrin.h>
+#endif
+
+// Polynomial approximations of the transcendental functions, which are used for parametrization of shape hits.
+//   Approximations are fitted for f32, f64 overloads just call std functions.
+//   Maximum errors are measured against f64 std functions, see benchmarks/bench_fastmath.cpp, tests/test_fastmath.cpp
+//   checks that they hold.
+//   SSE variants compute the same operations in the same order, so they give the same results as scalar ones.
+// NOTE: None of them handles NaN or infinity specially, garbage in garbage out.
+
+
+PBR_NAMESPACE_BEGIN
+
+namespace fastmath {
+
+// ****************************************************************************************************************
+// ************************************************** SCALAR ******************************************************
+// ****************************************************************************************************************
+
+#pragma region Scalar
+
+namespace detail {
+
+// Minimax polynomial of atan(t) / t in t^2 on [0, 1]
+inline f32 ATanPolynomial(f32 t)
+{
+    const f32 t2 = t * t;
+    return t * (0.99997726f + t2 * (-0.33262347f + t2 * (0.19354346f + t2 * (-0.11643287f + t2 * (0.05265332f + t2 * -0.01172120f)))));
+}
+
+// acos(x) / sqrt(1 - x) on [0, 1], Abramowitz and Stegun 4.4.46
+inline f32 ACosPolynomial(f32 x)
+{
+    return 1.5707963050f + x * (-0.2145988016f + x * (0.0889789874f + x * (-0.0501743046f + x * (0.0308918810f +
+           x * (-0.0170881256f + x * (0.0066700901f + x * -0.0012624911f))))));
+}
+
+// sin(r) and cos(r) on [-pi/4, pi/4], minimax polynomials from Cephes
+inline f32 SinPolynomial(f32 r)
+{
+    const f32 r2 = r * r;
+    return r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+}
+
+inline f32 CosPolynomial(f32 r)
+{
+    const f32 r2 = r * r;
+    return 1.f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+}
+
+// pi/2 split into three parts, first two have trailing zero bits, so k * part is exact for the small k.
+inline constexpr f32 piOver2Hi  = 1.5703125f;
+inline constexpr f32 piOver2Mid = 4.837512969970703125e-4f;
+inline constexpr f32 piOver2Lo  = 7.54978995489188216e-8f;
+
+// Reduces x to r in [-pi/4, pi/4], x = r + quadrant * pi/2.
+inline f32 ReduceToQuadrant(f32 x, i32 &out_quadrant)
+{
+    // NOTE: Rounds half away from zero by truncation, std::nearbyint() isn't inlined without SSE4.1 and is slower than the rest.
+    out_quadrant = static_cast<i32>(x * (2 / std::numbers::pi_v<f32>) + std::copysign(0.5f, x));
+    const f32 k = static_cast<f32>(out_quadrant);
+    return ((x - k * piOver2Hi) - k * piOver2Mid) - k * piOver2Lo;
+}
+
+// Branchless select, signs and octants of the hits are random, so branches would be mispredicted half of the time.
+inline f32 Select(bool condition, f32 a, f32 b)
+{
+    const ui32 mask = 0u - static_cast<ui32>(condition);
+    return std::bit_cast<f32>((std::bit_cast<ui32>(a) & mask) | (std::bit_cast<ui32>(b) & ~mask));
+}
+
+} // namespace detail
+
+
+// Max error is 2.0e-6 radians, std::atan2f() has 2.5e-7. Result is in [-pi, pi], as std::atan2().
+inline f32 ATan2(f32 y, f32 x)
+{
+    const f32 ax = std::abs(x), ay = std::abs(y);
+    const f32 maxXY = std::max(ax, ay);
+    // atan2(0, 0) is 0 for std::atan2() too
+    f32 r = detail::ATanPolynomial(maxXY == 0 ? 0.f : std::min(ax, ay) / maxXY);
+    r = detail::Select(ay > ax, std::numbers::pi_v<f32> / 2 - r, r);
+    r = detail::Select(std::signbit(x), std::numbers::pi_v<f32> - r, r);
+    return std::copysign(r, y);
+}
+
+// Max error is 4.4e-7 radians, std::acosf() has 2.1e-7. x must be in [-1, 1].
+inline f32 ACos(f32 x)
+{
+    const f32 ax = std::abs(x);
+    const f32 r = pbr::Sqrt(1 - ax) * detail::ACosPolynomial(ax);
+    return detail::Select(x < 0, std::numbers::pi_v<f32> - r, r);
+}
+
+// Max error of Sin() and Cos() is 9.3e-8 for |x| <= 8 * pi, std::sinf() has 3.2e-8. Error grows with |x|, as reduction loses bits of x.
+inline void SinCos(f32 x, f32 &out_sin, f32 &out_cos)
+{
+    i32 quadrant;
+    const f32 r = detail::ReduceToQuadrant(x, quadrant);
+    const f32 s = detail::SinPolynomial(r);
+    const f32 c = detail::CosPolynomial(r);
+    // sin and cos swap in odd quadrants, and change signs in quadrants 1, 2 for cos and in 2, 3 for sin.
+    const bool swap = (quadrant & 1) != 0;
+    out_sin = std::bit_cast<f32>(std::bit_cast<ui32>(detail::Select(swap, c, s)) ^ (static_cast<ui32>(quadrant & 2) << 30));
+    out_cos = std::bit_cast<f32>(std::bit_cast<ui32>(detail::Select(swap, s, c)) ^ (static_cast<ui32>((quadrant + 1) & 2) << 30));
+}
+
+inline f32 Sin(f32 x)
+{
+    f32 s, c;
+    SinCos(x, s, c);
+    return s;
+}
+
+inline f32 Cos(f32 x)
+{
+    f32 s, c;
+    SinCos(x, s, c);
+    return c;
+}
+
+
+inline f64 ATan2(f64 y, f64 x) { return pbr::ATan2(y, x); }
+inline f64 ACos(f64 x) { return pbr::ACos(x); }
+inline f64 Sin(f64 x) { return pbr::Sin(x); }
+inline f64 Cos(f64 x) { return pbr::Cos(x); }
+inline void SinCos(f64 x, f64 &out_sin, f64 &out_cos) { pbr::SinCos(x, out_sin, out_cos); }
+
+#pragma endregion Scalar
+
+
+// ****************************************************************************************************************
+// *************************************************** SSE ********************************************************
+// ****************************************************************************************************************
+
+#if PBR_ENABLE_SSE == 1
+#pragma region SSE
+
+// NOTE: Only SSE2 is used, it's the baseline of x64, so there is no blendv, selects are done with masks.
+namespace detail {
+
+inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 SignMask() { return _mm_castsi128_ps(_mm_set1_epi32(static_cast<i32>(0x80000000u))); }
+
+inline __m128 ATanPolynomial(__m128 t)
+{
+    const __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_add_ps(_mm_set1_ps(0.05265332f), _mm_mul_ps(t2, _mm_set1_ps(-0.01172120f)));
+    p = _mm_add_ps(_mm_set1_ps(-0.11643287f), _mm_mul_ps(t2, p));
+    p = _mm_add_ps(_mm_set1_ps(0.19354346f), _mm_mul_ps(t2, p));
+    p = _mm_add_ps(_mm_set1_ps(-0.33262347f), _mm_mul_ps(t2, p));
+    p = _mm_add_ps(_mm_set1_ps(0.99997726f), _mm_mul_ps(t2, p));
+    return _mm_mul_ps(t, p);
+}
+
+inline __m128 ACosPolynomial(__m128 x)
+{
+    __m128 p = _mm_add_ps(_mm_set1_ps(0.0066700901f), _mm_mul_ps(x, _mm_set1_ps(-0.0012624911f)));
+    p = _mm_add_ps(_mm_set1_ps(-0.0170881256f), _mm_mul_ps(x, p));
+    p = _mm_add_ps(_mm_set1_ps(0.0308918810f), _mm_mul_ps(x, p));
+    p = _mm_add_ps(_mm_set1_ps(-0.0501743046f), _mm_mul_ps(x, p));
+    p = _mm_add_ps(_mm_set1_ps(0.0889789874f), _mm_mul_ps(x, p));
+    p = _mm_add_ps(_mm_set1_ps(-0.2145988016f), _mm_mul_ps(x, p));
+    return _mm_add_ps(_mm_set1_ps(1.5707963050f), _mm_mul_ps(x, p));
+}
+
+inline __m128 SinPolynomial(__m128 r)
+{
+    const __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+    p = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, p));
+    return _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+}
+
+inline __m128 CosPolynomial(__m128 r)
+{
+    const __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+    p = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, p));
+    return _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), p));
+}
+
+} // namespace detail
+
+
+inline __m128 ATan2(__m128 y, __m128 x)
+{
+    const __m128 signMask = detail::SignMask();
+    const __m128 ax = _mm_andnot_ps(signMask, x), ay = _mm_andnot_ps(signMask, y);
+    const __m128 maxXY = _mm_max_ps(ax, ay);
+    const __m128 t = _mm_and_ps(_mm_cmpneq_ps(maxXY, _mm_setzero_ps()), _mm_div_ps(_mm_min_ps(ax, ay), maxXY));
+    __m128 r = detail::ATanPolynomial(t);
+    r = detail::Select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(std::numbers::pi_v<f32> / 2), r), r);
+    const __m128 xNegative = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31));
+    r = detail::Select(xNegative, _mm_sub_ps(_mm_set1_ps(std::numbers::pi_v<f32>), r), r);
+    return _mm_or_ps(r, _mm_and_ps(signMask, y));
+}
+
+inline __m128 ACos(__m128 x)
+{
+    const __m128 ax = _mm_andnot_ps(detail::SignMask(), x);
+    const __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.f), ax)), detail::ACosPolynomial(ax));
+    return detail::Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(std::numbers::pi_v<f32>), r), r);
+}
+
+inline void SinCos(__m128 x, __m128 &out_sin, __m128 &out_cos)
+{
+    const __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(detail::SignMask(), x));
+    const __m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2 / std::numbers::pi_v<f32>)), half));
+    const __m128 k = _mm_cvtepi32_ps(quadrant);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(detail::piOver2Hi)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(detail::piOver2Mid)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(detail::piOver2Lo)));
+
+    const __m128 s = detail::SinPolynomial(r);
+    const __m128 c = detail::CosPolynomial(r);
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+    const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    out_sin = _mm_xor_ps(detail::Select(swap, c, s), sinSign);
+    out_cos = _mm_xor_ps(detail::Select(swap, s, c), cosSign);
+}
+
+inline __m128 Sin(__m128 x)
+{
+    __m128 s, c;
+    SinCos(x, s, c);
+    return s;
+}
+
+inline __m128 Cos(__m128 x)
+{
+    __m128 s, c;
+    SinCos(x, s, c);
+    return c;
+}
+
+#pragma endregion SSE
+#endif
+
+} // namespace fastmath
+
+
+// Shapes use these for phi, theta and their sines and cosines.
+//   They're approximations from fastmath if PBR_ENABLE_FAST_MATH is set, and std functions otherwise.
+namespace shapemath {
+
+#if PBR_ENABLE_FAST_MATH == 1
+    using fastmath::ATan2;
+    using fastmath::ACos;
+    using fastmath::Sin;
+    using fastmath::Cos;
+    using fastmath::SinCos;
+#else
+    using pbr::ATan2;
+    using pbr::ACos;
+    using pbr::Sin;
+    using pbr::Cos;
+    using pbr::SinCos;
+#endif
+
+} // namespace shapemath
+
+PBR_NAMESPACE_END
@@ -5,6 +5,10 @@
 #include "core.hpp"
 #include "pbr_math.hpp"
 
+#if PBR_ENABLE_SIMD_GEOMETRY == 1
+    #include "simd.hpp"
+#endif
+
 
 #define PBR_CNSTEXPR constexpr
 #define PBR_INLINE inline
@@ -34,7 +38,7 @@ PBR_NAMESPACE_BEGIN
 template<typename T>
 struct Vector2
 {
-    using Vector2_arg = Vector2<T>&;
+    using Vector2_arg = const Vector2<T>&;
 
     PBR_CNSTEXPR Vector2();
     PBR_CNSTEXPR explicit Vector2(T value);
@@ -63,7 +67,7 @@ struct Vector2
 };
 
 using Vector2_t = Vector2<fp_t>;
-template<typename T> using Vector2_arg = Vector2<T>&;
+template<typename T> using Vector2_arg = const Vector2<T>&;
 
 
 // ---------------------------------------
@@ -210,7 +214,7 @@ T Vector2<T>::LengthSquared() const
 template<typename T> PBR_INLINE
 T Vector2<T>::Length() const
 {
-    return pbr::sqrt(LengthSquared());
+    return pbr::Sqrt(LengthSquared());
 }
 
 
@@ -255,13 +259,13 @@ T AbsDot(const Vector2_arg<T> v1, const Vector2_arg<T> v2)
 #pragma region Vector3
 
 template<typename T> class Point3; // NOTE: Forward declaration for Vector3(Point3_arg<T> p) conversion constructor
-template<typename T> using Point3_arg = Point3<T>&;
+template<typename T> using Point3_arg = const Point3<T>&;
 
 // TODO: Implement index operator[]
 template<typename T>
 struct Vector3
 {
-    using Vector3_arg = Vector3<T>&;
+    using Vector3_arg = const Vector3<T>&;
 
     PBR_CNSTEXPR Vector3();
     PBR_CNSTEXPR explicit Vector3(T value);
@@ -276,9 +280,9 @@ struct Vector3
     PBR_CNSTEXPR PBR_INLINE Vector3<T>& operator*=(const T scalar);
     PBR_CNSTEXPR PBR_INLINE Vector3<T>& operator/=(const T scalar);
 
-    friend auto operator<=>(const Vector3_arg<T>, const Vector3_arg<T>) = default;
+    friend auto operator<=>(const Vector3<T>&, const Vector3<T>&) = default;
 
-    /*T operator[](i32 i) const
+    T operator[](i32 i) const
     {
         PBR_ASSERT(i >= 0 && i <= 2)
         if (i == 0) return x;
@@ -291,7 +295,7 @@ struct Vector3
         if (i == 0) return x;
         if (i == 1) return y;
         return z;
-    }*/
+    }
 
     PBR_CNSTEXPR PBR_INLINE T LengthSquared() const;
     PBR_INLINE T Length() const;
@@ -306,7 +310,7 @@ struct Vector3
 };
 
 using Vector3_t = Vector3<fp_t>;
-template<typename T> using Vector3_arg = Vector3<T>&;
+template<typename T> using Vector3_arg = const Vector3<T>&;
 
 
 // ---------------------------------------
@@ -460,7 +464,7 @@ T Vector3<T>::LengthSquared() const
 template<typename T> PBR_INLINE
 T Vector3<T>::Length() const
 {
-    return pbr::sqrt(LengthSquared());
+    return pbr::Sqrt(LengthSquared());
 }
 
 
@@ -497,7 +501,7 @@ T AbsDot(const Vector3_arg<T> v1, const Vector3_arg<T> v2)
 template<typename T> PBR_CNSTEXPR PBR_INLINE
 Vector3<T> Cross(const Vector3_arg<T> v1, const Vector3_arg<T> v2)
 {
-    PBR_ASSERT(!n1.HasNaNs() && !n2.HasNaNs())
+    PBR_ASSERT(!v1.HasNaNs() && !v2.HasNaNs())
     if constexpr (std::is_same<T, f64>()) {
         return Vector3<T>(v1.y * v2.z - v1.z * v2.y,
                           v1.z * v2.x - v1.x * v2.z,
@@ -557,12 +561,12 @@ Vector3<T> Permute(const Vector3_arg<T> v, i32 x, i32 y, i32 z)
 }
 
 template<typename T> PBR_INLINE
-Vector3<T> CoordinateSystem(const Vector3_arg<T> v1, Vector3<T>& v2, Vector3<T>& v3)
+void CoordinateSystem(const Vector3_arg<T> v1, Vector3<T>& v2, Vector3<T>& v3)
 {
     if (std::abs(v1.x) > std::abs(v1.y))
-        v2 = Vector3<T>(-v1.z, 0, v1.x) / pbr::sqrt(v1.x * v1.x + v1.z * v1.z);
+        v2 = Vector3<T>(-v1.z, 0, v1.x) / pbr::Sqrt(v1.x * v1.x + v1.z * v1.z);
     else
-        v2 = Vector3<T>(0, v1.z, -v1.y) / pbr::sqrt(v1.y * v1.y + v1.z * v1.z);
+        v2 = Vector3<T>(0, v1.z, -v1.y) / pbr::Sqrt(v1.y * v1.y + v1.z * v1.z);
 
     v3 = Cross(v1, v2);
 }
@@ -580,7 +584,7 @@ Vector3<T> CoordinateSystem(const Vector3_arg<T> v1, Vector3<T>& v2, Vector3<T>&
 template<typename T>
 struct Point2
 {
-    using Point2_arg = Point2<T>&;
+    using Point2_arg = const Point2<T>&;
 
     PBR_CNSTEXPR Point2();
     PBR_CNSTEXPR explicit Point2(T value);
@@ -609,7 +613,7 @@ struct Point2
 };
 
 using Point2_t = Point2<fp_t>;
-template<typename T> using Point2_arg = Point2<T>&;
+template<typename T> using Point2_arg = const Point2<T>&;
 
 
 // ---------------------------------------
@@ -703,7 +707,7 @@ template<typename T> PBR_CNSTEXPR PBR_INLINE
 Vector2<T> operator-(const Point2_arg<T> p1, const Point2_arg<T> p2)
 {
     PBR_ASSERT(!p2.HasNaNs())
-    return Point2<T>(p1.x - p2.x, p1.y - p2.y);
+    return Vector2<T>(p1.x - p2.x, p1.y - p2.y);
 }
 
 
@@ -757,7 +761,7 @@ BINARY_OPERATOR_SP(*)
 template<typename T>
 struct Point3
 {
-    using Point3_arg = Point3<T>&;
+    using Point3_arg = const Point3<T>&;
 
     PBR_CNSTEXPR Point3();
     PBR_CNSTEXPR explicit Point3(T value);
@@ -774,6 +778,23 @@ struct Point3
     PBR_CNSTEXPR PBR_INLINE Point3<T>& operator+=(const Vector3_arg<T> p);
     PBR_CNSTEXPR PBR_INLINE Point3<T>& operator-=(const Vector3_arg<T> p);
 
+    friend auto operator<=>(const Point3<T>&, const Point3<T>&) = default;
+
+    T operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i <= 2)
+        if (i == 0) return x;
+        if (i == 1) return y;
+        return z;
+    }
+    T& operator[](i32 i)
+    {
+        PBR_ASSERT(i >= 0 && i <= 2)
+        if (i == 0) return x;
+        if (i == 1) return y;
+        return z;
+    }
+
 
     bool HasNaNs() const
     {
@@ -786,7 +807,7 @@ struct Point3
 
 using Point3_t = Point3<fp_t>;
 // NOTE: Declared before Vector3, cause of fockin conversion constructor
-//template<typename T> using Point3_arg = Point3<T>&;
+//template<typename T> using Point3_arg = const Point3<T>&;
 
 
 // ---------------------------------------
@@ -832,6 +853,17 @@ Point3<T>::Point3(const Vector3_arg<T> v)
 COMPOUND_OPERATOR_P(+=)
 
 
+#define COMPOUND_OPERATOR_V(op)                                   \
+    template<typename T> PBR_CNSTEXPR PBR_INLINE                  \
+    Point3<T>& Point3<T>::operator op(const Vector3_arg<T> v) {   \
+        x op v.x; y op v.y; z op v.z;                             \
+        return *this;                                             \
+    }
+
+COMPOUND_OPERATOR_V(+=)
+COMPOUND_OPERATOR_V(-=)
+
+
 #define COMPOUND_OPERATOR_S(op)                         \
     template<typename T> PBR_CNSTEXPR PBR_INLINE        \
     Point3<T>& Point3<T>::operator op(const T scalar) { \
@@ -898,7 +930,7 @@ Vector3<T> operator-(const Point3_arg<T> p1, const Point3_arg<T> p2) {
 BINARY_OPERATOR_PS(*)
 
 template<typename T> PBR_CNSTEXPR PBR_INLINE
-Point3<T>& operator/(const Point3_arg<T> p, const T scalar)
+Point3<T> operator/(const Point3_arg<T> p, const T scalar)
 {
     PBR_ASSERT(scalar != 0)
 
@@ -933,6 +965,7 @@ BINARY_OPERATOR_PV(-)
 
 
 #undef COMPOUND_OPERATOR_P
+#undef COMPOUND_OPERATOR_V
 #undef COMPOUND_OPERATOR_S
 
 #undef BINARY_OPERATOR_PP
@@ -972,13 +1005,13 @@ Point3<T> Max(const Point3_arg<T> p1, const Point3_arg<T> p2)
 template<typename T> PBR_INLINE
 Point3<T> Floor(const Point3_arg<T> p)
 {
-    return Point3<T>(pbr::floor(p.x), pbr::floor(p.y), pbr::floor(p.z));
+    return Point3<T>(pbr::Floor(p.x), pbr::Floor(p.y), pbr::Floor(p.z));
 }
 
 template<typename T> PBR_INLINE
 Point3<T> Ceil(const Point3_arg<T> p)
 {
-    return Point3<T>(pbr::ceil(p.x), pbr::ceil(p.y), pbr::ceil(p.z));
+    return Point3<T>(pbr::Ceil(p.x), pbr::Ceil(p.y), pbr::Ceil(p.z));
 }
 
 template<typename T> PBR_INLINE
@@ -988,9 +1021,9 @@ Point3<T> Abs(const Point3_arg<T> p)
 }
 
 template<typename T> PBR_CNSTEXPR PBR_INLINE
-Point3_arg<T> Permute(const Point3_arg<T> p, i32 x, i32 y, i32 z)
+Point3<T> Permute(const Point3_arg<T> p, i32 x, i32 y, i32 z)
 {
-   return Point3_arg<T>(p[x], p[y], p[z]);
+   return Point3<T>(p[x], p[y], p[z]);
 }
 
 template<typename T> PBR_CNSTEXPR PBR_INLINE
@@ -1011,7 +1044,7 @@ T Distance(const Point3_arg<T> p1, const Point3_arg<T> p2) {
 template<typename T>
 struct Normal3
 {
-    using Normal3_arg = Normal3<T>&;
+    using Normal3_arg = const Normal3<T>&;
 
     PBR_CNSTEXPR Normal3();
     PBR_CNSTEXPR explicit Normal3(T value);
@@ -1031,6 +1064,8 @@ struct Normal3
     PBR_CNSTEXPR PBR_INLINE Normal3<T>& operator*=(const T scalar);
     PBR_CNSTEXPR PBR_INLINE Normal3<T>& operator/=(const T scalar);
 
+    friend auto operator<=>(const Normal3<T>&, const Normal3<T>&) = default;
+
 
     bool HasNaNs() const
     {
@@ -1042,7 +1077,7 @@ struct Normal3
 };
 
 using Normal3_t = Normal3<fp_t>;
-template<typename T> using Normal3_arg = Normal3<T>&;
+template<typename T> using Normal3_arg = const Normal3<T>&;
 
 
 // ---------------------------------------
@@ -1156,7 +1191,7 @@ BINARY_OPERATOR_NN(*)
 //BINARY_OPERATOR_VS(*)
 
 template<typename T> PBR_CNSTEXPR PBR_INLINE
-Vector3<T> operator/(const Normal3_arg<T> n, const T scalar)
+Normal3<T> operator/(const Normal3_arg<T> n, const T scalar)
 {
     PBR_ASSERT(scalar != 0)
 
@@ -1201,7 +1236,7 @@ T Normal3<T>::LengthSquared() const
 template<typename T> PBR_INLINE
 T Normal3<T>::Length() const
 {
-    return pbr::sqrt(LengthSquared());
+    return pbr::Sqrt(LengthSquared());
 }
 
 
@@ -1278,6 +1313,304 @@ Normal3<T> FaceForward(const Normal3_arg<T> n1, const Normal3_arg<T> n2)
 #pragma endregion Normal3
 
 
+// ******************************************************************************
+// --------------------------------- VECTOR3A -----------------------------------
+// ******************************************************************************
+
+#pragma region Vector3A
+
+// Padded Vector3 for hot temporaries, it's 16 bytes aligned and its 4th lane is 0.
+//   Vectors, points and normals convert to it and back explicitly, so it's used inside of functions only,
+//   while Vector3, Point3 and Normal3 stay 12 bytes in memory.
+//   Vector3A<f32> is SSE register if PBR_ENABLE_SIMD_GEOMETRY is set, everything else is this scalar fallback.
+// NOTE: Results are the same as of Vector3 operations, except Cross(), which is not computed in f64 for f32.
+template<typename T>
+struct alignas(4 * sizeof(T)) Vector3A
+{
+    PBR_CNSTEXPR Vector3A() : x(0), y(0), z(0), w(0) {}
+    PBR_CNSTEXPR explicit Vector3A(T value) : x(value), y(value), z(value), w(0) {}
+    PBR_CNSTEXPR explicit Vector3A(T x, T y, T z) : x(x), y(y), z(z), w(0) {}
+
+    PBR_CNSTEXPR explicit Vector3A(const Vector3<T> &v) : Vector3A(v.x, v.y, v.z) {}
+    PBR_CNSTEXPR explicit Vector3A(const Point3<T> &p) : Vector3A(p.x, p.y, p.z) {}
+    PBR_CNSTEXPR explicit Vector3A(const Normal3<T> &n) : Vector3A(n.x, n.y, n.z) {}
+
+    PBR_CNSTEXPR explicit operator Vector3<T>() const { return Vector3<T>(x, y, z); }
+    PBR_CNSTEXPR explicit operator Point3<T>() const { return Point3<T>(x, y, z); }
+    PBR_CNSTEXPR explicit operator Normal3<T>() const { return Normal3<T>(x, y, z); }
+
+    PBR_CNSTEXPR T X() const { return x; }
+    PBR_CNSTEXPR T Y() const { return y; }
+    PBR_CNSTEXPR T Z() const { return z; }
+    PBR_CNSTEXPR T operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i <= 2)
+        if (i == 0) return x;
+        if (i == 1) return y;
+        return z;
+    }
+
+    PBR_CNSTEXPR Vector3A &operator+=(const Vector3A &v) { x += v.x; y += v.y; z += v.z; return *this; }
+    PBR_CNSTEXPR Vector3A &operator-=(const Vector3A &v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    PBR_CNSTEXPR Vector3A &operator*=(const Vector3A &v) { x *= v.x; y *= v.y; z *= v.z; return *this; }
+
+    PBR_CNSTEXPR friend Vector3A operator-(const Vector3A &v) { return Vector3A(-v.x, -v.y, -v.z); }
+
+    PBR_CNSTEXPR friend Vector3A operator+(Vector3A v1, const Vector3A &v2) { return v1 += v2; }
+    PBR_CNSTEXPR friend Vector3A operator-(Vector3A v1, const Vector3A &v2) { return v1 -= v2; }
+    PBR_CNSTEXPR friend Vector3A operator*(Vector3A v1, const Vector3A &v2) { return v1 *= v2; }
+    PBR_CNSTEXPR friend Vector3A operator*(const Vector3A &v, T scalar) { return Vector3A(v.x * scalar, v.y * scalar, v.z * scalar); }
+    PBR_CNSTEXPR friend Vector3A operator*(T scalar, const Vector3A &v) { return v * scalar; }
+    PBR_CNSTEXPR friend Vector3A operator/(const Vector3A &v, T scalar)
+    {
+        PBR_ASSERT(scalar != 0)
+        T inv = static_cast<T>(1) / scalar;
+        return v * inv;
+    }
+
+    PBR_CNSTEXPR T LengthSquared() const { return x * x + y * y + z * z; }
+    T Length() const { return pbr::Sqrt(LengthSquared()); }
+
+
+    T x, y, z, w;
+};
+
+using Vector3A_t = Vector3A<fp_t>;
+
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+T Dot(const Vector3A<T> &v1, const Vector3A<T> &v2)
+{
+    return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+template<typename T> PBR_INLINE
+T AbsDot(const Vector3A<T> &v1, const Vector3A<T> &v2)
+{
+    return std::abs(Dot(v1, v2));
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+Vector3A<T> Cross(const Vector3A<T> &v1, const Vector3A<T> &v2)
+{
+    return Vector3A<T>(v1.y * v2.z - v1.z * v2.y,
+                       v1.z * v2.x - v1.x * v2.z,
+                       v1.x * v2.y - v1.y * v2.x);
+}
+
+template<typename T> PBR_INLINE
+Vector3A<T> Normalize(const Vector3A<T> &v)
+{
+    return v / v.Length();
+}
+
+template<typename T> PBR_INLINE
+Vector3A<T> Abs(const Vector3A<T> &v)
+{
+    return Vector3A<T>(std::abs(v.x), std::abs(v.y), std::abs(v.z));
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+Vector3A<T> Min(const Vector3A<T> &v1, const Vector3A<T> &v2)
+{
+    return Vector3A<T>(std::min(v1.x, v2.x), std::min(v1.y, v2.y), std::min(v1.z, v2.z));
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+Vector3A<T> Max(const Vector3A<T> &v1, const Vector3A<T> &v2)
+{
+    return Vector3A<T>(std::max(v1.x, v2.x), std::max(v1.y, v2.y), std::max(v1.z, v2.z));
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+T MinComponent(const Vector3A<T> &v)
+{
+    return pbr::Min3(v.x, v.y, v.z);
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+T MaxComponent(const Vector3A<T> &v)
+{
+    return pbr::Max3(v.x, v.y, v.z);
+}
+
+// Same as MaxDimension() of Vector3, on ties the last of the dimensions wins.
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+i32 MaxDimension(const Vector3A<T> &v)
+{
+    if (v.x > v.y && v.x > v.z) return 0;
+    if (v.y > v.z) return 1;
+    return 2;
+}
+
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+Vector3A<T> Permute(const Vector3A<T> &v, i32 x, i32 y, i32 z)
+{
+    return Vector3A<T>(v[x], v[y], v[z]);
+}
+
+
+#if PBR_ENABLE_SIMD_GEOMETRY == 1
+
+// NOTE: Only SSE2 is required, AVX is used for Permute() if it's enabled.
+template<>
+struct alignas(16) Vector3A<f32>
+{
+    Vector3A() : v(_mm_setzero_ps()) {}
+    explicit Vector3A(f32 value) : v(_mm_setr_ps(value, value, value, 0)) {}
+    explicit Vector3A(f32 x, f32 y, f32 z) : v(_mm_setr_ps(x, y, z, 0)) {}
+    explicit Vector3A(f32x4 v) : v(v) {}
+
+    explicit Vector3A(const Vector3<f32> &v) : Vector3A(v.x, v.y, v.z) {}
+    explicit Vector3A(const Point3<f32> &p) : Vector3A(p.x, p.y, p.z) {}
+    explicit Vector3A(const Normal3<f32> &n) : Vector3A(n.x, n.y, n.z) {}
+
+    explicit operator Vector3<f32>() const { alignas(16) f32 f[4]; v.Store(f); return Vector3<f32>(f[0], f[1], f[2]); }
+    explicit operator Point3<f32>() const { alignas(16) f32 f[4]; v.Store(f); return Point3<f32>(f[0], f[1], f[2]); }
+    explicit operator Normal3<f32>() const { alignas(16) f32 f[4]; v.Store(f); return Normal3<f32>(f[0], f[1], f[2]); }
+
+    f32 X() const { return _mm_cvtss_f32(v.v); }
+    f32 Y() const { return _mm_cvtss_f32(_mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(1, 1, 1, 1))); }
+    f32 Z() const { return _mm_cvtss_f32(_mm_movehl_ps(v.v, v.v)); }
+    f32 operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i <= 2)
+        return v[i];
+    }
+
+    Vector3A &operator+=(const Vector3A &v2) { v = v + v2.v; return *this; }
+    Vector3A &operator-=(const Vector3A &v2) { v = v - v2.v; return *this; }
+    Vector3A &operator*=(const Vector3A &v2) { v = v * v2.v; return *this; }
+
+    // NOTE: 4th lane stays 0, it's 0 * scalar or 0 +- 0 everywhere, except division by 0.
+    friend Vector3A operator-(const Vector3A &v) { return Vector3A(_mm_sub_ps(_mm_setzero_ps(), v.v.v)); }
+
+    friend Vector3A operator+(Vector3A v1, const Vector3A &v2) { return v1 += v2; }
+    friend Vector3A operator-(Vector3A v1, const Vector3A &v2) { return v1 -= v2; }
+    friend Vector3A operator*(Vector3A v1, const Vector3A &v2) { return v1 *= v2; }
+    friend Vector3A operator*(const Vector3A &v, f32 scalar) { return Vector3A(v.v * f32x4(scalar)); }
+    friend Vector3A operator*(f32 scalar, const Vector3A &v) { return v * scalar; }
+    friend Vector3A operator/(const Vector3A &v, f32 scalar)
+    {
+        PBR_ASSERT(scalar != 0)
+        f32 inv = 1.f / scalar;
+        return v * inv;
+    }
+
+    f32 LengthSquared() const;
+    f32 Length() const { return pbr::Sqrt(LengthSquared()); }
+
+
+    f32x4 v;
+};
+
+
+// Sum of x, y, z lanes in the same order as the scalar x + y + z, broadcast to all lanes.
+PBR_INLINE
+__m128 SumXYZ(__m128 v)
+{
+    const __m128 xy = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    const __m128 xyz = _mm_add_ss(xy, _mm_movehl_ps(v, v));
+    return _mm_shuffle_ps(xyz, xyz, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+PBR_INLINE
+f32 Vector3A<f32>::LengthSquared() const
+{
+    return _mm_cvtss_f32(SumXYZ(_mm_mul_ps(v.v, v.v)));
+}
+
+PBR_INLINE
+f32 Dot(const Vector3A<f32> &v1, const Vector3A<f32> &v2)
+{
+    return _mm_cvtss_f32(SumXYZ(_mm_mul_ps(v1.v.v, v2.v.v)));
+}
+
+PBR_INLINE
+f32 AbsDot(const Vector3A<f32> &v1, const Vector3A<f32> &v2)
+{
+    return std::abs(Dot(v1, v2));
+}
+
+PBR_INLINE
+Vector3A<f32> Cross(const Vector3A<f32> &v1, const Vector3A<f32> &v2)
+{
+    // (y, z, x) * (z, x, y) - (z, x, y) * (y, z, x)
+    const __m128 a = v1.v.v, b = v2.v.v;
+    const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+    return Vector3A<f32>(_mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX)));
+}
+
+PBR_INLINE
+Vector3A<f32> Normalize(const Vector3A<f32> &v)
+{
+    return v / v.Length();
+}
+
+PBR_INLINE
+Vector3A<f32> Abs(const Vector3A<f32> &v)
+{
+    return Vector3A<f32>(Abs(v.v));
+}
+
+PBR_INLINE
+Vector3A<f32> Min(const Vector3A<f32> &v1, const Vector3A<f32> &v2)
+{
+    return Vector3A<f32>(Min(v1.v, v2.v));
+}
+
+PBR_INLINE
+Vector3A<f32> Max(const Vector3A<f32> &v1, const Vector3A<f32> &v2)
+{
+    return Vector3A<f32>(Max(v1.v, v2.v));
+}
+
+PBR_INLINE
+f32 MinComponent(const Vector3A<f32> &v)
+{
+    const __m128 m = _mm_min_ss(_mm_min_ss(v.v.v, _mm_shuffle_ps(v.v.v, v.v.v, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(v.v.v, v.v.v));
+    return _mm_cvtss_f32(m);
+}
+
+PBR_INLINE
+f32 MaxComponent(const Vector3A<f32> &v)
+{
+    const __m128 m = _mm_max_ss(_mm_max_ss(v.v.v, _mm_shuffle_ps(v.v.v, v.v.v, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(v.v.v, v.v.v));
+    return _mm_cvtss_f32(m);
+}
+
+// Lanes equal to the max component, the last of them wins on ties, as in the scalar variant.
+PBR_INLINE
+i32 MaxDimension(const Vector3A<f32> &v)
+{
+    const i32 mask = MoveMask(v.v == f32x4(MaxComponent(v)));
+    return (mask & 4) ? 2 : (mask & 2) ? 1 : 0;
+}
+
+PBR_INLINE
+Vector3A<f32> Permute(const Vector3A<f32> &v, i32 x, i32 y, i32 z)
+{
+    PBR_ASSERT(x >= 0 && x <= 2 && y >= 0 && y <= 2 && z >= 0 && z <= 2)
+#if PBR_ENABLE_AVX == 1
+    return Vector3A<f32>(_mm_permutevar_ps(v.v.v, _mm_setr_epi32(x, y, z, 3)));
+#else
+    alignas(16) f32 f[4];
+    v.v.Store(f);
+    return Vector3A<f32>(f[x], f[y], f[z]);
+#endif
+}
+
+#endif
+
+
+#pragma endregion Vector3A
+
+
 // ******************************************************************************
 // ------------------------------------ RAY -------------------------------------
 // ******************************************************************************
@@ -1305,7 +1638,7 @@ struct Ray
     fp_t time;
 };
 
-using Ray_arg = Ray&;
+using Ray_arg = const Ray&;
 
 
 // ---------------------------------------
@@ -1354,7 +1687,7 @@ Point3_t Ray::operator()(fp_t t) const
 
 struct RayDifferential : public Ray
 {
-    //using Vector3_arg = Vector3<T>&;
+    //using Vector3_arg = const Vector3<T>&;
 
     PBR_CNSTEXPR RayDifferential();
     PBR_CNSTEXPR explicit RayDifferential(const Point3_arg<fp_t> origin,
@@ -1372,7 +1705,7 @@ struct RayDifferential : public Ray
     bool hasDifferentials;
 };
 
-using RayDifferential_arg = RayDifferential&;
+using RayDifferential_arg = const RayDifferential&;
 
 
 // ---------------------------------------
@@ -1419,6 +1752,44 @@ void RayDifferential::ScaleDifferentials(fp_t scale)
 #pragma endregion RayDifferential
 
 
+// ******************************************************************************
+// -------------------------------- TRAVERSALRAY --------------------------------
+// ******************************************************************************
+
+#pragma region TraversalRay
+
+// Ray with its reciprocal direction and direction signs computed once, for traversal of the hierarchies,
+//   where the same ray is tested against many boxes, see Bounds3::IntersectP().
+// DIFFERENCE: In the book invDir and dirIsNeg are computed by every accelerator and passed along with the ray.
+//             It's not a part of Ray, so rays that are never tested against boxes stay small.
+// NOTE: Direction must not be changed after construction, or cached values will be stale.
+struct TraversalRay : public Ray
+{
+    PBR_CNSTEXPR explicit TraversalRay(const Ray_arg ray);
+
+
+    Vector3_t invDir;
+    // 1 if the direction is negative along the axis, it's the index of the near slab, bounds[dirIsNeg[i]]
+    i32 dirIsNeg[3];
+};
+
+using TraversalRay_arg = const TraversalRay&;
+
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+TraversalRay::TraversalRay(const Ray_arg ray)
+    : Ray(ray)
+    , invDir(1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z)
+    , dirIsNeg { invDir.x < 0, invDir.y < 0, invDir.z < 0 }
+{}
+
+#pragma endregion TraversalRay
+
+
 // ******************************************************************************
 // ---------------------------------- BOUNDS3 -----------------------------------
 // ******************************************************************************
@@ -1429,7 +1800,7 @@ void RayDifferential::ScaleDifferentials(fp_t scale)
 template<typename T>
 struct Bounds3
 {
-    //using Bounds3_arg = Bounds3<T>&;
+    //using Bounds3_arg = const Bounds3<T>&;
 
     PBR_CNSTEXPR Bounds3();
 
@@ -1458,16 +1829,32 @@ struct Bounds3
     PBR_CNSTEXPR PBR_INLINE bool IntersectP(const Ray_arg ray,
                                             fp_t *out_hit0 = nullptr,
                                             fp_t *out_hit1 = nullptr) const;
+    // Same, but with the reciprocal direction of the ray, there are no divisions.
+    PBR_CNSTEXPR PBR_INLINE bool IntersectP(const TraversalRay_arg ray, fp_t &out_hit0, fp_t &out_hit1) const;
     PBR_CNSTEXPR PBR_INLINE bool IntersectP(const Ray_arg ray,
                                             const Vector3_arg<T> invDir,
                                             const i32 dirIsNeg[3]) const;
+    // Overload above with the cached values of the ray, for traversal.
+    PBR_CNSTEXPR PBR_INLINE bool IntersectP(const TraversalRay_arg ray) const;
+
+    // 0 -> pMin, 1 -> pMax
+    const Point3<T>& operator[](i32 i) const
+    {
+        PBR_ASSERT(i == 0 || i == 1)
+        return i == 0 ? pMin : pMax;
+    }
+    Point3<T>& operator[](i32 i)
+    {
+        PBR_ASSERT(i == 0 || i == 1)
+        return i == 0 ? pMin : pMax;
+    }
 
 
     Point3<T> pMin, pMax;
 };
 
 using Bounds3_t = Bounds3<fp_t>;
-template<typename T> using Bounds3_arg = Bounds3<T>&;
+template<typename T> using Bounds3_arg = const Bounds3<T>&;
 
 
 // ---------------------------------------
@@ -1526,9 +1913,9 @@ Point3<T> Bounds3<T>::Corner(const i32 corner) const
     PBR_ASSERT(corner >= 0 && corner < 8)
 
     T x,y,z;
-    x = (corner & 1 == 0) ? pMin.x : pMax.x;
-    y = (corner & 2 == 0) ? pMin.y : pMax.y;
-    z = (corner & 4 == 0) ? pMin.z : pMax.z;
+    x = ((corner & 1) == 0) ? pMin.x : pMax.x;
+    y = ((corner & 2) == 0) ? pMin.y : pMax.y;
+    z = ((corner & 4) == 0) ? pMin.z : pMax.z;
     return Point3<T>(x, y, z);
 }
 
@@ -1604,6 +1991,33 @@ bool Bounds3<T>::IntersectP(const Ray_arg ray, fp_t *out_hit0 /*=nullptr*/, fp_t
     return true;
 }
 
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+bool Bounds3<T>::IntersectP(const TraversalRay_arg ray, fp_t &out_hit0, fp_t &out_hit1) const
+{
+    fp_t t0 = 0, t1 = ray.tMax;
+
+    for (int i = 0; i < 3; ++i) {
+        // Near and far slabs are known from the sign, no swap is needed
+        fp_t tNear = ((*this)[ray.dirIsNeg[i]][i] - ray.origin[i]) * ray.invDir[i];
+        fp_t tFar = ((*this)[1 - ray.dirIsNeg[i]][i] - ray.origin[i]) * ray.invDir[i];
+
+// NOTE: Chapter 3.9.2
+#if PBR_ENABLE_EFLOAT == 1
+        tFar *= 1 + 2 * Gamma(3);
+#endif
+
+        if(tNear > t0) t0 = tNear;
+        if(tFar < t1) t1 = tFar;
+
+        if(t0 > t1)
+            return false;
+    }
+
+    out_hit0 = t0;
+    out_hit1 = t1;
+    return true;
+}
+
 // NOTE: WTF is this style, what is this dirIsNeg
 // NOTE: Book claims 15% performance improvement with this method over it's overloaded brother above.
 template<typename T> PBR_CNSTEXPR PBR_INLINE
@@ -1643,6 +2057,12 @@ bool Bounds3<T>::IntersectP(const Ray_arg ray, const Vector3_arg<T> invDir, cons
     return (tMin < ray.tMax) && (tMax > 0);
 }
 
+template<typename T> PBR_CNSTEXPR PBR_INLINE
+bool Bounds3<T>::IntersectP(const TraversalRay_arg ray) const
+{
+    return IntersectP(ray, ray.invDir, ray.dirIsNeg);
+}
+
 
 // ---------------------------------------
 // ---------- UTILITY FUNCTIONS ----------
@@ -1656,7 +2076,7 @@ Bounds3<T> Union(const Bounds3_arg<T> b, const Point3_arg<T> p)
 {
     Bounds3<T> result;
     result.pMin = Min(b.pMin, p);
-    result.pMax = Max(b.pMax, p)
+    result.pMax = Max(b.pMax, p);
     return result;
 }
 
@@ -1665,7 +2085,7 @@ Bounds3<T> Union(const Bounds3_arg<T> b1, const Bounds3_arg<T> b2)
 {
     Bounds3<T> result;
     result.pMin = Min(b1.pMin, b2.pMin);
-    result.pMax = Max(b1.pMax, b2.pMax)
+    result.pMax = Max(b1.pMax, b2.pMax);
     return result;
 }
 
@@ -1674,7 +2094,7 @@ Bounds3<T> Intersect(const Bounds3_arg<T> b1, const Bounds3_arg<T> b2)
 {
     Bounds3<T> result;
     result.pMin = Max(b1.pMin, b2.pMin);
-    result.pMax = Min(b1.pMax, b2.pMax)
+    result.pMax = Min(b1.pMax, b2.pMax);
     return result;
 }
 
@@ -0,0 +1,105 @@
+#include "interaction.hpp"
+#include "shape.h"
+
+
+PBR_NAMESPACE_BEGIN
+
+// ******************************************************************************
+// -------------------------------- INTERACTION ---------------------------------
+// ******************************************************************************
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+Interaction::Interaction(const Point3_arg<fp_t> point,
+                         const Normal3_arg<fp_t> normal,
+                         const Vector3_arg<fp_t> pError,
+                         const Vector3_arg<fp_t> wo,
+                         fp_t time /*, const MediumInterface &mediumInterface*/)
+    : point(point)
+    , normal(normal)
+    , pError(pError)
+    , wo(Normalize(wo))
+    , time(time)
+    //, mediumInterface(mediumInterface)
+{}
+
+Interaction::Interaction(const Point3_arg<fp_t> point,
+                         const Vector3_arg<fp_t> wo,
+                         fp_t time /*, const MediumInterface &mediumInterface*/)
+    : point(point)
+    , time(time)
+    , wo(wo)
+    //, mediumInterface(mediumInterface)
+{}
+
+Interaction::Interaction(const Point3_arg<fp_t> point,
+                         fp_t time
+                         /*const MediumInterface &mediumInterface*/)
+    : point(point)
+    , time(time)
+    //, mediumInterface(mediumInterface)
+{}
+
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+// NOTE: Is this will generate correct assembly?
+//       or should I write it straightforward: notrmal.x != 0 || normal.y != 0 || normal.z != 0
+bool Interaction::IsSurfaceInteraction() const
+{ 
+    return normal != Normal3_t();
+}
+
+
+// ******************************************************************************
+// ----------------------------- SURFACEINTERACTION -----------------------------
+// ******************************************************************************
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+SurfaceInteraction::SurfaceInteraction(const Point3_arg<fp_t> point, const Vector3_arg<fp_t> pError,
+                                       const Point2_arg<fp_t> uv, const Vector3_arg<fp_t> wo,
+                                       const Vector3_arg<fp_t> dpdu, const Vector3_arg<fp_t> dpdv,
+                                       const Normal3_arg<fp_t> dndu, const Normal3_arg<fp_t> dndv,
+                                       fp_t time,
+                                       const Shape *shape
+                                       /*int faceIndex = 0*/)
+    : Interaction(point, Normal3_t(Normalize(Cross(dpdu, dpdv))), pError, wo, time /*,nullptr*/)
+    , uv(uv)
+    , dpdu(dpdu)
+    , dpdv(dpdv)
+    , dndu(dndu)
+    , dndv(dndv)
+    , shape(shape)
+    //, faceIndex(faceIndex)
+{
+    if (shape && (shape->reverseOrientation ^ shape->transformSwapsHandedness)) {
+        normal *= -1;
+    }
+    shading.normal = normal;
+    shading.dpdu = dpdu;
+    shading.dpdv = dpdv;
+    shading.dndu = dndu;
+    shading.dndv = dndv;
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+// FINDOUT: Why do the same work, that constructor already did ?
+//void SurfaceInteraction::SetShadingGeometry(const Vector3_arg<fp_t> dpdu, const Vector3_arg<fp_t> dpdv,
+//                                            const Normal3_arg<fp_t> dndu, const Normal3_arg<fp_t> dndv,
+//                                            bool orientationIsAuthoritative)
+//{
+    
+//}
+
+PBR_NAMESPACE_END
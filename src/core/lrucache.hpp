@@ -0,0 +1,106 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+
+// IMPROVE: Single mutex for the whole cache, which is fine while entries are expensive to build compared to the lookup.
+//          If it ever shows up in the profile, split the cache into shards by key hash.
+
+
+PBR_NAMESPACE_BEGIN
+
+// Thread safe size bounded cache, least recently used entries are evicted when the total size exceeds capacity.
+//   Size of every entry is given by the caller, so the capacity can be in bytes, triangles or anything else.
+//   Values are returned as shared_ptr, so the entry stays alive for the thread that uses it, even if it was evicted meanwhile.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache
+{
+public:
+    explicit LRUCache(std::size_t capacity)
+        : m_capacity(capacity)
+    {}
+
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+
+    // Returns nullptr if there is no such key, otherwise marks the entry as the most recently used.
+    std::shared_ptr<const Value> Find(const Key &key)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            ++m_nMisses;
+            return nullptr;
+        }
+        ++m_nHits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->value;
+    }
+
+    // If the key is already present, existing value is kept and returned, so threads that built
+    //   the same entry simultaneously end up sharing one copy.
+    // NOTE: Entry bigger than the whole capacity is returned but not stored.
+    std::shared_ptr<const Value> Insert(const Key &key, std::shared_ptr<const Value> value, std::size_t size)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return it->second->value;
+        }
+        if (size > m_capacity)
+            return value;
+
+        while (m_size + size > m_capacity) {
+            m_size -= m_entries.back().size;
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+            ++m_nEvictions;
+        }
+        m_entries.push_front(Entry{ key, value, size });
+        m_index.emplace(key, m_entries.begin());
+        m_size += size;
+        return value;
+    }
+
+    void Clear()
+    {
+        std::lock_guard lock(m_mutex);
+        m_index.clear();
+        m_entries.clear();
+        m_size = 0;
+    }
+
+    std::size_t Size() const       { std::lock_guard lock(m_mutex); return m_size; }
+    std::size_t Capacity() const   { return m_capacity; }
+    i64 Hits() const               { std::lock_guard lock(m_mutex); return m_nHits; }
+    i64 Misses() const             { std::lock_guard lock(m_mutex); return m_nMisses; }
+    i64 Evictions() const          { std::lock_guard lock(m_mutex); return m_nEvictions; }
+
+private:
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const Value> value;
+        std::size_t size;
+    };
+
+
+    const std::size_t m_capacity;
+    std::size_t m_size = 0;
+    // Front is the most recently used entry.
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> m_index;
+    i64 m_nHits = 0, m_nMisses = 0, m_nEvictions = 0;
+    mutable std::mutex m_mutex;
+};
+
+PBR_NAMESPACE_END
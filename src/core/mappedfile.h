@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core.hpp"
+#include <cstddef>
+#include <string>
+
+
+PBR_NAMESPACE_BEGIN
+
+// Read-only memory mapping of a whole file.
+// NOTE: Data is paged in by the OS on first access, so nothing is read until it's actually touched,
+//       and mapped pages are backed by the page cache instead of process memory.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if file cannot be opened or mapped. Empty files are not mapped either.
+    bool Open(const std::string &filename);
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+    // Data is aligned at least to the page size.
+    const ui8* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    const ui8 *m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+PBR_NAMESPACE_END
@@ -1,79 +1,286 @@
 #include "memory.h"
-//#include <cstdlib>    // std::aligned_alloc
+#include "stats.h"
 #include <algorithm>    // std::max
+#include <cstddef>      // std::max_align_t
+#include <cstdint>      // std::uintptr_t
+#include <cstdlib>      // posix_memalign, free
+#ifdef PBR_HAVE_MMAP
+    #include <sys/mman.h>   // mmap, munmap, madvise
+#endif
 
 
 PBR_NAMESPACE_BEGIN
 
-inline
 void* AllocAligned(std::size_t size)
 {
 #ifdef PBR_HAVE_ALIGNED_MALLOC
     return _aligned_malloc(size, PBR_L1_CACHE_LINE_SIZE);
+#elif defined(PBR_HAVE_POSIX_MEMALIGN)
+    void *ptr;
+    if (posix_memalign(&ptr, PBR_L1_CACHE_LINE_SIZE, size) != 0)
+        ptr = nullptr;
+    return ptr;
 #else
-    // TODO: Add std::aligned_alloc
-    #error "Only MSVC is supported for now"
+    #error "Aligned allocation is not supported on this platform"
 #endif
 }
 
-inline
 void FreeAligned(void* ptr)
 {
     PBR_ASSERT(ptr != nullptr)
 #ifdef PBR_HAVE_ALIGNED_MALLOC
     _aligned_free(ptr);
+#elif defined(PBR_HAVE_POSIX_MEMALIGN)
+    free(ptr);
 #else
-    #error "Only MSVC is supported for now"
+    #error "Aligned allocation is not supported on this platform"
 #endif
 }
 
+static std::size_t RoundUpToHugePage(std::size_t size)
+{
+    return (size + PBR_HUGE_PAGE_SIZE - 1) & ~std::size_t(PBR_HUGE_PAGE_SIZE - 1);
+}
+
+void* AllocHugePages(std::size_t size)
+{
+    size = RoundUpToHugePage(size);
+#ifdef PBR_HAVE_MMAP
+#ifdef MAP_HUGETLB
+    // Explicit huge pages are reserved here, so it fails now and not on the first touch, if there are not enough of them.
+    void *hugetlb = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (hugetlb != MAP_FAILED)
+        return hugetlb;
+#endif
+    // Transparent huge pages need aligned memory, so one page more is reserved and the ends are cut off.
+    void *reserved = mmap(nullptr, size + PBR_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED)
+        return nullptr;
+
+    ui8 *begin = static_cast<ui8*>(reserved);
+    ui8 *aligned = reinterpret_cast<ui8*>(RoundUpToHugePage(reinterpret_cast<std::uintptr_t>(begin)));
+    if (aligned != begin)
+        munmap(begin, aligned - begin);
+    munmap(aligned + size, begin + PBR_HUGE_PAGE_SIZE - aligned);
+#ifdef MADV_HUGEPAGE
+    // NOTE: It's only a hint, with transparent huge pages disabled(or set to 'never') pages stay 4 KB.
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#else
+    return AllocAligned(size);
+#endif
+}
+
+void FreeHugePages(void* ptr, std::size_t size)
+{
+    PBR_ASSERT(ptr != nullptr)
+#ifdef PBR_HAVE_MMAP
+    munmap(ptr, RoundUpToHugePage(size));
+#else
+    FreeAligned(ptr);
+#endif
+}
+
+
+PBR_STATS_MEMORY_COUNTER("Memory/Memory arena blocks", stats_MemoryArena_bytes)
 
-MemoryArena::MemoryArena(std::size_t blockSize)
+MemoryArena::MemoryArena(std::size_t blockSize, bool useHugePages /*= false*/)
     : m_blockSize(blockSize)
+    , m_useHugePages(useHugePages)
 {}
 
 MemoryArena::~MemoryArena()
 {
-    FreeAligned(m_currentBlock);
-    for (auto& block : m_usedBlocks) FreeAligned(block.second);
-    for (auto& block : m_availableBlocks) FreeAligned(block.second);
+    for (auto& block : m_usedBlocks) FreeBlock(block.second, block.first);
+    for (auto& block : m_availableBlocks) FreeBlock(block.second, block.first);
 }
 
-void* MemoryArena::Alloc(std::size_t nBytes)
+// NOTE: Used blocks are moved to the available ones by relinking the list nodes, without any allocations.
+//       They keep their order, so the same sequence of allocations after Reset() takes the same blocks.
+void MemoryArena::Reset()
+{
+    m_availableBlocks.splice(m_availableBlocks.begin(), m_usedBlocks);
+    m_currentBlock = nullptr;
+    m_currentBlockPos = 0;
+    m_currentBlockSize = 0;
+}
+
+size_t MemoryArena::TotalAllocated() const
+{
+    size_t total = 0;
+    for (const auto& block : m_usedBlocks) total += block.first;
+    for (const auto& block : m_availableBlocks) total += block.first;
+    return total;
+}
+
+// NOTE: Huge page blocks are rounded up, and the arena uses the whole rounded size.
+ui8* MemoryArena::AllocBlock(std::size_t &inout_size) const
+{
+    if (m_useHugePages)
+        inout_size = RoundUpToHugePage(inout_size);
+    PBR_STATS_VARIABLE_ADD(stats_MemoryArena_bytes, inout_size)
+
+    return static_cast<ui8*>(m_useHugePages ? AllocHugePages(inout_size) : AllocAligned(inout_size));
+}
+
+void MemoryArena::FreeBlock(ui8* block, std::size_t size) const
+{
+    if (m_useHugePages)
+        FreeHugePages(block, size);
+    else
+        FreeAligned(block);
+}
+
+void* MemoryArena::AllocBytes(std::size_t nBytes, std::size_t align /*= alignof(std::max_align_t)*/)
 {
     // DIFFERENCE: As I understand in the book they assume align=16, but msvc gives align=8. Does it affect anything ?
-    constexpr i32 align = alignof(std::max_align_t);
-    nBytes = (nBytes + align -1) & ~(align - 1);
-
-    if (m_currentBlockPos + nBytes > m_currentBlockSize) {
-        if (m_currentBlock != nullptr) {
-            // IMPROVE: emplace_back ?
-            m_usedBlocks.push_back(std::make_pair(m_currentBlockSize, m_currentBlock));
-            m_currentBlock = nullptr;
-        }
+    constexpr std::size_t minAlign = alignof(std::max_align_t);
+    PBR_ASSERT((align & (align - 1)) == 0)
+    align = std::max(align, minAlign);
+    nBytes = (nBytes + minAlign - 1) & ~(minAlign - 1);
+
+    // NOTE: Blocks are only aligned to the cache line, so padding depends on the address, not just on the position.
+    auto Padding = [align](const ui8 *ptr) {
+        return static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(ptr) & (align - 1));
+    };
+
+    std::size_t padding = m_currentBlock != nullptr ? Padding(m_currentBlock + m_currentBlockPos) : 0;
+    if (m_currentBlock == nullptr || m_currentBlockPos + padding + nBytes > m_currentBlockSize) {
+        m_currentBlock = nullptr;
+        const std::size_t blockBytes = nBytes + (align > PBR_L1_CACHE_LINE_SIZE ? align : 0);
 
         // IMPROVE: std::find() or at least foreach ?
         // Check if there are any already allocated free blocks
         for (auto iter = m_availableBlocks.begin(); iter != m_availableBlocks.end(); ++iter)
-            if (iter->first >= nBytes) {
+            if (iter->first >= blockBytes) {
                 m_currentBlockSize = iter->first;
                 m_currentBlock = iter->second;
-                m_availableBlocks.erase(iter);
+                // NOTE: Node is moved, not reallocated
+                m_usedBlocks.splice(m_usedBlocks.end(), m_availableBlocks, iter);
                 break;
             }
 
         if (m_currentBlock == nullptr) {
-            m_currentBlockSize = std::max(nBytes, m_blockSize);
-            m_currentBlock = static_cast<ui8*>(AllocAligned(m_currentBlockSize));
+            m_currentBlockSize = std::max(blockBytes, m_blockSize);
+            m_currentBlock = AllocBlock(m_currentBlockSize);
+            m_usedBlocks.emplace_back(m_currentBlockSize, m_currentBlock);
         }
 
         m_currentBlockPos = 0;
+        padding = Padding(m_currentBlock);
     }
 
-    void* ret = m_currentBlock + m_currentBlockPos;
-    m_currentBlockPos += nBytes;
+    void* ret = m_currentBlock + m_currentBlockPos + padding;
+    m_currentBlockPos += padding + nBytes;
 
     return ret;
 }
 
+
+// ******************************************************************************
+// ----------------------------- ArenaMemoryResource ----------------------------
+// ******************************************************************************
+
+void* ArenaMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    return m_arena.AllocBytes(bytes, alignment);
+}
+
+bool ArenaMemoryResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    // Memory of the same arena can be "deallocated" through any of its resources
+    const auto *resource = dynamic_cast<const ArenaMemoryResource*>(&other);
+    return resource != nullptr && &resource->m_arena == &m_arena;
+}
+
+MonotonicArenaResource::MonotonicArenaResource(std::size_t blockSize, bool useHugePages /*= false*/)
+    : ArenaMemoryResource(m_ownArena)
+    , m_ownArena(blockSize, useHugePages)
+{}
+
+
+// ******************************************************************************
+// ------------------------------- MemoryArenaPool ------------------------------
+// ******************************************************************************
+
+struct MemoryArenaPool::ThreadArena
+{
+    ThreadArena(const std::shared_ptr<State> &state, MemoryArena *arena)
+        : key(state.get()), state(state), arena(arena)
+    {}
+    ThreadArena(ThreadArena&&) = default;
+    ThreadArena& operator=(ThreadArena&&) = default;
+    ~ThreadArena()
+    {
+        // NOTE: Pool could be destroyed before the thread exits, and moved from arena has no state.
+        if (auto s = state.lock()) {
+            std::lock_guard lock(s->mutex);
+            s->freeArenas.push_back(arena);
+        }
+    }
+
+    // Raw pointer is for the lookup without touching the reference count
+    const State *key;
+    std::weak_ptr<State> state;
+    MemoryArena *arena;
+};
+
+// NOTE: Thread usually uses one or two pools, so linear search is fine.
+thread_local std::vector<MemoryArenaPool::ThreadArena> MemoryArenaPool::t_threadArenas;
+
+
+MemoryArenaPool::MemoryArenaPool(std::size_t blockSize, bool useHugePages /*= false*/)
+    : m_blockSize(blockSize)
+    , m_useHugePages(useHugePages)
+    , m_state(std::make_shared<State>())
+{}
+
+MemoryArena& MemoryArenaPool::Get()
+{
+    for (const ThreadArena &threadArena : t_threadArenas)
+        if (threadArena.key == m_state.get() && threadArena.state.expired() == false)
+            return *threadArena.arena;
+
+    MemoryArena *arena;
+    {
+        std::lock_guard lock(m_state->mutex);
+        if (m_state->freeArenas.empty()) {
+            m_state->arenas.push_back(std::make_unique<MemoryArena>(m_blockSize, m_useHugePages));
+            arena = m_state->arenas.back().get();
+        }
+        else {
+            arena = m_state->freeArenas.back();
+            m_state->freeArenas.pop_back();
+        }
+    }
+
+    // Arenas of the destroyed pools are dropped
+    std::erase_if(t_threadArenas, [](const ThreadArena &threadArena) { return threadArena.state.expired(); });
+    t_threadArenas.emplace_back(m_state, arena);
+    return *arena;
+}
+
+void MemoryArenaPool::ResetAll()
+{
+    std::lock_guard lock(m_state->mutex);
+    for (auto &arena : m_state->arenas)
+        arena->Reset();
+}
+
+size_t MemoryArenaPool::Size() const
+{
+    std::lock_guard lock(m_state->mutex);
+    return m_state->arenas.size();
+}
+
+size_t MemoryArenaPool::TotalAllocated() const
+{
+    std::lock_guard lock(m_state->mutex);
+    size_t total = 0;
+    for (const auto &arena : m_state->arenas)
+        total += arena->TotalAllocated();
+    return total;
+}
+
 PBR_NAMESPACE_END
@@ -1,21 +1,36 @@
 #pragma once
 
 #include "core.hpp"
+#include <cstddef>  // std::max_align_t
 #include <list>     // std::list
+#include <memory>   // std::shared_ptr, std::unique_ptr
+#include <memory_resource>
+#include <mutex>
+#include <new>      // placement new
 #include <utility>  // std::pair
+#include <vector>
 
 // FINDOUT: Is MemoryArena actually better than just 'new' ?
 
 PBR_NAMESPACE_BEGIN
 
-//void* AllocAligned(std::size_t size);
-//void  FreeAligned(void* ptr);
+// Aligned to PBR_L1_CACHE_LINE_SIZE.
+void* AllocAligned(std::size_t size);
+void  FreeAligned(void* ptr);
+
+// Size is rounded up to PBR_HUGE_PAGE_SIZE, and memory is aligned to it. Explicit huge pages are used if the system
+//   has enough of them reserved (vm.nr_hugepages on Linux), otherwise transparent huge pages are requested with madvise().
+// NOTE: Without mmap() it's AllocAligned() with the same rounding. FreeHugePages() needs the same size as AllocHugePages().
+void* AllocHugePages(std::size_t size);
+void  FreeHugePages(void* ptr, std::size_t size);
 
 // FINDOUT: Check if alignas() impact anything.
 class alignas(PBR_L1_CACHE_LINE_SIZE) MemoryArena
 {
 public:
-    MemoryArena(std::size_t blockSize);
+    // With useHugePages blocks are rounded up to PBR_HUGE_PAGE_SIZE and come from AllocHugePages(),
+    //   so memory of the arena is covered by fewer TLB entries. Small blocks would waste most of their pages.
+    MemoryArena(std::size_t blockSize, bool useHugePages = false);
     ~MemoryArena();
 
     MemoryArena(const MemoryArena&) = delete;
@@ -23,27 +38,113 @@ public:
 
     template<typename T>
     T* Alloc(size_t size, bool runConstructor);
+    // NOTE: Sizes are rounded up to alignof(std::max_align_t), and so is the alignment.
+    void* AllocBytes(std::size_t nBytes, std::size_t align = alignof(std::max_align_t));
+
+    // Everything allocated is discarded at once, blocks are kept for the next allocations.
+    //   Typical use is a Reset() after every sample, so the arena grows to the largest sample and then stays at it.
+    // NOTE: Destructors of the objects are not called.
+    void Reset();
 
+    // Bytes of all the blocks, including unused parts of them.
     size_t TotalAllocated() const;
 
 private:
-    void* Alloc(std::size_t bytes);
+    ui8* AllocBlock(std::size_t &inout_size) const;
+    void FreeBlock(ui8* block, std::size_t size) const;
 
 
     const std::size_t m_blockSize;
+    const bool m_useHugePages;
     std::size_t m_currentBlockPos = 0;
     std::size_t m_currentBlockSize = 0;
     ui8* m_currentBlock = nullptr;
     // IMPROVE: I'm sure that std::forward_list would be enough.
+    // DIFFERENCE: Current block is the last of the used blocks, so blocks are moved between the lists without allocations.
     std::list<std::pair<std::size_t, ui8*>> m_usedBlocks;
     std::list<std::pair<std::size_t, ui8*>> m_availableBlocks;
 };
 
 
+// MemoryArena of every thread that asks for one, so threads allocate scratch memory without any synchronization.
+//   Arena is created on the first Get() of a thread, and returned to the pool when the thread exits,
+//   so the next thread(see ParallelFor(), which creates them on every call) reuses it with all its blocks.
+// NOTE: Pool has to outlive the use of its arenas, but not the threads themselves.
+class MemoryArenaPool
+{
+public:
+    MemoryArenaPool(std::size_t blockSize, bool useHugePages = false);
+
+    MemoryArenaPool(const MemoryArenaPool&) = delete;
+    MemoryArenaPool& operator=(const MemoryArenaPool&) = delete;
+
+    // Arena of the calling thread. Lock is only taken on the first call of a thread.
+    MemoryArena& Get();
+
+    // Resets all the arenas, none of them can be in use by other threads at the time.
+    void ResetAll();
+
+    // Number of arenas, and bytes of all their blocks.
+    size_t Size() const;
+    size_t TotalAllocated() const;
+
+private:
+    // NOTE: Threads hold a weak pointer to it, to return their arenas only if the pool is still alive.
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<MemoryArena>> arenas;
+        std::vector<MemoryArena*> freeArenas;
+    };
+    // Arena taken by a thread, returns it to the pool on the thread exit.
+    struct ThreadArena;
+
+    const std::size_t m_blockSize;
+    const bool m_useHugePages;
+    std::shared_ptr<State> m_state;
+
+    static thread_local std::vector<ThreadArena> t_threadArenas;
+};
+
+
+// std::pmr::memory_resource on top of a MemoryArena, so std::pmr containers allocate from it.
+//   deallocate() does nothing, memory goes back to the arena with its Reset(), all at once.
+// NOTE: Containers have to be destroyed(or just not used) before the Reset(), arena doesn't call any destructors.
+class ArenaMemoryResource : public std::pmr::memory_resource
+{
+public:
+    explicit ArenaMemoryResource(MemoryArena &arena) : m_arena(arena) {}
+
+    MemoryArena& Arena() const { return m_arena; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* /*ptr*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+
+    MemoryArena &m_arena;
+};
+
+// Same as std::pmr::monotonic_buffer_resource, but with its own MemoryArena, so it can use huge pages.
+//   Everything is freed on Release() or destruction, blocks are kept for the reuse by Release().
+class MonotonicArenaResource : public ArenaMemoryResource
+{
+public:
+    explicit MonotonicArenaResource(std::size_t blockSize, bool useHugePages = false);
+
+    void Release() { m_ownArena.Reset(); }
+
+private:
+    // NOTE: Base class is constructed first, it only stores the reference.
+    MemoryArena m_ownArena;
+};
+
+
 template<typename T>
 T* MemoryArena::Alloc(size_t size, bool runConstructor)
 {
-    T* ret = static_cast<T*>(Alloc(size * sizeof(T)));
+    T* ret = static_cast<T*>(AllocBytes(size * sizeof(T), alignof(T)));
     if (runConstructor)
         for (size_t i = 0; i < size; ++i)
             new (&ret[i]) T();
@@ -0,0 +1,47 @@
+#include "parallel.h"
+#include <algorithm>    // std::min
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+PBR_NAMESPACE_BEGIN
+
+i32 NumSystemCores()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(i64 count, i64 chunkSize, const std::function<void(i64 begin, i64 end)> &func)
+{
+    PBR_ASSERT(chunkSize > 0)
+    if (count <= 0)
+        return;
+
+    const i64 nChunks = (count + chunkSize - 1) / chunkSize;
+    if (nChunks == 1) {
+        func(0, count);
+        return;
+    }
+
+    // NOTE: Chunks are taken dynamically, so threads that got "cheap" chunks will just take more of them.
+    std::atomic<i64> nextChunk = 0;
+    auto worker = [&]() {
+        for (i64 chunk = nextChunk++; chunk < nChunks; chunk = nextChunk++) {
+            const i64 begin = chunk * chunkSize;
+            func(begin, std::min(begin + chunkSize, count));
+        }
+    };
+
+    const i64 nThreads = std::min<i64>(NumSystemCores(), nChunks);
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (i64 i = 0; i < nThreads - 1; ++i)
+        threads.emplace_back(worker);
+    worker();
+
+    for (auto &thread : threads)
+        thread.join();
+}
+
+PBR_NAMESPACE_END
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "core.hpp"
+#include <functional>
+
+
+// TODO: Thread pool is not implemented, threads are created on every ParallelFor() call.
+//       It's fine for scene loading, but definitely not for rendering.
+
+
+PBR_NAMESPACE_BEGIN
+
+// Number of hardware threads, never less than 1.
+i32 NumSystemCores();
+
+// Splits [0, count) range into chunks of chunkSize elements and calls func(begin, end) for each of them,
+//   using all available cores. Calling thread also takes part in the work.
+//   If there is only one chunk, func is called directly without creating any threads.
+// DIFFERENCE: func gets a range instead of a single index, so the loop body can be tight and vectorized.
+void ParallelFor(i64 count, i64 chunkSize, const std::function<void(i64 begin, i64 end)> &func);
+
+PBR_NAMESPACE_END
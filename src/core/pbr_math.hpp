@@ -22,7 +22,7 @@ T Sqrt(const T v)
     static_assert(std::numeric_limits<T>::is_iec559);
 
     if constexpr (std::is_same<T, f32>())
-        return std::sqrtf(v);
+        return std::sqrt(v);
     else if constexpr (std::is_same<T, f64>())
         return std::sqrt(v);
 }
@@ -44,7 +44,7 @@ T Sin(const T v)
    static_assert(std::numeric_limits<T>::is_iec559);
 
    if constexpr (std::is_same<T, f32>())
-       return std::sinf(v);
+       return std::sin(v);
    else
        return std::sin(v);
 }
@@ -55,18 +55,27 @@ T Cos(const T v)
    static_assert(std::numeric_limits<T>::is_iec559);
 
    if constexpr (std::is_same<T, f32>())
-       return std::cosf(v);
+       return std::cos(v);
    else
        return std::cos(v);
 }
 
+// NOTE: Compilers usually merge separate sin and cos calls of the same argument into one sincos call,
+//       this is here so there is a single call site for both, see fastmath.hpp.
+template<typename T> inline
+void SinCos(const T v, T &out_sin, T &out_cos)
+{
+    out_sin = Sin(v);
+    out_cos = Cos(v);
+}
+
 template<typename T> inline
 T ACos(const T v)
 {
    static_assert(std::numeric_limits<T>::is_iec559);
 
    if constexpr (std::is_same<T, f32>())
-       return std::acosf(v);
+       return std::acos(v);
    else
        return std::acos(v);
 }
@@ -88,7 +97,7 @@ T ATan2(const T y, const T x)
    static_assert(std::numeric_limits<T>::is_iec559);
 
    if constexpr (std::is_same<T, f32>())
-       return std::atan2f(y, x);
+       return std::atan2(y, x);
    else
        return std::atan2(y, x);
 }
@@ -100,7 +109,7 @@ T Floor(const T v)
     static_assert(std::numeric_limits<T>::is_iec559);
 
     if constexpr (std::is_same<T, f32>())
-        return std::floorf(v);
+        return std::floor(v);
     else if constexpr (std::is_same<T, f64>())
         return std::floor(v);
 }
@@ -111,7 +120,7 @@ T Ceil(const T v)
     static_assert(std::numeric_limits<T>::is_iec559);
 
     if constexpr (std::is_same<T, f32>())
-        return std::ceilf(v);
+        return std::ceil(v);
     else if constexpr (std::is_same<T, f64>())
         return std::ceil(v);
 }
@@ -153,7 +162,7 @@ template<typename Float> inline constexpr
 Float Lerp(const Float t, const Float f1, const Float f2)
 {
     static_assert(std::numeric_limits<Float>::is_iec559);
-    return f1 - t * (f2 - f1);
+    return f1 + t * (f2 - f1);
 }
 
 inline constexpr
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "core.hpp"
+#include "pbr_math.hpp"
+#include "geometry.hpp"
+#include "transform.hpp"
+
+#define PBR_CNSTEXPR constexpr
+#define PBR_INLINE inline
+
+
+PBR_NAMESPACE_BEGIN
+
+// ******************************************************************************
+// -------------------------------- Quaternion ----------------------------------
+// ******************************************************************************
+
+#pragma region Quaternion
+
+// Unit quaternions are rotations, q = (v * sin(theta / 2), cos(theta / 2)) is rotation by theta around v.
+struct Quaternion
+{
+    // Creates identity rotation
+    PBR_CNSTEXPR Quaternion();
+    PBR_CNSTEXPR explicit Quaternion(const Vector3_arg<fp_t> v, fp_t w);
+    // Rotation of the transform, its upper 3x3 has to be orthonormal.
+    PBR_INLINE explicit Quaternion(const Transform &t);
+
+    PBR_CNSTEXPR PBR_INLINE Quaternion& operator+=(const Quaternion &q);
+    PBR_CNSTEXPR PBR_INLINE Quaternion& operator-=(const Quaternion &q);
+    PBR_CNSTEXPR PBR_INLINE Quaternion& operator*=(const fp_t scalar);
+    PBR_CNSTEXPR PBR_INLINE Quaternion& operator/=(const fp_t scalar);
+
+    // NOTE: Quaternion has to be normalized.
+    PBR_CNSTEXPR PBR_INLINE Transform ToTransform() const;
+
+
+    Vector3_t v;
+    fp_t w;
+};
+
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+Quaternion::Quaternion()
+    : v(0, 0, 0)
+    , w(1)
+{}
+
+PBR_CNSTEXPR
+Quaternion::Quaternion(const Vector3_arg<fp_t> v, fp_t w)
+    : v(v)
+    , w(w)
+{}
+
+// NOTE: Largest of w, x, y, z is computed from the diagonal first, the rest are divided by it,
+//       so there is no precision loss for the rotations by ~180 degrees.
+PBR_INLINE
+Quaternion::Quaternion(const Transform &t)
+{
+    const Matrix4x4 &m = t.m;
+    const fp_t trace = m[0][0] + m[1][1] + m[2][2];
+    if (trace > 0) {
+        fp_t s = std::sqrt(trace + 1);
+        w = s / 2;
+        s = fp_t(0.5) / s;
+        v = Vector3_t((m[2][1] - m[1][2]) * s, (m[0][2] - m[2][0]) * s, (m[1][0] - m[0][1]) * s);
+    }
+    else {
+        i32 i = 0;
+        if (m[1][1] > m[0][0]) i = 1;
+        if (m[2][2] > m[i][i]) i = 2;
+        const i32 j = (i + 1) % 3, k = (j + 1) % 3;
+        fp_t s = std::sqrt(m[i][i] - m[j][j] - m[k][k] + 1);
+        v[i] = s / 2;
+        s = fp_t(0.5) / s;
+        w = (m[k][j] - m[j][k]) * s;
+        v[j] = (m[j][i] + m[i][j]) * s;
+        v[k] = (m[k][i] + m[i][k]) * s;
+    }
+}
+
+
+// ---------------------------------------
+// ---- ARITHMETIC ASSIGNMENT OPERATORS --
+// ---------------------------------------
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion& Quaternion::operator+=(const Quaternion &q)
+{
+    v += q.v;
+    w += q.w;
+    return *this;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion& Quaternion::operator-=(const Quaternion &q)
+{
+    v -= q.v;
+    w -= q.w;
+    return *this;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion& Quaternion::operator*=(const fp_t scalar)
+{
+    v *= scalar;
+    w *= scalar;
+    return *this;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion& Quaternion::operator/=(const fp_t scalar)
+{
+    PBR_ASSERT(scalar != 0)
+    v /= scalar;
+    w /= scalar;
+    return *this;
+}
+
+
+// ---------------------------------------
+// ----- BINARY ARITHMETIC OPERATORS -----
+// ---------------------------------------
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator+(Quaternion q1, const Quaternion &q2)
+{
+    return q1 += q2;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator-(Quaternion q1, const Quaternion &q2)
+{
+    return q1 -= q2;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator-(Quaternion q)
+{
+    return q *= fp_t(-1);
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator*(Quaternion q, const fp_t scalar)
+{
+    return q *= scalar;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator*(const fp_t scalar, Quaternion q)
+{
+    return q *= scalar;
+}
+
+PBR_CNSTEXPR PBR_INLINE
+Quaternion operator/(Quaternion q, const fp_t scalar)
+{
+    return q /= scalar;
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+// DIFFERENCE: Matrix is row major and transforms column vectors, so there is no transpose at the end.
+PBR_CNSTEXPR PBR_INLINE
+Transform Quaternion::ToTransform() const
+{
+    const fp_t xx = v.x * v.x, yy = v.y * v.y, zz = v.z * v.z;
+    const fp_t xy = v.x * v.y, xz = v.x * v.z, yz = v.y * v.z;
+    const fp_t wx = v.x * w,   wy = v.y * w,   wz = v.z * w;
+
+    Matrix4x4 m(1 - 2 * (yy + zz), 2 * (xy - wz),     2 * (xz + wy),     0,
+                2 * (xy + wz),     1 - 2 * (xx + zz), 2 * (yz - wx),     0,
+                2 * (xz - wy),     2 * (yz + wx),     1 - 2 * (xx + yy), 0,
+                0,                 0,                 0,                 1);
+    // Inverse of the rotation is its transpose
+    return Transform(m, Transpose(m));
+}
+
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+PBR_CNSTEXPR PBR_INLINE
+fp_t Dot(const Quaternion &q1, const Quaternion &q2)
+{
+    return Dot(q1.v, q2.v) + q1.w * q2.w;
+}
+
+PBR_INLINE
+Quaternion Normalize(const Quaternion &q)
+{
+    return q / std::sqrt(Dot(q, q));
+}
+
+// Spherical linear interpolation, q(t) = q1 * cos(theta * t) + qPerp * sin(theta * t), theta is the angle between q1 and q2.
+// NOTE: Nearly parallel quaternions are interpolated linearly, sin(theta) is too small to divide by.
+PBR_INLINE
+Quaternion Slerp(fp_t t, const Quaternion &q1, const Quaternion &q2)
+{
+    const fp_t cosTheta = Dot(q1, q2);
+    if (cosTheta > fp_t(0.9995))
+        return Normalize((1 - t) * q1 + t * q2);
+
+    const fp_t theta = std::acos(std::clamp(cosTheta, fp_t(-1), fp_t(1)));
+    const fp_t thetaP = theta * t;
+    const Quaternion qPerp = Normalize(q2 - q1 * cosTheta);
+    return q1 * std::cos(thetaP) + qPerp * std::sin(thetaP);
+}
+
+#pragma endregion Quaternion
+
+PBR_NAMESPACE_END
+
+#undef PBR_CNSTEXPR
+#undef PBR_INLINE
@@ -23,16 +23,55 @@ Shape::Shape(const Transform *ObjectToWorld, const Transform *WorldToObject, boo
 // --------------- METHODS ---------------
 // ---------------------------------------
 
+bool Shape::Intersect(const RayDifferential_arg r,
+                      fp_t &out_tHit, SurfaceInteraction &out_isect,
+                      bool testAlphaTexture) const
+{
+    return Intersect(static_cast<Ray_arg>(r), out_tHit, out_isect, testAlphaTexture);
+}
+
 Bounds3_t Shape::WorldBound() const
 {
     return (*ObjectToWorld)(ObjectBound());
 }
 
-bool Shape::IsIntersecting(const Ray_arg r, bool testAlphaTexture = true) const
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+Bounds3_t RevolutionBounds(fp_t rMin, fp_t rMax, fp_t phiStart, fp_t phiEnd, fp_t zMin, fp_t zMax)
 {
-    // DIFFERENCE: I changed Intersect(const Ray_arg, fp_t &, SurfaceInteraction &,bool) to to references instead of pointers.
-    //             So I need to rework this function. 
-    return Intersect(r, nullptr, nullptr, testAlphaTexture);
+    PBR_ASSERT(rMin <= rMax && phiStart <= phiEnd)
+
+    if (phiEnd - phiStart >= 2 * constants::pi_t)
+        return Bounds3_t(Point3_t(-rMax, -rMax, zMin),
+                         Point3_t( rMax,  rMax, zMax));
+
+    // Corners of the sector
+    const fp_t cosStart = pbr::Cos(phiStart), sinStart = pbr::Sin(phiStart);
+    const fp_t cosEnd = pbr::Cos(phiEnd), sinEnd = pbr::Sin(phiEnd);
+    Bounds3_t bounds(Point3_t(rMin * cosStart, rMin * sinStart, zMin),
+                     Point3_t(rMax * cosStart, rMax * sinStart, zMax));
+    bounds = Union(bounds, Point3_t(rMin * cosEnd, rMin * sinEnd, zMin));
+    bounds = Union(bounds, Point3_t(rMax * cosEnd, rMax * sinEnd, zMin));
+
+    // Arc is extreme, where it crosses the axes
+    constexpr fp_t axisX[4] = { 1, 0, -1,  0 };
+    constexpr fp_t axisY[4] = { 0, 1,  0, -1 };
+    const fp_t halfPi = constants::pi_t / 2;
+    for (i32 k = static_cast<i32>(std::ceil(phiStart / halfPi)); k * halfPi <= phiEnd; ++k) {
+        const i32 axis = ((k % 4) + 4) % 4;
+        bounds = Union(bounds, Point3_t(rMax * axisX[axis], rMax * axisY[axis], zMin));
+    }
+
+    // Sin() and Cos() of the sector ends are rounded, hit at phiMax can be a bit outside
+    const fp_t pad = pbr::Gamma(4) * rMax;
+    bounds.pMin.x -= pad;
+    bounds.pMin.y -= pad;
+    bounds.pMax.x += pad;
+    bounds.pMax.y += pad;
+    return bounds;
 }
 
 
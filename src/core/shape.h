@@ -2,6 +2,7 @@
 
 #include "core.hpp"
 
+#include "fastmath.hpp"
 #include "geometry.hpp"
 #include "interaction.hpp"
 #include "transform.hpp"
@@ -11,7 +12,7 @@
 PBR_NAMESPACE_BEGIN
 
 // NOTE: Why not all virtual methods deleted( =0 ) ?
-//       Because only Triangle implements WorldBound. Don't know about IsIntersecting() for now.
+//       Because only Triangle implements WorldBound.
 // NOTE: Delete pointers in destructor ? (probably not, since Transform* shared across shapes)
 class Shape
 {
@@ -27,8 +28,15 @@ public:
     virtual bool Intersect(const Ray_arg r,
                            fp_t &out_tHit, SurfaceInteraction &out_isect,
                            bool testAlphaTexture = true) const = 0;
-    // NOTE: Why this method is defined in abstract class what the use of it ?
-    virtual bool IsIntersecting(const Ray_arg r, bool testAlphaTexture = true) const;
+    // Same as above, but shape can use ray differentials to choose the level of detail.
+    //   By default differentials are ignored.
+    // NOTE: Shapes that override only the Ray version need using Shape::Intersect, otherwise this one is hidden in them.
+    virtual bool Intersect(const RayDifferential_arg r,
+                           fp_t &out_tHit, SurfaceInteraction &out_isect,
+                           bool testAlphaTexture = true) const;
+    // Occlusion query, it stops after the root and clipping tests and never builds SurfaceInteraction.
+    // DIFFERENCE: Pure virtual, in the book it falls back to Intersect(), which is as expensive as closest hit.
+    virtual bool IsIntersecting(const Ray_arg r, bool testAlphaTexture = true) const = 0;
 
     // Surface area of a shape in object space.
     virtual fp_t Area() const = 0;
@@ -40,4 +48,20 @@ public:
     const bool transformSwapsHandedness;
 };
 
+
+// Tests phi of the object space hit point against phiMax of the partial quadric.
+//   Full quadric has nothing to clip, so ATan2() is skipped for it.
+inline bool IsPhiClipped(const Point3_arg<fp_t> pHit, fp_t phiMax)
+{
+    if (phiMax >= 2 * constants::pi_t)
+        return false;
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
+    if (phi < 0) phi += constants::pi_t * 2;
+    return phi > phiMax;
+}
+
+// Bounds of the part of the surface of revolution around z axis, which lies between radii rMin and rMax,
+//   phi from phiStart to phiEnd, and z from zMin to zMax. It's the box of the ring sector, not of the full ring.
+Bounds3_t RevolutionBounds(fp_t rMin, fp_t rMax, fp_t phiStart, fp_t phiEnd, fp_t zMin, fp_t zMax);
+
 PBR_NAMESPACE_END
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "core.hpp"
+
+#if PBR_ENABLE_SSE == 0
+    #error "simd.hpp requires SSE2"
+#endif
+
+#include <emmintrin.h>
+#if PBR_ENABLE_AVX == 1
+    #include <immintrin.h>
+#endif
+
+
+// Thin wrappers of SSE and AVX registers of f32 lanes, so code can be written once for any width, see EFloatN.
+//   Comparisons return masks of the same type, every lane is all ones or all zeros, masks are consumed by
+//   Select(), MoveMask(), Any() and All(). Lane i of MoveMask() is bit i.
+// NOTE: f32x8 is one AVX register if PBR_ENABLE_AVX is set, and two SSE registers otherwise.
+
+
+PBR_NAMESPACE_BEGIN
+
+// ****************************************************************************************************************
+// ************************************************** f32x4 *******************************************************
+// ****************************************************************************************************************
+
+#pragma region f32x4
+
+struct f32x4
+{
+    static constexpr i32 width = 4;
+
+    f32x4() = default;
+    f32x4(__m128 v) : v(v) {}
+    explicit f32x4(f32 f) : v(_mm_set1_ps(f)) {}
+    f32x4(f32 f0, f32 f1, f32 f2, f32 f3) : v(_mm_setr_ps(f0, f1, f2, f3)) {}
+
+    static f32x4 Load(const f32 *p) { return _mm_loadu_ps(p); }
+    void Store(f32 *out_p) const { _mm_storeu_ps(out_p, v); }
+
+    f32 operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i < width)
+        alignas(16) f32 lanes[width];
+        _mm_store_ps(lanes, v);
+        return lanes[i];
+    }
+
+    __m128 v;
+};
+
+inline f32x4 operator-(f32x4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.f)); }
+
+inline f32x4 operator+(f32x4 a, f32x4 b) { return _mm_add_ps(a.v, b.v); }
+inline f32x4 operator-(f32x4 a, f32x4 b) { return _mm_sub_ps(a.v, b.v); }
+inline f32x4 operator*(f32x4 a, f32x4 b) { return _mm_mul_ps(a.v, b.v); }
+inline f32x4 operator/(f32x4 a, f32x4 b) { return _mm_div_ps(a.v, b.v); }
+
+inline f32x4 operator<(f32x4 a, f32x4 b)  { return _mm_cmplt_ps(a.v, b.v); }
+inline f32x4 operator<=(f32x4 a, f32x4 b) { return _mm_cmple_ps(a.v, b.v); }
+inline f32x4 operator>(f32x4 a, f32x4 b)  { return _mm_cmpgt_ps(a.v, b.v); }
+inline f32x4 operator>=(f32x4 a, f32x4 b) { return _mm_cmpge_ps(a.v, b.v); }
+inline f32x4 operator==(f32x4 a, f32x4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+
+inline f32x4 operator&(f32x4 a, f32x4 b) { return _mm_and_ps(a.v, b.v); }
+inline f32x4 operator|(f32x4 a, f32x4 b) { return _mm_or_ps(a.v, b.v); }
+
+inline f32x4 Abs(f32x4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+inline f32x4 Sqrt(f32x4 a) { return _mm_sqrt_ps(a.v); }
+inline f32x4 Min(f32x4 a, f32x4 b) { return _mm_min_ps(a.v, b.v); }
+inline f32x4 Max(f32x4 a, f32x4 b) { return _mm_max_ps(a.v, b.v); }
+
+inline f32x4 Select(f32x4 mask, f32x4 a, f32x4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+inline i32 MoveMask(f32x4 mask) { return _mm_movemask_ps(mask.v); }
+inline bool Any(f32x4 mask) { return MoveMask(mask) != 0; }
+inline bool All(f32x4 mask) { return MoveMask(mask) == 0xF; }
+
+// Same as std::nextafter() towards infinity, lane by lane, but infinities and NaNs are not handled.
+inline f32x4 NextFloatUp(f32x4 a)
+{
+    // -0 becomes +0, then next float is one bit up for positive values and one bit down for negative ones.
+    const __m128i bits = _mm_castps_si128(_mm_add_ps(a.v, _mm_setzero_ps()));
+    const __m128i step = _mm_or_si128(_mm_srai_epi32(bits, 31), _mm_set1_epi32(1));
+    return _mm_castsi128_ps(_mm_add_epi32(bits, step));
+}
+
+inline f32x4 NextFloatDown(f32x4 a) { return -NextFloatUp(-a); }
+
+#pragma endregion f32x4
+
+
+// ****************************************************************************************************************
+// ************************************************** f32x8 *******************************************************
+// ****************************************************************************************************************
+
+#pragma region f32x8
+
+#if PBR_ENABLE_AVX == 1
+
+struct f32x8
+{
+    static constexpr i32 width = 8;
+
+    f32x8() = default;
+    f32x8(__m256 v) : v(v) {}
+    explicit f32x8(f32 f) : v(_mm256_set1_ps(f)) {}
+    f32x8(f32x4 lo, f32x4 hi) : v(_mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1)) {}
+
+    static f32x8 Load(const f32 *p) { return _mm256_loadu_ps(p); }
+    void Store(f32 *out_p) const { _mm256_storeu_ps(out_p, v); }
+
+    f32x4 Low() const { return _mm256_castps256_ps128(v); }
+    f32x4 High() const { return _mm256_extractf128_ps(v, 1); }
+
+    f32 operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i < width)
+        alignas(32) f32 lanes[width];
+        _mm256_store_ps(lanes, v);
+        return lanes[i];
+    }
+
+    __m256 v;
+};
+
+inline f32x8 operator-(f32x8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.f)); }
+
+inline f32x8 operator+(f32x8 a, f32x8 b) { return _mm256_add_ps(a.v, b.v); }
+inline f32x8 operator-(f32x8 a, f32x8 b) { return _mm256_sub_ps(a.v, b.v); }
+inline f32x8 operator*(f32x8 a, f32x8 b) { return _mm256_mul_ps(a.v, b.v); }
+inline f32x8 operator/(f32x8 a, f32x8 b) { return _mm256_div_ps(a.v, b.v); }
+
+inline f32x8 operator<(f32x8 a, f32x8 b)  { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline f32x8 operator<=(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline f32x8 operator>(f32x8 a, f32x8 b)  { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline f32x8 operator>=(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+inline f32x8 operator==(f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+
+inline f32x8 operator&(f32x8 a, f32x8 b) { return _mm256_and_ps(a.v, b.v); }
+inline f32x8 operator|(f32x8 a, f32x8 b) { return _mm256_or_ps(a.v, b.v); }
+
+inline f32x8 Abs(f32x8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+inline f32x8 Sqrt(f32x8 a) { return _mm256_sqrt_ps(a.v); }
+inline f32x8 Min(f32x8 a, f32x8 b) { return _mm256_min_ps(a.v, b.v); }
+inline f32x8 Max(f32x8 a, f32x8 b) { return _mm256_max_ps(a.v, b.v); }
+
+inline f32x8 Select(f32x8 mask, f32x8 a, f32x8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+inline i32 MoveMask(f32x8 mask) { return _mm256_movemask_ps(mask.v); }
+
+// NOTE: AVX has no 256 bit integer operations, that's AVX2, so it's done by halves.
+inline f32x8 NextFloatUp(f32x8 a) { return f32x8(NextFloatUp(a.Low()), NextFloatUp(a.High())); }
+
+#else
+
+struct f32x8
+{
+    static constexpr i32 width = 8;
+
+    f32x8() = default;
+    explicit f32x8(f32 f) : lo(f), hi(f) {}
+    f32x8(f32x4 lo, f32x4 hi) : lo(lo), hi(hi) {}
+
+    static f32x8 Load(const f32 *p) { return f32x8(f32x4::Load(p), f32x4::Load(p + 4)); }
+    void Store(f32 *out_p) const { lo.Store(out_p); hi.Store(out_p + 4); }
+
+    f32x4 Low() const { return lo; }
+    f32x4 High() const { return hi; }
+
+    f32 operator[](i32 i) const
+    {
+        PBR_ASSERT(i >= 0 && i < width)
+        return i < 4 ? lo[i] : hi[i - 4];
+    }
+
+    f32x4 lo, hi;
+};
+
+inline f32x8 operator-(f32x8 a) { return f32x8(-a.lo, -a.hi); }
+
+inline f32x8 operator+(f32x8 a, f32x8 b) { return f32x8(a.lo + b.lo, a.hi + b.hi); }
+inline f32x8 operator-(f32x8 a, f32x8 b) { return f32x8(a.lo - b.lo, a.hi - b.hi); }
+inline f32x8 operator*(f32x8 a, f32x8 b) { return f32x8(a.lo * b.lo, a.hi * b.hi); }
+inline f32x8 operator/(f32x8 a, f32x8 b) { return f32x8(a.lo / b.lo, a.hi / b.hi); }
+
+inline f32x8 operator<(f32x8 a, f32x8 b)  { return f32x8(a.lo < b.lo, a.hi < b.hi); }
+inline f32x8 operator<=(f32x8 a, f32x8 b) { return f32x8(a.lo <= b.lo, a.hi <= b.hi); }
+inline f32x8 operator>(f32x8 a, f32x8 b)  { return f32x8(a.lo > b.lo, a.hi > b.hi); }
+inline f32x8 operator>=(f32x8 a, f32x8 b) { return f32x8(a.lo >= b.lo, a.hi >= b.hi); }
+inline f32x8 operator==(f32x8 a, f32x8 b) { return f32x8(a.lo == b.lo, a.hi == b.hi); }
+
+inline f32x8 operator&(f32x8 a, f32x8 b) { return f32x8(a.lo & b.lo, a.hi & b.hi); }
+inline f32x8 operator|(f32x8 a, f32x8 b) { return f32x8(a.lo | b.lo, a.hi | b.hi); }
+
+inline f32x8 Abs(f32x8 a) { return f32x8(Abs(a.lo), Abs(a.hi)); }
+inline f32x8 Sqrt(f32x8 a) { return f32x8(Sqrt(a.lo), Sqrt(a.hi)); }
+inline f32x8 Min(f32x8 a, f32x8 b) { return f32x8(Min(a.lo, b.lo), Min(a.hi, b.hi)); }
+inline f32x8 Max(f32x8 a, f32x8 b) { return f32x8(Max(a.lo, b.lo), Max(a.hi, b.hi)); }
+
+inline f32x8 Select(f32x8 mask, f32x8 a, f32x8 b) { return f32x8(Select(mask.lo, a.lo, b.lo), Select(mask.hi, a.hi, b.hi)); }
+inline i32 MoveMask(f32x8 mask) { return MoveMask(mask.lo) | (MoveMask(mask.hi) << 4); }
+
+inline f32x8 NextFloatUp(f32x8 a) { return f32x8(NextFloatUp(a.lo), NextFloatUp(a.hi)); }
+
+#endif
+
+inline bool Any(f32x8 mask) { return MoveMask(mask) != 0; }
+inline bool All(f32x8 mask) { return MoveMask(mask) == 0xFF; }
+
+inline f32x8 NextFloatDown(f32x8 a) { return -NextFloatUp(-a); }
+
+#pragma endregion f32x8
+
+PBR_NAMESPACE_END
@@ -0,0 +1,96 @@
+#include "spacefillingcurve.h"
+#include "parallel.h"
+#include <algorithm>    // std::min, std::copy
+#include <vector>
+
+
+PBR_NAMESPACE_BEGIN
+
+namespace {
+
+constexpr i32 digitBits = 8;
+constexpr i32 nBuckets = 1 << digitBits;
+// Every block has its own histogram, so the scatter is parallel and still stable, blocks keep their order.
+constexpr i64 minBlockSize = 64 * 1024;
+
+template<typename Key>
+void RadixSortImpl(std::span<Key> keys, std::span<i32> values)
+{
+    PBR_ASSERT(keys.size() == values.size())
+    const i64 count = static_cast<i64>(keys.size());
+    if (count < 2)
+        return;
+
+    const i64 nBlocks = std::max<i64>(1, std::min<i64>(NumSystemCores(), count / minBlockSize));
+    const i64 blockSize = (count + nBlocks - 1) / nBlocks;
+
+    std::vector<Key> tempKeys(count);
+    std::vector<i32> tempValues(count);
+    // Histogram of the digit in every block, then its output offset
+    std::vector<i64> offsets(nBlocks * nBuckets);
+
+    Key *srcKeys = keys.data(), *dstKeys = tempKeys.data();
+    i32 *srcValues = values.data(), *dstValues = tempValues.data();
+
+    // Digits where all the keys are the same change nothing, AND and OR of all the keys tell which bits differ.
+    Key keysAnd = ~Key(0), keysOr = 0;
+    for (i64 i = 0; i < count; ++i) {
+        keysAnd &= srcKeys[i];
+        keysOr |= srcKeys[i];
+    }
+    const Key differentBits = keysAnd ^ keysOr;
+
+    for (i32 shift = 0; shift < i32(8 * sizeof(Key)); shift += digitBits) {
+        if (((differentBits >> shift) & (nBuckets - 1)) == 0)
+            continue;
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        ParallelFor(count, blockSize, [&](i64 begin, i64 end) {
+            i64 *histogram = &offsets[(begin / blockSize) * nBuckets];
+            for (i64 i = begin; i < end; ++i)
+                ++histogram[(srcKeys[i] >> shift) & (nBuckets - 1)];
+        });
+
+        // Exclusive prefix sum in the (digit, block) order
+        i64 sum = 0;
+        for (i32 digit = 0; digit < nBuckets; ++digit)
+            for (i64 block = 0; block < nBlocks; ++block) {
+                const i64 n = offsets[block * nBuckets + digit];
+                offsets[block * nBuckets + digit] = sum;
+                sum += n;
+            }
+
+        ParallelFor(count, blockSize, [&](i64 begin, i64 end) {
+            i64 *offset = &offsets[(begin / blockSize) * nBuckets];
+            for (i64 i = begin; i < end; ++i) {
+                const i64 destination = offset[(srcKeys[i] >> shift) & (nBuckets - 1)]++;
+                dstKeys[destination] = srcKeys[i];
+                dstValues[destination] = srcValues[i];
+            }
+        });
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    // Odd number of passes leaves the result in the temporary arrays
+    if (srcKeys != keys.data()) {
+        std::copy(srcKeys, srcKeys + count, keys.data());
+        std::copy(srcValues, srcValues + count, values.data());
+    }
+}
+
+} // namespace
+
+
+void RadixSort(std::span<ui32> keys, std::span<i32> values)
+{
+    RadixSortImpl(keys, values);
+}
+
+void RadixSort(std::span<ui64> keys, std::span<i32> values)
+{
+    RadixSortImpl(keys, values);
+}
+
+PBR_NAMESPACE_END
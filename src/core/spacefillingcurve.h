@@ -0,0 +1,334 @@
+#pragma once
+
+#include "core.hpp"
+#include <span>
+#include <type_traits>
+
+#if PBR_ENABLE_BMI2 == 1
+    #include <immintrin.h>
+#endif
+
+
+// Morton (Z-order) and Hilbert codes of 2D and 3D integer coordinates, for ordering of primitives, rays and tiles
+//   by locality, and radix sort of the codes. Key is ui32 or ui64, it's the size of the code,
+//   coordinates are truncated to its share of the key bits, see KeyBits2 and KeyBits3.
+// NOTE: Bit i of x is bit 2 * i (3 * i) of the code, y and z are next to it, so x changes fastest along the curve.
+
+
+PBR_NAMESPACE_BEGIN
+
+// ******************************************************************************
+// ----------------------------------- MORTON -----------------------------------
+// ******************************************************************************
+
+#pragma region Morton
+
+// Bits per coordinate, 16 and 32 for 2D, 10 and 21 for 3D.
+template<typename Key> inline constexpr i32 KeyBits2 = 4 * sizeof(Key);
+template<typename Key> inline constexpr i32 KeyBits3 = 8 * sizeof(Key) / 3;
+
+namespace detail {
+
+template<typename Key>
+inline constexpr void CheckKey()
+{
+    static_assert(std::is_same_v<Key, ui32> || std::is_same_v<Key, ui64>, "Key has to be ui32 or ui64");
+}
+
+// Masks of the code bits that belong to x, 0101... and 001001...
+template<typename Key> inline constexpr Key MortonMask2 = static_cast<Key>(0x5555555555555555ull);
+template<typename Key> inline constexpr Key MortonMask3 = static_cast<Key>(std::is_same_v<Key, ui32> ? 0x09249249ull : 0x1249249249249249ull);
+
+// Inserts one zero bit after every bit of the low KeyBits2 bits of x.
+template<typename Key>
+inline constexpr Key SpreadBits2(Key x)
+{
+    if constexpr (std::is_same_v<Key, ui64>) {
+        x &= 0x00000000FFFFFFFF;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFF;
+        x = (x | (x << 8))  & 0x00FF00FF00FF00FF;
+        x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0F;
+        x = (x | (x << 2))  & 0x3333333333333333;
+        x = (x | (x << 1))  & 0x5555555555555555;
+    }
+    else {
+        x &= 0x0000FFFF;
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+    }
+    return x;
+}
+
+template<typename Key>
+inline constexpr Key CompactBits2(Key x)
+{
+    if constexpr (std::is_same_v<Key, ui64>) {
+        x &= 0x5555555555555555;
+        x = (x | (x >> 1))  & 0x3333333333333333;
+        x = (x | (x >> 2))  & 0x0F0F0F0F0F0F0F0F;
+        x = (x | (x >> 4))  & 0x00FF00FF00FF00FF;
+        x = (x | (x >> 8))  & 0x0000FFFF0000FFFF;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFF;
+    }
+    else {
+        x &= 0x55555555;
+        x = (x | (x >> 1)) & 0x33333333;
+        x = (x | (x >> 2)) & 0x0F0F0F0F;
+        x = (x | (x >> 4)) & 0x00FF00FF;
+        x = (x | (x >> 8)) & 0x0000FFFF;
+    }
+    return x;
+}
+
+// Inserts two zero bits after every bit of the low KeyBits3 bits of x.
+template<typename Key>
+inline constexpr Key SpreadBits3(Key x)
+{
+    if constexpr (std::is_same_v<Key, ui64>) {
+        x &= 0x00000000001FFFFF;
+        x = (x | (x << 32)) & 0x001F00000000FFFF;
+        x = (x | (x << 16)) & 0x001F0000FF0000FF;
+        x = (x | (x << 8))  & 0x100F00F00F00F00F;
+        x = (x | (x << 4))  & 0x10C30C30C30C30C3;
+        x = (x | (x << 2))  & 0x1249249249249249;
+    }
+    else {
+        x &= 0x000003FF;
+        x = (x | (x << 16)) & 0xFF0000FF;
+        x = (x | (x << 8))  & 0x0300F00F;
+        x = (x | (x << 4))  & 0x030C30C3;
+        x = (x | (x << 2))  & 0x09249249;
+    }
+    return x;
+}
+
+template<typename Key>
+inline constexpr Key CompactBits3(Key x)
+{
+    if constexpr (std::is_same_v<Key, ui64>) {
+        x &= 0x1249249249249249;
+        x = (x | (x >> 2))  & 0x10C30C30C30C30C3;
+        x = (x | (x >> 4))  & 0x100F00F00F00F00F;
+        x = (x | (x >> 8))  & 0x001F0000FF0000FF;
+        x = (x | (x >> 16)) & 0x001F00000000FFFF;
+        x = (x | (x >> 32)) & 0x00000000001FFFFF;
+    }
+    else {
+        x &= 0x09249249;
+        x = (x | (x >> 2))  & 0x030C30C3;
+        x = (x | (x >> 4))  & 0x0300F00F;
+        x = (x | (x >> 8))  & 0xFF0000FF;
+        x = (x | (x >> 16)) & 0x000003FF;
+    }
+    return x;
+}
+
+// pdep/pext with the mask, or the shifts above if there is no BMI2 or it's constant evaluated.
+template<typename Key, i32 dimensions>
+inline constexpr Key Deposit(Key x)
+{
+#if PBR_ENABLE_BMI2 == 1
+    if (!std::is_constant_evaluated()) {
+        constexpr Key mask = dimensions == 2 ? MortonMask2<Key> : MortonMask3<Key>;
+        if constexpr (std::is_same_v<Key, ui64>)
+            return _pdep_u64(x, mask);
+        else
+            return _pdep_u32(x, mask);
+    }
+#endif
+    if constexpr (dimensions == 2)
+        return SpreadBits2(x);
+    else
+        return SpreadBits3(x);
+}
+
+template<typename Key, i32 dimensions>
+inline constexpr Key Extract(Key code)
+{
+#if PBR_ENABLE_BMI2 == 1
+    if (!std::is_constant_evaluated()) {
+        constexpr Key mask = dimensions == 2 ? MortonMask2<Key> : MortonMask3<Key>;
+        if constexpr (std::is_same_v<Key, ui64>)
+            return _pext_u64(code, mask);
+        else
+            return _pext_u32(code, mask);
+    }
+#endif
+    if constexpr (dimensions == 2)
+        return CompactBits2(code);
+    else
+        return CompactBits3(code);
+}
+
+} // namespace detail
+
+
+template<typename Key>
+inline constexpr Key EncodeMorton2(ui32 x, ui32 y)
+{
+    detail::CheckKey<Key>();
+    return detail::Deposit<Key, 2>(x) | (detail::Deposit<Key, 2>(y) << 1);
+}
+
+template<typename Key>
+inline constexpr void DecodeMorton2(Key code, ui32 &out_x, ui32 &out_y)
+{
+    detail::CheckKey<Key>();
+    out_x = static_cast<ui32>(detail::Extract<Key, 2>(code));
+    out_y = static_cast<ui32>(detail::Extract<Key, 2>(code >> 1));
+}
+
+template<typename Key>
+inline constexpr Key EncodeMorton3(ui32 x, ui32 y, ui32 z)
+{
+    detail::CheckKey<Key>();
+    return detail::Deposit<Key, 3>(x) | (detail::Deposit<Key, 3>(y) << 1) | (detail::Deposit<Key, 3>(z) << 2);
+}
+
+template<typename Key>
+inline constexpr void DecodeMorton3(Key code, ui32 &out_x, ui32 &out_y, ui32 &out_z)
+{
+    detail::CheckKey<Key>();
+    out_x = static_cast<ui32>(detail::Extract<Key, 3>(code));
+    out_y = static_cast<ui32>(detail::Extract<Key, 3>(code >> 1));
+    out_z = static_cast<ui32>(detail::Extract<Key, 3>(code >> 2));
+}
+
+#pragma endregion Morton
+
+
+// ******************************************************************************
+// ---------------------------------- HILBERT -----------------------------------
+// ******************************************************************************
+
+#pragma region Hilbert
+
+// NOTE: Skilling's method, "Programming the Hilbert curve" (2004). Coordinates are transformed in place
+//       to the "transposed" Hilbert index, interleaved the same way as Morton code they're the index,
+//       and the first coordinate holds its most significant bits. It's the same for any number of dimensions.
+//       Consecutive indices are always neighbours on the grid, Morton codes jump.
+
+namespace detail {
+
+template<i32 n>
+inline constexpr void AxesToTranspose(ui32 (&X)[n], i32 bits)
+{
+    const ui32 M = ui32(1) << (bits - 1);
+    // Inverse undo
+    for (ui32 Q = M; Q > 1; Q >>= 1) {
+        const ui32 P = Q - 1;
+        for (i32 i = 0; i < n; ++i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            }
+            else {
+                const ui32 t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // Gray encode
+    for (i32 i = 1; i < n; ++i)
+        X[i] ^= X[i - 1];
+    ui32 t = 0;
+    for (ui32 Q = M; Q > 1; Q >>= 1)
+        if (X[n - 1] & Q)
+            t ^= Q - 1;
+    for (i32 i = 0; i < n; ++i)
+        X[i] ^= t;
+}
+
+template<i32 n>
+inline constexpr void TransposeToAxes(ui32 (&X)[n], i32 bits)
+{
+    const ui32 M = ui32(1) << (bits - 1);
+    // Gray decode
+    const ui32 t = X[n - 1] >> 1;
+    for (i32 i = n - 1; i > 0; --i)
+        X[i] ^= X[i - 1];
+    X[0] ^= t;
+    // Undo excess work, Q wraps to 0 after the top bit of ui32
+    for (ui32 Q = 2; Q != 0 && Q <= M; Q <<= 1) {
+        const ui32 P = Q - 1;
+        for (i32 i = n - 1; i >= 0; --i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            }
+            else {
+                const ui32 t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+}
+
+inline constexpr ui32 LowBits(ui32 x, i32 bits)
+{
+    return bits == 32 ? x : x & ((ui32(1) << bits) - 1);
+}
+
+} // namespace detail
+
+
+template<typename Key>
+inline constexpr Key EncodeHilbert2(ui32 x, ui32 y)
+{
+    detail::CheckKey<Key>();
+    constexpr i32 bits = KeyBits2<Key>;
+    ui32 X[2] = { detail::LowBits(x, bits), detail::LowBits(y, bits) };
+    detail::AxesToTranspose(X, bits);
+    return EncodeMorton2<Key>(X[1], X[0]);
+}
+
+template<typename Key>
+inline constexpr void DecodeHilbert2(Key index, ui32 &out_x, ui32 &out_y)
+{
+    detail::CheckKey<Key>();
+    ui32 X[2];
+    DecodeMorton2<Key>(index, X[1], X[0]);
+    detail::TransposeToAxes(X, KeyBits2<Key>);
+    out_x = X[0];
+    out_y = X[1];
+}
+
+template<typename Key>
+inline constexpr Key EncodeHilbert3(ui32 x, ui32 y, ui32 z)
+{
+    detail::CheckKey<Key>();
+    constexpr i32 bits = KeyBits3<Key>;
+    ui32 X[3] = { detail::LowBits(x, bits), detail::LowBits(y, bits), detail::LowBits(z, bits) };
+    detail::AxesToTranspose(X, bits);
+    return EncodeMorton3<Key>(X[2], X[1], X[0]);
+}
+
+template<typename Key>
+inline constexpr void DecodeHilbert3(Key index, ui32 &out_x, ui32 &out_y, ui32 &out_z)
+{
+    detail::CheckKey<Key>();
+    ui32 X[3];
+    DecodeMorton3<Key>(index, X[2], X[1], X[0]);
+    detail::TransposeToAxes(X, KeyBits3<Key>);
+    out_x = X[0];
+    out_y = X[1];
+    out_z = X[2];
+}
+
+#pragma endregion Hilbert
+
+
+// ******************************************************************************
+// --------------------------------- RADIX SORT ---------------------------------
+// ******************************************************************************
+
+// Sorts keys in ascending order and moves values along with them, the sort is stable. LSD with 8 bit digits,
+//   digits that are the same for all the keys are skipped, so codes that use only low bits are sorted faster.
+//   Large arrays are split between the threads, see ParallelFor().
+// NOTE: Allocates temporary copy of both arrays.
+void RadixSort(std::span<ui32> keys, std::span<i32> values);
+void RadixSort(std::span<ui64> keys, std::span<i32> values);
+
+PBR_NAMESPACE_END
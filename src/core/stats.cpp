@@ -3,6 +3,20 @@
 
 namespace pbr {
 
+#if PBR_ENABLE_STATS_COUNT == 1
+
+std::vector<std::function<void(StatsAccumulator &)>> *StatsRegisterer::m_callbacks = nullptr;
+
+void StatsRegisterer::CallCallbacks(StatsAccumulator &accumulator)
+{
+    if (m_callbacks == nullptr)
+        return;
+    for (auto &callback : *m_callbacks)
+        callback(accumulator);
+}
+
+#endif // PBR_ENABLE_STATS_COUNT
+
 #if PBR_ENABLE_PROFILING == 1
 
 thread_local ui64 g_ProfilerState;
@@ -0,0 +1,210 @@
+#include "transform.hpp"
+#include "parallel.h"
+
+
+PBR_NAMESPACE_BEGIN
+
+// Batched transforms split arrays into chunks of this size for ParallelFor(), smaller arrays stay on the calling thread.
+constexpr i64 kBatchChunkSize = 64 * 1024;
+
+namespace {
+
+// Rows of the 3x4 matrix applied to every element, xyz' = M * xyz (+ M[i][3] if it's a point).
+//   Coefficients are picked per type of the array, so one kernel serves points, vectors and normals.
+struct Affine3x4
+{
+    fp_t m[3][4];
+};
+
+#if PBR_MATRIX4X4_SSE == 1
+
+// 4 elements of 3 floats are loaded as 3 registers (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3) and split to x, y and z.
+inline
+void LoadSoA(const f32 *p, __m128 &out_x, __m128 &out_y, __m128 &out_z)
+{
+    const __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+    out_x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    out_y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    out_z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+inline
+void StoreSoA(f32 *out_p, __m128 x, __m128 y, __m128 z)
+{
+    _mm_storeu_ps(out_p,     _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(out_p + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(out_p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// Row i of the matrix applied to 4 elements, products are summed in the same order as the scalar operator().
+template<bool hasTranslation> inline
+__m128 Row(const __m128 row[4], __m128 x, __m128 y, __m128 z)
+{
+    __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row[0], x), _mm_mul_ps(row[1], y)), _mm_mul_ps(row[2], z));
+    if constexpr (hasTranslation)
+        result = _mm_add_ps(result, row[3]);
+    return result;
+}
+
+#endif
+
+// NOTE: T is Point3_t, Vector3_t or Normal3_t, they're all 3 fp_t without padding.
+template<bool hasTranslation, typename T>
+void TransformArray(const Affine3x4 &M, std::span<const T> in, std::span<T> out)
+{
+    static_assert(sizeof(T) == 3 * sizeof(fp_t));
+    PBR_ASSERT(in.size() == out.size())
+
+    ParallelFor(static_cast<i64>(in.size()), kBatchChunkSize, [&](i64 begin, i64 end) {
+        i64 i = begin;
+#if PBR_MATRIX4X4_SSE == 1
+        __m128 rows[3][4];
+        for (i32 r = 0; r < 3; ++r)
+            for (i32 c = 0; c < 4; ++c)
+                rows[r][c] = _mm_set1_ps(M.m[r][c]);
+        for (; i + 4 <= end; i += 4) {
+            __m128 x, y, z;
+            LoadSoA(&in[i].x, x, y, z);
+            StoreSoA(&out[i].x, Row<hasTranslation>(rows[0], x, y, z),
+                                Row<hasTranslation>(rows[1], x, y, z),
+                                Row<hasTranslation>(rows[2], x, y, z));
+        }
+#endif
+        for (; i < end; ++i) {
+            const T v = in[i];
+            fp_t xyz[3];
+            for (i32 r = 0; r < 3; ++r) {
+                xyz[r] = M.m[r][0] * v.x + M.m[r][1] * v.y + M.m[r][2] * v.z;
+                if constexpr (hasTranslation)
+                    xyz[r] += M.m[r][3];
+            }
+            out[i] = T(xyz[0], xyz[1], xyz[2]);
+        }
+    });
+}
+
+// Copy, unless it's done in place.
+template<typename T>
+void CopyArray(std::span<const T> in, std::span<T> out)
+{
+    PBR_ASSERT(in.size() == out.size())
+    if (in.data() != out.data())
+        std::copy(in.begin(), in.end(), out.begin());
+}
+
+} // namespace
+
+
+// ---------------------------------------
+// ------- BATCHED TRANSFORMS ------------
+// ---------------------------------------
+
+// NOTE: Scalar paths of Translation and ScaleTranslation skip the zero terms of the matrix, for finite coordinates
+//       adding them changes nothing, so every affine type goes through the same kernel.
+void Transform::operator()(std::span<const Point3_t> points, std::span<Point3_t> out_points) const
+{
+    if (type == TransformType::Identity)
+        return CopyArray(points, out_points);
+
+    if (IsAffine() == false) {
+        ParallelFor(static_cast<i64>(points.size()), kBatchChunkSize, [&](i64 begin, i64 end) {
+            for (i64 i = begin; i < end; ++i)
+                out_points[i] = (*this)(points[i]);
+        });
+        return;
+    }
+
+    const Affine3x4 M{ { { m[0][0], m[0][1], m[0][2], m[0][3] },
+                         { m[1][0], m[1][1], m[1][2], m[1][3] },
+                         { m[2][0], m[2][1], m[2][2], m[2][3] } } };
+    TransformArray<true>(M, points, out_points);
+}
+
+void Transform::operator()(std::span<const Vector3_t> vectors, std::span<Vector3_t> out_vectors) const
+{
+    if (type == TransformType::Identity || type == TransformType::Translation)
+        return CopyArray(vectors, out_vectors);
+
+    const Affine3x4 M{ { { m[0][0], m[0][1], m[0][2], 0 },
+                         { m[1][0], m[1][1], m[1][2], 0 },
+                         { m[2][0], m[2][1], m[2][2], 0 } } };
+    TransformArray<false>(M, vectors, out_vectors);
+}
+
+// Inverse transpose, or the matrix itself for Rigid, as in operator()(Normal3).
+void Transform::operator()(std::span<const Normal3_t> normals, std::span<Normal3_t> out_normals) const
+{
+    if (type == TransformType::Identity || type == TransformType::Translation)
+        return CopyArray(normals, out_normals);
+
+    const Matrix4x4 &N = type == TransformType::Rigid ? m : mInv;
+    const bool transposed = type != TransformType::Rigid;
+    Affine3x4 M{};
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 3; ++j)
+            M.m[i][j] = transposed ? N[j][i] : N[i][j];
+    TransformArray<false>(M, normals, out_normals);
+}
+
+// Same as operator()(Bounds3) for every box. Affine boxes are transformed center and extent by |M| (Arvo's method),
+//   Translation and ScaleTranslation boxes are their transformed corners.
+void Transform::operator()(std::span<const Bounds3_t> bounds, std::span<Bounds3_t> out_bounds) const
+{
+    PBR_ASSERT(bounds.size() == out_bounds.size())
+    if (type == TransformType::Identity)
+        return CopyArray(bounds, out_bounds);
+
+    ParallelFor(static_cast<i64>(bounds.size()), kBatchChunkSize, [&](i64 begin, i64 end) {
+        i64 i = begin;
+#if PBR_MATRIX4X4_SSE == 1
+        if (IsAffine()) {
+            const bool corners = type == TransformType::Translation || type == TransformType::ScaleTranslation;
+            __m128 rows[3][4], absRows[3][4];
+            for (i32 r = 0; r < 3; ++r)
+                for (i32 c = 0; c < 4; ++c) {
+                    rows[r][c] = _mm_set1_ps(m[r][c]);
+                    absRows[r][c] = _mm_set1_ps(std::abs(m[r][c]));
+                }
+            const __m128 half = _mm_set1_ps(0.5f), gamma = _mm_set1_ps(pbr::Gamma(3));
+            const __m128 signMask = _mm_set1_ps(-0.f);
+            for (; i + 4 <= end; i += 4) {
+                // 4 boxes are 8 points, min and max alternate
+                __m128 x0, y0, z0, x1, y1, z1;
+                LoadSoA(&bounds[i].pMin.x, x0, y0, z0);
+                LoadSoA(&bounds[i + 2].pMin.x, x1, y1, z1);
+                const __m128 minX = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0)), maxX = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+                const __m128 minY = _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(2, 0, 2, 0)), maxY = _mm_shuffle_ps(y0, y1, _MM_SHUFFLE(3, 1, 3, 1));
+                const __m128 minZ = _mm_shuffle_ps(z0, z1, _MM_SHUFFLE(2, 0, 2, 0)), maxZ = _mm_shuffle_ps(z0, z1, _MM_SHUFFLE(3, 1, 3, 1));
+
+                __m128 lo[3], hi[3];
+                if (corners) {
+                    for (i32 r = 0; r < 3; ++r) {
+                        const __m128 a = Row<true>(rows[r], minX, minY, minZ), b = Row<true>(rows[r], maxX, maxY, maxZ);
+                        lo[r] = _mm_min_ps(a, b);
+                        hi[r] = _mm_max_ps(a, b);
+                    }
+                }
+                else {
+                    const __m128 cX = _mm_mul_ps(_mm_add_ps(minX, maxX), half), hX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+                    const __m128 cY = _mm_mul_ps(_mm_add_ps(minY, maxY), half), hY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+                    const __m128 cZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), hZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+                    for (i32 r = 0; r < 3; ++r) {
+                        const __m128 c = Row<true>(rows[r], cX, cY, cZ);
+                        const __m128 e = Row<false>(absRows[r], hX, hY, hZ);
+                        const __m128 radius = _mm_add_ps(e, _mm_mul_ps(gamma, _mm_add_ps(_mm_andnot_ps(signMask, c), e)));
+                        lo[r] = _mm_sub_ps(c, radius);
+                        hi[r] = _mm_add_ps(c, radius);
+                    }
+                }
+
+                StoreSoA(&out_bounds[i].pMin.x, _mm_unpacklo_ps(lo[0], hi[0]), _mm_unpacklo_ps(lo[1], hi[1]), _mm_unpacklo_ps(lo[2], hi[2]));
+                StoreSoA(&out_bounds[i + 2].pMin.x, _mm_unpackhi_ps(lo[0], hi[0]), _mm_unpackhi_ps(lo[1], hi[1]), _mm_unpackhi_ps(lo[2], hi[2]));
+            }
+        }
+#endif
+        for (; i < end; ++i)
+            out_bounds[i] = (*this)(bounds[i]);
+    });
+}
+
+PBR_NAMESPACE_END
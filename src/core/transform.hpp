@@ -6,9 +6,19 @@
 #include "geometry.hpp"
 #include "interaction.hpp" // NOTE: There is foockin circluar dependency, that's why I need to split implementation.
 
+#include <span>
+#include <type_traits>
+
 #define PBR_CNSTEXPR constexpr
 #define PBR_INLINE inline
 
+// Matrix4x4 functions use SSE, and AVX if it's enabled, for f32 only, f64 ones are scalar.
+#if PBR_ENABLE_SIMD_GEOMETRY == 1 && PBR_FP_T_F64 == 0
+    #define PBR_MATRIX4X4_SSE 1
+#else
+    #define PBR_MATRIX4X4_SSE 0
+#endif
+
 
 PBR_NAMESPACE_BEGIN
 
@@ -38,7 +48,7 @@ struct Matrix4x4
 
 // NOTE: I don't think there is a point of doing that, for an object of such a size.
 //       Although as I found out there is like 16 simd registers.
-using Matrix4x4_arg = Matrix4x4&;
+using Matrix4x4_arg = const Matrix4x4&;
 
 
 // ---------------------------------------
@@ -95,6 +105,140 @@ const fp_t* Matrix4x4::operator[](const i32 i) const
 }
 
 
+// ---------------------------------------
+// ------------- SSE HELPERS -------------
+// ---------------------------------------
+
+#if PBR_MATRIX4X4_SSE == 1
+
+namespace detail {
+
+// Lanes (x, y, z, w) of the result are lanes x, y of a and z, w of b, in the order of the arguments, unlike _MM_SHUFFLE.
+template<i32 x, i32 y, i32 z, i32 w> PBR_INLINE
+__m128 Shuffle(__m128 a, __m128 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+
+template<i32 x, i32 y, i32 z, i32 w> PBR_INLINE
+__m128 Swizzle(__m128 a) { return Shuffle<x, y, z, w>(a, a); }
+
+PBR_INLINE
+__m128 IdentityRow(i32 i)
+{
+    alignas(16) static constexpr f32 identity[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+    return _mm_load_ps(identity[i]);
+}
+
+PBR_INLINE
+void LoadRows(const Matrix4x4_arg m, __m128 out_rows[4])
+{
+    for (i32 i = 0; i < 4; ++i)
+        out_rows[i] = _mm_loadu_ps(m[i]);
+}
+
+PBR_INLINE
+void StoreRows(const __m128 rows[4], Matrix4x4 &out_m)
+{
+    for (i32 i = 0; i < 4; ++i)
+        _mm_storeu_ps(out_m[i], rows[i]);
+}
+
+// Row i of the product is the sum of the rows of b scaled by the elements of row i of a.
+PBR_INLINE
+void Mul(const __m128 a[4], const __m128 b[4], __m128 out_rows[4])
+{
+    for (i32 i = 0; i < 4; ++i) {
+        __m128 row = _mm_mul_ps(Swizzle<0, 0, 0, 0>(a[i]), b[0]);
+        row = _mm_add_ps(row, _mm_mul_ps(Swizzle<1, 1, 1, 1>(a[i]), b[1]));
+        row = _mm_add_ps(row, _mm_mul_ps(Swizzle<2, 2, 2, 2>(a[i]), b[2]));
+        row = _mm_add_ps(row, _mm_mul_ps(Swizzle<3, 3, 3, 3>(a[i]), b[3]));
+        out_rows[i] = row;
+    }
+}
+
+PBR_INLINE
+void InverseAffine(const __m128 rows[4], __m128 out_rows[4])
+{
+    const __m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const Vector3A<f32> a0(_mm_and_ps(rows[0], xyz)), a1(_mm_and_ps(rows[1], xyz)), a2(_mm_and_ps(rows[2], xyz));
+    // Columns of A^-1, their 4th lanes are 0
+    const f32x4 invDet(1.f / Dot(a0, Cross(a1, a2)));
+    const __m128 c0 = (Cross(a1, a2).v * invDet).v, c1 = (Cross(a2, a0).v * invDet).v, c2 = (Cross(a0, a1).v * invDet).v;
+    // -A^-1 * t, 4th lane is -0 + 1
+    __m128 t = _mm_mul_ps(c0, Swizzle<3, 3, 3, 3>(rows[0]));
+    t = _mm_add_ps(t, _mm_mul_ps(c1, Swizzle<3, 3, 3, 3>(rows[1])));
+    t = _mm_add_ps(t, _mm_mul_ps(c2, Swizzle<3, 3, 3, 3>(rows[2])));
+    t = _mm_add_ps(_mm_sub_ps(_mm_setzero_ps(), t), IdentityRow(3));
+
+    out_rows[0] = c0;
+    out_rows[1] = c1;
+    out_rows[2] = c2;
+    out_rows[3] = t;
+    _MM_TRANSPOSE4_PS(out_rows[0], out_rows[1], out_rows[2], out_rows[3]);
+}
+
+// 2x2 matrices are stored row major in one register, A * B, adj(A) * B and A * adj(B)
+PBR_INLINE
+__m128 Mul2x2(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+}
+
+PBR_INLINE
+__m128 AdjMul2x2(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+}
+
+PBR_INLINE
+__m128 MulAdj2x2(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+}
+
+// Inverse of the block matrix M = | A B |, it's 1/|M| * | X Y |, where X, Y, Z and W are adjugates of
+//                                 | C D |               | Z W |
+//   |D| * A - B * adj(D) * C and the like. See "Fast 4x4 matrix inverse with SSE SIMD, explained" by Eric Zhang.
+PBR_INLINE
+void InverseBlocks(const __m128 rows[4], __m128 out_rows[4])
+{
+    const __m128 A = _mm_movelh_ps(rows[0], rows[1]), B = _mm_movehl_ps(rows[1], rows[0]);
+    const __m128 C = _mm_movelh_ps(rows[2], rows[3]), D = _mm_movehl_ps(rows[3], rows[2]);
+
+    // Determinants of the blocks (|A|, |B|, |C|, |D|)
+    const __m128 detBlocks = _mm_sub_ps(_mm_mul_ps(Shuffle<0, 2, 0, 2>(rows[0], rows[2]), Shuffle<1, 3, 1, 3>(rows[1], rows[3])),
+                                        _mm_mul_ps(Shuffle<1, 3, 1, 3>(rows[0], rows[2]), Shuffle<0, 2, 0, 2>(rows[1], rows[3])));
+    const __m128 detA = Swizzle<0, 0, 0, 0>(detBlocks), detB = Swizzle<1, 1, 1, 1>(detBlocks);
+    const __m128 detC = Swizzle<2, 2, 2, 2>(detBlocks), detD = Swizzle<3, 3, 3, 3>(detBlocks);
+
+    const __m128 adjDC = AdjMul2x2(D, C), adjAB = AdjMul2x2(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mul2x2(B, adjDC));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mul2x2(C, adjAB));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), MulAdj2x2(D, adjAB));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), MulAdj2x2(A, adjDC));
+
+    // |M| = |A| * |D| + |B| * |C| - tr(adj(A) * B * adj(D) * C)
+    __m128 trace = _mm_mul_ps(adjAB, Swizzle<0, 2, 1, 3>(adjDC));
+    trace = _mm_add_ps(trace, Swizzle<2, 3, 0, 1>(trace));
+    trace = _mm_add_ps(trace, Swizzle<1, 0, 3, 2>(trace));
+    const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    // Signs of the adjugates are applied with the determinant, their transpositions with the stores
+    const __m128 invDetM = _mm_div_ps(_mm_setr_ps(1, -1, -1, 1), detM);
+    X = _mm_mul_ps(X, invDetM);
+    Y = _mm_mul_ps(Y, invDetM);
+    Z = _mm_mul_ps(Z, invDetM);
+    W = _mm_mul_ps(W, invDetM);
+
+    out_rows[0] = Shuffle<3, 1, 3, 1>(X, Y);
+    out_rows[1] = Shuffle<2, 0, 2, 0>(X, Y);
+    out_rows[2] = Shuffle<3, 1, 3, 1>(Z, W);
+    out_rows[3] = Shuffle<2, 0, 2, 0>(Z, W);
+}
+
+} // namespace detail
+
+#endif
+
+
 // ---------------------------------------
 // ---------- UTILITY FUNCTIONS ----------
 // ---------------------------------------
@@ -102,16 +246,53 @@ const fp_t* Matrix4x4::operator[](const i32 i) const
 PBR_CNSTEXPR PBR_INLINE
 Matrix4x4 Transpose(const Matrix4x4_arg m)
 {
+#if PBR_MATRIX4X4_SSE == 1
+    if (!std::is_constant_evaluated()) {
+        __m128 rows[4];
+        detail::LoadRows(m, rows);
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        Matrix4x4 result;
+        detail::StoreRows(rows, result);
+        return result;
+    }
+#endif
     return Matrix4x4(m[0][0], m[1][0], m[2][0], m[3][0],
                      m[0][1], m[1][1], m[2][1], m[3][1],
                      m[0][2], m[1][2], m[2][2], m[3][2],
                      m[0][3], m[1][3], m[2][3], m[3][3]);
 }
 
-// TODO: loop unroll ?
+// NOTE: SIMD variants sum the products in the same order as the loop, results are the same.
 PBR_CNSTEXPR PBR_INLINE
 Matrix4x4 Mul(const Matrix4x4_arg m1, const Matrix4x4_arg m2)
 {
+#if PBR_MATRIX4X4_SSE == 1
+    if (!std::is_constant_evaluated()) {
+        Matrix4x4 result;
+    #if PBR_ENABLE_AVX == 1
+        // Two rows of the result at once, rows of m2 are broadcast to both halves.
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m2[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m2[1]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m2[2]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(m2[3]));
+        for (i32 i = 0; i < 4; i += 2) {
+            const __m256 a = _mm256_loadu_ps(m1[i]);
+            __m256 row = _mm256_mul_ps(_mm256_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+            row = _mm256_add_ps(row, _mm256_mul_ps(_mm256_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+            row = _mm256_add_ps(row, _mm256_mul_ps(_mm256_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+            row = _mm256_add_ps(row, _mm256_mul_ps(_mm256_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+            _mm256_storeu_ps(result[i], row);
+        }
+    #else
+        __m128 a[4], b[4], rows[4];
+        detail::LoadRows(m1, a);
+        detail::LoadRows(m2, b);
+        detail::Mul(a, b, rows);
+        detail::StoreRows(rows, result);
+    #endif
+        return result;
+    }
+#endif
     // creates identity matrix so we need to reset the diagonal
     Matrix4x4 result;
     result[0][0] = result[1][1] = result[2][2]= result[3][3] = static_cast<fp_t>(0);
@@ -124,12 +305,53 @@ Matrix4x4 Mul(const Matrix4x4_arg m1, const Matrix4x4_arg m2)
     return result;
 }
 
-// TODO: Definitely needs to be revisited, as I understand it's not numerically stable
-// taken from https://stackoverflow.com/questions/1148309/inverting-a-4x4-matrix
-// may be take a look at https://stackoverflow.com/a/29686652
+// Affine matrices, the last row is (0, 0, 0, 1), are inverted as [A^-1, -A^-1 * t], columns of A^-1 are cross
+//   products of the rows of A divided by its determinant. Transforms of the scene are mostly affine.
+// Other matrices are inverted by cofactor expansion, or with SSE, by 2x2 blocks, either is followed by one step
+//   of iterative refinement X + X * (I - M * X), which fixes most of the cancellation error of the adjugate.
+// NOTE: Singular matrices give infinities and NaNs, as before, there is no error to return from a constructor.
 PBR_CNSTEXPR
-Matrix4x4 Inverse(const Matrix4x4_arg m) 
+Matrix4x4 Inverse(const Matrix4x4_arg m)
 {
+    const bool isAffine = m[3][0] == 0 && m[3][1] == 0 && m[3][2] == 0 && m[3][3] == 1;
+
+#if PBR_MATRIX4X4_SSE == 1
+    if (!std::is_constant_evaluated()) {
+        __m128 rows[4], inverse[4];
+        detail::LoadRows(m, rows);
+        if (isAffine)
+            detail::InverseAffine(rows, inverse);
+        else {
+            __m128 residual[4], correction[4];
+            detail::InverseBlocks(rows, inverse);
+            detail::Mul(rows, inverse, residual);
+            for (i32 i = 0; i < 4; ++i)
+                residual[i] = _mm_sub_ps(detail::IdentityRow(i), residual[i]);
+            detail::Mul(inverse, residual, correction);
+            for (i32 i = 0; i < 4; ++i)
+                inverse[i] = _mm_add_ps(inverse[i], correction[i]);
+        }
+        Matrix4x4 result;
+        detail::StoreRows(inverse, result);
+        return result;
+    }
+#endif
+
+    if (isAffine) {
+        Vector3_t a0(m[0][0], m[0][1], m[0][2]), a1(m[1][0], m[1][1], m[1][2]), a2(m[2][0], m[2][1], m[2][2]);
+        Vector3_t c0 = Cross(a1, a2), c1 = Cross(a2, a0), c2 = Cross(a0, a1);
+        const fp_t invDet = fp_t(1) / Dot(a0, c0);
+        c0 *= invDet;
+        c1 *= invDet;
+        c2 *= invDet;
+        const Vector3_t t = -(c0 * m[0][3] + c1 * m[1][3] + c2 * m[2][3]);
+        return Matrix4x4(c0.x, c1.x, c2.x, t.x,
+                         c0.y, c1.y, c2.y, t.y,
+                         c0.z, c1.z, c2.z, t.z,
+                         0,    0,    0,    1);
+    }
+
+    // Cofactor expansion, taken from https://stackoverflow.com/questions/1148309/inverting-a-4x4-matrix
     fp_t A2323 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
     fp_t A1323 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
     fp_t A1223 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
@@ -155,106 +377,231 @@ Matrix4x4 Inverse(const Matrix4x4_arg m)
              - m[0][3] * ( m[1][0] * A1223 - m[1][1] * A0223 + m[1][2] * A0123 );
     det = 1 / det;
 
-    return Matrix4x4(det *   ( m[1][1] * A2323 - m[1][2] * A1323 + m[1][3] * A1223 ),
-                     det * - ( m[0][1] * A2323 - m[0][2] * A1323 + m[0][3] * A1223 ),
-                     det *   ( m[0][1] * A2313 - m[0][2] * A1313 + m[0][3] * A1213 ),
-                     det * - ( m[0][1] * A2312 - m[0][2] * A1312 + m[0][3] * A1212 ),
-                     det * - ( m[1][0] * A2323 - m[1][2] * A0323 + m[1][3] * A0223 ),
-                     det *   ( m[0][0] * A2323 - m[0][2] * A0323 + m[0][3] * A0223 ),
-                     det * - ( m[0][0] * A2313 - m[0][2] * A0313 + m[0][3] * A0213 ),
-                     det *   ( m[0][0] * A2312 - m[0][2] * A0312 + m[0][3] * A0212 ),
-                     det *   ( m[1][0] * A1323 - m[1][1] * A0323 + m[1][3] * A0123 ),
-                     det * - ( m[0][0] * A1323 - m[0][1] * A0323 + m[0][3] * A0123 ),
-                     det *   ( m[0][0] * A1313 - m[0][1] * A0313 + m[0][3] * A0113 ),
-                     det * - ( m[0][0] * A1312 - m[0][1] * A0312 + m[0][3] * A0112 ),
-                     det * - ( m[1][0] * A1223 - m[1][1] * A0223 + m[1][2] * A0123 ),
-                     det *   ( m[0][0] * A1223 - m[0][1] * A0223 + m[0][2] * A0123 ),
-                     det * - ( m[0][0] * A1213 - m[0][1] * A0213 + m[0][2] * A0113 ),
-                     det *   ( m[0][0] * A1212 - m[0][1] * A0212 + m[0][2] * A0112 ));
+    Matrix4x4 inverse(det *   ( m[1][1] * A2323 - m[1][2] * A1323 + m[1][3] * A1223 ),
+                      det * - ( m[0][1] * A2323 - m[0][2] * A1323 + m[0][3] * A1223 ),
+                      det *   ( m[0][1] * A2313 - m[0][2] * A1313 + m[0][3] * A1213 ),
+                      det * - ( m[0][1] * A2312 - m[0][2] * A1312 + m[0][3] * A1212 ),
+                      det * - ( m[1][0] * A2323 - m[1][2] * A0323 + m[1][3] * A0223 ),
+                      det *   ( m[0][0] * A2323 - m[0][2] * A0323 + m[0][3] * A0223 ),
+                      det * - ( m[0][0] * A2313 - m[0][2] * A0313 + m[0][3] * A0213 ),
+                      det *   ( m[0][0] * A2312 - m[0][2] * A0312 + m[0][3] * A0212 ),
+                      det *   ( m[1][0] * A1323 - m[1][1] * A0323 + m[1][3] * A0123 ),
+                      det * - ( m[0][0] * A1323 - m[0][1] * A0323 + m[0][3] * A0123 ),
+                      det *   ( m[0][0] * A1313 - m[0][1] * A0313 + m[0][3] * A0113 ),
+                      det * - ( m[0][0] * A1312 - m[0][1] * A0312 + m[0][3] * A0112 ),
+                      det * - ( m[1][0] * A1223 - m[1][1] * A0223 + m[1][2] * A0123 ),
+                      det *   ( m[0][0] * A1223 - m[0][1] * A0223 + m[0][2] * A0123 ),
+                      det * - ( m[0][0] * A1213 - m[0][1] * A0213 + m[0][2] * A0113 ),
+                      det *   ( m[0][0] * A1212 - m[0][1] * A0212 + m[0][2] * A0112 ));
+
+    Matrix4x4 residual = Mul(m, inverse);
+    for (i32 i = 0; i < 4; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            residual[i][j] = (i == j ? fp_t(1) : fp_t(0)) - residual[i][j];
+    const Matrix4x4 correction = Mul(inverse, residual);
+    for (i32 i = 0; i < 4; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            inverse[i][j] += correction[i][j];
+    return inverse;
 }
 
 #pragma endregion Matrix4x4
 
 
 // ******************************************************************************
-// --------------------------------- Transform ----------------------------------
+// --------------------------------- Matrix3x4 ----------------------------------
 // ******************************************************************************
 
-#pragma region Transform
+#pragma region Matrix3x4
 
-// TODO: AnimatedTransform and Quaternion not implemented
-// TODO: Comparison operator and IsDentity method not implemented
-// TODO: I don't understand HasScale() method, so I won't implement it for now
-// TODO: I think Transformations should be more like in GLM, so matrices can be reused,
-//       without creating new matrix for every operation
-struct Transform
+// Matrix3x4, row major, affine matrix without its (0, 0, 0, 1) bottom row, see AffineTransform.
+struct Matrix3x4
 {
-    // NOTE: there is an empty constructor in the original implementation
-    PBR_CNSTEXPR explicit Transform(const fp_t matrix[4][4]);
-    PBR_CNSTEXPR explicit Transform(const Matrix4x4_arg matrix);
-    PBR_CNSTEXPR explicit Transform(const Matrix4x4_arg matrix, const Matrix4x4_arg inverse);
+    // Creates Identity matrix
+    PBR_CNSTEXPR Matrix3x4();
+    PBR_CNSTEXPR explicit Matrix3x4(fp_t t00, fp_t t01, fp_t t02, fp_t t03,
+                                    fp_t t10, fp_t t11, fp_t t12, fp_t t13,
+                                    fp_t t20, fp_t t21, fp_t t22, fp_t t23);
+    // Bottom row of the matrix has to be (0, 0, 0, 1).
+    PBR_CNSTEXPR explicit Matrix3x4(const Matrix4x4_arg matrix);
 
-    PBR_CNSTEXPR bool SwapsHandedness() const;
+    PBR_CNSTEXPR explicit operator Matrix4x4() const;
 
-    // FINDOUT: operator() is templated in the original for some reason that needs to be figured out. And they all marked as inline.
-    // TODO: There is a bunch of Transform() methods that not mentioned in the book, which takes additional arguments for error correctness.
-    //       Therefore i should remove this error correctness from simple implementation of this methods. If possible.
-    PBR_CNSTEXPR PBR_INLINE Point3_t operator()(const Point3_arg<fp_t> p) const;
-    PBR_CNSTEXPR PBR_INLINE Point3_t operator()(const Point3_arg<fp_t> p, Vector3_t &out_pError) const;
-    // TODO: Point3_t operator()(const Point3_arg<fp_t> p, const Vector3_arg<fp_t> pError, Vector3_t &out_absError)
-    PBR_CNSTEXPR PBR_INLINE Vector3_t operator()(const Vector3_arg<fp_t> v) const;
-    // FINDOUT: Why arguments are different for Point3 and Vector3 transformations ?
-    // TODO: Vector3_t operator()(const Vector3_arg<fp_t> v, Vector3_t &out_absError)
-    //       Vector3_t operator()(const Vector3_arg<fp_t> v, const Vector3_arg<fp_t> vError, Vector3_t &out_absError)
-    PBR_CNSTEXPR PBR_INLINE Normal3_t operator()(const Normal3_arg<fp_t> n) const;
-    PBR_CNSTEXPR PBR_INLINE Ray operator()(const Ray_arg r) const;
-    PBR_CNSTEXPR PBR_INLINE Ray operator()(const Ray_arg r, Vector3_t &out_oError, Vector3_t &out_dError) const;
-    // TODO: There is one more Ray transform function in the book.
-    //PBR_CNSTEXPR PBR_INLINE RayDifferential operator()(const RayDifferential_arg r) const;
-    //PBR_CNSTEXPR PBR_INLINE Bounds3_t operator()(const Bounds3_arg<fp_t> b) const;
-    PBR_CNSTEXPR PBR_INLINE SurfaceInteraction operator()(const SurfaceInteraction &si) const;
+    PBR_CNSTEXPR PBR_INLINE fp_t* operator[](const i32 i);
+    PBR_CNSTEXPR PBR_INLINE const fp_t* operator[](const i32 i) const;
 
-// NOTE: marked as private in the original implementation
-    Matrix4x4 m;
-    Matrix4x4 mInv;
+
+    fp_t m[3][4];
 };
 
+using Matrix3x4_arg = const Matrix3x4&;
+
 
 // ---------------------------------------
 // ------------ CONSTRUCTORS -------------
 // ---------------------------------------
 
 PBR_CNSTEXPR
-Transform::Transform(const fp_t matrix[4][4])
-    : m(matrix)
-    , mInv(Inverse(m))
+Matrix3x4::Matrix3x4()
+    : m { static_cast<fp_t>(1), static_cast<fp_t>(0), static_cast<fp_t>(0), static_cast<fp_t>(0),
+          static_cast<fp_t>(0), static_cast<fp_t>(1), static_cast<fp_t>(0), static_cast<fp_t>(0),
+          static_cast<fp_t>(0), static_cast<fp_t>(0), static_cast<fp_t>(1), static_cast<fp_t>(0) }
 {}
 
 PBR_CNSTEXPR
-Transform::Transform(const Matrix4x4_arg matrix)
-    : m(matrix)
-    , mInv(Inverse(m))
+Matrix3x4::Matrix3x4(fp_t t00, fp_t t01, fp_t t02, fp_t t03,
+                     fp_t t10, fp_t t11, fp_t t12, fp_t t13,
+                     fp_t t20, fp_t t21, fp_t t22, fp_t t23)
+    : m { t00, t01, t02, t03,
+          t10, t11, t12, t13,
+          t20, t21, t22, t23 }
 {}
 
 PBR_CNSTEXPR
-Transform::Transform(const Matrix4x4_arg matrix, const Matrix4x4_arg inverse)
-    : m(matrix)
-    , mInv(inverse)
-{}
+Matrix3x4::Matrix3x4(const Matrix4x4_arg matrix)
+    : m { matrix[0][0], matrix[0][1], matrix[0][2], matrix[0][3],
+          matrix[1][0], matrix[1][1], matrix[1][2], matrix[1][3],
+          matrix[2][0], matrix[2][1], matrix[2][2], matrix[2][3] }
+{
+    PBR_ASSERT(matrix[3][0] == 0 && matrix[3][1] == 0 && matrix[3][2] == 0 && matrix[3][3] == 1)
+}
 
 
 // ---------------------------------------
-// ----- BINARY ARITHMETIC OPERATORS -----
+// ------------ CONVERSIONS --------------
 // ---------------------------------------
 
-// TODO: Why overload operator* for transform and not for Mtrix4x4
 PBR_CNSTEXPR
-Transform operator*(const Transform &t1, const Transform &t2)
+Matrix3x4::operator Matrix4x4() const
 {
-    return Transform(Mul(t1.m, t2.m),
-                     Mul(t2.mInv, t1.mInv));
+    return Matrix4x4(m[0][0], m[0][1], m[0][2], m[0][3],
+                     m[1][0], m[1][1], m[1][2], m[1][3],
+                     m[2][0], m[2][1], m[2][2], m[2][3],
+                     0,       0,       0,       1);
+}
+
+
+// ---------------------------------------
+// ----------- ACCESS OPERATOR ------------
+// ---------------------------------------
+
+PBR_CNSTEXPR PBR_INLINE
+fp_t* Matrix3x4::operator[](const i32 i)
+{
+    PBR_ASSERT(i >= 0 && i <= 2)
+    return this->m[i];
 }
 
+PBR_CNSTEXPR PBR_INLINE
+const fp_t* Matrix3x4::operator[](const i32 i) const
+{
+    PBR_ASSERT(i >= 0 && i <= 2)
+    return this->m[i];
+}
+
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+// NOTE: Bottom rows are implicit, so only the translation column gets the extra term.
+PBR_CNSTEXPR PBR_INLINE
+Matrix3x4 Mul(const Matrix3x4_arg m1, const Matrix3x4_arg m2)
+{
+    Matrix3x4 result;
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            result[i][j] = m1[i][0] * m2[0][j] + m1[i][1] * m2[1][j] + m1[i][2] * m2[2][j] + (j == 3 ? m1[i][3] : fp_t(0));
+    return result;
+}
+
+// Same as the affine path of Inverse(Matrix4x4), see there.
+PBR_CNSTEXPR PBR_INLINE
+Matrix3x4 Inverse(const Matrix3x4_arg m)
+{
+    Matrix4x4 inverse = Inverse(static_cast<Matrix4x4>(m));
+    return Matrix3x4(inverse);
+}
+
+#pragma endregion Matrix3x4
+
+
+// ******************************************************************************
+// --------------------------------- Transform ----------------------------------
+// ******************************************************************************
+
+#pragma region Transform
+
+// Kind of the matrix, from the cheapest to apply to the most expensive.
+//   Every kind except General has (0, 0, 0, 1) bottom row, so w is never computed for them.
+enum class TransformType : ui8
+{
+    Identity,
+    // Only m[0..2][3] differ from identity.
+    Translation,
+    // Upper 3x3 is diagonal.
+    ScaleTranslation,
+    // Upper 3x3 is orthonormal, so normals can be transformed with m instead of mInv.
+    Rigid,
+    General
+};
+
+// Classifies the matrix, only Rigid check has tolerance, everything else is exact comparison.
+PBR_CNSTEXPR TransformType ClassifyTransform(const Matrix4x4_arg m);
+// Same for the affine matrix, General is general affine, never projective.
+PBR_CNSTEXPR TransformType ClassifyTransform(const Matrix3x4_arg m);
+
+
+// Matrix with its inverse and the operator() shared by Transform and AffineTransform, MatrixT is one of their matrices.
+//   Bodies are the same for both, w is computed only for Matrix4x4, Matrix3x4 is affine by construction.
+template<typename MatrixT>
+struct TransformBase
+{
+    static_assert(std::is_same_v<MatrixT, Matrix4x4> || std::is_same_v<MatrixT, Matrix3x4>);
+    static constexpr bool isAffineMatrix = std::is_same_v<MatrixT, Matrix3x4>;
+
+    PBR_CNSTEXPR bool SwapsHandedness() const;
+    PBR_CNSTEXPR bool IsIdentity() const { return type == TransformType::Identity; }
+    // Bottom row is (0, 0, 0, 1), so w is always 1. NOTE: General type can be affine too.
+    PBR_CNSTEXPR bool IsAffine() const
+    {
+        if constexpr (isAffineMatrix)
+            return true;
+        else
+            return type != TransformType::General || (m[3][0] == 0 && m[3][1] == 0 && m[3][2] == 0 && m[3][3] == 1);
+    }
+
+    // FINDOUT: operator() is templated in the original for some reason that needs to be figured out. And they all marked as inline.
+    // TODO: There is a bunch of Transform() methods that not mentioned in the book, which takes additional arguments for error correctness.
+    //       Therefore i should remove this error correctness from simple implementation of this methods. If possible.
+    PBR_CNSTEXPR PBR_INLINE Point3_t operator()(const Point3_arg<fp_t> p) const;
+    PBR_CNSTEXPR PBR_INLINE Point3_t operator()(const Point3_arg<fp_t> p, Vector3_t &out_pError) const;
+    // TODO: Point3_t operator()(const Point3_arg<fp_t> p, const Vector3_arg<fp_t> pError, Vector3_t &out_absError)
+    PBR_CNSTEXPR PBR_INLINE Vector3_t operator()(const Vector3_arg<fp_t> v) const;
+    // FINDOUT: Why arguments are different for Point3 and Vector3 transformations ?
+    PBR_CNSTEXPR PBR_INLINE Vector3_t operator()(const Vector3_arg<fp_t> v, Vector3_t &out_vError) const;
+    // TODO: Vector3_t operator()(const Vector3_arg<fp_t> v, const Vector3_arg<fp_t> vError, Vector3_t &out_absError)
+    PBR_CNSTEXPR PBR_INLINE Normal3_t operator()(const Normal3_arg<fp_t> n) const;
+    PBR_CNSTEXPR PBR_INLINE Ray operator()(const Ray_arg r) const;
+    PBR_CNSTEXPR PBR_INLINE Ray operator()(const Ray_arg r, Vector3_t &out_oError, Vector3_t &out_dError) const;
+    // TODO: There is one more Ray transform function in the book.
+    //PBR_CNSTEXPR PBR_INLINE RayDifferential operator()(const RayDifferential_arg r) const;
+    PBR_CNSTEXPR PBR_INLINE Bounds3_t operator()(const Bounds3_arg<fp_t> b) const;
+
+// NOTE: marked as private in the original implementation
+    MatrixT m;
+    MatrixT mInv;
+    // NOTE: It's computed from m in constructors, so m shouldn't be changed after that.
+    TransformType type;
+
+protected:
+    PBR_CNSTEXPR TransformBase(const MatrixT &matrix, const MatrixT &inverse, TransformType matrixType)
+        : m(matrix)
+        , mInv(inverse)
+        , type(matrixType)
+    {}
+};
+
 
 // ---------------------------------------
 // ------- FUNCTION CALL OPERATORS -------
@@ -262,68 +609,168 @@ Transform operator*(const Transform &t1, const Transform &t2)
 
 // NOTE: As stated int the book most of the time wp will be equal to 1,
 //       only the projective transformation will require division
-// FINDOUT: I think m[3] row will be zero every time and only m[3][3] will be non zero,
-//          so it can can be optimized
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Point3_t Transform::operator()(const Point3_arg<fp_t> p) const
+Point3_t TransformBase<MatrixT>::operator()(const Point3_arg<fp_t> p) const
 {
+    switch (type) {
+    case TransformType::Identity:
+        return p;
+    case TransformType::Translation:
+        return Point3_t(p.x + m[0][3], p.y + m[1][3], p.z + m[2][3]);
+    case TransformType::ScaleTranslation:
+        return Point3_t(m[0][0] * p.x + m[0][3], m[1][1] * p.y + m[1][3], m[2][2] * p.z + m[2][3]);
+    case TransformType::Rigid:
+        return Point3_t(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                        m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                        m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]);
+    default:
+        break;
+    }
+
     const fp_t xp = m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3];
     const fp_t yp = m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3];
     const fp_t zp = m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3];
-    const fp_t wp = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
-
-    PBR_ASSERT(wp != 0)
-    if (wp == 1)
+    if constexpr (isAffineMatrix)
         return Point3_t(xp, yp, zp);
-    else
-        // FINDOUT: Will be Point3_t(xp / wp, yp / wp, zp / wp); more effective ?
-        return Point3_t(xp, yp, zp) / wp;
+    else {
+        const fp_t wp = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+
+        PBR_ASSERT(wp != 0)
+        if (wp == 1)
+            return Point3_t(xp, yp, zp);
+        else
+            // FINDOUT: Will be Point3_t(xp / wp, yp / wp, zp / wp); more effective ?
+            return Point3_t(xp, yp, zp) / wp;
+    }
 }
 
+// NOTE: Error bounds of the simple types are tighter, because there are less operations, Gamma(n) for n roundings.
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Point3_t Transform::operator()(const Point3_arg<fp_t> p, Vector3_t &out_pError) const
+Point3_t TransformBase<MatrixT>::operator()(const Point3_arg<fp_t> p, Vector3_t &out_pError) const
 {
+    switch (type) {
+    case TransformType::Identity:
+        out_pError = Vector3_t(0, 0, 0);
+        return p;
+    case TransformType::Translation:
+        out_pError = pbr::Gamma(1) * Vector3_t(std::abs(p.x) + std::abs(m[0][3]),
+                                               std::abs(p.y) + std::abs(m[1][3]),
+                                               std::abs(p.z) + std::abs(m[2][3]));
+        return Point3_t(p.x + m[0][3], p.y + m[1][3], p.z + m[2][3]);
+    case TransformType::ScaleTranslation:
+        out_pError = pbr::Gamma(2) * Vector3_t(std::abs(m[0][0] * p.x) + std::abs(m[0][3]),
+                                               std::abs(m[1][1] * p.y) + std::abs(m[1][3]),
+                                               std::abs(m[2][2] * p.z) + std::abs(m[2][3]));
+        return Point3_t(m[0][0] * p.x + m[0][3], m[1][1] * p.y + m[1][3], m[2][2] * p.z + m[2][3]);
+    default:
+        break;
+    }
+
     // NOTE: I don't know if this additional parentheses will change anything
     //       https://github.com/mmp/pbrt-v3/issues/181
     const fp_t xp = (m[0][0] * p.x + m[0][1] * p.y) + (m[0][2] * p.z + m[0][3]);
     const fp_t yp = (m[1][0] * p.x + m[1][1] * p.y) + (m[1][2] * p.z + m[1][3]);
     const fp_t zp = (m[2][0] * p.x + m[2][1] * p.y) + (m[2][2] * p.z + m[2][3]);
-    const fp_t wp = (m[3][0] * p.x + m[3][1] * p.y) + (m[3][2] * p.z + m[3][3]);
 
     const fp_t xAbsSum = std::abs(m[0][0] * p.x) + std::abs(m[0][1] * p.y) + std::abs(m[0][2] * p.z) + std::abs(m[0][3]);
     const fp_t yAbsSum = std::abs(m[1][0] * p.x) + std::abs(m[1][1] * p.y) + std::abs(m[1][2] * p.z) + std::abs(m[1][3]);
     const fp_t zAbsSum = std::abs(m[2][0] * p.x) + std::abs(m[2][1] * p.y) + std::abs(m[2][2] * p.z) + std::abs(m[2][3]);
     out_pError = pbr::Gamma(3) * Vector3_t(xAbsSum, yAbsSum, zAbsSum);
 
-    PBR_ASSERT(wp != 0)
-    if (wp == 1)
+    if constexpr (isAffineMatrix)
         return Point3_t(xp, yp, zp);
-    else
-        // FINDOUT: Will be Point3_t(xp / wp, yp / wp, zp / wp); more effective ?
-        return Point3_t(xp, yp, zp) / wp;
+    else {
+        if (type == TransformType::Rigid)
+            return Point3_t(xp, yp, zp);
+
+        const fp_t wp = (m[3][0] * p.x + m[3][1] * p.y) + (m[3][2] * p.z + m[3][3]);
+        PBR_ASSERT(wp != 0)
+        if (wp == 1)
+            return Point3_t(xp, yp, zp);
+        else
+            // FINDOUT: Will be Point3_t(xp / wp, yp / wp, zp / wp); more effective ?
+            return Point3_t(xp, yp, zp) / wp;
+    }
 }
 
 
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Vector3_t Transform::operator()(const Vector3_arg<fp_t> v) const
+Vector3_t TransformBase<MatrixT>::operator()(const Vector3_arg<fp_t> v) const
 {
+    switch (type) {
+    case TransformType::Identity:
+    case TransformType::Translation:
+        return v;
+    case TransformType::ScaleTranslation:
+        return Vector3_t(m[0][0] * v.x, m[1][1] * v.y, m[2][2] * v.z);
+    default:
+        return Vector3_t(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                         m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                         m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+    }
+}
+
+template<typename MatrixT>
+PBR_CNSTEXPR PBR_INLINE
+Vector3_t TransformBase<MatrixT>::operator()(const Vector3_arg<fp_t> v, Vector3_t &out_vError) const
+{
+    switch (type) {
+    case TransformType::Identity:
+    case TransformType::Translation:
+        out_vError = Vector3_t(0, 0, 0);
+        return v;
+    case TransformType::ScaleTranslation: {
+        Vector3_t vt(m[0][0] * v.x, m[1][1] * v.y, m[2][2] * v.z);
+        out_vError = pbr::Gamma(1) * Abs(vt);
+        return vt;
+    }
+    default:
+        break;
+    }
+
+    const fp_t xAbsSum = std::abs(m[0][0] * v.x) + std::abs(m[0][1] * v.y) + std::abs(m[0][2] * v.z);
+    const fp_t yAbsSum = std::abs(m[1][0] * v.x) + std::abs(m[1][1] * v.y) + std::abs(m[1][2] * v.z);
+    const fp_t zAbsSum = std::abs(m[2][0] * v.x) + std::abs(m[2][1] * v.y) + std::abs(m[2][2] * v.z);
+    out_vError = pbr::Gamma(3) * Vector3_t(xAbsSum, yAbsSum, zAbsSum);
+
     return Vector3_t(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
                      m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
                      m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
 }
 
+// NOTE: Normals are transformed by inverse transpose, for Rigid it's the matrix itself.
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Normal3_t Transform::operator()(const Normal3_arg<fp_t> n) const
+Normal3_t TransformBase<MatrixT>::operator()(const Normal3_arg<fp_t> n) const
 {
-    return Normal3_t(mInv[0][0] * n.x + mInv[1][0] * n.y + mInv[2][0] * n.z,
-                     mInv[0][1] * n.x + mInv[1][1] * n.y + mInv[2][1] * n.z,
-                     mInv[0][2] * n.x + mInv[1][2] * n.y + mInv[2][2] * n.z);
+    switch (type) {
+    case TransformType::Identity:
+    case TransformType::Translation:
+        return n;
+    case TransformType::ScaleTranslation:
+        return Normal3_t(mInv[0][0] * n.x, mInv[1][1] * n.y, mInv[2][2] * n.z);
+    case TransformType::Rigid:
+        return Normal3_t(m[0][0] * n.x + m[0][1] * n.y + m[0][2] * n.z,
+                         m[1][0] * n.x + m[1][1] * n.y + m[1][2] * n.z,
+                         m[2][0] * n.x + m[2][1] * n.y + m[2][2] * n.z);
+    default:
+        return Normal3_t(mInv[0][0] * n.x + mInv[1][0] * n.y + mInv[2][0] * n.z,
+                         mInv[0][1] * n.x + mInv[1][1] * n.y + mInv[2][1] * n.z,
+                         mInv[0][2] * n.x + mInv[1][2] * n.y + mInv[2][2] * n.z);
+    }
 }
 
 // NOTE: Method with error correction, but probably there is no way without it, even with fp_t=double.
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Ray Transform::operator()(const Ray_arg r) const
+Ray TransformBase<MatrixT>::operator()(const Ray_arg r) const
 {
+    if (type == TransformType::Identity)
+        return r;
+
     Vector3_t oError;
     Point3_t origin = (*this)(r.origin, oError);
     Vector3_t direction = (*this)(r.direction);
@@ -341,9 +788,16 @@ Ray Transform::operator()(const Ray_arg r) const
 }
 
 // NOTE: Same problems as with basic Ray transform.
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-Ray Transform::operator()(const Ray_arg r, Vector3_t &out_oError, Vector3_t &out_dError) const
+Ray TransformBase<MatrixT>::operator()(const Ray_arg r, Vector3_t &out_oError, Vector3_t &out_dError) const
 {
+    if (type == TransformType::Identity) {
+        out_oError = Vector3_t(0, 0, 0);
+        out_dError = Vector3_t(0, 0, 0);
+        return r;
+    }
+
     Point3_t origin = (*this)(r.origin, out_oError);
     Vector3_t direction = (*this)(r.direction, out_dError);
     // Offset origin to edge of error bounds, to prevent self-intersection
@@ -361,33 +815,54 @@ Ray Transform::operator()(const Ray_arg r, Vector3_t &out_oError, Vector3_t &out
 
 // TODO: Implementation is shit in the book
 // PBR_CNSTEXPR PBR_INLINE
-// RayDifferential Transform::operator()(const RayDifferential_arg r) const
+// RayDifferential TransformBase<MatrixT>::operator()(const RayDifferential_arg r) const
 // {
 //     Ray tr = (*this)(r.)
 //     return ;
 // }
 
-// TODO: same as for Ray, and definitely should be optimized
-// PBR_CNSTEXPR PBR_INLINE
-// Bounds3_t Transform::operator()(const Bounds3_arg<fp_t> &b) const {
-//     const Transform &M = *this;
-//     Bounds3_t ret(M(Point3f(b.pMin.x, b.pMin.y, b.pMin.z)));
-//     ret = Union(ret, M(Point3f(b.pMax.x, b.pMin.y, b.pMin.z)));
-//     ret = Union(ret, M(Point3f(b.pMin.x, b.pMax.y, b.pMin.z)));
-//     ret = Union(ret, M(Point3f(b.pMin.x, b.pMin.y, b.pMax.z)));
-//     ret = Union(ret, M(Point3f(b.pMin.x, b.pMax.y, b.pMax.z)));
-//     ret = Union(ret, M(Point3f(b.pMax.x, b.pMax.y, b.pMin.z)));
-//     ret = Union(ret, M(Point3f(b.pMax.x, b.pMin.y, b.pMax.z)));
-//     ret = Union(ret, M(Point3f(b.pMax.x, b.pMax.y, b.pMax.z)));
-//     return ret;
-// }
-
+// DIFFERENCE: The book transforms all 8 corners. For the affine matrix it's the same box as the transformed center
+//             with half of the diagonal transformed by the absolute value of the matrix, so it's 1 point instead of 8.
+template<typename MatrixT>
 PBR_CNSTEXPR PBR_INLINE
-SurfaceInteraction Transform::operator()(const SurfaceInteraction &si) const
+Bounds3_t TransformBase<MatrixT>::operator()(const Bounds3_arg<fp_t> b) const
 {
-    const Transform &t = *this;
+    const TransformBase &M = *this;
+
+    switch (type) {
+    case TransformType::Identity:
+        return b;
+    case TransformType::Translation:
+    case TransformType::ScaleTranslation:
+        // Corners stay corners, Bounds3 constructor sorts them if scale is negative
+        return Bounds3_t(M(b.pMin), M(b.pMax));
+    default:
+        break;
+    }
 
-    // TODO:
+    if (IsAffine() == false) {
+        // Projective transformation, box isn't mapped to parallelepiped
+        Bounds3_t ret(M(Point3_t(b.pMin.x, b.pMin.y, b.pMin.z)));
+        ret = Union(ret, M(Point3_t(b.pMax.x, b.pMin.y, b.pMin.z)));
+        ret = Union(ret, M(Point3_t(b.pMin.x, b.pMax.y, b.pMin.z)));
+        ret = Union(ret, M(Point3_t(b.pMin.x, b.pMin.y, b.pMax.z)));
+        ret = Union(ret, M(Point3_t(b.pMin.x, b.pMax.y, b.pMax.z)));
+        ret = Union(ret, M(Point3_t(b.pMax.x, b.pMax.y, b.pMin.z)));
+        ret = Union(ret, M(Point3_t(b.pMax.x, b.pMin.y, b.pMax.z)));
+        ret = Union(ret, M(Point3_t(b.pMax.x, b.pMax.y, b.pMax.z)));
+        return ret;
+    }
+
+    const Point3_t center((b.pMin.x + b.pMax.x) / 2, (b.pMin.y + b.pMax.y) / 2, (b.pMin.z + b.pMax.z) / 2);
+    const Vector3_t halfDiagonal = b.Diagonal() / fp_t(2);
+    const Point3_t c = M(center);
+    const Vector3_t e(std::abs(m[0][0]) * halfDiagonal.x + std::abs(m[0][1]) * halfDiagonal.y + std::abs(m[0][2]) * halfDiagonal.z,
+                      std::abs(m[1][0]) * halfDiagonal.x + std::abs(m[1][1]) * halfDiagonal.y + std::abs(m[1][2]) * halfDiagonal.z,
+                      std::abs(m[2][0]) * halfDiagonal.x + std::abs(m[2][1]) * halfDiagonal.y + std::abs(m[2][2]) * halfDiagonal.z);
+    // NOTE: Rounding of center and extent is covered, so the box is never smaller than the one from 8 corners.
+    const Vector3_t r = e + pbr::Gamma(3) * Vector3_t(std::abs(c.x) + e.x, std::abs(c.y) + e.y, std::abs(c.z) + e.z);
+    return Bounds3_t(Point3_t(c.x - r.x, c.y - r.y, c.z - r.z),
+                     Point3_t(c.x + r.x, c.y + r.y, c.z + r.z));
 }
 
 
@@ -396,8 +871,9 @@ SurfaceInteraction Transform::operator()(const SurfaceInteraction &si) const
 // ---------------------------------------
 
 // NOTE: Method name is shit
+template<typename MatrixT>
 PBR_CNSTEXPR
-bool Transform::SwapsHandedness() const
+bool TransformBase<MatrixT>::SwapsHandedness() const
 {
     fp_t det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
                m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
@@ -406,10 +882,132 @@ bool Transform::SwapsHandedness() const
 }
 
 
+// NOTE: AnimatedTransform and Quaternion are in animatedtransform.h and quaternion.hpp
+// TODO: Comparison operator not implemented
+// TODO: I don't understand HasScale() method, so I won't implement it for now
+// TODO: I think Transformations should be more like in GLM, so matrices can be reused,
+//       without creating new matrix for every operation
+// DIFFERENCE: Matrix is classified on construction and operator() takes the shortest path for its type,
+//             most of the quadrics are only translated, and they transform every ray they test.
+struct Transform : TransformBase<Matrix4x4>
+{
+    // NOTE: there is an empty constructor in the original implementation
+    PBR_CNSTEXPR explicit Transform(const fp_t matrix[4][4]);
+    PBR_CNSTEXPR explicit Transform(const Matrix4x4_arg matrix);
+    PBR_CNSTEXPR explicit Transform(const Matrix4x4_arg matrix, const Matrix4x4_arg inverse);
+
+    using TransformBase::operator();
+    PBR_INLINE SurfaceInteraction operator()(const SurfaceInteraction &si) const;
+
+    // Batched transforms of whole arrays, the same results as of operator() for every element, see transform.cpp.
+    //   SIMD for f32, and large arrays are split between the threads. Array can be transformed in place,
+    //   otherwise input and output must not overlap.
+    void operator()(std::span<const Point3_t> points, std::span<Point3_t> out_points) const;
+    void operator()(std::span<const Vector3_t> vectors, std::span<Vector3_t> out_vectors) const;
+    void operator()(std::span<const Normal3_t> normals, std::span<Normal3_t> out_normals) const;
+    void operator()(std::span<const Bounds3_t> bounds, std::span<Bounds3_t> out_bounds) const;
+};
+
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+Transform::Transform(const fp_t matrix[4][4])
+    : Transform(Matrix4x4(matrix))
+{}
+
+PBR_CNSTEXPR
+Transform::Transform(const Matrix4x4_arg matrix)
+    : TransformBase(matrix, Inverse(matrix), ClassifyTransform(matrix))
+{}
+
+PBR_CNSTEXPR
+Transform::Transform(const Matrix4x4_arg matrix, const Matrix4x4_arg inverse)
+    : TransformBase(matrix, inverse, ClassifyTransform(matrix))
+{}
+
+
+// ---------------------------------------
+// ----- BINARY ARITHMETIC OPERATORS -----
+// ---------------------------------------
+
+// TODO: Why overload operator* for transform and not for Mtrix4x4
+PBR_CNSTEXPR
+Transform operator*(const Transform &t1, const Transform &t2)
+{
+    return Transform(Mul(t1.m, t2.m),
+                     Mul(t2.mInv, t1.mInv));
+}
+
+
+// ---------------------------------------
+// ------- FUNCTION CALL OPERATORS -------
+// ---------------------------------------
+
+// TODO: BSDF, BSSRDF and shading geometry derivatives (dpdx, dudx, ...) are not transformed yet.
+PBR_INLINE
+SurfaceInteraction Transform::operator()(const SurfaceInteraction &si) const
+{
+    const Transform &t = *this;
+
+    SurfaceInteraction ret(si);
+    ret.point = t(si.point, ret.pError);
+    ret.normal = Normalize(t(si.normal));
+    ret.wo = Normalize(t(si.wo));
+    ret.dpdu = t(si.dpdu);
+    ret.dpdv = t(si.dpdv);
+    ret.dndu = t(si.dndu);
+    ret.dndv = t(si.dndv);
+    ret.shading.normal = Normalize(t(si.shading.normal));
+    ret.shading.dpdu = t(si.shading.dpdu);
+    ret.shading.dpdv = t(si.shading.dpdv);
+    ret.shading.dndu = t(si.shading.dndu);
+    ret.shading.dndv = t(si.shading.dndv);
+
+    return ret;
+}
+
+
 // ---------------------------------------
 // ---------- UTILITY FUNCTIONS ----------
 // ---------------------------------------
 
+PBR_CNSTEXPR
+TransformType ClassifyTransform(const Matrix4x4_arg m)
+{
+    if (m[3][0] != 0 || m[3][1] != 0 || m[3][2] != 0 || m[3][3] != 1)
+        return TransformType::General;
+
+    Matrix3x4 affine(m);
+    return ClassifyTransform(affine);
+}
+
+PBR_CNSTEXPR
+TransformType ClassifyTransform(const Matrix3x4_arg m)
+{
+    if (m[0][1] == 0 && m[0][2] == 0 && m[1][0] == 0 && m[1][2] == 0 && m[2][0] == 0 && m[2][1] == 0) {
+        if (m[0][0] != 1 || m[1][1] != 1 || m[2][2] != 1)
+            return TransformType::ScaleTranslation;
+        if (m[0][3] != 0 || m[1][3] != 0 || m[2][3] != 0)
+            return TransformType::Translation;
+        return TransformType::Identity;
+    }
+
+    // Rows of orthonormal matrix are orthonormal, checked with tolerance, matrices from Rotate() aren't exact.
+    constexpr fp_t tolerance = 1e-5f;
+    for (i32 i = 0; i < 3; ++i)
+        for (i32 j = i; j < 3; ++j) {
+            fp_t dot = m[i][0] * m[j][0] + m[i][1] * m[j][1] + m[i][2] * m[j][2];
+            fp_t expected = i == j ? fp_t(1) : fp_t(0);
+            if (dot - expected > tolerance || expected - dot > tolerance)
+                return TransformType::General;
+        }
+    return TransformType::Rigid;
+}
+
+
 PBR_CNSTEXPR
 Transform Inverse(const Transform &t)
 {
@@ -452,6 +1050,7 @@ Transform Scale(const fp_t x, const fp_t y, const fp_t z)
     return Transform(m, mInv);
 }
 
+inline
 Transform RotateX(const fp_t theta)
 {
     const fp_t sinTheta = pbr::Sin(Radians(theta));
@@ -463,6 +1062,7 @@ Transform RotateX(const fp_t theta)
     return Transform(m, Transpose(m));
 }
 
+inline
 Transform RotateY(const fp_t theta)
 {
     const fp_t sinTheta = pbr::Sin(Radians(theta));
@@ -474,6 +1074,7 @@ Transform RotateY(const fp_t theta)
     return Transform(m, Transpose(m));
 }
 
+inline
 Transform RotateZ(const fp_t theta)
 {
     const fp_t sinTheta = pbr::Sin(Radians(theta));
@@ -487,6 +1088,7 @@ Transform RotateZ(const fp_t theta)
 
 // TODO: implementation slightly differs from original, needs to be checked
 //       may be there is a precision loss
+inline
 Transform Rotate(const fp_t theta, const Vector3_arg<fp_t> axis) {
     const auto a = Normalize(axis);
     const fp_t sinTheta = pbr::Sin(Radians(theta));
@@ -508,11 +1110,12 @@ Transform Rotate(const fp_t theta, const Vector3_arg<fp_t> axis) {
     Matrix4x4 m(m00, m01, m02, 0,
                 m10, m11, m12, 0,
                 m20, m21, m22, 0,
-                  0,   0,   0, 0);
+                  0,   0,   0, 1);
     return Transform(m, Transpose(m));
 }
 
 // TODO: matrix inverse can be simplified in this case
+inline
 Transform LookAt(const Point3_arg<fp_t> pos, const Point3_arg<fp_t> look, const Vector3_arg<fp_t> up) {
     const auto direction = Normalize(look - pos);
     const auto right = Normalize(Cross(Normalize(up), direction));
@@ -521,7 +1124,7 @@ Transform LookAt(const Point3_arg<fp_t> pos, const Point3_arg<fp_t> look, const
     PBR_ASSERT_MSG(Cross(Normalize(up), direction).Length() == 0,
         "up vector and viewing direction passed to LookAt are pointing in the same direction")
 
-    Matrix4x4 cameraToWorld(right.x, newUp.x, direction.x, pox.x,
+    Matrix4x4 cameraToWorld(right.x, newUp.x, direction.x, pos.x,
                             right.y, newUp.y, direction.y, pos.y,
                             right.z, newUp.z, direction.z, pos.z,
                                   0,       0,           0,     1);
@@ -530,6 +1133,85 @@ Transform LookAt(const Point3_arg<fp_t> pos, const Point3_arg<fp_t> look, const
 
 #pragma endregion Transform
 
+
+// ******************************************************************************
+// ------------------------------ AffineTransform -------------------------------
+// ******************************************************************************
+
+#pragma region AffineTransform
+
+// Transform without the bottom row, modelling transforms are affine, so w is never computed and there is no divide.
+//   Matrices are 2x48 bytes instead of 2x64. Results, error bounds included, are the same as of Transform
+//   with the same matrix, so one can replace the other. General type means general affine here.
+// TODO: SurfaceInteraction transform not implemented, same as for Transform.
+struct AffineTransform : TransformBase<Matrix3x4>
+{
+    PBR_CNSTEXPR explicit AffineTransform(const Matrix3x4_arg matrix);
+    PBR_CNSTEXPR explicit AffineTransform(const Matrix3x4_arg matrix, const Matrix3x4_arg inverse);
+    // Transform has to be affine.
+    PBR_CNSTEXPR explicit AffineTransform(const Transform &t);
+
+    PBR_CNSTEXPR explicit operator Transform() const;
+};
+
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+AffineTransform::AffineTransform(const Matrix3x4_arg matrix)
+    : TransformBase(matrix, Inverse(matrix), ClassifyTransform(matrix))
+{}
+
+PBR_CNSTEXPR
+AffineTransform::AffineTransform(const Matrix3x4_arg matrix, const Matrix3x4_arg inverse)
+    : TransformBase(matrix, inverse, ClassifyTransform(matrix))
+{}
+
+PBR_CNSTEXPR
+AffineTransform::AffineTransform(const Transform &t)
+    : TransformBase(Matrix3x4(t.m), Matrix3x4(t.mInv), t.type)
+{
+    PBR_ASSERT(t.IsAffine())
+}
+
+
+// ---------------------------------------
+// ------------ CONVERSIONS --------------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+AffineTransform::operator Transform() const
+{
+    return Transform(static_cast<Matrix4x4>(m), static_cast<Matrix4x4>(mInv));
+}
+
+
+// ---------------------------------------
+// ----- BINARY ARITHMETIC OPERATORS -----
+// ---------------------------------------
+
+PBR_CNSTEXPR
+AffineTransform operator*(const AffineTransform &t1, const AffineTransform &t2)
+{
+    return AffineTransform(Mul(t1.m, t2.m),
+                           Mul(t2.mInv, t1.mInv));
+}
+
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+PBR_CNSTEXPR
+AffineTransform Inverse(const AffineTransform &t)
+{
+    return AffineTransform(t.mInv, t.m);
+}
+
+#pragma endregion AffineTransform
+
 PBR_NAMESPACE_END
 
 #undef PBR_CNSTEXPR
@@ -0,0 +1,100 @@
+#include "transformcache.h"
+#include "stats.h"
+#include <mutex>
+#include <string_view>
+
+
+PBR_NAMESPACE_BEGIN
+
+PBR_STATS_MEMORY_COUNTER("Memory/Transform cache", stats_TransformCache_bytes)
+PBR_STATS_PERCENT("Scene/Transform cache hits", stats_nTransformCacheHits, stats_nTransformCacheLookups)
+
+// NOTE: -0 is hashed as 0, they're equal, and inverses often have -0 where the matrix has 0.
+std::size_t TransformCache::MatrixHash::operator()(const Matrix4x4 &m) const
+{
+    fp_t values[16];
+    for (i32 i = 0; i < 16; ++i)
+        values[i] = m.m[i / 4][i % 4] + fp_t(0);
+    return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(values), sizeof(values)));
+}
+
+bool TransformCache::MatrixEqual::operator()(const Matrix4x4 &a, const Matrix4x4 &b) const
+{
+    for (i32 i = 0; i < 4; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            if (a.m[i][j] != b.m[i][j])
+                return false;
+    return true;
+}
+
+void TransformCache::Lookup(const Matrix4x4_arg m, const Transform *&out_transform, const Transform *&out_inverse)
+{
+    PBR_STATS_VARIABLE_INCREMENT(stats_nTransformCacheLookups)
+    if (Find(m, out_transform, out_inverse)) {
+        PBR_STATS_VARIABLE_INCREMENT(stats_nTransformCacheHits)
+        return;
+    }
+    Insert(Transform(m), out_transform, out_inverse);
+}
+
+void TransformCache::Lookup(const Transform &t, const Transform *&out_transform, const Transform *&out_inverse)
+{
+    PBR_STATS_VARIABLE_INCREMENT(stats_nTransformCacheLookups)
+    if (Find(t.m, out_transform, out_inverse)) {
+        PBR_STATS_VARIABLE_INCREMENT(stats_nTransformCacheHits)
+        return;
+    }
+    Insert(t, out_transform, out_inverse);
+}
+
+std::size_t TransformCache::Size() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_transforms.size();
+}
+
+void TransformCache::Clear()
+{
+    std::unique_lock lock(m_mutex);
+    m_index.clear();
+    m_transforms.clear();
+}
+
+bool TransformCache::Find(const Matrix4x4 &m, const Transform *&out_transform, const Transform *&out_inverse) const
+{
+    std::shared_lock lock(m_mutex);
+    auto it = m_index.find(m);
+    if (it == m_index.end())
+        return false;
+    out_transform = it->second.transform;
+    out_inverse = it->second.inverse;
+    return true;
+}
+
+void TransformCache::Insert(const Transform &t, const Transform *&out_transform, const Transform *&out_inverse)
+{
+    std::unique_lock lock(m_mutex);
+    auto it = m_index.find(t.m);
+    if (it != m_index.end()) {
+        out_transform = it->second.transform;
+        out_inverse = it->second.inverse;
+        return;
+    }
+
+    const Transform *transform = &m_transforms.emplace_back(t);
+    // Identity and the other involutions are their own inverses, no need to keep a copy.
+    const Transform *inverse = transform;
+    if (MatrixEqual()(t.m, t.mInv) == false)
+        inverse = &m_transforms.emplace_back(t.mInv, t.m);
+    PBR_STATS_VARIABLE_ADD(stats_TransformCache_bytes, (inverse == transform ? 1 : 2) * sizeof(Transform))
+
+    m_index.emplace(t.m, Entry{ transform, inverse });
+    // NOTE: If the inverse matrix is already interned, its pair is kept, pointers returned before stay canonical.
+    //       Inverse of that inverse is rarely bit exact to m, so the pair of m is separate anyway.
+    m_index.try_emplace(t.mInv, Entry{ inverse, transform });
+
+    out_transform = transform;
+    out_inverse = inverse;
+}
+
+PBR_NAMESPACE_END
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "transform.hpp"
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+PBR_NAMESPACE_BEGIN
+
+// Interns transforms, so shapes with equal matrices share one ObjectToWorld/WorldToObject pair
+//   instead of each of them owning its own copy. Transforms live as long as the cache, pointers never move.
+// NOTE: Matrices are compared element by element, so they must not contain NaNs.
+// DIFFERENCE: Thread safe, lookups of the existing transforms only take a shared lock,
+//             inverse of the new matrix is computed outside of the lock.
+class TransformCache
+{
+public:
+    TransformCache() = default;
+
+    TransformCache(const TransformCache&) = delete;
+    TransformCache& operator=(const TransformCache&) = delete;
+
+    // Canonical transform of the matrix and its inverse. Inverse is computed only once per matrix,
+    //   and it's interned too, so lookup of the inverse matrix returns the same pair swapped.
+    void Lookup(const Matrix4x4_arg m, const Transform *&out_transform, const Transform *&out_inverse);
+    // Same, but the inverse is taken from the transform.
+    void Lookup(const Transform &t, const Transform *&out_transform, const Transform *&out_inverse);
+
+    // Number of unique transforms, inverses included.
+    std::size_t Size() const;
+    // NOTE: Invalidates all the pointers returned so far.
+    void Clear();
+
+private:
+    struct Entry
+    {
+        const Transform *transform;
+        const Transform *inverse;
+    };
+
+    struct MatrixHash
+    {
+        std::size_t operator()(const Matrix4x4 &m) const;
+    };
+
+    struct MatrixEqual
+    {
+        bool operator()(const Matrix4x4 &a, const Matrix4x4 &b) const;
+    };
+
+    bool Find(const Matrix4x4 &m, const Transform *&out_transform, const Transform *&out_inverse) const;
+    // If another thread inserted the matrix meanwhile, its pair is returned and t is dropped.
+    void Insert(const Transform &t, const Transform *&out_transform, const Transform *&out_inverse);
+
+
+    std::unordered_map<Matrix4x4, Entry, MatrixHash, MatrixEqual> m_index;
+    std::deque<Transform> m_transforms;
+    mutable std::shared_mutex m_mutex;
+};
+
+PBR_NAMESPACE_END
@@ -0,0 +1,511 @@
+#include "objmesh.h"
+#include "../core/mappedfile.h"
+#include "../core/memory.h"
+#include "../core/parallel.h"
+#include "../core/stats.h"
+
+#include <algorithm>    // std::min, std::max
+#include <atomic>
+#include <charconv>     // std::from_chars
+#include <cstdio>       // std::fprintf
+#include <cstring>      // std::memchr
+#include <unordered_map>
+
+
+PBR_NAMESPACE_BEGIN
+
+PBR_STATS_COUNTER("Scene/OBJ meshes loaded", stats_nObjMeshes)
+PBR_STATS_RATIO("Scene/OBJ vertices per face vertex", stats_nObjUniqueVertices, stats_nObjCorners)
+
+namespace {
+
+// NOTE: Chunks should be big enough so the merge is cheap, and small enough so all cores are busy till the end.
+constexpr std::size_t minChunkBytes = 1 << 20;
+constexpr i64 chunksPerCore = 4;
+constexpr i64 parallelChunkSize = 64 * 1024;
+constexpr i32 nDedupShards = 64;
+constexpr std::size_t dedupArenaBlockSize = 1 << 20;
+
+
+// ******************************************************************************
+// ---------------------------------- PARSING -----------------------------------
+// ******************************************************************************
+
+#pragma region Parsing
+
+// Flags of ObjCorner
+enum : ui8
+{
+    ObjRelativeV  = 1 << 0,
+    ObjRelativeVT = 1 << 1,
+    ObjRelativeVN = 1 << 2
+};
+
+// One vertex of a face. Indices are 0 based, -1 if not present.
+// Relative(negative in file) indices are relative to the beginning of the chunk until they're resolved.
+struct ObjCorner
+{
+    i32 v, vt, vn;
+    ui8 flags;
+};
+
+struct ObjChunk
+{
+    std::vector<Point3_t> positions;
+    std::vector<Point2_t> uv;
+    std::vector<Normal3_t> normals;
+    std::vector<ObjCorner> corners;
+    std::vector<i32> faceSizes;
+    i64 nTriangles = 0;     // after fan triangulation of every face, quads included
+    i64 nQuads = 0;
+    const char *error = nullptr;
+};
+
+
+void PrintObjError(const std::string &filename, const char *message)
+{
+    std::fprintf(stderr, "OBJ: %s: %s\n", filename.c_str(), message);
+}
+
+const char* SkipSpaces(const char *ptr, const char *end)
+{
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r'))
+        ++ptr;
+    return ptr;
+}
+
+bool ParseFloat(const char *&ptr, const char *end, fp_t &out_value)
+{
+    ptr = SkipSpaces(ptr, end);
+    // NOTE: std::from_chars doesn't accept leading '+'
+    if (ptr < end && *ptr == '+')
+        ++ptr;
+    auto [next, ec] = std::from_chars(ptr, end, out_value);
+    if (ec != std::errc())
+        return false;
+    ptr = next;
+    return true;
+}
+
+// Converts 1 based(or negative relative) OBJ index to 0 based, nElements is the number of elements in the chunk so far.
+bool ParseIndex(const char *&ptr, const char *end, i64 nElements, ui8 relativeFlag, i32 &out_index, ui8 &inout_flags)
+{
+    i64 index;
+    auto [next, ec] = std::from_chars(ptr, end, index);
+    if (ec != std::errc() || index == 0 || index > std::numeric_limits<i32>::max() || index < -std::numeric_limits<i32>::max())
+        return false;
+    ptr = next;
+
+    if (index > 0)
+        out_index = static_cast<i32>(index - 1);
+    else {
+        // NOTE: May be negative if it refers to one of the previous chunks.
+        out_index = static_cast<i32>(nElements + index);
+        inout_flags |= relativeFlag;
+    }
+    return true;
+}
+
+bool ParseFace(const char *ptr, const char *end, ObjChunk &chunk)
+{
+    i32 nCorners = 0;
+    for (ptr = SkipSpaces(ptr, end); ptr < end; ptr = SkipSpaces(ptr, end)) {
+        ObjCorner corner = { -1, -1, -1, 0 };
+        if (ParseIndex(ptr, end, chunk.positions.size(), ObjRelativeV, corner.v, corner.flags) == false)
+            return false;
+        if (ptr < end && *ptr == '/') {
+            ++ptr;
+            if (ptr < end && *ptr != '/' && ParseIndex(ptr, end, chunk.uv.size(), ObjRelativeVT, corner.vt, corner.flags) == false)
+                return false;
+            if (ptr < end && *ptr == '/') {
+                ++ptr;
+                if (ParseIndex(ptr, end, chunk.normals.size(), ObjRelativeVN, corner.vn, corner.flags) == false)
+                    return false;
+            }
+        }
+        chunk.corners.push_back(corner);
+        ++nCorners;
+    }
+
+    if (nCorners < 3)
+        return false;
+    chunk.faceSizes.push_back(nCorners);
+    chunk.nTriangles += nCorners - 2;
+    chunk.nQuads += nCorners == 4;
+    return true;
+}
+
+void ParseChunk(const char *ptr, const char *end, ObjChunk &chunk)
+{
+    while (ptr < end) {
+        const char *lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+        if (lineEnd == nullptr)
+            lineEnd = end;
+
+        // Everything after '#' is a comment, it may follow the data on the same line
+        const char *comment = static_cast<const char*>(std::memchr(ptr, '#', lineEnd - ptr));
+        const char *dataEnd = comment != nullptr ? comment : lineEnd;
+
+        const char *p = SkipSpaces(ptr, dataEnd);
+        if (p + 1 < dataEnd && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            fp_t x, y, z;
+            ++p;
+            if (!ParseFloat(p, dataEnd, x) || !ParseFloat(p, dataEnd, y) || !ParseFloat(p, dataEnd, z)) {
+                chunk.error = "invalid vertex position";
+                return;
+            }
+            chunk.positions.emplace_back(x, y, z);
+        }
+        else if (p + 2 < dataEnd && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            fp_t u, v = 0;
+            p += 2;
+            // NOTE: 1D texture coordinates are legal, v is 0 in this case.
+            if (!ParseFloat(p, dataEnd, u) || (SkipSpaces(p, dataEnd) != dataEnd && !ParseFloat(p, dataEnd, v))) {
+                chunk.error = "invalid texture coordinate";
+                return;
+            }
+            chunk.uv.emplace_back(u, v);
+        }
+        else if (p + 2 < dataEnd && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+            fp_t x, y, z;
+            p += 2;
+            if (!ParseFloat(p, dataEnd, x) || !ParseFloat(p, dataEnd, y) || !ParseFloat(p, dataEnd, z)) {
+                chunk.error = "invalid vertex normal";
+                return;
+            }
+            chunk.normals.emplace_back(x, y, z);
+        }
+        else if (p + 1 < dataEnd && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            if (ParseFace(p + 1, dataEnd, chunk) == false) {
+                chunk.error = "invalid face";
+                return;
+            }
+        }
+
+        ptr = lineEnd + 1;
+    }
+}
+
+#pragma endregion Parsing
+
+
+// ******************************************************************************
+// ----------------------------------- MERGE ------------------------------------
+// ******************************************************************************
+
+#pragma region Merge
+
+struct ObjKey
+{
+    bool operator==(const ObjKey&) const = default;
+
+    i32 v, vt, vn;
+};
+
+struct ObjKeyHash
+{
+    std::size_t operator()(const ObjKey &key) const
+    {
+        // NOTE: Multipliers are just big odd constants, the top bits are mixed the best, so they're used for sharding.
+        ui64 h = ui64(ui32(key.v)) * 0x9E3779B97F4A7C15ull;
+        h ^= ui64(ui32(key.vt)) * 0xC2B2AE3D27D4EB4Full;
+        h ^= ui64(ui32(key.vn)) * 0x165667B19E3779F9ull;
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+};
+
+i32 ShardOf(const ObjKey &key)
+{
+    return static_cast<i32>((ui64(ObjKeyHash()(key)) >> 58) % nDedupShards);
+}
+
+// Exclusive prefix sum of per-block counts, returns the total.
+i64 ExclusiveScan(std::vector<i64> &inout_values)
+{
+    i64 sum = 0;
+    for (auto &value : inout_values) {
+        const i64 count = value;
+        value = sum;
+        sum += count;
+    }
+    return sum;
+}
+
+// Finds unique (v, vt, vn) combinations. For every corner returns index of the unique vertex in out_vertexOfCorner,
+//   unique vertices are numbered in order of their first appearance, so the mesh keeps the locality of the file.
+//   out_firstCorners gets a corner for each of the unique vertices.
+void DeduplicateCorners(const std::vector<ObjCorner> &corners,
+                        std::vector<i32> &out_vertexOfCorner, std::vector<i32> &out_firstCorners)
+{
+    const i64 nCorners = static_cast<i64>(corners.size());
+    const i64 nBlocks = (nCorners + parallelChunkSize - 1) / parallelChunkSize;
+    auto KeyOf = [&corners](i64 c) { return ObjKey{ corners[c].v, corners[c].vt, corners[c].vn }; };
+
+    // Counting sort of corners by shard, order of corners inside a shard stays the same.
+    std::vector<i64> shardOffsets(nDedupShards * nBlocks, 0);
+    ParallelFor(nCorners, parallelChunkSize, [&](i64 begin, i64 end) {
+        const i64 block = begin / parallelChunkSize;
+        for (i64 c = begin; c < end; ++c)
+            ++shardOffsets[ShardOf(KeyOf(c)) * nBlocks + block];
+    });
+    ExclusiveScan(shardOffsets);
+    std::vector<i64> shardBegin(nDedupShards + 1);
+    for (i32 s = 0; s < nDedupShards; ++s)
+        shardBegin[s] = shardOffsets[s * nBlocks];
+    shardBegin[nDedupShards] = nCorners;
+
+    std::vector<i32> sortedCorners(nCorners);
+    ParallelFor(nCorners, parallelChunkSize, [&](i64 begin, i64 end) {
+        const i64 block = begin / parallelChunkSize;
+        for (i64 c = begin; c < end; ++c)
+            sortedCorners[shardOffsets[ShardOf(KeyOf(c)) * nBlocks + block]++] = static_cast<i32>(c);
+    });
+
+    // Every shard has its own keys, so shards are deduplicated independently.
+    // NOTE: Map allocates a node for every unique vertex, they come from the arena of the thread,
+    //       which is reset for the next shard, so its blocks are allocated only once.
+    MemoryArenaPool arenas(dedupArenaBlockSize);
+    std::vector<i32> firstCornerOf(nCorners);
+    ParallelFor(nDedupShards, 1, [&](i64 begin, i64 end) {
+        ArenaMemoryResource resource(arenas.Get());
+        for (i64 s = begin; s < end; ++s) {
+            resource.Arena().Reset();
+            std::pmr::unordered_map<ObjKey, i32, ObjKeyHash> firstCorners(&resource);
+            firstCorners.reserve(shardBegin[s + 1] - shardBegin[s]);
+            for (i64 i = shardBegin[s]; i < shardBegin[s + 1]; ++i) {
+                const i32 c = sortedCorners[i];
+                firstCornerOf[c] = firstCorners.try_emplace(KeyOf(c), c).first->second;
+            }
+        }
+    });
+    sortedCorners = {};
+
+    // Number unique vertices in order of their first corners.
+    std::vector<i64> blockOffsets(nBlocks, 0);
+    ParallelFor(nCorners, parallelChunkSize, [&](i64 begin, i64 end) {
+        i64 count = 0;
+        for (i64 c = begin; c < end; ++c)
+            count += firstCornerOf[c] == c;
+        blockOffsets[begin / parallelChunkSize] = count;
+    });
+    const i64 nVertices = ExclusiveScan(blockOffsets);
+
+    out_vertexOfCorner.resize(nCorners);
+    out_firstCorners.resize(nVertices);
+    ParallelFor(nCorners, parallelChunkSize, [&](i64 begin, i64 end) {
+        i64 vertex = blockOffsets[begin / parallelChunkSize];
+        for (i64 c = begin; c < end; ++c)
+            if (firstCornerOf[c] == c) {
+                out_vertexOfCorner[c] = static_cast<i32>(vertex);
+                out_firstCorners[vertex++] = static_cast<i32>(c);
+            }
+    });
+    // NOTE: First corner always goes before the others, but they may be in different blocks, so it's a separate pass.
+    ParallelFor(nCorners, parallelChunkSize, [&](i64 begin, i64 end) {
+        for (i64 c = begin; c < end; ++c)
+            if (firstCornerOf[c] != c)
+                out_vertexOfCorner[c] = out_vertexOfCorner[firstCornerOf[c]];
+    });
+}
+
+#pragma endregion Merge
+
+} // namespace
+
+
+std::vector<std::shared_ptr<Shape>> LoadObjMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation, bool quadsAsPatches /*= false*/)
+{
+    MappedFile file;
+    if (file.Open(filename) == false) {
+        PrintObjError(filename, "cannot open file");
+        return {};
+    }
+
+    // Split file into line aligned chunks
+    const char *data = reinterpret_cast<const char*>(file.Data());
+    const char *fileEnd = data + file.Size();
+    const i64 maxChunks = std::max<i64>(1, std::min<i64>(NumSystemCores() * chunksPerCore, file.Size() / minChunkBytes));
+    const std::size_t chunkBytes = file.Size() / maxChunks;
+
+    std::vector<const char*> chunkBegins = { data };
+    for (i64 i = 1; i < maxChunks; ++i) {
+        const char *ptr = std::max(data + i * chunkBytes, chunkBegins.back());
+        const char *lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', fileEnd - ptr));
+        if (lineEnd == nullptr || lineEnd + 1 == fileEnd)
+            break;
+        chunkBegins.push_back(lineEnd + 1);
+    }
+    chunkBegins.push_back(fileEnd);
+    const i64 nChunks = static_cast<i64>(chunkBegins.size()) - 1;
+
+    std::vector<ObjChunk> chunks(nChunks);
+    ParallelFor(nChunks, 1, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i)
+            ParseChunk(chunkBegins[i], chunkBegins[i + 1], chunks[i]);
+    });
+    for (const auto &chunk : chunks)
+        if (chunk.error != nullptr) {
+            PrintObjError(filename, chunk.error);
+            return {};
+        }
+
+    // Offsets of every chunk in the merged arrays
+    struct ChunkOffsets { i64 positions, uv, normals, corners, triangles, quads; };
+    std::vector<ChunkOffsets> offsets(nChunks + 1);
+    offsets[0] = {};
+    for (i64 i = 0; i < nChunks; ++i) {
+        // Every quad kept as a patch is 2 triangles less
+        const i64 nQuads = quadsAsPatches ? chunks[i].nQuads : 0;
+        offsets[i + 1] = { offsets[i].positions + static_cast<i64>(chunks[i].positions.size()),
+                           offsets[i].uv + static_cast<i64>(chunks[i].uv.size()),
+                           offsets[i].normals + static_cast<i64>(chunks[i].normals.size()),
+                           offsets[i].corners + static_cast<i64>(chunks[i].corners.size()),
+                           offsets[i].triangles + chunks[i].nTriangles - 2 * nQuads,
+                           offsets[i].quads + nQuads };
+    }
+    const ChunkOffsets &totals = offsets[nChunks];
+
+    if (totals.triangles == 0 && totals.quads == 0) {
+        PrintObjError(filename, "file has no faces");
+        return {};
+    }
+    if (totals.positions > std::numeric_limits<i32>::max() || totals.corners > std::numeric_limits<i32>::max() ||
+        totals.triangles > std::numeric_limits<i32>::max() / 3 || totals.quads > std::numeric_limits<i32>::max() / 4) {
+        PrintObjError(filename, "mesh is too big");
+        return {};
+    }
+
+    // Merge chunks and resolve relative indices
+    std::vector<Point3_t> positions(totals.positions);
+    std::vector<Point2_t> uv(totals.uv);
+    std::vector<Normal3_t> normals(totals.normals);
+    std::vector<ObjCorner> corners(totals.corners);
+    // Triangles first, patches after them
+    std::vector<i32> cornerIndices(3 * totals.triangles + 4 * totals.quads);
+    std::atomic<bool> indicesValid = true, allHaveUV = true, allHaveNormals = true;
+    ParallelFor(nChunks, 1, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i) {
+            ObjChunk &chunk = chunks[i];
+            const ChunkOffsets &offset = offsets[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + offset.positions);
+            std::copy(chunk.uv.begin(), chunk.uv.end(), uv.begin() + offset.uv);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + offset.normals);
+
+            bool valid = true, hasUV = true, hasNormals = true;
+            for (std::size_t c = 0; c < chunk.corners.size(); ++c) {
+                ObjCorner corner = chunk.corners[c];
+                if (corner.flags & ObjRelativeV)  corner.v  += static_cast<i32>(offset.positions);
+                if (corner.flags & ObjRelativeVT) corner.vt += static_cast<i32>(offset.uv);
+                if (corner.flags & ObjRelativeVN) corner.vn += static_cast<i32>(offset.normals);
+                corner.flags = 0;
+
+                valid &= corner.v >= 0 && corner.v < totals.positions && corner.vt < totals.uv && corner.vn < totals.normals;
+                // NOTE: -1 means there is no index, so vt, vn can only be checked for the lower bound after that
+                valid &= corner.vt >= -1 && corner.vn >= -1;
+                hasUV &= corner.vt >= 0;
+                hasNormals &= corner.vn >= 0;
+                corners[offset.corners + c] = corner;
+            }
+
+            // Triangulate faces as fans
+            i32 *triangle = cornerIndices.data() + 3 * offset.triangles;
+            i32 *quad = cornerIndices.data() + 3 * totals.triangles + 4 * offset.quads;
+            i32 faceBegin = static_cast<i32>(offset.corners);
+            for (i32 faceSize : chunk.faceSizes) {
+                if (faceSize == 4 && quadsAsPatches) {
+                    QuadToPatchIndices(faceBegin, faceBegin + 1, faceBegin + 2, faceBegin + 3, quad);
+                    quad += 4;
+                    faceBegin += faceSize;
+                    continue;
+                }
+                for (i32 j = 2; j < faceSize; ++j) {
+                    *triangle++ = faceBegin;
+                    *triangle++ = faceBegin + j - 1;
+                    *triangle++ = faceBegin + j;
+                }
+                faceBegin += faceSize;
+            }
+
+            if (!valid)      indicesValid = false;
+            if (!hasUV)      allHaveUV = false;
+            if (!hasNormals) allHaveNormals = false;
+            chunk = {};
+        }
+    });
+    chunks = {};
+    if (indicesValid == false) {
+        PrintObjError(filename, "vertex index is out of range");
+        return {};
+    }
+
+    // Attributes are either present for every vertex or not present at all.
+    const bool useUV = allHaveUV && totals.uv > 0;
+    const bool useNormals = allHaveNormals && totals.normals > 0;
+    if (useUV == false || useNormals == false)
+        ParallelFor(totals.corners, parallelChunkSize, [&](i64 begin, i64 end) {
+            for (i64 c = begin; c < end; ++c) {
+                if (!useUV)      corners[c].vt = -1;
+                if (!useNormals) corners[c].vn = -1;
+            }
+        });
+
+    std::vector<i32> indices(cornerIndices.size());
+    i64 nVertices;
+    if (useUV == false && useNormals == false) {
+        // Nothing to deduplicate, positions are the vertices.
+        nVertices = totals.positions;
+        ParallelFor(static_cast<i64>(indices.size()), parallelChunkSize, [&](i64 begin, i64 end) {
+            for (i64 i = begin; i < end; ++i)
+                indices[i] = corners[cornerIndices[i]].v;
+        });
+    }
+    else {
+        std::vector<i32> vertexOfCorner, firstCorners;
+        DeduplicateCorners(corners, vertexOfCorner, firstCorners);
+        nVertices = static_cast<i64>(firstCorners.size());
+
+        ParallelFor(static_cast<i64>(indices.size()), parallelChunkSize, [&](i64 begin, i64 end) {
+            for (i64 i = begin; i < end; ++i)
+                indices[i] = vertexOfCorner[cornerIndices[i]];
+        });
+
+        std::vector<Point3_t> vertexPositions(nVertices);
+        std::vector<Point2_t> vertexUV(useUV ? nVertices : 0);
+        std::vector<Normal3_t> vertexNormals(useNormals ? nVertices : 0);
+        ParallelFor(nVertices, parallelChunkSize, [&](i64 begin, i64 end) {
+            for (i64 i = begin; i < end; ++i) {
+                const ObjCorner &corner = corners[firstCorners[i]];
+                vertexPositions[i] = positions[corner.v];
+                if (useUV)      vertexUV[i] = uv[corner.vt];
+                if (useNormals) vertexNormals[i] = normals[corner.vn];
+            }
+        });
+        positions = std::move(vertexPositions);
+        uv = std::move(vertexUV);
+        normals = std::move(vertexNormals);
+    }
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nObjMeshes)
+    PBR_STATS_VARIABLE_ADD(stats_nObjUniqueVertices, nVertices)
+    PBR_STATS_VARIABLE_ADD(stats_nObjCorners, totals.corners)
+
+    // IMPROVE: Mixed meshes copy vertices to both meshes.
+    std::vector<std::shared_ptr<Shape>> shapes;
+    if (totals.triangles > 0)
+        shapes = CreateTriangleMesh(ObjectToWorld, WorldToObject, reverseOrientation,
+                                    static_cast<i32>(totals.triangles), indices.data(),
+                                    static_cast<i32>(nVertices), positions.data(),
+                                    nullptr, useNormals ? normals.data() : nullptr, useUV ? uv.data() : nullptr);
+    if (totals.quads > 0) {
+        auto patches = CreateBilinearPatchMesh(ObjectToWorld, WorldToObject, reverseOrientation,
+                                               static_cast<i32>(totals.quads), indices.data() + 3 * totals.triangles,
+                                               static_cast<i32>(nVertices), positions.data(),
+                                               useNormals ? normals.data() : nullptr, useUV ? uv.data() : nullptr);
+        shapes.insert(shapes.end(), patches.begin(), patches.end());
+    }
+    return shapes;
+}
+
+PBR_NAMESPACE_END
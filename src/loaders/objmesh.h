@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../shapes/triangle.h"
+#include "../shapes/bilinearpatch.h"
+#include <string>
+
+
+PBR_NAMESPACE_BEGIN
+
+// Loads Wavefront OBJ file as a single triangle mesh, only v/vt/vn/f statements are used, everything else is ignored.
+//   Polygons with more than 3 vertices are triangulated as fans, negative(relative) indices are supported.
+//   If quadsAsPatches is true, quads are not triangulated, every quad becomes one BilinearPatch.
+//   Unique v/vt/vn combinations become mesh vertices, normals and uv are used only if every face vertex has them.
+// NOTE: File is split into line aligned chunks which are parsed in parallel, chunks are merged afterwards.
+// TODO: Groups, materials and line continuation('\') are not supported.
+// Returns empty vector if the file cannot be loaded, the reason is printed to stderr.
+std::vector<std::shared_ptr<Shape>> LoadObjMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation, bool quadsAsPatches = false);
+
+PBR_NAMESPACE_END
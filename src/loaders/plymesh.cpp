@@ -0,0 +1,637 @@
+#include "plymesh.h"
+#include "../core/mappedfile.h"
+#include "../core/parallel.h"
+#include "../core/stats.h"
+
+#include <algorithm>    // std::reverse
+#include <atomic>
+#include <bit>          // std::endian
+#include <charconv>     // std::from_chars
+#include <cstdio>       // std::fprintf
+#include <cstring>      // std::memcpy
+#include <string_view>
+
+
+PBR_NAMESPACE_BEGIN
+
+PBR_STATS_COUNTER("Scene/PLY meshes loaded", stats_nPlyMeshes)
+PBR_STATS_MEMORY_COUNTER("Memory/PLY files mapped", stats_PlyMapped_bytes)
+
+namespace {
+
+// Number of vertices/faces processed by one ParallelFor() chunk.
+constexpr i64 parallelChunkSize = 64 * 1024;
+
+
+// ******************************************************************************
+// --------------------------------- PLY HEADER ---------------------------------
+// ******************************************************************************
+
+#pragma region PlyHeader
+
+enum class PlyType : ui8
+{
+    Invalid,
+    Int8, UInt8,
+    Int16, UInt16,
+    Int32, UInt32,
+    Float32, Float64
+};
+
+i32 PlyTypeSize(PlyType type)
+{
+    switch (type) {
+        case PlyType::Int8:    case PlyType::UInt8:  return 1;
+        case PlyType::Int16:   case PlyType::UInt16: return 2;
+        case PlyType::Int32:   case PlyType::UInt32: return 4;
+        case PlyType::Float32:                       return 4;
+        case PlyType::Float64:                       return 8;
+        default:                                     return 0;
+    }
+}
+
+PlyType ParsePlyType(std::string_view name)
+{
+    if (name == "char"   || name == "int8")    return PlyType::Int8;
+    if (name == "uchar"  || name == "uint8")   return PlyType::UInt8;
+    if (name == "short"  || name == "int16")   return PlyType::Int16;
+    if (name == "ushort" || name == "uint16")  return PlyType::UInt16;
+    if (name == "int"    || name == "int32")   return PlyType::Int32;
+    if (name == "uint"   || name == "uint32")  return PlyType::UInt32;
+    if (name == "float"  || name == "float32") return PlyType::Float32;
+    if (name == "double" || name == "float64") return PlyType::Float64;
+    return PlyType::Invalid;
+}
+
+
+struct PlyProperty
+{
+    bool IsList() const { return countType != PlyType::Invalid; }
+
+    std::string name;
+    PlyType type = PlyType::Invalid;        // Value type, or type of list items
+    PlyType countType = PlyType::Invalid;   // Type of list size, Invalid if property is not a list
+    i32 offset = -1;                        // Offset from the beginning of the element, -1 if it goes after a list
+};
+
+struct PlyElement
+{
+    const PlyProperty* Find(std::string_view propertyName) const
+    {
+        for (const auto &property : properties)
+            if (property.name == propertyName)
+                return &property;
+        return nullptr;
+    }
+
+    std::string name;
+    i64 count = 0;
+    std::vector<PlyProperty> properties;
+    i32 stride = 0;                         // Size of one element in bytes, -1 if element contains lists
+};
+
+struct PlyHeader
+{
+    bool bigEndian = false;
+    std::vector<PlyElement> elements;
+    std::size_t dataOffset = 0;
+};
+
+
+void PrintPlyError(const std::string &filename, const char *message)
+{
+    std::fprintf(stderr, "PLY: %s: %s\n", filename.c_str(), message);
+}
+
+// Splits the line by spaces, tabs are not used by any exporter I know of, but they're legal.
+std::vector<std::string_view> Tokenize(std::string_view line)
+{
+    std::vector<std::string_view> tokens;
+    std::size_t pos = 0;
+    while (pos < line.size()) {
+        pos = line.find_first_not_of(" \t\r", pos);
+        if (pos == std::string_view::npos)
+            break;
+        std::size_t end = line.find_first_of(" \t\r", pos);
+        if (end == std::string_view::npos)
+            end = line.size();
+        tokens.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return tokens;
+}
+
+bool ParsePlyHeader(const std::string &filename, const ui8 *data, std::size_t size, PlyHeader &out_header)
+{
+    const std::string_view text(reinterpret_cast<const char*>(data), size);
+
+    std::size_t lineBegin = 0;
+    bool formatFound = false;
+    for (i32 lineNumber = 0;; ++lineNumber) {
+        const std::size_t lineEnd = text.find('\n', lineBegin);
+        if (lineEnd == std::string_view::npos) {
+            PrintPlyError(filename, "unexpected end of file in the header");
+            return false;
+        }
+        const auto tokens = Tokenize(text.substr(lineBegin, lineEnd - lineBegin));
+        lineBegin = lineEnd + 1;
+
+        if (lineNumber == 0) {
+            if (tokens.size() != 1 || tokens[0] != "ply") {
+                PrintPlyError(filename, "not a PLY file");
+                return false;
+            }
+            continue;
+        }
+        if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+            continue;
+
+        if (tokens[0] == "end_header") {
+            out_header.dataOffset = lineBegin;
+            break;
+        }
+        else if (tokens[0] == "format" && tokens.size() >= 2) {
+            if (tokens[1] == "binary_little_endian")
+                out_header.bigEndian = false;
+            else if (tokens[1] == "binary_big_endian")
+                out_header.bigEndian = true;
+            else {
+                PrintPlyError(filename, "only binary PLY files are supported");
+                return false;
+            }
+            formatFound = true;
+        }
+        else if (tokens[0] == "element" && tokens.size() == 3) {
+            PlyElement element;
+            element.name = tokens[1];
+            auto [ptr, ec] = std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count);
+            if (ec != std::errc() || element.count < 0) {
+                PrintPlyError(filename, "invalid element count");
+                return false;
+            }
+            out_header.elements.push_back(std::move(element));
+        }
+        else if (tokens[0] == "property" && !out_header.elements.empty()) {
+            PlyElement &element = out_header.elements.back();
+            PlyProperty property;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                property.countType = ParsePlyType(tokens[2]);
+                property.type = ParsePlyType(tokens[3]);
+                property.name = tokens[4];
+                if (property.countType == PlyType::Invalid || property.countType == PlyType::Float32 ||
+                    property.countType == PlyType::Float64) {
+                    PrintPlyError(filename, "invalid list size type");
+                    return false;
+                }
+            }
+            else if (tokens.size() == 3) {
+                property.type = ParsePlyType(tokens[1]);
+                property.name = tokens[2];
+            }
+            if (property.type == PlyType::Invalid) {
+                PrintPlyError(filename, "invalid property");
+                return false;
+            }
+
+            if (element.stride >= 0) {
+                property.offset = element.stride;
+                element.stride = property.IsList() ? -1 : element.stride + PlyTypeSize(property.type);
+            }
+            element.properties.push_back(std::move(property));
+        }
+        else {
+            PrintPlyError(filename, "unknown header line");
+            return false;
+        }
+    }
+
+    if (formatFound == false) {
+        PrintPlyError(filename, "format is not specified");
+        return false;
+    }
+    return true;
+}
+
+#pragma endregion PlyHeader
+
+
+// ******************************************************************************
+// ---------------------------------- PLY DATA ----------------------------------
+// ******************************************************************************
+
+#pragma region PlyData
+
+template<typename T>
+T Load(const ui8 *ptr, bool swapBytes)
+{
+    ui8 bytes[sizeof(T)];
+    std::memcpy(bytes, ptr, sizeof(T));
+    if (swapBytes)
+        std::reverse(bytes, bytes + sizeof(T));
+
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+f64 LoadAsFloat(const ui8 *ptr, PlyType type, bool swapBytes)
+{
+    switch (type) {
+        case PlyType::Int8:    return Load<std::int8_t>(ptr, swapBytes);
+        case PlyType::UInt8:   return Load<std::uint8_t>(ptr, swapBytes);
+        case PlyType::Int16:   return Load<std::int16_t>(ptr, swapBytes);
+        case PlyType::UInt16:  return Load<std::uint16_t>(ptr, swapBytes);
+        case PlyType::Int32:   return Load<std::int32_t>(ptr, swapBytes);
+        case PlyType::UInt32:  return Load<std::uint32_t>(ptr, swapBytes);
+        case PlyType::Float32: return Load<f32>(ptr, swapBytes);
+        case PlyType::Float64: return Load<f64>(ptr, swapBytes);
+        default:               return 0;
+    }
+}
+
+i64 LoadAsInt(const ui8 *ptr, PlyType type, bool swapBytes)
+{
+    switch (type) {
+        case PlyType::Int8:    return Load<std::int8_t>(ptr, swapBytes);
+        case PlyType::UInt8:   return Load<std::uint8_t>(ptr, swapBytes);
+        case PlyType::Int16:   return Load<std::int16_t>(ptr, swapBytes);
+        case PlyType::UInt16:  return Load<std::uint16_t>(ptr, swapBytes);
+        case PlyType::Int32:   return Load<std::int32_t>(ptr, swapBytes);
+        case PlyType::UInt32:  return Load<std::uint32_t>(ptr, swapBytes);
+        case PlyType::Float32: return static_cast<i64>(Load<f32>(ptr, swapBytes));
+        case PlyType::Float64: return static_cast<i64>(Load<f64>(ptr, swapBytes));
+        default:               return 0;
+    }
+}
+
+// Returns pointer past the property, or nullptr if it goes beyond the end of file.
+const ui8* SkipProperty(const PlyProperty &property, const ui8 *ptr, const ui8 *end, bool swapBytes)
+{
+    if (property.IsList()) {
+        const i32 countSize = PlyTypeSize(property.countType);
+        if (end - ptr < countSize)
+            return nullptr;
+        const i64 count = LoadAsInt(ptr, property.countType, swapBytes);
+        ptr += countSize;
+        if (count < 0 || (end - ptr) / PlyTypeSize(property.type) < count)
+            return nullptr;
+        return ptr + count * PlyTypeSize(property.type);
+    }
+
+    if (end - ptr < PlyTypeSize(property.type))
+        return nullptr;
+    return ptr + PlyTypeSize(property.type);
+}
+
+const ui8* SkipElementRow(const PlyElement &element, const ui8 *ptr, const ui8 *end, bool swapBytes)
+{
+    for (const auto &property : element.properties) {
+        ptr = SkipProperty(property, ptr, end, swapBytes);
+        if (ptr == nullptr)
+            return nullptr;
+    }
+    return ptr;
+}
+
+const ui8* SkipElement(const PlyElement &element, const ui8 *ptr, const ui8 *end, bool swapBytes)
+{
+    if (element.stride >= 0) {
+        if (element.stride > 0 && (end - ptr) / element.stride < element.count)
+            return nullptr;
+        return ptr + element.count * element.stride;
+    }
+
+    for (i64 i = 0; i < element.count && ptr != nullptr; ++i)
+        ptr = SkipElementRow(element, ptr, end, swapBytes);
+    return ptr;
+}
+
+const PlyProperty* FindAny(const PlyElement &element, std::initializer_list<std::string_view> names)
+{
+    for (auto name : names)
+        if (const PlyProperty *property = element.Find(name); property != nullptr)
+            return property;
+    return nullptr;
+}
+
+
+// Decoded vertex data, positions may point directly into the mapped file.
+struct PlyVertices
+{
+    const Point3_t *positions = nullptr;
+    const Normal3_t *normals = nullptr;
+    const Point2_t *uv = nullptr;
+
+    std::vector<Point3_t> positionsStorage;
+    std::vector<Normal3_t> normalsStorage;
+    std::vector<Point2_t> uvStorage;
+};
+
+bool DecodeVertices(const std::string &filename, const PlyElement &element, const ui8 *data, bool swapBytes,
+                    PlyVertices &out_vertices)
+{
+    const PlyProperty *x = element.Find("x"), *y = element.Find("y"), *z = element.Find("z");
+    if (x == nullptr || y == nullptr || z == nullptr) {
+        PrintPlyError(filename, "vertex element has no x, y, z properties");
+        return false;
+    }
+    if (element.stride < 0) {
+        PrintPlyError(filename, "list properties in vertex element are not supported");
+        return false;
+    }
+    const PlyProperty *nx = element.Find("nx"), *ny = element.Find("ny"), *nz = element.Find("nz");
+    const bool hasNormals = nx != nullptr && ny != nullptr && nz != nullptr;
+    const PlyProperty *u = FindAny(element, { "u", "s", "texture_u", "texture_s" });
+    const PlyProperty *v = FindAny(element, { "v", "t", "texture_v", "texture_t" });
+    const bool hasUV = u != nullptr && v != nullptr;
+
+    const i64 nVertices = element.count;
+    const i64 stride = element.stride;
+
+    // Fast path: tightly packed float positions, same byte order, nothing to decode.
+    const bool positionsArePacked = std::endian::native == std::endian::little && !swapBytes &&
+                                    sizeof(fp_t) == sizeof(f32) && sizeof(Point3_t) == 3 * sizeof(f32) &&
+                                    element.properties.size() == 3 && stride == sizeof(Point3_t) &&
+                                    x->type == PlyType::Float32 && x->offset == 0 &&
+                                    y->type == PlyType::Float32 && y->offset == 4 &&
+                                    z->type == PlyType::Float32 && z->offset == 8 &&
+                                    reinterpret_cast<std::uintptr_t>(data) % alignof(Point3_t) == 0;
+    if (positionsArePacked) {
+        out_vertices.positions = reinterpret_cast<const Point3_t*>(data);
+        return true;
+    }
+
+    out_vertices.positionsStorage.resize(nVertices);
+    if (hasNormals)
+        out_vertices.normalsStorage.resize(nVertices);
+    if (hasUV)
+        out_vertices.uvStorage.resize(nVertices);
+
+    ParallelFor(nVertices, parallelChunkSize, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i) {
+            const ui8 *row = data + i * stride;
+            out_vertices.positionsStorage[i] = Point3_t(fp_t(LoadAsFloat(row + x->offset, x->type, swapBytes)),
+                                                        fp_t(LoadAsFloat(row + y->offset, y->type, swapBytes)),
+                                                        fp_t(LoadAsFloat(row + z->offset, z->type, swapBytes)));
+            if (hasNormals)
+                out_vertices.normalsStorage[i] = Normal3_t(fp_t(LoadAsFloat(row + nx->offset, nx->type, swapBytes)),
+                                                           fp_t(LoadAsFloat(row + ny->offset, ny->type, swapBytes)),
+                                                           fp_t(LoadAsFloat(row + nz->offset, nz->type, swapBytes)));
+            if (hasUV)
+                out_vertices.uvStorage[i] = Point2_t(fp_t(LoadAsFloat(row + u->offset, u->type, swapBytes)),
+                                                     fp_t(LoadAsFloat(row + v->offset, v->type, swapBytes)));
+        }
+    });
+
+    out_vertices.positions = out_vertices.positionsStorage.data();
+    if (hasNormals)
+        out_vertices.normals = out_vertices.normalsStorage.data();
+    if (hasUV)
+        out_vertices.uv = out_vertices.uvStorage.data();
+    return true;
+}
+
+// Fast path for the most common case: faces contain only a list of 3 or 4 32bit integer indices with 8bit size.
+//   Quads go to out_quadIndices if it's not nullptr, otherwise they are split into two triangles.
+//   Returns false if the faces don't match this layout, output is untouched in this case.
+bool DecodePolygonsFast(const PlyElement &element, const PlyProperty &indicesProperty,
+                        const ui8 *data, const ui8 *fileEnd, bool swapBytes, i64 nVertices,
+                        std::vector<i32> &out_indices, std::vector<i32> *out_quadIndices, bool &out_indicesValid)
+{
+    const i64 nFaces = element.count;
+    const bool isInteger = indicesProperty.type == PlyType::Int32 || indicesProperty.type == PlyType::UInt32;
+    if (element.properties.size() != 1 || PlyTypeSize(indicesProperty.countType) != 1 ||
+        isInteger == false || nFaces == 0 || fileEnd - data < 1)
+        return false;
+    const i32 faceSize = data[0];
+    const i64 stride = 1 + faceSize * sizeof(i32);
+    if ((faceSize != 3 && faceSize != 4) || (fileEnd - data) / stride < nFaces)
+        return false;
+
+    // NOTE: If every size is the same as the first one, then the layout is exactly what we assumed, otherwise bail out to the slow path.
+    std::atomic<bool> allSameSize = true;
+    ParallelFor(nFaces, parallelChunkSize, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i)
+            if (data[i * stride] != faceSize) {
+                allSameSize = false;
+                return;
+            }
+    });
+    if (allSameSize == false)
+        return false;
+
+    const bool keepQuads = faceSize == 4 && out_quadIndices != nullptr;
+    std::vector<i32> &indices = keepQuads ? *out_quadIndices : out_indices;
+    // Quad is either one patch or two triangles, 4 or 6 indices
+    const i64 indicesPerFace = faceSize == 3 ? 3 : (keepQuads ? 4 : 6);
+    indices.resize(indicesPerFace * nFaces);
+    std::atomic<bool> indicesValid = true;
+    const bool isUnsigned = indicesProperty.type == PlyType::UInt32;
+    ParallelFor(nFaces, parallelChunkSize, [&](i64 begin, i64 end) {
+        bool valid = true;
+        i32 face[4];
+        for (i64 i = begin; i < end; ++i) {
+            const ui8 *row = data + i * stride + 1;
+            for (i32 j = 0; j < faceSize; ++j) {
+                const i64 index = isUnsigned ? i64(Load<ui32>(row + 4 * j, swapBytes)) : i64(Load<i32>(row + 4 * j, swapBytes));
+                valid &= index >= 0 && index < nVertices;
+                face[j] = static_cast<i32>(index);
+            }
+
+            i32 *out = &indices[indicesPerFace * i];
+            if (faceSize == 3) {
+                out[0] = face[0]; out[1] = face[1]; out[2] = face[2];
+            }
+            else if (keepQuads)
+                QuadToPatchIndices(face[0], face[1], face[2], face[3], out);
+            else {
+                out[0] = face[0]; out[1] = face[1]; out[2] = face[2];
+                out[3] = face[0]; out[4] = face[2]; out[5] = face[3];
+            }
+        }
+        if (valid == false)
+            indicesValid = false;
+    });
+
+    out_indicesValid = indicesValid;
+    return true;
+}
+
+// Triangles go to out_indices, quads go to out_quadIndices, if it's not nullptr.
+bool DecodeFaces(const std::string &filename, const PlyElement &element, const ui8 *data, const ui8 *end,
+                 bool swapBytes, i64 nVertices, std::vector<i32> &out_indices, std::vector<i32> *out_quadIndices)
+{
+    const PlyProperty *indicesProperty = FindAny(element, { "vertex_indices", "vertex_index" });
+    if (indicesProperty == nullptr || indicesProperty->IsList() == false) {
+        PrintPlyError(filename, "face element has no vertex_indices list");
+        return false;
+    }
+    if (indicesProperty->type == PlyType::Float32 || indicesProperty->type == PlyType::Float64) {
+        PrintPlyError(filename, "vertex_indices list has a floating point type");
+        return false;
+    }
+
+    bool indicesValid = true;
+    if (DecodePolygonsFast(element, *indicesProperty, data, end, swapBytes, nVertices, out_indices, out_quadIndices, indicesValid) == false) {
+        // NOTE: Sizes of rows are different, so there is no way to split the work without walking through all of them first.
+        out_indices.clear();
+        out_indices.reserve(3 * element.count);
+
+        const ui8 *ptr = data;
+        for (i64 i = 0; i < element.count; ++i) {
+            for (const auto &property : element.properties) {
+                if (&property != indicesProperty) {
+                    ptr = SkipProperty(property, ptr, end, swapBytes);
+                    if (ptr == nullptr)
+                        break;
+                    continue;
+                }
+
+                const i32 countSize = PlyTypeSize(property.countType);
+                const i32 indexSize = PlyTypeSize(property.type);
+                if (end - ptr < countSize) {
+                    ptr = nullptr;
+                    break;
+                }
+                const i64 count = LoadAsInt(ptr, property.countType, swapBytes);
+                ptr += countSize;
+                if (count < 0 || (end - ptr) / indexSize < count) {
+                    ptr = nullptr;
+                    break;
+                }
+
+                if (count == 4 && out_quadIndices != nullptr) {
+                    i64 quad[4];
+                    for (i32 j = 0; j < 4; ++j) {
+                        quad[j] = LoadAsInt(ptr + j * indexSize, property.type, swapBytes);
+                        indicesValid &= quad[j] >= 0 && quad[j] < nVertices;
+                    }
+                    i32 patch[4];
+                    QuadToPatchIndices(static_cast<i32>(quad[0]), static_cast<i32>(quad[1]),
+                                       static_cast<i32>(quad[2]), static_cast<i32>(quad[3]), patch);
+                    out_quadIndices->insert(out_quadIndices->end(), patch, patch + 4);
+                    ptr += count * indexSize;
+                    continue;
+                }
+
+                // Triangulate polygon as a fan, polygons with less than 3 vertices are skipped
+                const i64 i0 = LoadAsInt(ptr, property.type, swapBytes);
+                for (i64 j = 2; j < count; ++j) {
+                    const i64 i1 = LoadAsInt(ptr + (j - 1) * indexSize, property.type, swapBytes);
+                    const i64 i2 = LoadAsInt(ptr + j * indexSize, property.type, swapBytes);
+                    indicesValid &= i0 >= 0 && i0 < nVertices && i1 >= 0 && i1 < nVertices && i2 >= 0 && i2 < nVertices;
+                    out_indices.push_back(static_cast<i32>(i0));
+                    out_indices.push_back(static_cast<i32>(i1));
+                    out_indices.push_back(static_cast<i32>(i2));
+                }
+                ptr += count * indexSize;
+            }
+            if (ptr == nullptr) {
+                PrintPlyError(filename, "unexpected end of file in face element");
+                return false;
+            }
+        }
+    }
+
+    if (indicesValid == false) {
+        PrintPlyError(filename, "vertex index is out of range");
+        return false;
+    }
+    if (out_indices.size() / 3 > static_cast<std::size_t>(std::numeric_limits<i32>::max()) ||
+        (out_quadIndices != nullptr && out_quadIndices->size() / 4 > static_cast<std::size_t>(std::numeric_limits<i32>::max()))) {
+        PrintPlyError(filename, "too many faces");
+        return false;
+    }
+    return true;
+}
+
+#pragma endregion PlyData
+
+} // namespace
+
+
+std::vector<std::shared_ptr<Shape>> LoadPlyMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation, bool quadsAsPatches /*= false*/)
+{
+    MappedFile file;
+    if (file.Open(filename) == false) {
+        PrintPlyError(filename, "cannot open file");
+        return {};
+    }
+    PBR_STATS_VARIABLE_ADD(stats_PlyMapped_bytes, file.Size())
+
+    PlyHeader header;
+    if (ParsePlyHeader(filename, file.Data(), file.Size(), header) == false)
+        return {};
+
+    const bool swapBytes = header.bigEndian != (std::endian::native == std::endian::big);
+    const ui8 *ptr = file.Data() + header.dataOffset;
+    const ui8 *end = file.Data() + file.Size();
+
+    const PlyElement *vertexElement = nullptr, *faceElement = nullptr;
+    const ui8 *vertexData = nullptr, *faceData = nullptr;
+    for (const auto &element : header.elements) {
+        if (element.name == "vertex") {
+            vertexElement = &element;
+            vertexData = ptr;
+        }
+        else if (element.name == "face") {
+            faceElement = &element;
+            faceData = ptr;
+        }
+        // NOTE: Nothing after vertices and faces is needed.
+        if (vertexElement != nullptr && faceElement != nullptr)
+            break;
+
+        ptr = SkipElement(element, ptr, end, swapBytes);
+        if (ptr == nullptr) {
+            PrintPlyError(filename, "unexpected end of file");
+            return {};
+        }
+    }
+
+    if (vertexElement == nullptr || faceElement == nullptr) {
+        PrintPlyError(filename, "file has no vertex or face element");
+        return {};
+    }
+    if (vertexElement->count > std::numeric_limits<i32>::max()) {
+        PrintPlyError(filename, "too many vertices");
+        return {};
+    }
+    // NOTE: The loop above stops before skipping the last of two elements, so its size is not checked yet.
+    //       Faces are checked while decoding, but vertices need to be checked here.
+    if (vertexElement->stride > 0 && (end - vertexData) / vertexElement->stride < vertexElement->count) {
+        PrintPlyError(filename, "unexpected end of file in vertex element");
+        return {};
+    }
+
+    PlyVertices vertices;
+    if (DecodeVertices(filename, *vertexElement, vertexData, swapBytes, vertices) == false)
+        return {};
+
+    std::vector<i32> indices, quadIndices;
+    if (DecodeFaces(filename, *faceElement, faceData, end, swapBytes, vertexElement->count,
+                    indices, quadsAsPatches ? &quadIndices : nullptr) == false)
+        return {};
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPlyMeshes)
+
+    // IMPROVE: Mixed meshes copy vertices to both meshes.
+    std::vector<std::shared_ptr<Shape>> shapes;
+    if (indices.empty() == false)
+        shapes = CreateTriangleMesh(ObjectToWorld, WorldToObject, reverseOrientation,
+                                    static_cast<i32>(indices.size() / 3), indices.data(),
+                                    static_cast<i32>(vertexElement->count), vertices.positions,
+                                    nullptr, vertices.normals, vertices.uv);
+    if (quadIndices.empty() == false) {
+        auto patches = CreateBilinearPatchMesh(ObjectToWorld, WorldToObject, reverseOrientation,
+                                               static_cast<i32>(quadIndices.size() / 4), quadIndices.data(),
+                                               static_cast<i32>(vertexElement->count), vertices.positions,
+                                               vertices.normals, vertices.uv);
+        shapes.insert(shapes.end(), patches.begin(), patches.end());
+    }
+    return shapes;
+}
+
+PBR_NAMESPACE_END
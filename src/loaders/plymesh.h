@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../shapes/triangle.h"
+#include "../shapes/bilinearpatch.h"
+#include <string>
+
+
+PBR_NAMESPACE_BEGIN
+
+// Loads binary(little or big endian) PLY file as a triangle mesh, ASCII PLY is not supported.
+//   Vertex properties x/y/z are required, nx/ny/nz and u/v (or s/t, texture_u/texture_v) are optional.
+//   Polygons with more than 3 vertices are triangulated as fans, except for quads if quadsAsPatches is true,
+//   then every quad becomes one BilinearPatch.
+// NOTE: File is memory mapped, for the most common layout(float x/y/z only) positions are passed to the TriangleMesh
+//       directly from the mapping, otherwise vertices and faces are decoded in parallel.
+// Returns empty vector if the file cannot be loaded, the reason is printed to stderr.
+std::vector<std::shared_ptr<Shape>> LoadPlyMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation, bool quadsAsPatches = false);
+
+PBR_NAMESPACE_END
@@ -0,0 +1,188 @@
+#include "rawmesh.h"
+#include "../core/mappedfile.h"
+#include "../core/parallel.h"
+#include "../core/stats.h"
+
+#include <atomic>
+#include <cstdio>       // std::FILE, std::fprintf
+#include <cstring>      // std::memcmp
+
+
+PBR_NAMESPACE_BEGIN
+
+PBR_STATS_COUNTER("Scene/Raw meshes loaded", stats_nRawMeshes)
+
+// NOTE: Arrays are dumped as is, so there must be no padding inside geometry types.
+static_assert(sizeof(Point3_t) == 3 * sizeof(fp_t) && sizeof(Normal3_t) == 3 * sizeof(fp_t) &&
+              sizeof(Vector3_t) == 3 * sizeof(fp_t) && sizeof(Point2_t) == 2 * sizeof(fp_t));
+static_assert(sizeof(RawMeshHeader) % 8 == 0);
+
+namespace {
+
+constexpr i64 parallelChunkSize = 256 * 1024;
+
+ui64 AlignOffset(ui64 offset)
+{
+    return (offset + PBR_L1_CACHE_LINE_SIZE - 1) & ~ui64(PBR_L1_CACHE_LINE_SIZE - 1);
+}
+
+void PrintRawMeshError(const std::string &filename, const char *message)
+{
+    std::fprintf(stderr, "Raw mesh: %s: %s\n", filename.c_str(), message);
+}
+
+bool WriteArray(std::FILE *file, ui64 &inout_position, ui64 offset, const void *data, ui64 size)
+{
+    static constexpr ui8 zeros[PBR_L1_CACHE_LINE_SIZE] = {};
+    PBR_ASSERT(offset >= inout_position && offset - inout_position < PBR_L1_CACHE_LINE_SIZE)
+
+    if (std::fwrite(zeros, 1, offset - inout_position, file) != offset - inout_position)
+        return false;
+    if (std::fwrite(data, 1, size, file) != size)
+        return false;
+    inout_position = offset + size;
+    return true;
+}
+
+// Checks that [offset, offset + size) is inside the file and properly aligned.
+bool IsValidArray(ui64 offset, ui64 size, ui64 fileSize)
+{
+    return offset % PBR_L1_CACHE_LINE_SIZE == 0 && offset >= sizeof(RawMeshHeader) &&
+           offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+
+bool WriteRawMesh(const std::string &filename,
+                  i32 nTriangles, const i32 *vertexIndices,
+                  i32 nVertices, const Point3_t *positions,
+                  const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv)
+{
+    PBR_ASSERT(nTriangles > 0 && nVertices > 0 && vertexIndices != nullptr && positions != nullptr)
+
+    RawMeshHeader header = {};
+    std::memcpy(header.magic, RawMeshHeader::magicValue, sizeof(header.magic));
+    header.version = RawMeshHeader::currentVersion;
+    header.endianTag = RawMeshHeader::endianTagValue;
+    header.floatSize = sizeof(fp_t);
+    header.nTriangles = nTriangles;
+    header.nVertices = nVertices;
+
+    const ui64 indicesSize = 3 * header.nTriangles * sizeof(i32);
+    const ui64 positionsSize = header.nVertices * sizeof(Point3_t);
+    const ui64 normalsSize = header.nVertices * sizeof(Normal3_t);
+    const ui64 tangentsSize = header.nVertices * sizeof(Vector3_t);
+    const ui64 uvSize = header.nVertices * sizeof(Point2_t);
+
+    ui64 offset = AlignOffset(sizeof(RawMeshHeader));
+    header.indicesOffset = offset;
+    offset = AlignOffset(offset + indicesSize);
+    header.positionsOffset = offset;
+    offset = AlignOffset(offset + positionsSize);
+    if (normals != nullptr) {
+        header.normalsOffset = offset;
+        offset = AlignOffset(offset + normalsSize);
+    }
+    if (tangents != nullptr) {
+        header.tangentsOffset = offset;
+        offset = AlignOffset(offset + tangentsSize);
+    }
+    if (uv != nullptr)
+        header.uvOffset = offset;
+
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    ui64 position = 0;
+    bool success = WriteArray(file, position, 0, &header, sizeof(header)) &&
+                   WriteArray(file, position, header.indicesOffset, vertexIndices, indicesSize) &&
+                   WriteArray(file, position, header.positionsOffset, positions, positionsSize);
+    if (success && normals != nullptr)
+        success = WriteArray(file, position, header.normalsOffset, normals, normalsSize);
+    if (success && tangents != nullptr)
+        success = WriteArray(file, position, header.tangentsOffset, tangents, tangentsSize);
+    if (success && uv != nullptr)
+        success = WriteArray(file, position, header.uvOffset, uv, uvSize);
+
+    return std::fclose(file) == 0 && success;
+}
+
+std::vector<std::shared_ptr<Shape>> LoadRawMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation)
+{
+    MappedFile file;
+    if (file.Open(filename) == false) {
+        PrintRawMeshError(filename, "cannot open file");
+        return {};
+    }
+    if (file.Size() < sizeof(RawMeshHeader)) {
+        PrintRawMeshError(filename, "file is too small");
+        return {};
+    }
+
+    RawMeshHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, RawMeshHeader::magicValue, sizeof(header.magic)) != 0) {
+        PrintRawMeshError(filename, "not a raw mesh file");
+        return {};
+    }
+    if (header.version != RawMeshHeader::currentVersion || header.endianTag != RawMeshHeader::endianTagValue ||
+        header.floatSize != sizeof(fp_t)) {
+        PrintRawMeshError(filename, "file was written by incompatible version or platform");
+        return {};
+    }
+    if (header.nTriangles == 0 || header.nVertices == 0 ||
+        header.nTriangles > ui64(std::numeric_limits<i32>::max()) / 3 ||
+        header.nVertices > ui64(std::numeric_limits<i32>::max())) {
+        PrintRawMeshError(filename, "invalid number of triangles or vertices");
+        return {};
+    }
+
+    const ui64 fileSize = file.Size();
+    const ui64 nVertices = header.nVertices;
+    bool valid = IsValidArray(header.indicesOffset, 3 * header.nTriangles * sizeof(i32), fileSize) &&
+                 IsValidArray(header.positionsOffset, nVertices * sizeof(Point3_t), fileSize);
+    if (header.normalsOffset != 0)
+        valid &= IsValidArray(header.normalsOffset, nVertices * sizeof(Normal3_t), fileSize);
+    if (header.tangentsOffset != 0)
+        valid &= IsValidArray(header.tangentsOffset, nVertices * sizeof(Vector3_t), fileSize);
+    if (header.uvOffset != 0)
+        valid &= IsValidArray(header.uvOffset, nVertices * sizeof(Point2_t), fileSize);
+    if (valid == false) {
+        PrintRawMeshError(filename, "array is out of file bounds");
+        return {};
+    }
+
+    const ui8 *data = file.Data();
+    const i32 *indices = reinterpret_cast<const i32*>(data + header.indicesOffset);
+    const i64 nIndices = 3 * static_cast<i64>(header.nTriangles);
+
+    // NOTE: Indices are the only thing that can break rendering, so they're checked anyway.
+    std::atomic<bool> indicesValid = true;
+    ParallelFor(nIndices, parallelChunkSize, [&](i64 begin, i64 end) {
+        bool chunkValid = true;
+        for (i64 i = begin; i < end; ++i)
+            chunkValid &= indices[i] >= 0 && ui64(indices[i]) < nVertices;
+        if (chunkValid == false)
+            indicesValid = false;
+    });
+    if (indicesValid == false) {
+        PrintRawMeshError(filename, "vertex index is out of range");
+        return {};
+    }
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nRawMeshes)
+
+    auto ArrayOrNull = [data](ui64 offset) { return offset != 0 ? data + offset : nullptr; };
+    return CreateTriangleMesh(ObjectToWorld, WorldToObject, reverseOrientation,
+                              static_cast<i32>(header.nTriangles), indices,
+                              static_cast<i32>(header.nVertices), reinterpret_cast<const Point3_t*>(data + header.positionsOffset),
+                              reinterpret_cast<const Vector3_t*>(ArrayOrNull(header.tangentsOffset)),
+                              reinterpret_cast<const Normal3_t*>(ArrayOrNull(header.normalsOffset)),
+                              reinterpret_cast<const Point2_t*>(ArrayOrNull(header.uvOffset)));
+}
+
+PBR_NAMESPACE_END
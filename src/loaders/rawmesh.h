@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../shapes/triangle.h"
+#include <string>
+
+
+// Raw mesh is an internal binary format, which is basically a dump of TriangleMesh arrays.
+//   File starts with RawMeshHeader, followed by arrays, every array begins at PBR_L1_CACHE_LINE_SIZE aligned offset.
+//   Since mapped file is page aligned, arrays are passed to the TriangleMesh straight from the mapping, without any parsing.
+// NOTE: Values are stored in the byte order and fp_t precision of the machine that wrote the file,
+//       it's a cache format for fast loading, not an exchange format.
+
+
+PBR_NAMESPACE_BEGIN
+
+struct RawMeshHeader
+{
+    static constexpr char magicValue[8] = { 'P', 'B', 'R', 'M', 'E', 'S', 'H', '\0' };
+    static constexpr ui32 currentVersion = 1;
+    static constexpr ui32 endianTagValue = 0x01020304;
+
+    char magic[8];
+    ui32 version;
+    ui32 endianTag;
+    ui32 floatSize;         // sizeof(fp_t) of the writer
+    ui32 reserved;
+    ui64 nTriangles;
+    ui64 nVertices;
+    // Offsets from the beginning of the file, 0 if array is not present.
+    ui64 indicesOffset;
+    ui64 positionsOffset;
+    ui64 normalsOffset;
+    ui64 tangentsOffset;
+    ui64 uvOffset;
+};
+
+
+// Arguments are the same as for CreateTriangleMesh(), except for the transforms.
+//   Returns false if the file cannot be written.
+bool WriteRawMesh(const std::string &filename,
+                  i32 nTriangles, const i32 *vertexIndices,
+                  i32 nVertices, const Point3_t *positions,
+                  const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv);
+
+// Returns empty vector if the file cannot be loaded, the reason is printed to stderr.
+std::vector<std::shared_ptr<Shape>> LoadRawMesh(const std::string &filename,
+                                                const Transform *ObjectToWorld, const Transform *WorldToObject,
+                                                bool reverseOrientation);
+
+PBR_NAMESPACE_END
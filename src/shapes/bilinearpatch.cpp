@@ -0,0 +1,311 @@
+#include "bilinearpatch.h"
+#include "../core/stats.h"
+
+
+// TODO: BilinearPatch::Sample(), SolidAngle() and shading normals from mesh normals are not implemented.
+
+
+PBR_NAMESPACE_BEGIN
+
+// ---------------------------------------
+// ---------- UTILITY FUNCTIONS ----------
+// ---------------------------------------
+
+namespace {
+
+// Real roots of a*t^2 + b*t + c = 0, out_t0 <= out_t1, a can be 0.
+// NOTE: EFloat version from efloat.hpp can't be used here, patch is intersected with plain floats.
+bool SolveQuadratic(fp_t a, fp_t b, fp_t c, fp_t &out_t0, fp_t &out_t1)
+{
+    if (a == 0) {
+        if (b == 0)
+            return false;
+        out_t0 = out_t1 = -c / b;
+        return true;
+    }
+
+    f64 discriminant = f64(b) * f64(b) - 4 * f64(a) * f64(c);
+    if (discriminant < 0)
+        return false;
+    f64 rootDiscriminant = std::sqrt(discriminant);
+    f64 q = b < 0 ? -0.5 * (b - rootDiscriminant) : -0.5 * (b + rootDiscriminant);
+    out_t0 = static_cast<fp_t>(q / a);
+    out_t1 = q != 0 ? static_cast<fp_t>(c / q) : out_t0;
+    if (out_t0 > out_t1)
+        std::swap(out_t0, out_t1);
+    return true;
+}
+
+} // namespace
+
+
+bool IntersectBilinearPatch(const Ray_arg r,
+                            const Point3_arg<fp_t> p00, const Point3_arg<fp_t> p10,
+                            const Point3_arg<fp_t> p01, const Point3_arg<fp_t> p11,
+                            fp_t &out_t, fp_t &out_u, fp_t &out_v)
+{
+    // Find quadratic coefficients for distance from ray to u iso-lines
+    fp_t a = Dot(Cross(p10 - p00, p01 - p11), r.direction);
+    fp_t c = Dot(Cross(p00 - r.origin, r.direction), p01 - p00);
+    fp_t b = Dot(Cross(p10 - r.origin, r.direction), p11 - p10) - (a + c);
+    // Solve quadratic for bilinear patch u intersection
+    fp_t u0, u1;
+    if (SolveQuadratic(a, b, c, u0, u1) == false)
+        return false;
+
+    // Epsilon to make sure that candidate t is greater than zero
+    fp_t eps = Gamma(10) * (MaxComponent(Abs(Vector3_t(r.origin))) + MaxComponent(Abs(r.direction)) +
+                            MaxComponent(Abs(Vector3_t(p00))) + MaxComponent(Abs(Vector3_t(p10))) +
+                            MaxComponent(Abs(Vector3_t(p01))) + MaxComponent(Abs(Vector3_t(p11))));
+
+    // Compute v and t for both u roots, closest valid one wins
+    fp_t t = r.tMax;
+    bool hit = false;
+    for (fp_t u : { u0, u1 }) {
+        if (u < 0 || u > 1 || (hit && u == out_u))
+            continue;
+
+        Point3_t uo = Lerp(u, p00, p10);
+        Vector3_t ud = Lerp(u, p01, p11) - uo;
+        Vector3_t deltao = uo - r.origin;
+        Vector3_t perp = Cross(r.direction, ud);
+        fp_t p2 = perp.LengthSquared();
+        // Numerators of v and t are determinants of [deltao, d, perp] and [deltao, ud, perp]
+        fp_t vNumerator = Dot(deltao, Cross(r.direction, perp));
+        fp_t tNumerator = Dot(deltao, Cross(ud, perp));
+        if (tNumerator > p2 * eps && tNumerator < t * p2 && 0 <= vNumerator && vNumerator <= p2) {
+            t = tNumerator / p2;
+            out_u = u;
+            out_v = vNumerator / p2;
+            hit = true;
+        }
+    }
+    if (hit == false)
+        return false;
+
+    out_t = t;
+    return true;
+}
+
+// NOTE: Same as CreateTriangleMesh().
+std::vector<std::shared_ptr<Shape>> CreateBilinearPatchMesh(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                                                            i32 nPatches, const i32 *vertexIndices,
+                                                            i32 nVertices, const Point3_t *positions,
+                                                            const Normal3_t *normals, const Point2_t *uv)
+{
+    auto mesh = std::make_shared<BilinearPatchMesh>(*ObjectToWorld, nPatches, vertexIndices, nVertices, positions, normals, uv);
+
+    std::vector<std::shared_ptr<Shape>> patches;
+    patches.reserve(nPatches);
+    for (i32 i = 0; i < nPatches; ++i)
+        patches.push_back(std::make_shared<BilinearPatch>(ObjectToWorld, WorldToObject, reverseOrientation, mesh, i));
+
+    return patches;
+}
+
+
+// ******************************************************************************
+// ----------------------------- BilinearPatchMesh ------------------------------
+// ******************************************************************************
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_STATS_MEMORY_COUNTER("Memory/Bilinear patch meshes", stats_BilinearPatchMesh_bytes)
+PBR_STATS_RATIO("Scene/Patches per bilinear patch mesh", stats_nPatches, stats_nPatchMeshes)
+
+BilinearPatchMesh::BilinearPatchMesh(const Transform &ObjectToWorld,
+                                     i32 _nPatches, const i32 *_vertexIndices,
+                                     i32 _nVertices, const Point3_t *_positions,
+                                     const Normal3_t *_normals, const Point2_t *_uv)
+    : nPatches(_nPatches)
+    , nVertices(_nVertices)
+    , vertexIndices(_vertexIndices, _vertexIndices + 4 * _nPatches)
+{
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchMeshes)
+    PBR_STATS_VARIABLE_ADD(stats_nPatches, nPatches)
+    PBR_STATS_VARIABLE_ADD(stats_BilinearPatchMesh_bytes, sizeof(*this) + vertexIndices.size() * sizeof(i32) + nVertices * sizeof(*_positions))
+
+    positions = std::make_unique<Point3_t[]>(nVertices);
+    ObjectToWorld(std::span(_positions, nVertices), std::span(positions.get(), nVertices));
+
+    if (_uv != nullptr) {
+        PBR_STATS_VARIABLE_ADD(stats_BilinearPatchMesh_bytes, nVertices * sizeof(*_uv))
+
+        uv = std::make_unique<Point2_t[]>(nVertices);
+        std::copy(_uv, _uv + nVertices, uv.get());
+    }
+    if (_normals != nullptr) {
+        PBR_STATS_VARIABLE_ADD(stats_BilinearPatchMesh_bytes, nVertices * sizeof(*_normals))
+
+        normals = std::make_unique<Normal3_t[]>(nVertices);
+        ObjectToWorld(std::span(_normals, nVertices), std::span(normals.get(), nVertices));
+    }
+}
+
+
+// ******************************************************************************
+// ------------------------------- BilinearPatch --------------------------------
+// ******************************************************************************
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+BilinearPatch::BilinearPatch(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                             const std::shared_ptr<BilinearPatchMesh> &mesh, i32 patchIndex)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation)
+    , m_mesh(mesh)
+    , m_vIndices(&mesh->vertexIndices[4 * patchIndex])
+{
+    PBR_STATS_VARIABLE_ADD(stats_BilinearPatchMesh_bytes, sizeof(*this))
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+// NOTE: Bilinear patch is inside of the convex hull of its vertices.
+Bounds3_t BilinearPatch::ObjectBound() const
+{
+    return Union(Union(Bounds3_t((*WorldToObject)(m_mesh->positions[m_vIndices[0]]),
+                                 (*WorldToObject)(m_mesh->positions[m_vIndices[1]])),
+                       (*WorldToObject)(m_mesh->positions[m_vIndices[2]])),
+                 (*WorldToObject)(m_mesh->positions[m_vIndices[3]]));
+}
+
+Bounds3_t BilinearPatch::WorldBound() const
+{
+    return Union(Union(Bounds3_t(m_mesh->positions[m_vIndices[0]],
+                                 m_mesh->positions[m_vIndices[1]]),
+                       m_mesh->positions[m_vIndices[2]]),
+                 m_mesh->positions[m_vIndices[3]]);
+}
+
+PBR_STATS_PERCENT("Intersections/Ray-bilinear patch intersection tests", stats_nPatchHits, stats_nPatchTests)
+bool BilinearPatch::Intersect(const Ray_arg r,
+                              fp_t &out_tHit, SurfaceInteraction &out_isect,
+                              bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchTests)
+
+    Point3_t p00 = m_mesh->positions[m_vIndices[0]];
+    Point3_t p10 = m_mesh->positions[m_vIndices[1]];
+    Point3_t p01 = m_mesh->positions[m_vIndices[2]];
+    Point3_t p11 = m_mesh->positions[m_vIndices[3]];
+
+    fp_t t, u, v;
+    if (IntersectBilinearPatch(r, p00, p10, p01, p11, t, u, v) == false)
+        return false;
+
+    // Compute patch point, first and second derivatives at (u,v)
+    Point3_t pHit = Lerp(u, Lerp(v, p00, p01), Lerp(v, p10, p11));
+    Vector3_t dpdu = Lerp(v, p10, p11) - Lerp(v, p00, p01);
+    Vector3_t dpdv = Lerp(u, p01, p11) - Lerp(u, p00, p10);
+    // NOTE: d2p/du2 and d2p/dv2 are always zero for bilinear patch.
+    Vector3_t d2pduu(0, 0, 0), d2pdvv(0, 0, 0);
+    Vector3_t d2pduv = (p00 - p01) + (p11 - p10);
+
+    Point2_t uvHit(u, v);
+    // NOTE: Mesh uv is never compact, see BilinearPatchMesh.
+    if (m_mesh->uv != nullptr) {
+        // Change parametrization from patch (u,v) to mesh (s,t)
+        Point2_t uv00 = m_mesh->uv[m_vIndices[0]];
+        Point2_t uv10 = m_mesh->uv[m_vIndices[1]];
+        Point2_t uv01 = m_mesh->uv[m_vIndices[2]];
+        Point2_t uv11 = m_mesh->uv[m_vIndices[3]];
+        uvHit = uv00 * ((1 - u) * (1 - v)) + uv10 * (u * (1 - v)) + uv01 * ((1 - u) * v) + uv11 * (u * v);
+
+        Vector2_t dstdu = (uv10 * (1 - v) + uv11 * v) - (uv00 * (1 - v) + uv01 * v);
+        Vector2_t dstdv = (uv01 * (1 - u) + uv11 * u) - (uv00 * (1 - u) + uv10 * u);
+        fp_t duds = std::abs(dstdu.x) < fp_t(1e-8) ? 0 : 1 / dstdu.x;
+        fp_t dvds = std::abs(dstdv.x) < fp_t(1e-8) ? 0 : 1 / dstdv.x;
+        fp_t dudt = std::abs(dstdu.y) < fp_t(1e-8) ? 0 : 1 / dstdu.y;
+        fp_t dvdt = std::abs(dstdv.y) < fp_t(1e-8) ? 0 : 1 / dstdv.y;
+
+        Vector3_t dpds = dpdu * duds + dpdv * dvds;
+        Vector3_t dpdt = dpdu * dudt + dpdv * dvdt;
+        // FINDOUT: Degenerate uv keeps patch parametrization, same as Triangle falls back to CoordinateSystem().
+        if (Cross(dpds, dpdt).LengthSquared() != 0) {
+            // Flip dpdt if needed, so the normal keeps its orientation
+            if (Dot(Cross(dpdu, dpdv), Cross(dpds, dpdt)) < 0)
+                dpdt = -dpdt;
+            dpdu = dpds;
+            dpdv = dpdt;
+
+            Vector3_t d2pdss = d2pduv * (2 * duds * dvds);
+            Vector3_t d2pdst = d2pduv * (duds * dvdt + dudt * dvds);
+            Vector3_t d2pdtt = d2pduv * (2 * dudt * dvdt);
+            d2pduu = d2pdss;
+            d2pduv = d2pdst;
+            d2pdvv = d2pdtt;
+        }
+    }
+
+    // Compute coefficients for fundamental forms, same as for Sphere
+    fp_t E = Dot(dpdu, dpdu);
+    fp_t F = Dot(dpdu, dpdv);
+    fp_t G = Dot(dpdv, dpdv);
+    Vector3_t N = Normalize(Cross(dpdu, dpdv));
+    fp_t e = Dot(N, d2pduu);
+    fp_t f = Dot(N, d2pduv);
+    fp_t g = Dot(N, d2pdvv);
+    // Compute partial derivatives of normal vectors from fundamental form coefficients
+    fp_t EGF2 = E * G - F * F;
+    fp_t invEGF2 = EGF2 == 0 ? fp_t(0) : fp_t(1) / EGF2;
+    Normal3_t dndu((f * F - e * G) * invEGF2 * dpdu + (e * F - f * E) * invEGF2 * dpdv);
+    Normal3_t dndv((g * F - f * G) * invEGF2 * dpdu + (f * F - g * E) * invEGF2 * dpdv);
+
+    // Error bounds for bilinear interpolation of the vertices
+    Vector3_t pError = Gamma(6) * Vector3_t(Max(Max(Abs(p00), Abs(p10)), Max(Abs(p01), Abs(p11))));
+
+    out_tHit = t;
+    out_isect = SurfaceInteraction(pHit, pError, uvHit, -r.direction,
+                                   dpdu, dpdv, dndu, dndv,
+                                   r.time, this);
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchHits)
+
+    return true;
+}
+
+bool BilinearPatch::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchTests)
+
+    fp_t t, u, v;
+    if (IntersectBilinearPatch(r, m_mesh->positions[m_vIndices[0]], m_mesh->positions[m_vIndices[1]],
+                               m_mesh->positions[m_vIndices[2]], m_mesh->positions[m_vIndices[3]], t, u, v) == false)
+        return false;
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchHits)
+
+    return true;
+}
+
+fp_t BilinearPatch::Area() const
+{
+    Point3_t p00 = m_mesh->positions[m_vIndices[0]];
+    Point3_t p10 = m_mesh->positions[m_vIndices[1]];
+    Point3_t p01 = m_mesh->positions[m_vIndices[2]];
+    Point3_t p11 = m_mesh->positions[m_vIndices[3]];
+
+    // Midpoint rule over |dp/du x dp/dv|, which is constant for parallelograms
+    constexpr i32 n = 8;
+    fp_t area = 0;
+    for (i32 i = 0; i < n; ++i)
+        for (i32 j = 0; j < n; ++j) {
+            fp_t u = (i + fp_t(0.5)) / n;
+            fp_t v = (j + fp_t(0.5)) / n;
+            Vector3_t dpdu = Lerp(v, p10, p11) - Lerp(v, p00, p01);
+            Vector3_t dpdv = Lerp(u, p01, p11) - Lerp(u, p00, p10);
+            area += Cross(dpdu, dpdv).Length();
+        }
+    return area / (n * n);
+}
+
+PBR_NAMESPACE_END
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../core/shape.h"
+#include <memory>
+#include <vector>
+
+
+// NOTE: Bilinear patch is from pbrt-v4, intersection is "Cool Patches: A Geometric Approach to Ray/Bilinear Patch Intersections" by Reshetov.
+//       One quad is one primitive, instead of two triangles, and there is no diagonal seam.
+
+
+PBR_NAMESPACE_BEGIN
+
+// TODO: Alpha mask is not implemented.
+struct BilinearPatchMesh
+{
+    BilinearPatchMesh(const Transform &ObjectToWorld,
+                      i32 _nPatches, const i32 *_vertexIndices,
+                      i32 _nVertices, const Point3_t *_positions,
+                      const Normal3_t *_normals, const Point2_t *_uv);
+
+    const i32 nPatches, nVertices;
+    // 4 indices per patch in p00, p10, p01, p11 order. NOTE: It's not the order of quad vertices around its boundary.
+    std::vector<i32> vertexIndices;
+    // An array of $nVertices$ vertex positions, in world space.
+    std::unique_ptr<Point3_t[]> positions;
+    // An optional array of normal vectors, one per vertex in the mesh.
+    std::unique_ptr<Normal3_t[]> normals;
+    // An optional array of parametric(u,v) values, one per vertex.
+    // NOTE: Always full precision, there is no compact form like in TriangleMesh, so patches read it directly.
+    std::unique_ptr<Point2_t[]> uv;
+};
+
+
+class BilinearPatch : public Shape
+{
+public:
+    BilinearPatch(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                  const std::shared_ptr<BilinearPatchMesh> &mesh, i32 patchIndex);
+
+
+    Bounds3_t ObjectBound() const override;
+    Bounds3_t WorldBound() const override;
+
+    using Shape::Intersect;
+    // NOTE: testAlphaTexture is not used
+    bool Intersect(const Ray_arg r,
+                   fp_t &out_tHit, SurfaceInteraction &out_isect,
+                   bool /*testAlphaTexture = true*/) const override;
+    // NOTE: testAlphaTexture is not used
+    bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
+
+    // NOTE: Exact only for planar patches, otherwise it's numerical approximation.
+    fp_t Area() const override;
+
+
+private:
+    std::shared_ptr<BilinearPatchMesh> m_mesh;
+    // Pointer to four patch vertex indices in the mesh.
+    const i32 *m_vIndices;
+};
+
+
+// Ray/patch intersection in the space of the given points, returns hit distance and (u,v) of the hit point on the patch.
+bool IntersectBilinearPatch(const Ray_arg r,
+                            const Point3_arg<fp_t> p00, const Point3_arg<fp_t> p10,
+                            const Point3_arg<fp_t> p01, const Point3_arg<fp_t> p11,
+                            fp_t &out_t, fp_t &out_u, fp_t &out_v);
+
+// vertexIndices contains 4 indices per patch in p00, p10, p01, p11 order.
+std::vector<std::shared_ptr<Shape>> CreateBilinearPatchMesh(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                                                            i32 nPatches, const i32 *vertexIndices,
+                                                            i32 nVertices, const Point3_t *positions,
+                                                            const Normal3_t *normals, const Point2_t *uv);
+
+// Converts quad, given by its vertices in the boundary order, to the p00, p10, p01, p11 order of the patch.
+inline void QuadToPatchIndices(i32 v0, i32 v1, i32 v2, i32 v3, i32 out_indices[4])
+{
+    out_indices[0] = v0;
+    out_indices[1] = v1;
+    out_indices[2] = v3;
+    out_indices[3] = v2;
+}
+
+PBR_NAMESPACE_END
@@ -25,14 +25,11 @@ Cone::Cone(const Transform *ObjectToWorld, const Transform *WorldToObject, bool
 
 Bounds3_t Cone::ObjectBound() const
 {
-    return Bounds3_t(Point3_t(-m_radius, -m_radius, 0),
-                     Point3_t( m_radius,  m_radius, m_height));
+    return RevolutionBounds(0, m_radius, 0, m_phiMax, 0, m_height);
 }
 
-// NOTE: testAlphaTexture is not used
-bool Cone::Intersect(const Ray_arg r,
-                     fp_t &out_tHit, SurfaceInteraction &out_isect,
-                     bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Cone::IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
 
@@ -41,24 +38,24 @@ bool Cone::Intersect(const Ray_arg r,
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-    EFloat e_height(m_height);
-    EFloat k = EFloat(m_radius) / e_height;
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float e_height(m_height);
+    Float k = Float(m_radius) / e_height;
     k = k * k;
     // Compute quadratic tConeHit coefficients
-    EFloat a = dx * dx + dy * dy - k * dz * dz;
-    EFloat b = 2 * (dx * ox + dy * oy - k * dz * (oz - e_height));
-    EFloat c = ox * ox + oy * oy - k * (oz - e_height) * (oz - e_height);
+    Float a = dx * dx + dy * dy - k * dz * dz;
+    Float b = 2 * (dx * ox + dy * oy - k * dz * (oz - e_height));
+    Float c = ox * ox + oy * oy - k * (oz - e_height) * (oz - e_height);
 
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tConeHit = t0;
+    Float tConeHit = t0;
     if (tConeHit.LowerBound() <= 0) {
         tConeHit = t1;
         if (tConeHit.UpperBound() > ray.tMax)
@@ -66,7 +63,7 @@ bool Cone::Intersect(const Ray_arg r,
     }
    // Compute cone hit(intersection) point and phi
     Point3_t pHit = ray(fp_t(tConeHit));
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
     if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
@@ -78,7 +75,7 @@ bool Cone::Intersect(const Ray_arg r,
         tConeHit = t1;
         // Compute cone hit(intersection) point and phi
         pHit = ray(fp_t(tConeHit));
-        phi = pbr::ATan2(pHit.y, pHit.x);
+        phi = shapemath::ATan2(pHit.y, pHit.x);
         if (phi < 0) phi += constants::pi_t * 2;
         if (pHit.z < 0 || pHit.z > m_height || phi > m_phiMax)
             return false;
@@ -113,9 +110,9 @@ bool Cone::Intersect(const Ray_arg r,
     // NOTE: This thing is nessesary for SurfaceConstruction anyway.
 //#if PBR_PBR_ENABLE_EFLOAT == 1
     // Compute error bounds for cone intersection
-    EFloat px = ox + tConeHit * dx;
-    EFloat py = oy + tConeHit * dy;
-    EFloat pz = oz + tConeHit * dz;
+    Float px = ox + tConeHit * dx;
+    Float py = oy + tConeHit * dy;
+    Float pz = oz + tConeHit * dz;
     Vector3_t pError(px.GetAbsoluteError(), py.GetAbsoluteError(), pz.GetAbsoluteError());
 //#endif
 
@@ -128,8 +125,8 @@ bool Cone::Intersect(const Ray_arg r,
     return true;
 }
 
-// NOTE: testAlphaTexture is not used
-bool Cone::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Cone::IsIntersectingWith(const Ray_arg r) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
 
@@ -138,56 +135,74 @@ bool Cone::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) con
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-    EFloat e_height(m_height);
-    EFloat k = EFloat(m_radius) / e_height;
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float e_height(m_height);
+    Float k = Float(m_radius) / e_height;
     k = k * k;
     // Compute quadratic tConeHit coefficients
-    EFloat a = dx * dx + dy * dy - k * dz * dz;
-    EFloat b = 2 * (dx * ox + dy * oy - k * dz * (oz - e_height));
-    EFloat c = ox * ox + oy * oy - k * (oz - e_height) * (oz - e_height);
+    Float a = dx * dx + dy * dy - k * dz * dz;
+    Float b = 2 * (dx * ox + dy * oy - k * dz * (oz - e_height));
+    Float c = ox * ox + oy * oy - k * (oz - e_height) * (oz - e_height);
 
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tConeHit = t0;
+    Float tConeHit = t0;
     if (tConeHit.LowerBound() <= 0) {
         tConeHit = t1;
         if (tConeHit.UpperBound() > ray.tMax)
             return false;
     }
-   // Compute cone hit(intersection) point and phi
+   // Compute cone hit(intersection) point
     Point3_t pHit = ray(fp_t(tConeHit));
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-    if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
     // Test cone intersection against clipping parametrs
-    if (pHit.z < 0 || pHit.z > m_height || phi > m_phiMax) {
+    if (pHit.z < 0 || pHit.z > m_height || IsPhiClipped(pHit, m_phiMax)) {
         // DIFFERENCE: Why the fuck they changed this check in all shapes after sphere in the book?
         if (tConeHit == t1 || t1.UpperBound() > ray.tMax)
             return false;
         tConeHit = t1;
-        // Compute cone hit(intersection) point and phi
+        // Compute cone hit(intersection) point
         pHit = ray(fp_t(tConeHit));
-        phi = pbr::ATan2(pHit.y, pHit.x);
-        if (phi < 0) phi += constants::pi_t * 2;
-        if (pHit.z < 0 || pHit.z > m_height || phi > m_phiMax)
+        if (pHit.z < 0 || pHit.z > m_height || IsPhiClipped(pHit, m_phiMax))
             return false;
     }
 
     return true;
 }
 
+// NOTE: testAlphaTexture is not used
+bool Cone::Intersect(const Ray_arg r,
+                     fp_t &out_tHit, SurfaceInteraction &out_isect,
+                     bool /*testAlphaTexture = true*/) const
+{
+    return IntersectWith<QuadricFloat>(r, out_tHit, out_isect);
+}
+
+// NOTE: testAlphaTexture is not used
+bool Cone::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    return IsIntersectingWith<QuadricFloat>(r);
+}
+
 // NOTE: Doesn't count base(circle) area
 fp_t Cone::Area() const
 {
     return m_radius * pbr::Sqrt(m_height * m_height + m_radius * m_radius) * m_phiMax / 2;
 }
 
+
+template bool Cone::IntersectWith<EFloatT<true>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cone::IntersectWith<EFloatT<false>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cone::IntersectWith<RawFloat>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cone::IsIntersectingWith<EFloatT<true>>(const Ray_arg r) const;
+template bool Cone::IsIntersectingWith<EFloatT<false>>(const Ray_arg r) const;
+template bool Cone::IsIntersectingWith<RawFloat>(const Ray_arg r) const;
+
 PBR_NAMESPACE_END
@@ -14,6 +14,7 @@ public:
 
     Bounds3_t ObjectBound() const override;
 
+    using Shape::Intersect;
     // NOTE: testAlphaTexture is not used
     bool Intersect(const Ray_arg r,
                    fp_t &out_tHit, SurfaceInteraction &out_isect,
@@ -21,6 +22,13 @@ public:
     // NOTE: testAlphaTexture is not used
     bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
 
+    // Float is the arithmetic used for quadratic coefficients, see efloat.hpp. Intersect() and IsIntersecting() use QuadricFloat.
+    //   Instantiated for EFloatT<true>, EFloatT<false> and RawFloat.
+    template<typename Float>
+    bool IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+    template<typename Float>
+    bool IsIntersectingWith(const Ray_arg r) const;
+
     fp_t Area() const override;
 
 
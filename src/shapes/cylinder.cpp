@@ -25,17 +25,13 @@ Cylinder::Cylinder(const Transform *ObjectToWorld, const Transform *WorldToObjec
 // --------------- METHODS ---------------
 // ---------------------------------------
 
-// TODO: Can be improved as stated in 3.3.1 chapter
 Bounds3_t Cylinder::ObjectBound() const
 {
-    return Bounds3_t(Point3_t(-m_radius, -m_radius, m_zMin),
-                     Point3_t( m_radius,  m_radius, m_zMax));
+    return RevolutionBounds(m_radius, m_radius, 0, m_phiMax, m_zMin, m_zMax);
 }
 
-// NOTE: testAlphaTexture is not used
-bool Cylinder::Intersect(const Ray_arg r,
-                         fp_t &out_tHit, SurfaceInteraction &out_isect,
-                         bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Cylinder::IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
 
@@ -44,20 +40,20 @@ bool Cylinder::Intersect(const Ray_arg r,
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y);
     // Compute quadratic cylinder coefficients
-    EFloat a = dx * dx + dy * dy;
-    EFloat b = 2 * (dx * ox + dy * oy);
-    EFloat c = ox * ox + oy * oy - EFloat(m_radius) * EFloat(m_radius);
+    Float a = dx * dx + dy * dy;
+    Float b = 2 * (dx * ox + dy * oy);
+    Float c = ox * ox + oy * oy - Float(m_radius) * Float(m_radius);
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tCylinderHit = t0;
+    Float tCylinderHit = t0;
     if (tCylinderHit.LowerBound() <= 0) {
         tCylinderHit = t1;
         if (tCylinderHit.UpperBound() > ray.tMax)
@@ -67,11 +63,11 @@ bool Cylinder::Intersect(const Ray_arg r,
     Point3_t pHit = ray(fp_t(tCylinderHit));
 //#if PBR_PBR_ENABLE_EFLOAT == 1
     // Refine cylinder intersection point
-    fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y + pHit.y);
+    fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y * pHit.y);
     pHit.x *= m_radius / hitRadius;
     pHit.y *= m_radius / hitRadius;
 //#endif
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
     if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
@@ -84,10 +80,10 @@ bool Cylinder::Intersect(const Ray_arg r,
         // Compute cylinder hit(intersection) point and phi
         pHit = ray(fp_t(tCylinderHit));
         // Refine cylinder intersection point
-        fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y + pHit.y);
+        fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y * pHit.y);
         pHit.x *= m_radius / hitRadius;
         pHit.y *= m_radius / hitRadius;
-        phi = pbr::ATan2(pHit.y, pHit.x);
+        phi = shapemath::ATan2(pHit.y, pHit.x);
         if (phi < 0) phi += constants::pi_t * 2;
         if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
             return false;
@@ -134,8 +130,8 @@ bool Cylinder::Intersect(const Ray_arg r,
     return true;
 }
 
-// NOTE: testAlphaTexture is not used
-bool Cylinder::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Cylinder::IsIntersectingWith(const Ray_arg r) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
 
@@ -144,61 +140,70 @@ bool Cylinder::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/)
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y);
     // Compute quadratic cylinder coefficients
-    EFloat a = dx * dx + dy * dy;
-    EFloat b = 2 * (dx * ox + dy * oy);
-    EFloat c = ox * ox + oy * oy - EFloat(m_radius) * EFloat(m_radius);
+    Float a = dx * dx + dy * dy;
+    Float b = 2 * (dx * ox + dy * oy);
+    Float c = ox * ox + oy * oy - Float(m_radius) * Float(m_radius);
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tCylinderHit = t0;
+    Float tCylinderHit = t0;
     if (tCylinderHit.LowerBound() <= 0) {
         tCylinderHit = t1;
         if (tCylinderHit.UpperBound() > ray.tMax)
             return false;
     }
-    // Compute cylinder hit(intersection) point and phi
+    // Compute cylinder hit(intersection) point
+    // NOTE: Hit point isn't refined, refinement scales x and y only, it changes neither z nor phi.
     Point3_t pHit = ray((fp_t)tCylinderHit);
-//#if PBR_PBR_ENABLE_EFLOAT == 1
-    // Refine cylinder intersection point
-    fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y + pHit.y);
-    pHit.x *= m_radius / hitRadius;
-    pHit.y *= m_radius / hitRadius;
-//#endif
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-    if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
     // Test cylinder intersection against clipping parametrs
-    if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax) {
+    if (pHit.z < m_zMin || pHit.z > m_zMax || IsPhiClipped(pHit, m_phiMax)) {
         if (tCylinderHit == t1 || t1.UpperBound() > ray.tMax)
             return false;
         tCylinderHit = t1;
-        // Compute sphere hit(intersection) point and phi
+        // Compute cylinder hit(intersection) point
         pHit = ray((fp_t)tCylinderHit);
-        // Refine cylinder intersection point
-        fp_t hitRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y + pHit.y);
-        pHit.x *= m_radius / hitRadius;
-        pHit.y *= m_radius / hitRadius;
-        fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-        if (phi < 0) phi += constants::pi_t * 2;
-        if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
+        if (pHit.z < m_zMin || pHit.z > m_zMax || IsPhiClipped(pHit, m_phiMax))
             return false;
     }
 
     return true;
 }
 
+// NOTE: testAlphaTexture is not used
+bool Cylinder::Intersect(const Ray_arg r,
+                         fp_t &out_tHit, SurfaceInteraction &out_isect,
+                         bool /*testAlphaTexture = true*/) const
+{
+    return IntersectWith<QuadricFloat>(r, out_tHit, out_isect);
+}
+
+// NOTE: testAlphaTexture is not used
+bool Cylinder::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    return IsIntersectingWith<QuadricFloat>(r);
+}
+
 // NOTE: Doesn't count top and bottom circle area.
 fp_t Cylinder::Area() const
 {
     return m_phiMax * m_radius * (m_zMax - m_zMin);
 }
 
+
+template bool Cylinder::IntersectWith<EFloatT<true>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cylinder::IntersectWith<EFloatT<false>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cylinder::IntersectWith<RawFloat>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Cylinder::IsIntersectingWith<EFloatT<true>>(const Ray_arg r) const;
+template bool Cylinder::IsIntersectingWith<EFloatT<false>>(const Ray_arg r) const;
+template bool Cylinder::IsIntersectingWith<RawFloat>(const Ray_arg r) const;
+
 PBR_NAMESPACE_END
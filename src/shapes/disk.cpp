@@ -24,11 +24,9 @@ Disk::Disk(const Transform *ObjectToWorld, const Transform *WorldToObject, bool
 // --------------- METHODS ---------------
 // ---------------------------------------
 
-// TODO: Can be improved as stated in 3.3.1 chapter
 Bounds3_t Disk::ObjectBound() const
 {
-    return Bounds3_t(Point3_t(-m_radius, -m_radius, m_height),
-                     Point3_t( m_radius,  m_radius, m_height));
+    return RevolutionBounds(m_innerRadius, m_radius, 0, m_phiMax, m_height, m_height);
 }
 
 // NOTE: Don't understand how this whole thing with disk work.
@@ -59,7 +57,7 @@ bool Disk::Intersect(const Ray_arg r,
     // Refine disk intersection point
     pHit.z = m_height;
 //#endif
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
     if (phi < 0) phi += constants::pi_t * 2;
     if (phi > m_phiMax)
         return false;
@@ -95,9 +93,8 @@ bool Disk::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) con
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
 
-    // Transform ray to object space
-    Vector3_t oError, dError;
-    Ray ray = (*WorldToObject)(r, oError, dError);
+    // Transform ray to object space, error bounds aren't used by disk
+    Ray ray = (*WorldToObject)(r);
 
     // Reject disk intersection for rays parallel to the disk's plane
     if (ray.direction.z == 0)
@@ -106,18 +103,13 @@ bool Disk::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) con
     if (tDiskHit <= 0 || tDiskHit >= ray.tMax)
         return false;
 
-    // Compute cylinder hit(intersection) point and phi
+    // Compute disk hit(intersection) point
     Point3_t pHit = ray(tDiskHit);
     fp_t dist2 = pHit.x * pHit.x + pHit.y * pHit.y;
     if (dist2 > m_radius * m_radius || dist2 < m_innerRadius * m_innerRadius)
         return false;
 
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-    if (phi < 0) phi += constants::pi_t * 2;
-    if (phi > m_phiMax)
-        return false;
-
-    return true;
+    return !IsPhiClipped(pHit, m_phiMax);
 }
 
 fp_t Disk::Area() const
@@ -14,6 +14,7 @@ public:
 
     Bounds3_t ObjectBound() const override;
 
+    using Shape::Intersect;
     // NOTE: testAlphaTexture is not used
     bool Intersect(const Ray_arg r,
                    fp_t &out_tHit, SurfaceInteraction &out_isect,
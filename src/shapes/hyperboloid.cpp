@@ -10,193 +10,267 @@ PBR_NAMESPACE_BEGIN
 // ---------------------------------------
 
 // FINDOUT: Without std::clamp() and min()/max() ?
-// Hyperboloid::Hyperboloid(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
-//                          Point3_arg<fp_t> point1, Point3_arg<fp_t> point2, fp_t tm)
-//     : Shape(ObjectToWorld, WorldToObject, reverseOrientation)
-//     , m_point1(point1)
-//     , m_point2(point2)
-//     , m_zMin(std::min(point1.z, point2.z))
-//     , m_zMax(std::max(point1.z, point2.z))
-//     , m_phiMax(pbr::Radians(std::clamp(tm, fp_t(0), fp_t(360))))
-// {
-//     fp_t radius1 = pbr::Sqrt(point1.x * point1.x + point1.y * point1.y);
-//     fp_t radius2 = pbr::Sqrt(point2.x * point2.x + point2.y * point2.y);
-//     m_rMax = std::max(radius1, radius2);
+Hyperboloid::Hyperboloid(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                         const Point3_arg<fp_t> point1, const Point3_arg<fp_t> point2, fp_t phiMax)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation)
+    , m_point1(point1)
+    , m_point2(point2)
+    , m_zMin(std::min(point1.z, point2.z))
+    , m_zMax(std::max(point1.z, point2.z))
+    , m_phiMax(pbr::Radians(std::clamp(phiMax, fp_t(0), fp_t(360))))
+{
+    fp_t radius1 = pbr::Sqrt(point1.x * point1.x + point1.y * point1.y);
+    fp_t radius2 = pbr::Sqrt(point2.x * point2.x + point2.y * point2.y);
+    m_rMax = std::max(radius1, radius2);
+    // NOTE: Segment in the same plane with z axis gives a cone, which has no such implicit form, Cone shape should be used instead.
+    PBR_ASSERT_MSG(point1.x * point2.y - point1.y * point2.x != 0 || radius1 == radius2,
+        "hyperboloid segment lies in the plane with z axis, it's a cone")
 
+    // Compute implicit function coefficients for hyperboloid
+    // NOTE: Second point is used as a divisor, so it can't be at z = 0.
+    PBR_ASSERT_MSG(point1.z != 0 || point2.z != 0, "hyperboloid segment lies in the plane z = 0")
+    PBR_ASSERT_MSG(point1 != point2, "hyperboloid segment has zero length")
+    if (m_point2.z == 0)
+        std::swap(m_point1, m_point2);
+    Point3_t pp = m_point1;
+    fp_t xy1, xy2;
+    // FINDOUT: Why the book moves the point along the segment until coefficients are finite ?
+    // NOTE: Lines through the origin never get finite coefficients, so the number of steps is limited.
+    constexpr i32 maxSteps = 64;
+    i32 step = 0;
+    do {
+        pp += fp_t(2) * (m_point2 - m_point1);
+        xy1 = pp.x * pp.x + pp.y * pp.y;
+        xy2 = m_point2.x * m_point2.x + m_point2.y * m_point2.y;
+        m_ah = (1 / xy1 - (pp.z * pp.z) / (xy1 * m_point2.z * m_point2.z)) /
+               (1 - (xy2 * pp.z * pp.z) / (xy1 * m_point2.z * m_point2.z));
+        m_ch = (m_ah * xy2 - 1) / (m_point2.z * m_point2.z);
+    } while ((std::isinf(m_ah) || std::isnan(m_ah) || std::isinf(m_ch) || std::isnan(m_ch)) && ++step < maxSteps);
 
-// }
+    if (step == maxSteps) {
+        PBR_ASSERT_MSG(false, "hyperboloid segment has no implicit form with the waist at z = 0")
+        // Release builds get an empty shape, see IsEmpty()
+        m_ah = 0;
+        m_ch = 0;
+    }
+}
 
 
 // ---------------------------------------
 // --------------- METHODS ---------------
 // ---------------------------------------
 
-// Bounds3_t Hyperboloid::ObjectBound() const
-// {
-//     // NOTE: Is this the answer for sphere bounds computation excersice ?
-//     return Bounds3_t(Point3_t(-m_rMax, -m_rMax, m_zMin),
-//                      Point3_t( m_rMax,  m_rMax, m_zMax));
-// }
+// NOTE: Phi of the hit is measured from the segment point at the same height, see HitPhi(),
+//       so the surface covers angles from the smallest angle of the segment to its largest angle + phiMax.
+Bounds3_t Hyperboloid::ObjectBound() const
+{
+    // Angle of the segment point changes monotonically and by less than pi, segment doesn't cross z axis
+    const fp_t angle1 = pbr::ATan2(m_point1.y, m_point1.x);
+    fp_t angle2 = pbr::ATan2(m_point2.y, m_point2.x);
+    if (angle2 - angle1 > constants::pi_t) angle2 -= 2 * constants::pi_t;
+    if (angle1 - angle2 > constants::pi_t) angle2 += 2 * constants::pi_t;
+
+    // Smallest radius is the distance from z axis to the segment, it's the waist of the hyperboloid
+    const fp_t dx = m_point2.x - m_point1.x, dy = m_point2.y - m_point1.y;
+    const fp_t length2 = dx * dx + dy * dy;
+    const fp_t v = length2 > 0 ? std::clamp(-(m_point1.x * dx + m_point1.y * dy) / length2, fp_t(0), fp_t(1)) : fp_t(0);
+    const fp_t xWaist = m_point1.x + v * dx, yWaist = m_point1.y + v * dy;
+    const fp_t rMin = pbr::Sqrt(xWaist * xWaist + yWaist * yWaist);
+
+    return RevolutionBounds(rMin, m_rMax, std::min(angle1, angle2), std::max(angle1, angle2) + m_phiMax, m_zMin, m_zMax);
+}
+
+fp_t Hyperboloid::HitPhi(const Point3_arg<fp_t> pHit) const
+{
+    fp_t v = (pHit.z - m_point1.z) / (m_point2.z - m_point1.z);
+    fp_t prX = (1 - v) * m_point1.x + v * m_point2.x;
+    fp_t prY = (1 - v) * m_point1.y + v * m_point2.y;
+    fp_t phi = shapemath::ATan2(prX * pHit.y - pHit.x * prY, pHit.x * prX + pHit.y * prY);
+    if (phi < 0) phi += constants::pi_t * 2;
+    return phi;
+}
+
+template<typename Float>
+bool Hyperboloid::IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
+    if (IsEmpty())
+        return false;
+
+    // Transform ray to object space
+    Vector3_t oError, dError;
+    Ray ray = (*WorldToObject)(r, oError, dError);
+
+    // Initialize EFloat ray coordinate values;
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float ah(m_ah), ch(m_ch);
+    // Compute quadratic tHyperboloidHit coefficients
+    Float a = ah * dx * dx + ah * dy * dy - ch * dz * dz;
+    Float b = 2 * (ah * dx * ox + ah * dy * oy - ch * dz * oz);
+    Float c = ah * ox * ox + ah * oy * oy - ch * oz * oz - Float(1);
+
+    // Solve quadratic equation
+    Float t0, t1;
+    if (Quadratic(a, b, c, t0, t1) == false)
+        return false;
+    // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
+    if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
+        return false;
+    Float tHyperboloidHit = t0;
+    if (tHyperboloidHit.LowerBound() <= 0) {
+        tHyperboloidHit = t1;
+        if (tHyperboloidHit.UpperBound() > ray.tMax)
+            return false;
+    }
+    // Compute hyperboloid hit(intersection) point and phi
+    Point3_t pHit = ray(fp_t(tHyperboloidHit));
+    fp_t phi = HitPhi(pHit);
+
+    // Test hyperboloid intersection against clipping parametrs
+    if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax) {
+        if (tHyperboloidHit == t1 || t1.UpperBound() > ray.tMax)
+            return false;
+        tHyperboloidHit = t1;
+        // Compute hyperboloid hit(intersection) point and phi
+        pHit = ray(fp_t(tHyperboloidHit));
+        phi = HitPhi(pHit);
+        if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
+            return false;
+    }
+
+    // Find parametric representation of hyperboloid hit
+    fp_t u = phi / m_phiMax;
+    fp_t v = (pHit.z - m_point1.z) / (m_point2.z - m_point1.z);
+    // Compute hyperboloid dpdu and dpdv
+    fp_t sinPhi, cosPhi;
+    shapemath::SinCos(phi, sinPhi, cosPhi);
+    const Vector3_t segment = m_point2 - m_point1;
+    Vector3_t dpdu(-m_phiMax * pHit.y, m_phiMax * pHit.x, 0);
+    Vector3_t dpdv(segment.x * cosPhi - segment.y * sinPhi,
+                   segment.x * sinPhi + segment.y * cosPhi,
+                   segment.z);
+
+    // Compute hyperboloid derivatives, second derivative by v is zero, surface is ruled
+    Vector3_t d2pduu = -m_phiMax * m_phiMax * Vector3_t(pHit.x, pHit.y, 0);
+    Vector3_t d2pduv = m_phiMax * Vector3_t(-dpdv.y, dpdv.x, 0);
+    // Compute coefficients for fundamental forms
+    fp_t E = Dot(dpdu, dpdu);
+    fp_t F = Dot(dpdu, dpdv);
+    fp_t G = Dot(dpdv, dpdv);
+    Vector3_t N = Normalize(Cross(dpdu, dpdv)); // NOTE: This vector will be computed again in SurfaceInteraction constructor.
+    fp_t e = Dot(N, d2pduu);
+    fp_t f = Dot(N, d2pduv);
+    // Compute Partial derivatives of Noprmal Vectors from fundamental form coefficients, g = 0
+    fp_t invEGF2 = fp_t(1) / (E * G - F * F);
+    Normal3_t dndu((f * F - e * G) * invEGF2 * dpdu + (e * F - f * E) * invEGF2 * dpdv);
+    Normal3_t dndv((-f * G) * invEGF2 * dpdu + (f * F) * invEGF2 * dpdv);
+
+    // Compute error bounds for hyperboloid intersection
+    Float px = ox + tHyperboloidHit * dx;
+    Float py = oy + tHyperboloidHit * dy;
+    Float pz = oz + tHyperboloidHit * dz;
+    Vector3_t pError(px.GetAbsoluteError(), py.GetAbsoluteError(), pz.GetAbsoluteError());
+
+    out_tHit = fp_t(tHyperboloidHit);
+    out_isect = (*ObjectToWorld)(SurfaceInteraction(pHit, pError,
+                                                    Point2_t(u, v), -ray.direction,
+                                                    dpdu, dpdv, dndu, dndv,
+                                                    ray.time, this));
+
+    return true;
+}
+
+template<typename Float>
+bool Hyperboloid::IsIntersectingWith(const Ray_arg r) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
+    if (IsEmpty())
+        return false;
+
+    // Transform ray to object space
+    Vector3_t oError, dError;
+    Ray ray = (*WorldToObject)(r, oError, dError);
+
+    // Initialize EFloat ray coordinate values;
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float ah(m_ah), ch(m_ch);
+    // Compute quadratic tHyperboloidHit coefficients
+    Float a = ah * dx * dx + ah * dy * dy - ch * dz * dz;
+    Float b = 2 * (ah * dx * ox + ah * dy * oy - ch * dz * oz);
+    Float c = ah * ox * ox + ah * oy * oy - ch * oz * oz - Float(1);
+
+    // Solve quadratic equation
+    Float t0, t1;
+    if (Quadratic(a, b, c, t0, t1) == false)
+        return false;
+    // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
+    if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
+        return false;
+    Float tHyperboloidHit = t0;
+    if (tHyperboloidHit.LowerBound() <= 0) {
+        tHyperboloidHit = t1;
+        if (tHyperboloidHit.UpperBound() > ray.tMax)
+            return false;
+    }
+    // Compute hyperboloid hit(intersection) point
+    Point3_t pHit = ray(fp_t(tHyperboloidHit));
+
+    // Test hyperboloid intersection against clipping parametrs, phi is needed only for partial hyperboloid
+    const bool isPartial = m_phiMax < 2 * constants::pi_t;
+    if (pHit.z < m_zMin || pHit.z > m_zMax || (isPartial && HitPhi(pHit) > m_phiMax)) {
+        if (tHyperboloidHit == t1 || t1.UpperBound() > ray.tMax)
+            return false;
+        tHyperboloidHit = t1;
+        // Compute hyperboloid hit(intersection) point
+        pHit = ray(fp_t(tHyperboloidHit));
+        if (pHit.z < m_zMin || pHit.z > m_zMax || (isPartial && HitPhi(pHit) > m_phiMax))
+            return false;
+    }
+
+    return true;
+}
 
 // NOTE: testAlphaTexture is not used
-// bool Paraboloid::Intersect(const Ray_arg r,
-//                            fp_t &out_tHit, SurfaceInteraction &out_isect,
-//                            bool /*testAlphaTexture = true*/) const
-// {
-//     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
-
-//     // Transform ray to object space
-//     Vector3_t oError, dError;
-//     Ray ray = (*WorldToObject)(r, oError, dError);
-
-//     // Initialize EFloat ray coordinate values;
-//     EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-//     EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-//     EFloat k = EFloat(m_zMax) / EFloat(m_radius) * EFloat(m_radius);
-//     // Compute quadratic tParaboloidHit coefficients
-//     EFloat a = k * (dx * dx + dy * dy);
-//     EFloat b = 2 * k * (dx * ox + dy * oy) - dz;
-//     EFloat c = k * (ox * ox + oy * oy) - oz;
-
-//     // Solve quadratic equation
-//     EFloat t0, t1;
-//     if (Quadratic(a, b, c, t0, t1) == false)
-//         return false;
-//     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
-//     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
-//         return false;
-//     EFloat tParaboloidHit = t0;
-//     if (tParaboloidHit.LowerBound() <= 0) {
-//         tParaboloidHit = t1;
-//         if (tParaboloidHit.UpperBound() > ray.tMax)
-//             return false;
-//     }
-//    // Compute paraboloid hit(intersection) point and phi
-//     Point3_t pHit = ray(fp_t(tParaboloidHit));
-//     fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-//     if (phi < 0) phi += constants::pi_t * 2;
-
-//     // TODO: This shit is repetitive and definitely can be optimized
-//     // Test paraboloid intersection against clipping parametrs
-//     if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax) {
-//         // DIFFERENCE: Why the fuck they changed this check in all shapes after sphere in the book?
-//         if (tParaboloidHit == t1 || t1.UpperBound() > ray.tMax)
-//             return false;
-//         tParaboloidHit = t1;
-//         // Compute cone hit(intersection) point and phi
-//         pHit = ray(fp_t(tParaboloidHit));
-//         phi = pbr::ATan2(pHit.y, pHit.x);
-//         if (phi < 0) phi += constants::pi_t * 2;
-//         if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
-//             return false;
-//     }
-
-//     const fp_t zDiff = m_zMax - m_zMin;
-//     const fp_t pHitZ2 = 2 * pHit.z;
-//     // Find parametric representation of paraboloid hit
-//     fp_t u = phi / m_phiMax;
-//     fp_t v = (pHit.z - m_zMin) / zDiff;
-//     // Compute paraboloid dpdu and dpdv
-//     Vector3_t dpdu(-m_phiMax * pHit.y, m_phiMax * pHit.x, 0);
-//     Vector3_t dpdv = zDiff * Vector3_t(pHit.x / pHitZ2, pHit.y / pHitZ2, 1);
-
-//     // NOTE: This stuff(Partial derivatives of Noprmal Vectors, Weingarten equations) I don't understand.
-//     // Compute paraboloid derivatives
-//     Vector3_t d2pduu = -m_phiMax * m_phiMax * Vector3_t(pHit.x, pHit.y, 0);
-//     Vector3_t d2pduv = zDiff * m_phiMax * Vector3_t(-pHit.y / pHitZ2, pHit.x / pHitZ2, 0);
-//     Vector3_t d2pdvv = -zDiff * zDiff * Vector3_t(-pHit.x / (pHitZ2 * pHitZ2), pHit.y / (pHitZ2 * pHitZ2), 0);
-//     // Compute coefficients for fundamental forms
-//     fp_t E = Dot(dpdu, dpdu);
-//     fp_t F = Dot(dpdu, dpdv);
-//     fp_t G = Dot(dpdv, dpdv);
-//     Vector3_t N = Normalize(Cross(dpdu, dpdv)); // NOTE: This vector will be computed again in SurfaceInteraction constructor.
-//     fp_t e = Dot(N, d2pduu);
-//     fp_t f = Dot(N, d2pduv);
-//     fp_t g = Dot(N, d2pdvv);
-//     // Compute Partial derivatives of Noprmal Vectors from fundamental form coefficients
-//     fp_t invEGF2 = fp_t(1) / (E * G - F * F);
-//     Normal3_t dndu((f * F - e * G) * invEGF2 * dpdu + (e * F - f * E) * invEGF2 * dpdv);
-//     Normal3_t dndv((g * F - f * G) * invEGF2 * dpdu + (f * F - g * E) * invEGF2 * dpdv);
-
-//     // NOTE: This thing is nessesary for SurfaceConstruction anyway.
-// //#if PBR_PBR_ENABLE_EFLOAT == 1
-//     // Compute error bounds for paraboloid intersection
-//     EFloat px = ox + tParaboloidHit * dx;
-//     EFloat py = oy + tParaboloidHit * dy;
-//     EFloat pz = oz + tParaboloidHit * dz;
-//     Vector3_t pError(px.GetAbsoluteError(), py.GetAbsoluteError(), pz.GetAbsoluteError());
-// //#endif
-
-//     out_tHit = fp_t(tParaboloidHit);
-//     out_isect = (*ObjectToWorld)(SurfaceInteraction(pHit, pError,
-//                                                     Point2_t(u, v), -ray.direction,
-//                                                     dpdu, dpdv, dndu, dndv,
-//                                                     ray.time, this));
-
-//     return true;
-// }
-
-// // NOTE: testAlphaTexture is not used
-// bool Paraboloid::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
-// {
-//     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
-
-//     // Transform ray to object space
-//     Vector3_t oError, dError;
-//     Ray ray = (*WorldToObject)(r, oError, dError);
-
-//     // Initialize EFloat ray coordinate values;
-//     EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-//     EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-//     EFloat k = EFloat(m_zMax) / EFloat(m_radius) * EFloat(m_radius);
-//     // Compute quadratic tParaboloidHit coefficients
-//     EFloat a = k * (dx * dx + dy * dy);
-//     EFloat b = 2 * k * (dx * ox + dy * oy) - dz;
-//     EFloat c = k * (ox * ox + oy * oy) - oz;
-
-//     // Solve quadratic equation
-//     EFloat t0, t1;
-//     if (Quadratic(a, b, c, t0, t1) == false)
-//         return false;
-//     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
-//     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
-//         return false;
-//     EFloat tParaboloidHit = t0;
-//     if (tParaboloidHit.LowerBound() <= 0) {
-//         tParaboloidHit = t1;
-//         if (tParaboloidHit.UpperBound() > ray.tMax)
-//             return false;
-//     }
-//    // Compute paraboloid hit(intersection) point and phi
-//     Point3_t pHit = ray(fp_t(tParaboloidHit));
-//     fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-//     if (phi < 0) phi += constants::pi_t * 2;
-
-//     // TODO: This shit is repetitive and definitely can be optimized
-//     // Test paraboloid intersection against clipping parametrs
-//     if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax) {
-//         // DIFFERENCE: Why the fuck they changed this check in all shapes after sphere in the book?
-//         if (tParaboloidHit == t1 || t1.UpperBound() > ray.tMax)
-//             return false;
-//         tParaboloidHit = t1;
-//         // Compute cone hit(intersection) point and phi
-//         pHit = ray(fp_t(tParaboloidHit));
-//         phi = pbr::ATan2(pHit.y, pHit.x);
-//         if (phi < 0) phi += constants::pi_t * 2;
-//         if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
-//             return false;
-//     }
-
-//     return true;
-// }
-
-// // NOTE: Not verified.
-// fp_t Paraboloid::Area() const
-// {
-//     fp_t radius2 = m_radius * m_radius;
-//     fp_t k = 4 * m_zMax / radius2;
-//     return (radius2 * radius2 * m_phiMax / (12 * m_zMax * m_zMax)) *
-//            (std::pow(k * m_zMax + 1, fp_t(1.5)) - std::pow(k * m_zMin + 1, fp_t(1.5)));
-// }
+bool Hyperboloid::Intersect(const Ray_arg r,
+                            fp_t &out_tHit, SurfaceInteraction &out_isect,
+                            bool /*testAlphaTexture = true*/) const
+{
+    return IntersectWith<QuadricFloat>(r, out_tHit, out_isect);
+}
+
+// NOTE: testAlphaTexture is not used
+bool Hyperboloid::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    return IsIntersectingWith<QuadricFloat>(r);
+}
+
+// DIFFERENCE: The book has closed form, I couldn't verify it, so here |dpdu x dpdv| is integrated over v with Simpson's rule.
+//             It depends only on v, because u is rotation around z axis.
+fp_t Hyperboloid::Area() const
+{
+    constexpr i32 nIntervals = 64;
+    const Vector3_t segment = m_point2 - m_point1;
+    auto areaDensity = [&](fp_t v) {
+        fp_t x = m_point1.x + v * segment.x;
+        fp_t y = m_point1.y + v * segment.y;
+        fp_t radial = x * segment.x + y * segment.y;
+        return pbr::Sqrt((x * x + y * y) * segment.z * segment.z + radial * radial);
+    };
+
+    fp_t sum = areaDensity(0) + areaDensity(1);
+    for (i32 i = 1; i < nIntervals; ++i)
+        sum += (i % 2 == 1 ? 4 : 2) * areaDensity(fp_t(i) / nIntervals);
+    return m_phiMax * sum / (3 * nIntervals);
+}
+
+
+template bool Hyperboloid::IntersectWith<EFloatT<true>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Hyperboloid::IntersectWith<EFloatT<false>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Hyperboloid::IntersectWith<RawFloat>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Hyperboloid::IsIntersectingWith<EFloatT<true>>(const Ray_arg r) const;
+template bool Hyperboloid::IsIntersectingWith<EFloatT<false>>(const Ray_arg r) const;
+template bool Hyperboloid::IsIntersectingWith<RawFloat>(const Ray_arg r) const;
 
 PBR_NAMESPACE_END
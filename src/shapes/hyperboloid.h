@@ -6,31 +6,52 @@
 PBR_NAMESPACE_BEGIN
 
 // NOTE: Nice variables naming, guys from the book.
-// class Hyperboloid : public Shape
-// {
-// public:
-//     Hyperboloid(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
-//                 Point3_arg<fp_t> point1, Point3_arg<fp_t> point2, fp_t tm);
-
-
-//     Bounds3_t ObjectBound() const override;
-
-//     // NOTE: testAlphaTexture is not used
-//     bool Intersect(const Ray_arg r,
-//                    fp_t &out_tHit, SurfaceInteraction &out_isect,
-//                    bool /*testAlphaTexture = true*/) const override;
-//     // NOTE: testAlphaTexture is not used
-//     bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
-
-//     fp_t Area() const override;
-
-
-// private:
-//     const Point3_t m_point1, m_point2;
-//     const fp_t m_zMin, m_zMax;
-//     const fp_t m_phiMax;
-//     fp_t m_rMax;
-//     fp_t m_ah, m_ch;
-// };
+// Surface of revolution of the segment point1-point2 around z axis.
+// NOTE: Implicit form below assumes that the waist(the narrowest circle) of the hyperboloid is at z = 0,
+//       so the line of the segment has to be the closest to z axis at z = 0. Otherwise the shape is not the
+//       surface of revolution of the segment, such hyperboloids have to be moved along z with ObjectToWorld.
+//       Segments in the plane z = 0, of zero length, or on a line through the origin are rejected.
+class Hyperboloid : public Shape
+{
+public:
+    Hyperboloid(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                const Point3_arg<fp_t> point1, const Point3_arg<fp_t> point2, fp_t phiMax);
+
+
+    Bounds3_t ObjectBound() const override;
+
+    using Shape::Intersect;
+    // NOTE: testAlphaTexture is not used
+    bool Intersect(const Ray_arg r,
+                   fp_t &out_tHit, SurfaceInteraction &out_isect,
+                   bool /*testAlphaTexture = true*/) const override;
+    // NOTE: testAlphaTexture is not used
+    bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
+
+    // Float is the arithmetic used for quadratic coefficients, see efloat.hpp. Intersect() and IsIntersecting() use QuadricFloat.
+    //   Instantiated for EFloatT<true>, EFloatT<false> and RawFloat.
+    template<typename Float>
+    bool IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+    template<typename Float>
+    bool IsIntersectingWith(const Ray_arg r) const;
+
+    // NOTE: Numerical approximation, see .cpp
+    fp_t Area() const override;
+
+
+private:
+    // Coefficients are both zero only if the constructor failed, the surface "0 = 1" is empty.
+    bool IsEmpty() const { return m_ah == 0 && m_ch == 0; }
+    // Phi of the hit point, it's measured from the segment rotated to the height of the hit.
+    fp_t HitPhi(const Point3_arg<fp_t> pHit) const;
+
+
+    Point3_t m_point1, m_point2;
+    const fp_t m_zMin, m_zMax;
+    const fp_t m_phiMax;
+    fp_t m_rMax;
+    // Coefficients of the implicit form ah * (x^2 + y^2) - ch * z^2 = 1
+    fp_t m_ah, m_ch;
+};
 
 PBR_NAMESPACE_END
@@ -0,0 +1,559 @@
+#include "loopsubdiv.h"
+#include "triangle.h"
+#include "../core/stats.h"
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+
+PBR_NAMESPACE_BEGIN
+
+PBR_STATS_COUNTER("Subdivision/Patches tessellated", stats_nPatchesTessellated)
+PBR_STATS_MEMORY_COUNTER("Memory/Tessellated patches", stats_TessellatedPatch_bytes)
+PBR_STATS_PERCENT("Subdivision/Tessellation cache hits", stats_nCacheHits, stats_nCacheLookups)
+
+namespace {
+
+// Every level multiplies number of triangles by 4, 8 levels is 65536 triangles per control face.
+constexpr i32 maxSubdivisionLevel = 8;
+constexpr std::size_t defaultTessellationCacheSize = std::size_t(512) << 20;
+
+std::atomic<ui32> g_nextMeshId = 0;
+
+
+// Control face with everything required to subdivide it: faces around its vertices(1-ring).
+//   Vertices outside of the region get wrong positions after subdivision(their 1-ring is unknown),
+//   but region of the next level only depends on the vertices that are computed correctly.
+struct LocalMesh
+{
+    std::vector<Point3_t> positions;
+    // First nRegionFaces faces are the region itself, the rest are the ring around it.
+    std::vector<std::array<i32, 3>> faces;
+    std::vector<std::array<Point2_t, 3>> regionUV;
+    i32 nRegionFaces;
+};
+
+struct LocalEdge
+{
+    i32 v[2];
+    i32 opposite[2];
+    i32 nFaces;
+};
+
+ui64 EdgeKey(i32 v0, i32 v1)
+{
+    return v0 < v1 ? (ui64(v0) << 32) | ui64(v1) : (ui64(v1) << 32) | ui64(v0);
+}
+
+// Edges of the mesh, out_faceEdges[f][k] is the edge between faces[f][k] and faces[f][(k + 1) % 3].
+std::vector<LocalEdge> BuildEdges(const LocalMesh &mesh, std::vector<std::array<i32, 3>> &out_faceEdges)
+{
+    std::vector<LocalEdge> edges;
+    std::unordered_map<ui64, i32> edgeIndices;
+    edges.reserve(3 * mesh.faces.size());
+    edgeIndices.reserve(3 * mesh.faces.size());
+    out_faceEdges.resize(mesh.faces.size());
+
+    for (std::size_t f = 0; f < mesh.faces.size(); ++f) {
+        for (i32 k = 0; k < 3; ++k) {
+            i32 v0 = mesh.faces[f][k];
+            i32 v1 = mesh.faces[f][(k + 1) % 3];
+            i32 opposite = mesh.faces[f][(k + 2) % 3];
+
+            auto [it, inserted] = edgeIndices.try_emplace(EdgeKey(v0, v1), static_cast<i32>(edges.size()));
+            if (inserted)
+                edges.push_back(LocalEdge{ { v0, v1 }, { opposite, -1 }, 1 });
+            else {
+                LocalEdge &edge = edges[it->second];
+                // NOTE: Non-manifold edges keep only the first two faces.
+                if (edge.nFaces == 1)
+                    edge.opposite[1] = opposite;
+                ++edge.nFaces;
+            }
+            out_faceEdges[f][k] = it->second;
+        }
+    }
+    return edges;
+}
+
+// Per vertex data gathered from the edges around it.
+struct VertexRing
+{
+    Point3_t sum;
+    i32 valence = 0;
+    i32 nBoundary = 0;
+    i32 boundary[2] = { -1, -1 };
+};
+
+std::vector<VertexRing> BuildRings(const LocalMesh &mesh, const std::vector<LocalEdge> &edges)
+{
+    std::vector<VertexRing> rings(mesh.positions.size());
+    for (const LocalEdge &edge : edges) {
+        for (i32 s = 0; s < 2; ++s) {
+            VertexRing &ring = rings[edge.v[s]];
+            i32 other = edge.v[1 - s];
+            ring.sum += mesh.positions[other];
+            ++ring.valence;
+            if (edge.nFaces == 1) {
+                if (ring.nBoundary < 2)
+                    ring.boundary[ring.nBoundary] = other;
+                ++ring.nBoundary;
+            }
+        }
+    }
+    return rings;
+}
+
+fp_t LoopBeta(i32 valence)
+{
+    return valence == 3 ? fp_t(3) / fp_t(16) : fp_t(3) / (fp_t(8) * valence);
+}
+
+// Single Loop subdivision step, every face is split into 4, children of face i are faces 4i...4i+3.
+LocalMesh Subdivide(const LocalMesh &mesh)
+{
+    std::vector<std::array<i32, 3>> faceEdges;
+    const std::vector<LocalEdge> edges = BuildEdges(mesh, faceEdges);
+    const std::vector<VertexRing> rings = BuildRings(mesh, edges);
+    const i32 nVertices = static_cast<i32>(mesh.positions.size());
+
+    LocalMesh result;
+    result.nRegionFaces = 4 * mesh.nRegionFaces;
+    result.positions.resize(nVertices + edges.size());
+
+    // Vertex points keep their indices
+    for (i32 v = 0; v < nVertices; ++v) {
+        const VertexRing &ring = rings[v];
+        const Point3_t &p = mesh.positions[v];
+        if (ring.nBoundary == 0) {
+            fp_t beta = LoopBeta(ring.valence);
+            result.positions[v] = p * (fp_t(1) - ring.valence * beta) + ring.sum * beta;
+        }
+        else if (ring.nBoundary == 2)
+            result.positions[v] = p * fp_t(0.75) + (mesh.positions[ring.boundary[0]] + mesh.positions[ring.boundary[1]]) * fp_t(0.125);
+        else
+            // Corner or non-manifold vertex, keep it where it is
+            result.positions[v] = p;
+    }
+    // Edge points go after them
+    for (std::size_t e = 0; e < edges.size(); ++e) {
+        const LocalEdge &edge = edges[e];
+        Point3_t ends = mesh.positions[edge.v[0]] + mesh.positions[edge.v[1]];
+        if (edge.nFaces == 2)
+            result.positions[nVertices + e] = ends * fp_t(0.375) +
+                                              (mesh.positions[edge.opposite[0]] + mesh.positions[edge.opposite[1]]) * fp_t(0.125);
+        else
+            result.positions[nVertices + e] = ends * fp_t(0.5);
+    }
+
+    result.faces.resize(4 * mesh.faces.size());
+    for (std::size_t f = 0; f < mesh.faces.size(); ++f) {
+        const i32 v0 = mesh.faces[f][0], v1 = mesh.faces[f][1], v2 = mesh.faces[f][2];
+        const i32 e01 = nVertices + faceEdges[f][0];
+        const i32 e12 = nVertices + faceEdges[f][1];
+        const i32 e20 = nVertices + faceEdges[f][2];
+        result.faces[4 * f + 0] = { v0, e01, e20 };
+        result.faces[4 * f + 1] = { e01, v1, e12 };
+        result.faces[4 * f + 2] = { e20, e12, v2 };
+        result.faces[4 * f + 3] = { e01, e12, e20 };
+    }
+
+    result.regionUV.resize(result.nRegionFaces);
+    for (i32 f = 0; f < mesh.nRegionFaces; ++f) {
+        const std::array<Point2_t, 3> &uv = mesh.regionUV[f];
+        Point2_t uv01 = (uv[0] + uv[1]) * fp_t(0.5);
+        Point2_t uv12 = (uv[1] + uv[2]) * fp_t(0.5);
+        Point2_t uv20 = (uv[2] + uv[0]) * fp_t(0.5);
+        result.regionUV[4 * f + 0] = { uv[0], uv01, uv20 };
+        result.regionUV[4 * f + 1] = { uv01, uv[1], uv12 };
+        result.regionUV[4 * f + 2] = { uv20, uv12, uv[2] };
+        result.regionUV[4 * f + 3] = { uv01, uv12, uv20 };
+    }
+    return result;
+}
+
+// Drops faces that don't touch the region and vertices that are not used anymore.
+void RestrictToRegion(LocalMesh &mesh)
+{
+    std::vector<bool> isRegionVertex(mesh.positions.size(), false);
+    for (i32 f = 0; f < mesh.nRegionFaces; ++f)
+        for (i32 v : mesh.faces[f])
+            isRegionVertex[v] = true;
+
+    std::vector<std::array<i32, 3>> faces(mesh.faces.begin(), mesh.faces.begin() + mesh.nRegionFaces);
+    for (std::size_t f = mesh.nRegionFaces; f < mesh.faces.size(); ++f) {
+        const std::array<i32, 3> &face = mesh.faces[f];
+        if (isRegionVertex[face[0]] || isRegionVertex[face[1]] || isRegionVertex[face[2]])
+            faces.push_back(face);
+    }
+
+    std::vector<i32> remap(mesh.positions.size(), -1);
+    std::vector<Point3_t> positions;
+    positions.reserve(mesh.positions.size());
+    for (std::array<i32, 3> &face : faces)
+        for (i32 &v : face) {
+            if (remap[v] == -1) {
+                remap[v] = static_cast<i32>(positions.size());
+                positions.push_back(mesh.positions[v]);
+            }
+            v = remap[v];
+        }
+
+    mesh.faces = std::move(faces);
+    mesh.positions = std::move(positions);
+}
+
+// Projects region vertices onto the limit surface.
+void PushToLimit(LocalMesh &mesh)
+{
+    std::vector<std::array<i32, 3>> faceEdges;
+    const std::vector<LocalEdge> edges = BuildEdges(mesh, faceEdges);
+    const std::vector<VertexRing> rings = BuildRings(mesh, edges);
+
+    std::vector<Point3_t> limit = mesh.positions;
+    for (i32 f = 0; f < mesh.nRegionFaces; ++f)
+        for (i32 v : mesh.faces[f]) {
+            const VertexRing &ring = rings[v];
+            const Point3_t &p = mesh.positions[v];
+            if (ring.nBoundary == 0) {
+                fp_t gamma = fp_t(1) / (ring.valence + fp_t(3) / (fp_t(8) * LoopBeta(ring.valence)));
+                limit[v] = p * (fp_t(1) - ring.valence * gamma) + ring.sum * gamma;
+            }
+            else if (ring.nBoundary == 2)
+                limit[v] = p * fp_t(0.6) + (mesh.positions[ring.boundary[0]] + mesh.positions[ring.boundary[1]]) * fp_t(0.2);
+        }
+    mesh.positions = std::move(limit);
+}
+
+} // namespace
+
+
+std::shared_ptr<TessellationCache> DefaultTessellationCache()
+{
+    static std::shared_ptr<TessellationCache> cache = std::make_shared<TessellationCache>(defaultTessellationCacheSize);
+    return cache;
+}
+
+std::vector<std::shared_ptr<Shape>> CreateLoopSubdiv(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                                                     i32 nTriangles, const i32 *vertexIndices,
+                                                     i32 nVertices, const Point3_t *positions,
+                                                     i32 baseLevel, i32 maxLevel,
+                                                     std::shared_ptr<TessellationCache> cache)
+{
+    if (cache == nullptr)
+        cache = DefaultTessellationCache();
+    auto mesh = std::make_shared<SubdivisionMesh>(*ObjectToWorld, nTriangles, vertexIndices, nVertices, positions,
+                                                  baseLevel, maxLevel, cache);
+
+    std::vector<std::shared_ptr<Shape>> patches;
+    patches.reserve(nTriangles);
+    for (i32 i = 0; i < nTriangles; ++i)
+        patches.push_back(std::make_shared<SubdivisionPatch>(ObjectToWorld, WorldToObject, reverseOrientation, mesh, i));
+
+    return patches;
+}
+
+
+// ******************************************************************************
+// ------------------------------ TessellatedPatch ------------------------------
+// ******************************************************************************
+
+std::size_t TessellatedPatch::SizeBytes() const
+{
+    return sizeof(*this) + positions.size() * sizeof(Point3_t) + uv.size() * sizeof(Point2_t) +
+           vertexIndices.size() * sizeof(i32) + nodeBounds.size() * sizeof(Bounds3_t);
+}
+
+
+// ******************************************************************************
+// ------------------------------ SubdivisionMesh -------------------------------
+// ******************************************************************************
+
+SubdivisionMesh::SubdivisionMesh(const Transform &ObjectToWorld,
+                                 i32 _nTriangles, const i32 *_vertexIndices,
+                                 i32 _nVertices, const Point3_t *_positions,
+                                 i32 _baseLevel, i32 _maxLevel,
+                                 const std::shared_ptr<TessellationCache> &_cache)
+    : id(g_nextMeshId++)
+    , nTriangles(_nTriangles)
+    , nVertices(_nVertices)
+    , vertexIndices(_vertexIndices, _vertexIndices + 3 * _nTriangles)
+    , baseLevel(std::clamp(_baseLevel, 0, maxSubdivisionLevel))
+    , maxLevel(std::clamp(_maxLevel, baseLevel, maxSubdivisionLevel))
+    , cache(_cache)
+{
+    positions = std::make_unique<Point3_t[]>(nVertices);
+    ObjectToWorld(std::span(_positions, nVertices), std::span(positions.get(), nVertices));
+
+    // Counting sort of faces by vertex
+    vertexFacesOffsets.assign(nVertices + 1, 0);
+    for (i32 v : vertexIndices)
+        ++vertexFacesOffsets[v + 1];
+    for (i32 v = 0; v < nVertices; ++v)
+        vertexFacesOffsets[v + 1] += vertexFacesOffsets[v];
+    vertexFaces.resize(vertexIndices.size());
+    std::vector<i32> fill(vertexFacesOffsets.begin(), vertexFacesOffsets.end() - 1);
+    for (std::size_t i = 0; i < vertexIndices.size(); ++i)
+        vertexFaces[fill[vertexIndices[i]]++] = static_cast<i32>(i / 3);
+}
+
+
+// ******************************************************************************
+// ------------------------------ SubdivisionPatch ------------------------------
+// ******************************************************************************
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+SubdivisionPatch::SubdivisionPatch(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                                   const std::shared_ptr<SubdivisionMesh> &mesh, i32 faceIndex)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation)
+    , m_mesh(mesh)
+    , m_faceIndex(faceIndex)
+    , m_maxEdgeLength(0)
+{
+    const i32 *face = &mesh->vertexIndices[3 * faceIndex];
+    m_worldBound = Bounds3_t(mesh->positions[face[0]]);
+    for (i32 k = 0; k < 3; ++k) {
+        i32 v = face[k];
+        m_maxEdgeLength = std::max(m_maxEdgeLength, Distance(mesh->positions[v], mesh->positions[face[(k + 1) % 3]]));
+        for (i32 i = mesh->vertexFacesOffsets[v]; i < mesh->vertexFacesOffsets[v + 1]; ++i) {
+            const i32 *ringFace = &mesh->vertexIndices[3 * mesh->vertexFaces[i]];
+            for (i32 j = 0; j < 3; ++j)
+                m_worldBound = Union(m_worldBound, mesh->positions[ringFace[j]]);
+        }
+    }
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+Bounds3_t SubdivisionPatch::ObjectBound() const
+{
+    return (*WorldToObject)(m_worldBound);
+}
+
+Bounds3_t SubdivisionPatch::WorldBound() const
+{
+    return m_worldBound;
+}
+
+// Level at which triangle edges are about the size of the ray footprint where the ray enters the patch.
+i32 SubdivisionPatch::LevelFromFootprint(const RayDifferential_arg r) const
+{
+    if (r.hasDifferentials == false)
+        return m_mesh->baseLevel;
+
+    fp_t tEnter;
+    if (m_worldBound.IntersectP(static_cast<Ray_arg>(r), &tEnter) == false)
+        return m_mesh->baseLevel;
+
+    Point3_t p = r(tEnter);
+    Point3_t px = r.rxOrigin + r.rxDirection * tEnter;
+    Point3_t py = r.ryOrigin + r.ryDirection * tEnter;
+    fp_t footprint = std::max(Distance(p, px), Distance(p, py));
+    if (footprint <= 0)
+        return m_mesh->maxLevel;
+
+    // NOTE: Degenerate face or infinite footprint gives -inf or NaN here, it's clamped before conversion to int.
+    fp_t level = std::ceil(std::log2(m_maxEdgeLength / footprint));
+    if (std::isnan(level))
+        return m_mesh->baseLevel;
+    return static_cast<i32>(std::clamp(level, fp_t(m_mesh->baseLevel), fp_t(m_mesh->maxLevel)));
+}
+
+std::shared_ptr<const TessellatedPatch> SubdivisionPatch::GetTessellation(i32 level) const
+{
+    const TessellationKey key{ m_mesh->id, m_faceIndex, level };
+    PBR_STATS_VARIABLE_INCREMENT(stats_nCacheLookups)
+    if (std::shared_ptr<const TessellatedPatch> cached = m_mesh->cache->Find(key)) {
+        PBR_STATS_VARIABLE_INCREMENT(stats_nCacheHits)
+        return cached;
+    }
+
+    // Gather the face and its 1-ring
+    const SubdivisionMesh &mesh = *m_mesh;
+    LocalMesh local;
+    local.nRegionFaces = 1;
+    local.regionUV.push_back({ Point2_t(0, 0), Point2_t(1, 0), Point2_t(1, 1) });
+    std::vector<i32> ringFaces = { m_faceIndex };
+    for (i32 k = 0; k < 3; ++k) {
+        i32 v = mesh.vertexIndices[3 * m_faceIndex + k];
+        for (i32 i = mesh.vertexFacesOffsets[v]; i < mesh.vertexFacesOffsets[v + 1]; ++i)
+            if (std::find(ringFaces.begin(), ringFaces.end(), mesh.vertexFaces[i]) == ringFaces.end())
+                ringFaces.push_back(mesh.vertexFaces[i]);
+    }
+    std::unordered_map<i32, i32> localIndices;
+    for (i32 f : ringFaces) {
+        std::array<i32, 3> face;
+        for (i32 k = 0; k < 3; ++k) {
+            auto [it, inserted] = localIndices.try_emplace(mesh.vertexIndices[3 * f + k], static_cast<i32>(local.positions.size()));
+            if (inserted)
+                local.positions.push_back(mesh.positions[it->first]);
+            face[k] = it->second;
+        }
+        local.faces.push_back(face);
+    }
+
+    for (i32 i = 0; i < level; ++i) {
+        local = Subdivide(local);
+        RestrictToRegion(local);
+    }
+    PushToLimit(local);
+
+    // Keep only the region, RestrictToRegion() numbered region vertices first
+    auto patch = std::make_shared<TessellatedPatch>();
+    patch->level = level;
+    i32 nRegionVertices = 0;
+    for (i32 f = 0; f < local.nRegionFaces; ++f)
+        for (i32 v : local.faces[f])
+            nRegionVertices = std::max(nRegionVertices, v + 1);
+    patch->positions.assign(local.positions.begin(), local.positions.begin() + nRegionVertices);
+    patch->uv.resize(nRegionVertices);
+    patch->vertexIndices.resize(3 * local.nRegionFaces);
+    for (i32 f = 0; f < local.nRegionFaces; ++f)
+        for (i32 k = 0; k < 3; ++k) {
+            patch->vertexIndices[3 * f + k] = local.faces[f][k];
+            patch->uv[local.faces[f][k]] = local.regionUV[f][k];
+        }
+
+    // Build the quadtree bottom up
+    patch->nodeBounds.resize(TessellatedPatch::NodeOffset(level + 1));
+    Bounds3_t *leaves = &patch->nodeBounds[TessellatedPatch::NodeOffset(level)];
+    for (i32 f = 0; f < local.nRegionFaces; ++f)
+        leaves[f] = Union(Bounds3_t(patch->positions[patch->vertexIndices[3 * f]], patch->positions[patch->vertexIndices[3 * f + 1]]),
+                          patch->positions[patch->vertexIndices[3 * f + 2]]);
+    for (i32 depth = level - 1; depth >= 0; --depth) {
+        Bounds3_t *nodes = &patch->nodeBounds[TessellatedPatch::NodeOffset(depth)];
+        const Bounds3_t *children = &patch->nodeBounds[TessellatedPatch::NodeOffset(depth + 1)];
+        for (i32 i = 0; i < (1 << (2 * depth)); ++i)
+            nodes[i] = Union(Union(children[4 * i], children[4 * i + 1]), Union(children[4 * i + 2], children[4 * i + 3]));
+    }
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nPatchesTessellated)
+    PBR_STATS_VARIABLE_ADD(stats_TessellatedPatch_bytes, patch->SizeBytes())
+
+    return m_mesh->cache->Insert(key, patch, patch->SizeBytes());
+}
+
+// If out_isect is nullptr, returns on the first hit.
+bool SubdivisionPatch::IntersectTessellation(const TessellatedPatch &patch, const Ray_arg r,
+                                             fp_t &out_tHit, SurfaceInteraction *out_isect) const
+{
+    TraversalRay ray(r);
+
+    i32 hitTriangle = -1;
+    fp_t hitB[3] = {};
+    // Depth first traversal, every level adds at most 3 nodes to the stack
+    struct Node { i32 depth, index; };
+    Node stack[3 * maxSubdivisionLevel + 1];
+    i32 stackSize = 0;
+    stack[stackSize++] = Node{ 0, 0 };
+    while (stackSize > 0) {
+        Node node = stack[--stackSize];
+        if (patch.nodeBounds[TessellatedPatch::NodeOffset(node.depth) + node.index].IntersectP(ray) == false)
+            continue;
+
+        if (node.depth < patch.level) {
+            for (i32 i = 3; i >= 0; --i)
+                stack[stackSize++] = Node{ node.depth + 1, 4 * node.index + i };
+            continue;
+        }
+
+        const i32 *v = &patch.vertexIndices[3 * node.index];
+        fp_t t, b[3];
+        if (IntersectTriangle(static_cast<Ray_arg>(ray), patch.positions[v[0]], patch.positions[v[1]], patch.positions[v[2]], t, b)) {
+            if (out_isect == nullptr)
+                return true;
+            ray.tMax = t;
+            hitTriangle = node.index;
+            hitB[0] = b[0]; hitB[1] = b[1]; hitB[2] = b[2];
+        }
+    }
+    if (hitTriangle == -1)
+        return false;
+
+    const i32 *v = &patch.vertexIndices[3 * hitTriangle];
+    const Point3_t &p0 = patch.positions[v[0]];
+    const Point3_t &p1 = patch.positions[v[1]];
+    const Point3_t &p2 = patch.positions[v[2]];
+    const Point2_t &uv0 = patch.uv[v[0]];
+    const Point2_t &uv1 = patch.uv[v[1]];
+    const Point2_t &uv2 = patch.uv[v[2]];
+
+    // Same as for Triangle, uv of the patch are never degenerate
+    Vector2_t duv02 = uv0 - uv2;
+    Vector2_t duv12 = uv1 - uv2;
+    Vector3_t dp02 = p0 - p2;
+    Vector3_t dp12 = p1 - p2;
+    fp_t rcpDeterminant = fp_t(1) / (duv02.x * duv12.y - duv02.y * duv12.x);
+    Vector3_t dpdu = (duv12.y * dp02 - duv02.y * dp12) * rcpDeterminant;
+    Vector3_t dpdv = (-duv12.x * dp02 + duv02.x * dp12) * rcpDeterminant;
+    if (Cross(dpdu, dpdv).LengthSquared() == 0)
+        // Limit surface collapsed to the line or the point here
+        return false;
+
+    Point3_t pHit = p0 * hitB[0] + p1 * hitB[1] + p2 * hitB[2];
+    Point2_t uvHit = uv0 * hitB[0] + uv1 * hitB[1] + uv2 * hitB[2];
+    fp_t xAbsSum = std::abs(hitB[0] * p0.x) + std::abs(hitB[1] * p1.x) + std::abs(hitB[2] * p2.x);
+    fp_t yAbsSum = std::abs(hitB[0] * p0.y) + std::abs(hitB[1] * p1.y) + std::abs(hitB[2] * p2.y);
+    fp_t zAbsSum = std::abs(hitB[0] * p0.z) + std::abs(hitB[1] * p1.z) + std::abs(hitB[2] * p2.z);
+    Vector3_t pError = Gamma(7) * Vector3_t(xAbsSum, yAbsSum, zAbsSum);
+
+    out_tHit = ray.tMax;
+    // NOTE: Positions are already in world space, so no transformation here.
+    *out_isect = SurfaceInteraction(pHit, pError, uvHit, -r.direction,
+                                    dpdu, dpdv, Normal3_t(0, 0, 0), Normal3_t(0, 0, 0),
+                                    r.time, this);
+    return true;
+}
+
+// NOTE: Neighbour patches can be tessellated at different levels for the same ray, so there are tiny cracks between them,
+//       but they are smaller than the ray footprint, since level is chosen from it.
+bool SubdivisionPatch::Intersect(const RayDifferential_arg r,
+                                 fp_t &out_tHit, SurfaceInteraction &out_isect,
+                                 bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
+
+    std::shared_ptr<const TessellatedPatch> patch = GetTessellation(LevelFromFootprint(r));
+    return IntersectTessellation(*patch, static_cast<Ray_arg>(r), out_tHit, &out_isect);
+}
+
+bool SubdivisionPatch::Intersect(const Ray_arg r,
+                                 fp_t &out_tHit, SurfaceInteraction &out_isect,
+                                 bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
+
+    std::shared_ptr<const TessellatedPatch> patch = GetTessellation(m_mesh->baseLevel);
+    return IntersectTessellation(*patch, r, out_tHit, &out_isect);
+}
+
+bool SubdivisionPatch::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
+
+    std::shared_ptr<const TessellatedPatch> patch = GetTessellation(m_mesh->baseLevel);
+    fp_t tHit;
+    return IntersectTessellation(*patch, r, tHit, nullptr);
+}
+
+fp_t SubdivisionPatch::Area() const
+{
+    std::shared_ptr<const TessellatedPatch> patch = GetTessellation(m_mesh->baseLevel);
+    fp_t area = 0;
+    for (std::size_t i = 0; i < patch->vertexIndices.size(); i += 3) {
+        const Point3_t &p0 = patch->positions[patch->vertexIndices[i]];
+        const Point3_t &p1 = patch->positions[patch->vertexIndices[i + 1]];
+        const Point3_t &p2 = patch->positions[patch->vertexIndices[i + 2]];
+        area += Cross(p1 - p0, p2 - p0).Length() / fp_t(2);
+    }
+    return area;
+}
+
+PBR_NAMESPACE_END
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../core/shape.h"
+#include "../core/lrucache.hpp"
+#include <memory>
+#include <vector>
+
+
+// Loop subdivision surface, which is tessellated lazily, one patch per control triangle.
+//   Patch is tessellated only when a ray reaches its bounds, level of tessellation is chosen from the ray footprint(RayDifferential),
+//   so distant or blurry patches stay coarse. Tessellated patches are kept in the size bounded LRU cache shared by all meshes.
+// DIFFERENCE: pbrt subdivides the whole mesh to a fixed level upfront and turns it into triangles.
+// TODO: Catmull-Clark is not implemented, all meshes are triangle meshes for now.
+// TODO: Shading normals from the limit tangents, creases and uv from the mesh are not implemented.
+
+
+PBR_NAMESPACE_BEGIN
+
+// Tessellation of a single control face, positions are on the limit surface and in world space.
+struct TessellatedPatch
+{
+    std::size_t SizeBytes() const;
+
+
+    i32 level;
+    std::vector<Point3_t> positions;
+    // Parametric coordinates of the control face, (0,0), (1,0), (1,1) at its corners.
+    std::vector<Point2_t> uv;
+    // 4^level triangles, 4 children of any triangle of the previous level are stored next to each other,
+    //   so the triangles are the leaves of implicit quadtree.
+    std::vector<i32> vertexIndices;
+    // Bounds of the quadtree nodes, level by level, node i of depth d is at NodeOffset(d) + i.
+    std::vector<Bounds3_t> nodeBounds;
+
+    static constexpr i32 NodeOffset(i32 depth) { return ((1 << (2 * depth)) - 1) / 3; }
+};
+
+struct TessellationKey
+{
+    ui32 meshId;
+    i32 faceIndex;
+    i32 level;
+
+    bool operator==(const TessellationKey&) const = default;
+};
+
+struct TessellationKeyHash
+{
+    std::size_t operator()(const TessellationKey &key) const
+    {
+        return std::hash<ui64>()((ui64(key.meshId) << 32) ^ (ui64(key.faceIndex) << 4) ^ ui64(key.level));
+    }
+};
+
+// Capacity is in bytes.
+using TessellationCache = LRUCache<TessellationKey, TessellatedPatch, TessellationKeyHash>;
+
+// Cache that is used when no cache was given to CreateLoopSubdiv().
+std::shared_ptr<TessellationCache> DefaultTessellationCache();
+
+
+struct SubdivisionMesh
+{
+    SubdivisionMesh(const Transform &ObjectToWorld,
+                    i32 _nTriangles, const i32 *_vertexIndices,
+                    i32 _nVertices, const Point3_t *_positions,
+                    i32 _baseLevel, i32 _maxLevel,
+                    const std::shared_ptr<TessellationCache> &_cache);
+
+    // Unique id, so cache entries of the deleted mesh can't be mistaken for the entries of the new one.
+    const ui32 id;
+    const i32 nTriangles, nVertices;
+    std::vector<i32> vertexIndices;
+    // Control points in world space, subdivision rules are affine invariant, so it doesn't matter where to subdivide.
+    std::unique_ptr<Point3_t[]> positions;
+    // Faces around every vertex: vertexFaces[vertexFacesOffsets[v]] ... vertexFaces[vertexFacesOffsets[v + 1] - 1].
+    std::vector<i32> vertexFacesOffsets;
+    std::vector<i32> vertexFaces;
+    // Level used for rays without differentials and shadow rays, and the finest level ever built.
+    const i32 baseLevel, maxLevel;
+    std::shared_ptr<TessellationCache> cache;
+};
+
+
+class SubdivisionPatch : public Shape
+{
+public:
+    SubdivisionPatch(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                     const std::shared_ptr<SubdivisionMesh> &mesh, i32 faceIndex);
+
+
+    Bounds3_t ObjectBound() const override;
+    Bounds3_t WorldBound() const override;
+
+    // NOTE: testAlphaTexture is not used
+    bool Intersect(const Ray_arg r,
+                   fp_t &out_tHit, SurfaceInteraction &out_isect,
+                   bool /*testAlphaTexture = true*/) const override;
+    bool Intersect(const RayDifferential_arg r,
+                   fp_t &out_tHit, SurfaceInteraction &out_isect,
+                   bool /*testAlphaTexture = true*/) const override;
+    // NOTE: Always uses base level, so shadow rays may see slightly different surface than camera rays.
+    bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
+
+    // Area of the base level tessellation.
+    fp_t Area() const override;
+
+    // Tessellation of the face at the given level, it's taken from the cache or built and put there.
+    std::shared_ptr<const TessellatedPatch> GetTessellation(i32 level) const;
+
+
+private:
+    i32 LevelFromFootprint(const RayDifferential_arg r) const;
+    bool IntersectTessellation(const TessellatedPatch &patch, const Ray_arg r,
+                               fp_t &out_tHit, SurfaceInteraction *out_isect) const;
+
+
+    std::shared_ptr<SubdivisionMesh> m_mesh;
+    const i32 m_faceIndex;
+    // Bounds of the control points around the face, limit surface is inside of their convex hull.
+    Bounds3_t m_worldBound;
+    fp_t m_maxEdgeLength;
+};
+
+
+// Creates one SubdivisionPatch per control triangle, nothing is tessellated here.
+//   cache can be nullptr, then DefaultTessellationCache() is used.
+std::vector<std::shared_ptr<Shape>> CreateLoopSubdiv(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                                                     i32 nTriangles, const i32 *vertexIndices,
+                                                     i32 nVertices, const Point3_t *positions,
+                                                     i32 baseLevel, i32 maxLevel,
+                                                     std::shared_ptr<TessellationCache> cache = nullptr);
+
+PBR_NAMESPACE_END
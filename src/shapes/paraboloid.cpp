@@ -26,15 +26,13 @@ Paraboloid::Paraboloid(const Transform *ObjectToWorld, const Transform *WorldToO
 
 Bounds3_t Paraboloid::ObjectBound() const
 {
-    // NOTE: Is this the answer for sphere bounds computation excersice ?
-    return Bounds3_t(Point3_t(-m_radius, -m_radius, m_zMin),
-                     Point3_t( m_radius,  m_radius, m_zMax));
+    // Radius grows as sqrt(z), it's m_radius at m_zMax
+    const fp_t rMin = m_radius * pbr::Sqrt(std::max(fp_t(0), m_zMin) / m_zMax);
+    return RevolutionBounds(rMin, m_radius, 0, m_phiMax, m_zMin, m_zMax);
 }
 
-// NOTE: testAlphaTexture is not used
-bool Paraboloid::Intersect(const Ray_arg r,
-                           fp_t &out_tHit, SurfaceInteraction &out_isect,
-                           bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Paraboloid::IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
 
@@ -43,22 +41,22 @@ bool Paraboloid::Intersect(const Ray_arg r,
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-    EFloat k = EFloat(m_zMax) / EFloat(m_radius) * EFloat(m_radius);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float k = Float(m_zMax) / (Float(m_radius) * Float(m_radius));
     // Compute quadratic tParaboloidHit coefficients
-    EFloat a = k * (dx * dx + dy * dy);
-    EFloat b = 2 * k * (dx * ox + dy * oy) - dz;
-    EFloat c = k * (ox * ox + oy * oy) - oz;
+    Float a = k * (dx * dx + dy * dy);
+    Float b = 2 * k * (dx * ox + dy * oy) - dz;
+    Float c = k * (ox * ox + oy * oy) - oz;
 
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tParaboloidHit = t0;
+    Float tParaboloidHit = t0;
     if (tParaboloidHit.LowerBound() <= 0) {
         tParaboloidHit = t1;
         if (tParaboloidHit.UpperBound() > ray.tMax)
@@ -66,7 +64,7 @@ bool Paraboloid::Intersect(const Ray_arg r,
     }
    // Compute paraboloid hit(intersection) point and phi
     Point3_t pHit = ray(fp_t(tParaboloidHit));
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
     if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
@@ -78,7 +76,7 @@ bool Paraboloid::Intersect(const Ray_arg r,
         tParaboloidHit = t1;
         // Compute cone hit(intersection) point and phi
         pHit = ray(fp_t(tParaboloidHit));
-        phi = pbr::ATan2(pHit.y, pHit.x);
+        phi = shapemath::ATan2(pHit.y, pHit.x);
         if (phi < 0) phi += constants::pi_t * 2;
         if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
             return false;
@@ -114,9 +112,9 @@ bool Paraboloid::Intersect(const Ray_arg r,
     // NOTE: This thing is nessesary for SurfaceConstruction anyway.
 //#if PBR_PBR_ENABLE_EFLOAT == 1
     // Compute error bounds for paraboloid intersection
-    EFloat px = ox + tParaboloidHit * dx;
-    EFloat py = oy + tParaboloidHit * dy;
-    EFloat pz = oz + tParaboloidHit * dz;
+    Float px = ox + tParaboloidHit * dx;
+    Float py = oy + tParaboloidHit * dy;
+    Float pz = oz + tParaboloidHit * dz;
     Vector3_t pError(px.GetAbsoluteError(), py.GetAbsoluteError(), pz.GetAbsoluteError());
 //#endif
 
@@ -129,8 +127,8 @@ bool Paraboloid::Intersect(const Ray_arg r,
     return true;
 }
 
-// NOTE: testAlphaTexture is not used
-bool Paraboloid::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Paraboloid::IsIntersectingWith(const Ray_arg r) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
 
@@ -139,50 +137,60 @@ bool Paraboloid::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
-    EFloat k = EFloat(m_zMax) / EFloat(m_radius) * EFloat(m_radius);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float k = Float(m_zMax) / (Float(m_radius) * Float(m_radius));
     // Compute quadratic tParaboloidHit coefficients
-    EFloat a = k * (dx * dx + dy * dy);
-    EFloat b = 2 * k * (dx * ox + dy * oy) - dz;
-    EFloat c = k * (ox * ox + oy * oy) - oz;
+    Float a = k * (dx * dx + dy * dy);
+    Float b = 2 * k * (dx * ox + dy * oy) - dz;
+    Float c = k * (ox * ox + oy * oy) - oz;
 
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tParaboloidHit = t0;
+    Float tParaboloidHit = t0;
     if (tParaboloidHit.LowerBound() <= 0) {
         tParaboloidHit = t1;
         if (tParaboloidHit.UpperBound() > ray.tMax)
             return false;
     }
-   // Compute paraboloid hit(intersection) point and phi
+   // Compute paraboloid hit(intersection) point
     Point3_t pHit = ray(fp_t(tParaboloidHit));
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-    if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
     // Test paraboloid intersection against clipping parametrs
-    if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax) {
+    if (pHit.z < m_zMin || pHit.z > m_zMax || IsPhiClipped(pHit, m_phiMax)) {
         // DIFFERENCE: Why the fuck they changed this check in all shapes after sphere in the book?
         if (tParaboloidHit == t1 || t1.UpperBound() > ray.tMax)
             return false;
         tParaboloidHit = t1;
-        // Compute cone hit(intersection) point and phi
+        // Compute paraboloid hit(intersection) point
         pHit = ray(fp_t(tParaboloidHit));
-        phi = pbr::ATan2(pHit.y, pHit.x);
-        if (phi < 0) phi += constants::pi_t * 2;
-        if (pHit.z < m_zMin || pHit.z > m_zMax || phi > m_phiMax)
+        if (pHit.z < m_zMin || pHit.z > m_zMax || IsPhiClipped(pHit, m_phiMax))
             return false;
     }
 
     return true;
 }
 
+// NOTE: testAlphaTexture is not used
+bool Paraboloid::Intersect(const Ray_arg r,
+                           fp_t &out_tHit, SurfaceInteraction &out_isect,
+                           bool /*testAlphaTexture = true*/) const
+{
+    return IntersectWith<QuadricFloat>(r, out_tHit, out_isect);
+}
+
+// NOTE: testAlphaTexture is not used
+bool Paraboloid::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    return IsIntersectingWith<QuadricFloat>(r);
+}
+
 // NOTE: Not verified.
 fp_t Paraboloid::Area() const
 {
@@ -192,4 +200,12 @@ fp_t Paraboloid::Area() const
            (std::pow(k * m_zMax + 1, fp_t(1.5)) - std::pow(k * m_zMin + 1, fp_t(1.5)));
 }
 
+
+template bool Paraboloid::IntersectWith<EFloatT<true>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Paraboloid::IntersectWith<EFloatT<false>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Paraboloid::IntersectWith<RawFloat>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Paraboloid::IsIntersectingWith<EFloatT<true>>(const Ray_arg r) const;
+template bool Paraboloid::IsIntersectingWith<EFloatT<false>>(const Ray_arg r) const;
+template bool Paraboloid::IsIntersectingWith<RawFloat>(const Ray_arg r) const;
+
 PBR_NAMESPACE_END
@@ -30,17 +30,35 @@ Sphere::Sphere(const Transform *ObjectToWorld, const Transform *WorldToObject, b
 // --------------- METHODS ---------------
 // ---------------------------------------
 
-// TODO: Can be improved as stated in 3.2.1 chapter
 Bounds3_t Sphere::ObjectBound() const
 {
-    return Bounds3_t(Point3_t(-m_radius, -m_radius, m_zMin),
-                     Point3_t( m_radius,  m_radius, m_zMax));
+    // Radius of the sphere slice at the clipping planes, it's the largest at z = 0
+    const fp_t radiusAtZMin = pbr::Sqrt(std::max(fp_t(0), m_radius * m_radius - m_zMin * m_zMin));
+    const fp_t radiusAtZMax = pbr::Sqrt(std::max(fp_t(0), m_radius * m_radius - m_zMax * m_zMax));
+    const fp_t rMax = (m_zMin <= 0 && m_zMax >= 0) ? m_radius : std::max(radiusAtZMin, radiusAtZMax);
+    return RevolutionBounds(std::min(radiusAtZMin, radiusAtZMax), rMax, 0, m_phiMax, m_zMin, m_zMax);
 }
 
-// NOTE: testAlphaTexture is not used
-bool Sphere::Intersect(const Ray_arg r,
-                       fp_t &out_tHit, SurfaceInteraction &out_isect,
-                       bool /*testAlphaTexture = true*/) const
+// DIFFERENCE: Affine image of the full sphere is an ellipsoid, and its box is known exactly,
+//             half of its side along the axis i is radius * |row i of the matrix|.
+//             Transformed object box of the rotated sphere can be up to sqrt(3) times bigger.
+Bounds3_t Sphere::WorldBound() const
+{
+    const bool isFull = m_zMin <= -m_radius && m_zMax >= m_radius && m_phiMax >= 2 * constants::pi_t;
+    if (isFull == false || ObjectToWorld->IsAffine() == false)
+        return Shape::WorldBound();
+
+    const Transform &t = *ObjectToWorld;
+    const Point3_t center = t(Point3_t(0, 0, 0));
+    fp_t halfExtent[3];
+    for (i32 i = 0; i < 3; ++i)
+        halfExtent[i] = m_radius * pbr::Sqrt(t.m[i][0] * t.m[i][0] + t.m[i][1] * t.m[i][1] + t.m[i][2] * t.m[i][2]) * (1 + pbr::Gamma(3));
+    return Bounds3_t(Point3_t(center.x - halfExtent[0], center.y - halfExtent[1], center.z - halfExtent[2]),
+                     Point3_t(center.x + halfExtent[0], center.y + halfExtent[1], center.z + halfExtent[2]));
+}
+
+template<typename Float>
+bool Sphere::IntersectWith(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
 
@@ -49,20 +67,20 @@ bool Sphere::Intersect(const Ray_arg r,
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
     // Compute quadratic sphere coefficients
-    EFloat a = dx * dx + dy * dy + dz * dz;
-    EFloat b = 2 * (dx * ox + dy * oy + dz * oz);
-    EFloat c = ox * ox + oy * oy + oz * oz - EFloat(m_radius) * EFloat(m_radius);
+    Float a = dx * dx + dy * dy + dz * dz;
+    Float b = 2 * (dx * ox + dy * oy + dz * oz);
+    Float c = ox * ox + oy * oy + oz * oz - Float(m_radius) * Float(m_radius);
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tSphereHit = t0;
+    Float tSphereHit = t0;
     if (tSphereHit.LowerBound() <= 0) {
         tSphereHit = t1;
         if (tSphereHit.UpperBound() > ray.tMax)
@@ -76,12 +94,12 @@ bool Sphere::Intersect(const Ray_arg r,
     // FINDOUT: I don't know what this line doing, there is not explanation in the book. Seems like it's safe guard for std::atan2()
     if (pHit.x == 0 && pHit.y == 0) pHit.x = 1e-5 * m_radius;
 //#endif
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
+    fp_t phi = shapemath::ATan2(pHit.y, pHit.x);
     if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
     // Test sphere intersection against clipping parametrs
-    if (m_zMin > -m_radius && pHit.z < m_zMin || m_zMax < m_radius && pHit.z > m_zMax || phi > m_phiMax) {
+    if ((m_zMin > -m_radius && pHit.z < m_zMin) || (m_zMax < m_radius && pHit.z > m_zMax) || phi > m_phiMax) {
         if (tSphereHit == t1 || t1.UpperBound() > ray.tMax)
             return false;
         tSphereHit = t1;
@@ -89,25 +107,26 @@ bool Sphere::Intersect(const Ray_arg r,
         pHit = ray(fp_t(tSphereHit));
         pHit *= m_radius / Distance(pHit, Point3_t(0));
         if (pHit.x == 0 && pHit.y == 0) pHit.x = 1e-5 * m_radius;
-        phi = pbr::ATan2(pHit.y, pHit.x);
+        phi = shapemath::ATan2(pHit.y, pHit.x);
         if (phi < 0) phi += constants::pi_t * 2;
-        if (m_zMin > -m_radius && pHit.z < m_zMin || m_zMax < m_radius && pHit.z > m_zMax || phi > m_phiMax)
+        if ((m_zMin > -m_radius && pHit.z < m_zMin) || (m_zMax < m_radius && pHit.z > m_zMax) || phi > m_phiMax)
             return false;
     }
 
     // Find parametric representation of sphere hit
     fp_t u = phi / m_phiMax;
-    fp_t theta = pbr::ACos(std::clamp(pHit.z / m_radius, fp_t(-1), fp_t(1)));
+    fp_t theta = shapemath::ACos(std::clamp(pHit.z / m_radius, fp_t(-1), fp_t(1)));
     fp_t v = (theta - m_thetaMin) / (m_thetaMax - m_thetaMin);
     // Compute sphere dpdu and dpdv
-    // FINDOUT: Why the fuck cosPhi and sinPhi calculated manually, instead of using Sin(phi), Cos(phi) ?
-    //          Most likely they tried to do what sincos() does. But I'm sure it will be slower, as there is a special instructions for this task.
+    // NOTE: cosPhi and sinPhi are computed from the hit point instead of Sin(phi), Cos(phi), it's a sqrt and a division
+    //       against two polynomial evaluations, and it's exact for the hit, while phi already has error of ATan2().
+    //       The same way sin(theta) = zRadius / radius, so ACos() result is used only for v.
     fp_t zRadius = pbr::Sqrt(pHit.x * pHit.x + pHit.y * pHit.y);
     fp_t invZRadius = 1 / zRadius;
     fp_t cosPhi = pHit.x * invZRadius;
     fp_t sinPhi = pHit.y * invZRadius;
     Vector3_t dpdu(-m_phiMax * pHit.y, m_phiMax * pHit.x, 0);
-    Vector3_t dpdv = (m_thetaMax - m_thetaMin) * Vector3_t(pHit.z * cosPhi, pHit.z * sinPhi, -m_radius * pbr::Sin(theta));
+    Vector3_t dpdv = (m_thetaMax - m_thetaMin) * Vector3_t(pHit.z * cosPhi, pHit.z * sinPhi, -zRadius);
 
     // NOTE: This stuff(Partial derivatives of Noprmal Vectors, Weingarten equations) I don't understand.
     // Compute second derivatives
@@ -142,7 +161,8 @@ bool Sphere::Intersect(const Ray_arg r,
     return true;
 }
 
-bool Sphere::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+template<typename Float>
+bool Sphere::IsIntersectingWith(const Ray_arg r) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
 
@@ -151,20 +171,20 @@ bool Sphere::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) c
     Ray ray = (*WorldToObject)(r, oError, dError);
 
     // Initialize EFloat ray coordinate values;
-    EFloat ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
-    EFloat dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
+    Float ox(ray.origin.x, oError.x), oy(ray.origin.y, oError.y), oz(ray.origin.z, oError.z);
+    Float dx(ray.direction.x, dError.x), dy(ray.direction.y, dError.y), dz(ray.direction.z, dError.z);
     // Compute quadratic sphere coefficients
-    EFloat a = dx * dx + dy * dy + dz * dz;
-    EFloat b = 2 * (dx * ox + dy * oy + dz * oz);
-    EFloat c = ox * ox + oy * oy + oz * oz - EFloat(m_radius) * EFloat(m_radius);
+    Float a = dx * dx + dy * dy + dz * dz;
+    Float b = 2 * (dx * ox + dy * oy + dz * oz);
+    Float c = ox * ox + oy * oy + oz * oz - Float(m_radius) * Float(m_radius);
     // Solve quadratic equation
-    EFloat t0, t1;
+    Float t0, t1;
     if (Quadratic(a, b, c, t0, t1) == false)
         return false;
     // After Quadratic() t0 will be <= t1, so only need to check this 2 conditions
     if (t0.UpperBound() > ray.tMax || t1.LowerBound() <= 0)
         return false;
-    EFloat tSphereHit = t0;
+    Float tSphereHit = t0;
     if (tSphereHit.LowerBound() <= 0) {
         tSphereHit = t1;
         if (tSphereHit.UpperBound() > ray.tMax)
@@ -175,31 +195,49 @@ bool Sphere::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) c
     pHit *= m_radius / Distance(pHit, Point3_t(0)); // NOTE: This Distance call can be more effective, basically it's similiar to pHit.Length()
     // FINDOUT: I don't know what this line doing, there is not explanation in the book. Seems like it's safe guard for std::atan2()
     if (pHit.x == 0 && pHit.y == 0) pHit.x = 1e-5 * m_radius;
-    fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-    if (phi < 0) phi += constants::pi_t * 2;
 
     // TODO: This shit is repetitive and definitely can be optimized
     // Test sphere intersection against clipping parametrs
-    if (m_zMin > -m_radius && pHit.z < m_zMin || m_zMax < m_radius && pHit.z > m_zMax || phi > m_phiMax) {
+    if ((m_zMin > -m_radius && pHit.z < m_zMin) || (m_zMax < m_radius && pHit.z > m_zMax) || IsPhiClipped(pHit, m_phiMax)) {
         if (tSphereHit == t1 || t1.UpperBound() > ray.tMax)
             return false;
         tSphereHit = t1;
         // Compute sphere hit(intersection) point and phi
-        Point3_t pHit = ray((fp_t)tSphereHit);
+        pHit = ray((fp_t)tSphereHit);
         pHit *= m_radius / Distance(pHit, Point3_t(0));
         if (pHit.x == 0 && pHit.y == 0) pHit.x = 1e-5 * m_radius;
-        fp_t phi = pbr::ATan2(pHit.y, pHit.x);
-        if (phi < 0) phi += constants::pi_t * 2;
-        if (m_zMin > -m_radius && pHit.z < m_zMin || m_zMax < m_radius && pHit.z > m_zMax || phi > m_phiMax)
+        if ((m_zMin > -m_radius && pHit.z < m_zMin) || (m_zMax < m_radius && pHit.z > m_zMax) || IsPhiClipped(pHit, m_phiMax))
             return false;
     }
 
     return true;
 }
 
+// NOTE: testAlphaTexture is not used
+bool Sphere::Intersect(const Ray_arg r,
+                       fp_t &out_tHit, SurfaceInteraction &out_isect,
+                       bool /*testAlphaTexture = true*/) const
+{
+    return IntersectWith<QuadricFloat>(r, out_tHit, out_isect);
+}
+
+// NOTE: testAlphaTexture is not used
+bool Sphere::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    return IsIntersectingWith<QuadricFloat>(r);
+}
+
 fp_t Sphere::Area() const
 {
     return m_phiMax * m_radius * (m_zMax - m_zMin);
 }
 
+
+template bool Sphere::IntersectWith<EFloatT<true>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Sphere::IntersectWith<EFloatT<false>>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Sphere::IntersectWith<RawFloat>(const Ray_arg r, fp_t &out_tHit, SurfaceInteraction &out_isect) const;
+template bool Sphere::IsIntersectingWith<EFloatT<true>>(const Ray_arg r) const;
+template bool Sphere::IsIntersectingWith<EFloatT<false>>(const Ray_arg r) const;
+template bool Sphere::IsIntersectingWith<RawFloat>(const Ray_arg r) const;
+
 PBR_NAMESPACE_END
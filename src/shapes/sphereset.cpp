@@ -0,0 +1,363 @@
+#include "sphereset.h"
+#include "../core/stats.h"
+#include "../core/parallel.h"
+#include <algorithm>
+#include <numeric>
+
+
+// TODO: SphereSet::Sample(), SolidAngle() are not implemented.
+
+
+PBR_NAMESPACE_BEGIN
+
+// ---------------------------------------
+// ------------ CONSTRUCTORS -------------
+// ---------------------------------------
+
+PBR_STATS_MEMORY_COUNTER("Memory/Sphere sets", stats_SphereSet_bytes)
+PBR_STATS_RATIO("Scene/Spheres per sphere set", stats_nSpheres, stats_nSphereSets)
+
+SphereSet::SphereSet(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+                     i32 nSpheres, const Point3_t *centers, const fp_t *radii)
+    : Shape(ObjectToWorld, WorldToObject, reverseOrientation)
+    , m_centerX(nSpheres)
+    , m_centerY(nSpheres)
+    , m_centerZ(nSpheres)
+    , m_radius(nSpheres)
+{
+    PBR_ASSERT(nSpheres > 0 && centers != nullptr && radii != nullptr)
+
+    // Radius is scaled by the length of transformed axis, all three of them must have same length
+    fp_t scale = (*ObjectToWorld)(Vector3_t(1, 0, 0)).Length();
+    PBR_ASSERT(std::abs((*ObjectToWorld)(Vector3_t(0, 1, 0)).Length() - scale) <= fp_t(1e-3) * scale &&
+               std::abs((*ObjectToWorld)(Vector3_t(0, 0, 1)).Length() - scale) <= fp_t(1e-3) * scale)
+
+    ParallelFor(nSpheres, 64 * 1024, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i) {
+            Point3_t c = (*ObjectToWorld)(centers[i]);
+            m_centerX[i] = c.x;
+            m_centerY[i] = c.y;
+            m_centerZ[i] = c.z;
+            m_radius[i] = radii[i] * scale;
+        }
+    });
+
+    f64 area = 0;
+    for (i32 i = 0; i < nSpheres; ++i)
+        area += f64(m_radius[i]) * m_radius[i];
+    m_area = static_cast<fp_t>(4 * std::numbers::pi * area);
+
+    // Build BVH over sphere indices, then reorder spheres so every leaf is a contiguous range.
+    //   Top levels are split on this thread, subtrees under them are built in parallel and then concatenated.
+    std::vector<i32> order(nSpheres);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<TopLevelNode> topNodes;
+    std::vector<std::pair<i32, i32>> subtreeRanges;
+    SplitTopLevel(order, 0, nSpheres, std::max(64 * 1024, nSpheres / (4 * NumSystemCores())), topNodes, subtreeRanges);
+
+    std::vector<std::vector<BVHNode>> subtrees(subtreeRanges.size());
+    ParallelFor(static_cast<i64>(subtrees.size()), 1, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i)
+            BuildRecursive(order, subtreeRanges[i].first, subtreeRanges[i].second, subtrees[i]);
+    });
+
+    std::size_t nNodes = topNodes.size();
+    for (const auto &subtree : subtrees)
+        nNodes += subtree.size();
+    m_nodes.reserve(nNodes);
+    EmitTopLevel(topNodes, 0, subtrees);
+
+    for (std::vector<fp_t> *values : { &m_centerX, &m_centerY, &m_centerZ, &m_radius }) {
+        std::vector<fp_t> ordered(nSpheres);
+        ParallelFor(nSpheres, 64 * 1024, [&](i64 begin, i64 end) {
+            for (i64 i = begin; i < end; ++i)
+                ordered[i] = (*values)[order[i]];
+        });
+        values->swap(ordered);
+    }
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nSphereSets)
+    PBR_STATS_VARIABLE_ADD(stats_nSpheres, nSpheres)
+    PBR_STATS_VARIABLE_ADD(stats_SphereSet_bytes, sizeof(*this) + 4 * nSpheres * sizeof(fp_t) + m_nodes.size() * sizeof(BVHNode))
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+i32 SphereSet::SplitAtMedian(std::vector<i32> &order, i32 begin, i32 end) const
+{
+    Bounds3_t centerBounds;
+    for (i32 i = begin; i < end; ++i)
+        centerBounds = Union(centerBounds, Point3_t(m_centerX[order[i]], m_centerY[order[i]], m_centerZ[order[i]]));
+
+    // Split along the axis of the largest extent
+    i32 axis = centerBounds.MaximumExtent();
+    const std::vector<fp_t> &key = axis == 0 ? m_centerX : (axis == 1 ? m_centerY : m_centerZ);
+    i32 mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     [&key](i32 a, i32 b) { return key[a] < key[b]; });
+    return axis;
+}
+
+// IMPROVE: Median split is fast to build, but SAH would give better trees.
+i32 SphereSet::BuildRecursive(std::vector<i32> &order, i32 begin, i32 end, std::vector<BVHNode> &out_nodes) const
+{
+    i32 nodeIndex = static_cast<i32>(out_nodes.size());
+    out_nodes.push_back(BVHNode());
+
+    if (end - begin <= kMaxSpheresInLeaf) {
+        Bounds3_t bounds;
+        for (i32 i = begin; i < end; ++i) {
+            i32 s = order[i];
+            Point3_t c(m_centerX[s], m_centerY[s], m_centerZ[s]);
+            Vector3_t r(m_radius[s], m_radius[s], m_radius[s]);
+            bounds = Union(bounds, Bounds3_t(c - r, c + r));
+        }
+        out_nodes[nodeIndex].bounds = bounds;
+        out_nodes[nodeIndex].offset = begin;
+        out_nodes[nodeIndex].nSpheres = static_cast<ui8>(end - begin);
+        out_nodes[nodeIndex].axis = 0;
+        return nodeIndex;
+    }
+
+    i32 axis = SplitAtMedian(order, begin, end);
+    i32 mid = begin + (end - begin) / 2;
+    i32 firstChild = BuildRecursive(order, begin, mid, out_nodes);
+    i32 secondChild = BuildRecursive(order, mid, end, out_nodes);
+    // NOTE: out_nodes could be reallocated by recursive calls, so no references are kept across them.
+    out_nodes[nodeIndex].bounds = Union(out_nodes[firstChild].bounds, out_nodes[secondChild].bounds);
+    out_nodes[nodeIndex].offset = secondChild;
+    out_nodes[nodeIndex].nSpheres = 0;
+    out_nodes[nodeIndex].axis = static_cast<ui8>(axis);
+    return nodeIndex;
+}
+
+i32 SphereSet::SplitTopLevel(std::vector<i32> &order, i32 begin, i32 end, i32 maxSubtreeSpheres,
+                             std::vector<TopLevelNode> &out_topNodes, std::vector<std::pair<i32, i32>> &out_subtreeRanges) const
+{
+    i32 nodeIndex = static_cast<i32>(out_topNodes.size());
+    out_topNodes.push_back(TopLevelNode());
+
+    if (end - begin <= maxSubtreeSpheres) {
+        out_topNodes[nodeIndex].subtree = static_cast<i32>(out_subtreeRanges.size());
+        out_subtreeRanges.emplace_back(begin, end);
+        return nodeIndex;
+    }
+
+    i32 axis = SplitAtMedian(order, begin, end);
+    i32 mid = begin + (end - begin) / 2;
+    i32 firstChild = SplitTopLevel(order, begin, mid, maxSubtreeSpheres, out_topNodes, out_subtreeRanges);
+    i32 secondChild = SplitTopLevel(order, mid, end, maxSubtreeSpheres, out_topNodes, out_subtreeRanges);
+    out_topNodes[nodeIndex].children[0] = firstChild;
+    out_topNodes[nodeIndex].children[1] = secondChild;
+    out_topNodes[nodeIndex].subtree = -1;
+    out_topNodes[nodeIndex].axis = axis;
+    return nodeIndex;
+}
+
+i32 SphereSet::EmitTopLevel(const std::vector<TopLevelNode> &topNodes, i32 topNodeIndex, const std::vector<std::vector<BVHNode>> &subtrees)
+{
+    const TopLevelNode &topNode = topNodes[topNodeIndex];
+    i32 nodeIndex = static_cast<i32>(m_nodes.size());
+
+    if (topNode.subtree >= 0) {
+        // Subtree node indices are local to it, shift them by the position of subtree root
+        for (BVHNode node : subtrees[topNode.subtree]) {
+            if (node.nSpheres == 0)
+                node.offset += nodeIndex;
+            m_nodes.push_back(node);
+        }
+        return nodeIndex;
+    }
+
+    m_nodes.push_back(BVHNode());
+    i32 firstChild = EmitTopLevel(topNodes, topNode.children[0], subtrees);
+    i32 secondChild = EmitTopLevel(topNodes, topNode.children[1], subtrees);
+    m_nodes[nodeIndex].bounds = Union(m_nodes[firstChild].bounds, m_nodes[secondChild].bounds);
+    m_nodes[nodeIndex].offset = secondChild;
+    m_nodes[nodeIndex].nSpheres = 0;
+    m_nodes[nodeIndex].axis = static_cast<ui8>(topNode.axis);
+    return nodeIndex;
+}
+
+// NOTE: Loop has no branches and works on SoA arrays, so compiler can vectorize it, whole leaf is tested at once.
+//       Closest hit is selected after it, in a separate scalar loop.
+// NOTE: Discriminant is computed from the distance between the center and the ray line,
+//       it's much more accurate than b^2 - 4ac, when sphere is small relatively to the distance to it.
+i32 SphereSet::IntersectLeaf(const Ray_arg r, fp_t invDirLength, i32 first, i32 n, fp_t &inout_tMax, bool anyHit) const
+{
+    const fp_t *cx = &m_centerX[first];
+    const fp_t *cy = &m_centerY[first];
+    const fp_t *cz = &m_centerZ[first];
+    const fp_t *radius = &m_radius[first];
+
+    const fp_t ox = r.origin.x, oy = r.origin.y, oz = r.origin.z;
+    const fp_t dx = r.direction.x, dy = r.direction.y, dz = r.direction.z;
+    const fp_t a = dx * dx + dy * dy + dz * dz;
+    const fp_t invA = 1 / a;
+    const fp_t tMax = inout_tMax;
+
+    fp_t tHit[kMaxSpheresInLeaf];
+    for (i32 i = 0; i < n; ++i) {
+        fp_t fx = ox - cx[i], fy = oy - cy[i], fz = oz - cz[i];
+        fp_t b = fx * dx + fy * dy + fz * dz;
+        fp_t r2 = radius[i] * radius[i];
+        fp_t c = fx * fx + fy * fy + fz * fz - r2;
+        // Vector from the center to the closest point of the ray line
+        fp_t lx = fx - b * invA * dx, ly = fy - b * invA * dy, lz = fz - b * invA * dz;
+        fp_t discriminant = r2 - (lx * lx + ly * ly + lz * lz);
+        fp_t q = -(b + std::copysign(pbr::Sqrt(std::max(discriminant, fp_t(0)) * a), b));
+        fp_t t0 = c / q, t1 = q * invA;
+        fp_t tNear = std::min(t0, t1), tFar = std::max(t0, t1);
+        // Hit distance error grows with distance to the sphere and its size
+        fp_t eps = Gamma(7) * (std::max(std::max(std::abs(fx), std::abs(fy)), std::abs(fz)) + radius[i]) * invDirLength;
+        fp_t t = tNear > eps ? tNear : tFar;
+        tHit[i] = (discriminant >= 0 && t > eps && t < tMax) ? t : constants::infinity;
+    }
+
+    i32 closest = -1;
+    for (i32 i = 0; i < n; ++i)
+        if (tHit[i] < inout_tMax) {
+            inout_tMax = tHit[i];
+            closest = first + i;
+            if (anyHit)
+                break;
+        }
+    return closest;
+}
+
+i32 SphereSet::Traverse(const Ray_arg r, fp_t &out_tHit, bool anyHit) const
+{
+    TraversalRay ray(r);
+    fp_t invDirLength = 1 / ray.direction.Length();
+
+    i32 closest = -1;
+    i32 toVisitOffset = 0, currentNodeIndex = 0;
+    i32 nodesToVisit[64];
+    while (true) {
+        const BVHNode &node = m_nodes[currentNodeIndex];
+        if (node.bounds.IntersectP(ray)) {
+            if (node.nSpheres > 0) {
+                i32 sphere = IntersectLeaf(ray, invDirLength, node.offset, node.nSpheres, ray.tMax, anyHit);
+                if (sphere >= 0) {
+                    closest = sphere;
+                    if (anyHit)
+                        break;
+                }
+                if (toVisitOffset == 0)
+                    break;
+                currentNodeIndex = nodesToVisit[--toVisitOffset];
+            }
+            else {
+                // Visit the near child first
+                if (ray.dirIsNeg[node.axis]) {
+                    nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+                    currentNodeIndex = node.offset;
+                }
+                else {
+                    nodesToVisit[toVisitOffset++] = node.offset;
+                    currentNodeIndex = currentNodeIndex + 1;
+                }
+            }
+        }
+        else {
+            if (toVisitOffset == 0)
+                break;
+            currentNodeIndex = nodesToVisit[--toVisitOffset];
+        }
+    }
+
+    out_tHit = ray.tMax;
+    return closest;
+}
+
+Bounds3_t SphereSet::ObjectBound() const
+{
+    return (*WorldToObject)(WorldBound());
+}
+
+Bounds3_t SphereSet::WorldBound() const
+{
+    return m_nodes[0].bounds;
+}
+
+PBR_STATS_PERCENT("Intersections/Ray-sphere set intersection tests", stats_nSphereSetHits, stats_nSphereSetTests)
+
+// NOTE: testAlphaTexture is not used
+bool SphereSet::Intersect(const Ray_arg r,
+                          fp_t &out_tHit, SurfaceInteraction &out_isect,
+                          bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_Intersect)
+    PBR_STATS_VARIABLE_INCREMENT(stats_nSphereSetTests)
+
+    fp_t tHit;
+    i32 sphere = Traverse(r, tHit, false);
+    if (sphere < 0)
+        return false;
+
+    // Refine hit point by reprojecting it onto the sphere surface, same as in Sphere
+    Point3_t center(m_centerX[sphere], m_centerY[sphere], m_centerZ[sphere]);
+    fp_t radius = m_radius[sphere];
+    Vector3_t pLocal = r(tHit) - center;
+    pLocal *= radius / pLocal.Length();
+    if (pLocal.x == 0 && pLocal.y == 0) pLocal.x = 1e-5 * radius;
+    Point3_t pHit = center + pLocal;
+
+    // Find parametric representation of the hit, it's the full sphere with thetaMin = pi, thetaMax = 0
+    fp_t phi = shapemath::ATan2(pLocal.y, pLocal.x);
+    if (phi < 0) phi += constants::pi_t * 2;
+    fp_t u = phi / (constants::pi_t * 2);
+    fp_t theta = shapemath::ACos(std::clamp(pLocal.z / radius, fp_t(-1), fp_t(1)));
+    fp_t v = 1 - theta / constants::pi_t;
+    // Compute dpdu and dpdv
+    fp_t zRadius = pbr::Sqrt(pLocal.x * pLocal.x + pLocal.y * pLocal.y);
+    fp_t invZRadius = 1 / zRadius;
+    fp_t cosPhi = pLocal.x * invZRadius;
+    fp_t sinPhi = pLocal.y * invZRadius;
+    Vector3_t dpdu(-2 * constants::pi_t * pLocal.y, 2 * constants::pi_t * pLocal.x, 0);
+    Vector3_t dpdv = -constants::pi_t * Vector3_t(pLocal.z * cosPhi, pLocal.z * sinPhi, -zRadius);
+    // NOTE: Normal of the sphere is (p - center) / radius, so Weingarten equations are not needed.
+    Normal3_t dndu(dpdu / radius);
+    Normal3_t dndv(dpdv / radius);
+
+    // Error of the reprojection, plus rounding of adding the center back
+    Vector3_t pError = Gamma(5) * Abs(pLocal) + Gamma(1) * Vector3_t(Abs(pHit));
+
+    out_tHit = tHit;
+    out_isect = SurfaceInteraction(pHit, pError, Point2_t(u, v), -r.direction,
+                                   dpdu, dpdv, dndu, dndv,
+                                   r.time, this);
+    // Interaction is computed in world space, so it's not transformed and handedness flip doesn't apply
+    if (transformSwapsHandedness) {
+        out_isect.normal *= -1;
+        out_isect.shading.normal = out_isect.normal;
+    }
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nSphereSetHits)
+
+    return true;
+}
+
+bool SphereSet::IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const
+{
+    PBR_PROFILE_FUNCTION(ProfileCategory::Shape_IsIntersecting)
+    PBR_STATS_VARIABLE_INCREMENT(stats_nSphereSetTests)
+
+    fp_t tHit;
+    if (Traverse(r, tHit, true) < 0)
+        return false;
+
+    PBR_STATS_VARIABLE_INCREMENT(stats_nSphereSetHits)
+
+    return true;
+}
+
+fp_t SphereSet::Area() const
+{
+    return m_area;
+}
+
+PBR_NAMESPACE_END
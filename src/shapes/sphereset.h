@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../core/shape.h"
+#include <utility>
+#include <vector>
+
+
+// NOTE: Set of full spheres for particles and point clouds. Spheres are stored in world space as SoA arrays,
+//       so there is no Transform pair per sphere, and ray is never transformed to object space.
+// DIFFERENCE: pbrt would create Sphere shape with its own transforms for every particle and put them into the scene BVH.
+//             Here the whole set is one shape with its own BVH, because there is no accelerator in the tree yet.
+
+
+PBR_NAMESPACE_BEGIN
+
+class SphereSet : public Shape
+{
+public:
+    // Centers and radii are in object space. ObjectToWorld can't have non-uniform scale, sphere must stay a sphere.
+    SphereSet(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
+              i32 nSpheres, const Point3_t *centers, const fp_t *radii);
+
+
+    Bounds3_t ObjectBound() const override;
+    Bounds3_t WorldBound() const override;
+
+    using Shape::Intersect;
+    // NOTE: testAlphaTexture is not used
+    bool Intersect(const Ray_arg r,
+                   fp_t &out_tHit, SurfaceInteraction &out_isect,
+                   bool /*testAlphaTexture = true*/) const override;
+    // NOTE: testAlphaTexture is not used
+    bool IsIntersecting(const Ray_arg r, bool /*testAlphaTexture = true*/) const override;
+
+    fp_t Area() const override;
+
+    i32 SphereCount() const { return static_cast<i32>(m_radius.size()); }
+
+
+private:
+    static constexpr i32 kMaxSpheresInLeaf = 8;
+
+    // DIFFERENCE: Same layout as LinearBVHNode from pbrt, first child of the interior node is right after it.
+    struct BVHNode
+    {
+        Bounds3_t bounds;
+        // Index of the first sphere for leaf, index of the second child for interior node.
+        i32 offset;
+        // 0 for interior node.
+        ui8 nSpheres;
+        ui8 axis;
+    };
+
+    // Node of the top levels of the tree, which are split before subtrees under them are built in parallel.
+    struct TopLevelNode
+    {
+        i32 children[2];
+        // Index of the subtree built in parallel, or -1 for interior node.
+        i32 subtree;
+        i32 axis;
+    };
+
+    // Sorts order[begin, end) so that its halves are on the different sides of the median center, returns split axis.
+    i32 SplitAtMedian(std::vector<i32> &order, i32 begin, i32 end) const;
+    // Builds subtree over spheres order[begin, end) into out_nodes, leaf refers to its range of order array.
+    //   Returns index of subtree root node in out_nodes.
+    i32 BuildRecursive(std::vector<i32> &order, i32 begin, i32 end, std::vector<BVHNode> &out_nodes) const;
+    // Splits order[begin, end) until ranges are smaller than maxSubtreeSpheres, returns index of the node in out_topNodes.
+    i32 SplitTopLevel(std::vector<i32> &order, i32 begin, i32 end, i32 maxSubtreeSpheres,
+                      std::vector<TopLevelNode> &out_topNodes, std::vector<std::pair<i32, i32>> &out_subtreeRanges) const;
+    // Appends top level node and everything under it to m_nodes in depth first order, returns its index.
+    i32 EmitTopLevel(const std::vector<TopLevelNode> &topNodes, i32 topNodeIndex, const std::vector<std::vector<BVHNode>> &subtrees);
+    // Finds closest sphere of the leaf hit in (0, inout_tMax), returns its index or -1.
+    //   If anyHit is set, returns first sphere hit instead of closest one.
+    i32 IntersectLeaf(const Ray_arg r, fp_t invDirLength, i32 first, i32 n, fp_t &inout_tMax, bool anyHit) const;
+    // Returns index of the closest sphere hit or -1.
+    i32 Traverse(const Ray_arg r, fp_t &out_tHit, bool anyHit) const;
+
+
+    // Sphere centers and radii in world space, in BVH leaf order.
+    std::vector<fp_t> m_centerX, m_centerY, m_centerZ;
+    std::vector<fp_t> m_radius;
+    std::vector<BVHNode> m_nodes;
+    fp_t m_area = 0;
+};
+
+PBR_NAMESPACE_END
@@ -1,6 +1,7 @@
 #include "triangle.h"
 #include "../core/stats.h"
 #include "../core/efloat.hpp"
+#include "../core/parallel.h"
 
 
 // TODO: CreateTriangleMeshShape(), Triangle::SolidAngle(), Triangle::Sample() are not implemented. Intersect methods are not finished.
@@ -17,13 +18,17 @@ PBR_NAMESPACE_BEGIN
 std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
                                                        i32 nTriangles, const i32 *vertexIndices,
                                                        i32 nVertices, const Point3_t *positions,
-                                                       const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv)
+                                                       const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv,
+                                                       const std::shared_ptr<AlphaMask> &alphaMask /*= nullptr*/,
+                                                       const std::shared_ptr<AlphaMask> &shadowAlphaMask /*= nullptr*/,
+                                                       bool compactAttributes /*= false*/)
 {
-    auto mesh = std::make_shared<TriangleMesh>(*ObjectToWorld, nTriangles, vertexIndices, nVertices, positions, tangents, normals, uv);
+    auto mesh = std::make_shared<TriangleMesh>(*ObjectToWorld, nTriangles, vertexIndices, nVertices, positions, tangents, normals, uv,
+                                               alphaMask, shadowAlphaMask, compactAttributes);
     
     std::vector<std::shared_ptr<Shape>> triangles;
     triangles.reserve(nTriangles);
-    for(int i; i < nTriangles; ++i)
+    for(int i = 0; i < nTriangles; ++i)
         // FINDOUT: emplace_back ?
         triangles.push_back(std::make_shared<Triangle>(ObjectToWorld, WorldToObject, reverseOrientation, mesh, i));
     
@@ -31,6 +36,96 @@ std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(const Transform *ObjectTo
 }
 
 
+// Watertight Ray/Triangle intersection
+bool IntersectTriangle(const Ray_arg r, const Point3_arg<fp_t> p0, const Point3_arg<fp_t> p1, const Point3_arg<fp_t> p2,
+                       fp_t &out_t, fp_t out_b[3])
+{
+    // NOTE: Translation, permutation and shear are done on padded vectors, see Vector3A. Results are the same as of
+    //       the scalar code, x and y of the shear get (Sx * z, Sy * z) added, z gets 0 * z added.
+    // Transform triangle vertices to ray coordinate space(relative to ray origin)
+    const Vector3A_t origin(r.origin);
+    Vector3A_t p0a = Vector3A_t(p0) - origin;
+    Vector3A_t p1a = Vector3A_t(p1) - origin;
+    Vector3A_t p2a = Vector3A_t(p2) - origin;
+    // Calculate dimension where the ray direction is maximal
+    Vector3A_t direction(r.direction);
+    i32 kz = MaxDimension(Abs(direction));
+    i32 kx = kz + 1; if (kx == 3) kx = 0;
+    i32 ky = kx + 1; if (ky == 3) ky = 0;
+    // Permute components of triangle vertices and ray direction
+    direction = Permute(direction, kx, ky, kz);
+    p0a = Permute(p0a, kx, ky, kz);
+    p1a = Permute(p1a, kx, ky, kz);
+    p2a = Permute(p2a, kx, ky, kz);
+    // Apply shear transformation to translated vertex positions
+    // FINDOUT: Compute Sz first and then Sx=-direction.x * Sz ?
+    fp_t Sx = -direction.X() / direction.Z();
+    fp_t Sy = -direction.Y() / direction.Z();
+    fp_t Sz = fp_t(1) / direction.Z(); // FINDOUT: Move where it's used ? Although probably compiler will do it anyway.
+    const Vector3A_t shear(Sx, Sy, 0);
+    Point3_t p0t(p0a + shear * Vector3A_t(p0a.Z()));
+    Point3_t p1t(p1a + shear * Vector3A_t(p1a.Z()));
+    Point3_t p2t(p2a + shear * Vector3A_t(p2a.Z()));
+
+    // Compute edge function coefficients
+    fp_t e0 = p1t.x * p2t.y - p1t.y * p2t.x;
+    fp_t e1 = p2t.x * p0t.y - p2t.y * p0t.x;
+    fp_t e2 = p0t.x * p1t.y - p0t.y * p1t.x;
+    // Fall back to double precision test at triangle edges
+    if constexpr (std::is_same_v<fp_t, f32>) {
+        if (e0 == 0 || e1 == 0 || e2 == 0) {
+            e0 = f32(f64(p1t.x) * f64(p2t.y) - f64(p1t.y) * f64(p2t.x));
+            e1 = f32(f64(p2t.x) * f64(p0t.y) - f64(p2t.y) * f64(p0t.x));
+            e2 = f32(f64(p0t.x) * f64(p1t.y) - f64(p0t.y) * f64(p1t.x));
+        }
+    }
+    // Perform triangle edge and determinant tests
+    if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 >0 || e1 > 0 || e2 > 0))
+        return false;
+    fp_t det = e0 + e1 + e2;
+    if (det == 0)
+        return false;
+
+    // Compute scaled hit distance to triangle and test against ray $tMax$ range
+    p0t.z *= Sz;
+    p1t.z *= Sz;
+    p2t.z *= Sz;
+    fp_t tScaled = e0 * p0t.z + e1 * p1t.z + e2 * p2t.z;
+    // NOTE: Probably can be simplified
+    if (det < 0 && (tScaled >= 0 || tScaled < r.tMax * det))
+        return false;
+    else if (det > 0 && (tScaled <= 0 || tScaled > r.tMax * det))
+        return false;
+    // Compute barycentric coordinates and triangle intersection
+    fp_t rcpDet = fp_t(1) / det;
+    fp_t b0 = e0 * rcpDet;
+    fp_t b1 = e1 * rcpDet;
+    fp_t b2 = e2 * rcpDet;
+    fp_t t = tScaled * rcpDet;
+
+//#if PBR_PBR_ENABLE_EFLOAT == 1
+    fp_t maxXt = MaxComponent(Abs(Vector3_t(p0t.x, p1t.x, p2t.x)));
+    fp_t maxYt = MaxComponent(Abs(Vector3_t(p0t.y, p1t.y, p2t.y)));
+    fp_t maxZt = MaxComponent(Abs(Vector3_t(p0t.z, p1t.z, p2t.z)));
+    fp_t deltaX = Gamma(5) * (maxXt + maxZt);
+    fp_t deltaY = Gamma(5) * (maxYt + maxZt);
+    fp_t deltaZ = Gamma(3) * maxZt;
+    
+    fp_t deltaE = fp_t(2) * (Gamma(2) * maxXt * maxYt + deltaY * maxXt + deltaX * maxYt);
+    fp_t maxE = MaxComponent(Abs(Vector3_t(e0, e1, e2)));
+    fp_t deltaT = fp_t(3) * (Gamma(3) * maxE * maxZt + deltaE * maxZt + deltaZ * maxE) * std::abs(rcpDet);
+    if (t <= deltaT)
+        return false;
+//#endif
+
+    out_t = t;
+    out_b[0] = b0;
+    out_b[1] = b1;
+    out_b[2] = b2;
+    return true;
+}
+
+
 // ******************************************************************************
 // -------------------------------- TriangleMesh --------------------------------
 // ******************************************************************************
@@ -45,13 +140,16 @@ PBR_STATS_RATIO("Scene/Triangles per triangle mesh", stats_nTriangles, stats_nMe
 TriangleMesh::TriangleMesh(const Transform &ObjectToWorld,
                            i32 _nTriangles, const i32 *_vertexIndices,
                            i32 _nVertices, const Point3_t *_positions,
-                           const Vector3_t *_tangents, const Normal3_t *_normals, const Point2_t *_uv
-                           //const std::shared_ptr<Texture<fp_t>> &alphaMask,
-                           //const std::shared_ptr<Texture<fp_t>> &shadingMask,
+                           const Vector3_t *_tangents, const Normal3_t *_normals, const Point2_t *_uv,
+                           const std::shared_ptr<AlphaMask> &_alphaMask /*= nullptr*/,
+                           const std::shared_ptr<AlphaMask> &_shadowAlphaMask /*= nullptr*/,
+                           bool compactAttributes /*= false*/
                            /*const i32 *_faceIndices*/)
     : nTriangles(_nTriangles)
     , nVertices(_nVertices)
     , vertexIndices(_vertexIndices, _vertexIndices + 3 * _nTriangles)
+    , alphaMask(_alphaMask)
+    , shadowAlphaMask(_shadowAlphaMask)
 {
     PBR_STATS_VARIABLE_INCREMENT(stats_nMeshes)
     PBR_STATS_VARIABLE_ADD(stats_nTriangles, nTriangles)
@@ -59,29 +157,99 @@ TriangleMesh::TriangleMesh(const Transform &ObjectToWorld,
 
     // DIFFERENCE: Why they are using unique_ptr.reset() ?
     positions = std::make_unique<Point3_t[]>(nVertices);
-    for(int i = 0; i < nVertices; ++i)
-        positions[i] = ObjectToWorld(_positions[i]);
+    ObjectToWorld(std::span(_positions, nVertices), std::span(positions.get(), nVertices));
     
-    if (_uv != nullptr) {
-        PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_uv))
-
-        uv = std::make_unique<Point2_t[]>(nVertices);
-        std::copy(_uv, _uv + nVertices, uv.get()); // FINDOUT: Will it be as effective as memcpy() ?
+    if (compactAttributes) {
+        if (_uv != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(HalfPoint2))
+
+            compactUV = std::make_unique<HalfPoint2[]>(nVertices);
+            ParallelFor(nVertices, 16384, [&](i64 begin, i64 end) {
+                for (i64 i = begin; i < end; ++i)
+                    compactUV[i] = HalfPoint2(_uv[i]);
+            });
+        }
+        // NOTE: Vectors are transformed to world space in a temporary array first, and encoded after that.
+        if (_normals != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(OctahedralVector))
+
+            auto world = std::make_unique<Normal3_t[]>(nVertices);
+            ObjectToWorld(std::span(_normals, nVertices), std::span(world.get(), nVertices));
+            compactNormals = std::make_unique<OctahedralVector[]>(nVertices);
+            ParallelFor(nVertices, 16384, [&](i64 begin, i64 end) {
+                for (i64 i = begin; i < end; ++i)
+                    compactNormals[i] = OctahedralVector(world[i]);
+            });
+        }
+        if (_tangents != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(OctahedralVector))
+
+            auto world = std::make_unique<Vector3_t[]>(nVertices);
+            ObjectToWorld(std::span(_tangents, nVertices), std::span(world.get(), nVertices));
+            compactTangents = std::make_unique<OctahedralVector[]>(nVertices);
+            ParallelFor(nVertices, 16384, [&](i64 begin, i64 end) {
+                for (i64 i = begin; i < end; ++i)
+                    compactTangents[i] = OctahedralVector(world[i]);
+            });
+        }
     }
-    if (_normals != nullptr) {
-        PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_normals))
-
-        normals = std::make_unique<Normal3_t[]>(nVertices);
-        for(int i = 0; i < nVertices; ++i)
-            normals[i] = ObjectToWorld(_normals[i]);
+    else {
+        if (_uv != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_uv))
+
+            uv = std::make_unique<Point2_t[]>(nVertices);
+            std::copy(_uv, _uv + nVertices, uv.get()); // FINDOUT: Will it be as effective as memcpy() ?
+        }
+        if (_normals != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_normals))
+
+            normals = std::make_unique<Normal3_t[]>(nVertices);
+            ObjectToWorld(std::span(_normals, nVertices), std::span(normals.get(), nVertices));
+        }
+        if (_tangents != nullptr) {
+            PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_tangents))
+
+            tangents = std::make_unique<Vector3_t[]>(nVertices);
+            ObjectToWorld(std::span(_tangents, nVertices), std::span(tangents.get(), nVertices));
+        }
     }
-    if (_tangents != nullptr) {
-        PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nVertices * sizeof(*_tangents))
 
-        tangents = std::make_unique<Vector3_t[]>(nVertices);
-        for(int i = 0; i < nVertices; ++i)
-            tangents[i] = ObjectToWorld(_tangents[i]);
+    if (alphaMask != nullptr) {
+        PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nTriangles * sizeof(AlphaCoverage))
+        alphaCoverage = ClassifyTriangles(*alphaMask);
     }
+    if (shadowAlphaMask != nullptr) {
+        PBR_STATS_VARIABLE_ADD(stats_TriangleMesh_bytes, nTriangles * sizeof(AlphaCoverage))
+        shadowAlphaCoverage = ClassifyTriangles(*shadowAlphaMask);
+    }
+}
+
+
+// ---------------------------------------
+// --------------- METHODS ---------------
+// ---------------------------------------
+
+std::vector<AlphaCoverage> TriangleMesh::ClassifyTriangles(const AlphaMask &mask) const
+{
+    std::vector<AlphaCoverage> coverage(nTriangles);
+    ParallelFor(nTriangles, 4096, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i) {
+            Point2_t uvMin, uvMax;
+            if (HasUV()) {
+                const i32 *v = &vertexIndices[3 * i];
+                const Point2_t uv0 = UV(v[0]), uv1 = UV(v[1]), uv2 = UV(v[2]);
+                uvMin = Point2_t(std::min({ uv0.x, uv1.x, uv2.x }), std::min({ uv0.y, uv1.y, uv2.y }));
+                uvMax = Point2_t(std::max({ uv0.x, uv1.x, uv2.x }), std::max({ uv0.y, uv1.y, uv2.y }));
+            }
+            else {
+                // Same as default uv in Triangle::GetUV()
+                uvMin = Point2_t(0, 0);
+                uvMax = Point2_t(1, 1);
+            }
+            coverage[i] = mask.Classify(uvMin, uvMax);
+        }
+    });
+    return coverage;
 }
 
 
@@ -127,10 +295,10 @@ Bounds3_t Triangle::WorldBound() const
 
 void Triangle::GetUV(Point2_t out_uv[3]) const
 {
-    if (m_mesh->uv != nullptr) {
-        out_uv[0] = m_mesh->uv[m_vIndices[0]];
-        out_uv[1] = m_mesh->uv[m_vIndices[1]];
-        out_uv[2] = m_mesh->uv[m_vIndices[2]];
+    if (m_mesh->HasUV()) {
+        out_uv[0] = m_mesh->UV(m_vIndices[0]);
+        out_uv[1] = m_mesh->UV(m_vIndices[1]);
+        out_uv[2] = m_mesh->UV(m_vIndices[2]);
     }
     else {
         out_uv[0] = Point2_t(0, 0);
@@ -140,99 +308,49 @@ void Triangle::GetUV(Point2_t out_uv[3]) const
 }
 
 PBR_STATS_PERCENT("Intersections/Ray-triangle intersection tests", stats_nHits, stats_nTests)
-// TODO: Texture not implemented, and therefore test against alpha texture intersection.
+PBR_STATS_PERCENT("Intersections/Alpha masked tests resolved without mask lookup", stats_nAlphaNoLookup, stats_nAlphaTests)
 // TODO: out_isect is not filled
 // Watertight Ray/Triangle intersection
 bool Triangle::Intersect(const Ray_arg r,
                          fp_t &out_tHit, SurfaceInteraction &out_isect,
-                         bool testAlphaTexture = true) const
+                         bool testAlphaTexture) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Triangle_Intersect)
     PBR_STATS_VARIABLE_INCREMENT(stats_nTests)
 
+    AlphaCoverage coverage = AlphaCoverage::Opaque;
+    if (testAlphaTexture && m_mesh->alphaMask) {
+        coverage = m_mesh->alphaCoverage[TriangleIndex()];
+        PBR_STATS_VARIABLE_INCREMENT(stats_nAlphaTests)
+        if (coverage != AlphaCoverage::Partial) {
+            PBR_STATS_VARIABLE_INCREMENT(stats_nAlphaNoLookup)
+        }
+    }
+    // Early cutoff, there is no need to intersect triangle that is cut away completely
+    if (coverage == AlphaCoverage::Transparent)
+        return false;
+
     // Get triangle vertices
     // DIFFERENCE: I'm pretty sure that copy is better than const reference.
     Point3_t p0 = m_mesh->positions[m_vIndices[0]];
     Point3_t p1 = m_mesh->positions[m_vIndices[1]];
     Point3_t p2 = m_mesh->positions[m_vIndices[2]];
 
-    // Transform triangle vertices to ray coordinate space(relative to ray origin)
-    Point3_t p0t = p0 - Vector3_t(r.origin);
-    Point3_t p1t = p1 - Vector3_t(r.origin);
-    Point3_t p2t = p2 - Vector3_t(r.origin);
-    // Calculate dimension where the ray direction is maximal
-    i32 kz = MaxDimension(Abs(r.direction));
-    i32 kx = kz + 1; if (kx == 3) kx = 0;
-    i32 ky = kx + 1; if (ky == 3) ky = 0;
-    // Permute components of triangle vertices and ray direction
-    Vector3_t direction = Permute(r.direction, kx, ky, kz);
-    p0t = Permute(p0t, kx, ky, kz);
-    p1t = Permute(p1t, kx, ky, kz);
-    p2t = Permute(p2t, kx, ky, kz);
-    // Apply shear transformation to translated vertex positions
-    // FINDOUT: Compute Sz first and then Sx=-direction.x * Sz ?
-    fp_t Sx = -direction.x / direction.z;
-    fp_t Sy = -direction.y / direction.z;
-    fp_t Sz = fp_t(1) / direction.z; // FINDOUT: Move where it's used ? Although probably compiler will do it anyway.
-    p0t.x += Sx * p0t.z;
-    p0t.y += Sy * p0t.z;
-    p1t.x += Sx * p1t.z;
-    p1t.y += Sy * p1t.z;
-    p2t.x += Sx * p2t.z;
-    p2t.y += Sy * p2t.z;
-
-    // Compute edge function coefficients
-    fp_t e0 = p1t.x * p2t.y - p1t.y * p2t.x;
-    fp_t e1 = p2t.x * p0t.y - p2t.y * p0t.x;
-    fp_t e2 = p0t.x * p1t.y - p0t.y * p1t.x;
-    // Fall back to double precision test at triangle edges
-    if (sizeof(fp_t) == sizeof(f32) && (e0 == 0 || e1 == 0 || e2 == 0)) {
-        e0 = f32(f64(p1t.x) * f64(p2t.y) - f64(p1t.y) * f64(p2t.x));
-        e1 = f32(f64(p2t.x) * f64(p0t.y) - f64(p2t.y) * f64(p0t.x));
-        e2 = f32(f64(p0t.x) * f64(p1t.y) - f64(p0t.y) * f64(p1t.x));
-    }
-    // Perform triangle edge and determinant tests
-    if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 >0 || e1 > 0 || e2 > 0))
-        return false;
-    fp_t det = e0 + e1 + e2;
-    if (det == 0)
-        return false;
-
-    // Compute scaled hit distance to triangle and test against ray $tMax$ range
-    p0t.z *= Sz;
-    p1t.z *= Sz;
-    p2t.z *= Sz;
-    fp_t tScaled = e0 * p0t.z + e1 * p1t.z + e2 * p2t.z;
-    // NOTE: Probably can be simplified
-    if (det < 0 && (tScaled >= 0 || tScaled < r.tMax * det))
+    fp_t t, b[3];
+    if (IntersectTriangle(r, p0, p1, p2, t, b) == false)
         return false;
-    else if (det > 0 && (tScaled <= 0 || tScaled > r.tMax * det))
-        return false;
-    // Compute barycentric coordinates and triangle intersection
-    fp_t rcpDet = fp_t(1) / det;
-    fp_t b0 = e0 * rcpDet;
-    fp_t b1 = e1 * rcpDet;
-    fp_t b2 = e2 * rcpDet;
-    fp_t t = tScaled * rcpDet;
-
-//#if PBR_PBR_ENABLE_EFLOAT == 1
-    fp_t maxXt = MaxComponent(Abs(Vector3_t(p0t.x, p1t.x, p2t.x)));
-    fp_t maxYt = MaxComponent(Abs(Vector3_t(p0t.y, p1t.y, p2t.y)));
-    fp_t maxZt = MaxComponent(Abs(Vector3_t(p0t.z, p1t.z, p2t.z)));
-    fp_t deltaX = Gamma(5) * (maxXt + maxZt);
-    fp_t deltaY = Gamma(5) * (maxYt + maxZt);
-    fp_t deltaZ = Gamma(3) * maxZt;
-    
-    fp_t deltaE = fp_t(2) * (Gamma(2) * maxXt * maxYt + deltaY * maxXt + deltaX * maxYt);
-    fp_t maxE = MaxComponent(Abs(Vector3_t(e0, e1, e2)));
-    fp_t deltaT = fp_t(3) * (Gamma(3) * maxE * maxZt + deltaE * maxZt + deltaZ * maxE) * std::abs(rcpDet);
-    if (t <= deltaT)
-        return false;
-//#endif
+    fp_t b0 = b[0];
+    fp_t b1 = b[1];
+    fp_t b2 = b[2];
 
     // Compute triangle partial derivatives
     Point2_t uv[3];
     GetUV(uv);
+    // Test intersection against alpha mask, if present
+    if (coverage == AlphaCoverage::Partial) {
+        if (m_mesh->alphaMask->IsOpaque(uv[0] * b0 + uv[1] * b1 + uv[2] * b2) == false)
+            return false;
+    }
     // Compute deltas for triangle partial derivatives
     Vector2_t duv02 = uv[0] - uv[2];
     Vector2_t duv12 = uv[1] - uv[2];
@@ -277,94 +395,48 @@ bool Triangle::Intersect(const Ray_arg r,
     return true;
 }
 
-// TODO: Test shadow ray intersection against alpha texture
 // Watertight Ray/Triangle intersection
-bool Triangle::IsIntersecting(const Ray_arg r, bool testAlphaTexture = true) const
+bool Triangle::IsIntersecting(const Ray_arg r, bool testAlphaTexture) const
 {
     PBR_PROFILE_FUNCTION(ProfileCategory::Triangle_IsIntersecting)
     PBR_STATS_VARIABLE_INCREMENT(stats_nTests)
 
+    // Shadow rays use shadowAlphaMask if it's present, and alphaMask otherwise
+    const AlphaMask *mask = nullptr;
+    AlphaCoverage coverage = AlphaCoverage::Opaque;
+    if (testAlphaTexture && m_mesh->shadowAlphaMask) {
+        mask = m_mesh->shadowAlphaMask.get();
+        coverage = m_mesh->shadowAlphaCoverage[TriangleIndex()];
+    }
+    else if (testAlphaTexture && m_mesh->alphaMask) {
+        mask = m_mesh->alphaMask.get();
+        coverage = m_mesh->alphaCoverage[TriangleIndex()];
+    }
+    if (mask != nullptr) {
+        PBR_STATS_VARIABLE_INCREMENT(stats_nAlphaTests)
+        if (coverage != AlphaCoverage::Partial) {
+            PBR_STATS_VARIABLE_INCREMENT(stats_nAlphaNoLookup)
+        }
+    }
+    if (coverage == AlphaCoverage::Transparent)
+        return false;
+
     // Get triangle vertices
     // DIFFERENCE: I'm pretty sure that copy is better than const reference.
     Point3_t p0 = m_mesh->positions[m_vIndices[0]];
     Point3_t p1 = m_mesh->positions[m_vIndices[1]];
     Point3_t p2 = m_mesh->positions[m_vIndices[2]];
 
-    // Transform triangle vertices to ray coordinate space(relative to ray origin)
-    Point3_t p0t = p0 - Vector3_t(r.origin);
-    Point3_t p1t = p1 - Vector3_t(r.origin);
-    Point3_t p2t = p2 - Vector3_t(r.origin);
-    // Calculate dimension where the ray direction is maximal
-    i32 kz = MaxDimension(Abs(r.direction));
-    i32 kx = kz + 1; if (kx == 3) kx = 0;
-    i32 ky = kx + 1; if (ky == 3) ky = 0;
-    // Permute components of triangle vertices and ray direction
-    Vector3_t direction = Permute(r.direction, kx, ky, kz);
-    p0t = Permute(p0t, kx, ky, kz);
-    p1t = Permute(p1t, kx, ky, kz);
-    p2t = Permute(p2t, kx, ky, kz);
-    // Apply shear transformation to translated vertex positions
-    // FINDOUT: Compute Sz first and then Sx=-direction.x * Sz ?
-    fp_t Sx = -direction.x / direction.z;
-    fp_t Sy = -direction.y / direction.z;
-    fp_t Sz = fp_t(1) / direction.z; // FINDOUT: Move where it's used ? Although probably compiler will do it anyway.
-    p0t.x += Sx * p0t.z;
-    p0t.y += Sy * p0t.z;
-    p1t.x += Sx * p1t.z;
-    p1t.y += Sy * p1t.z;
-    p2t.x += Sx * p2t.z;
-    p2t.y += Sy * p2t.z;
-
-    // Compute edge function coefficients
-    fp_t e0 = p1t.x * p2t.y - p1t.y * p2t.x;
-    fp_t e1 = p2t.x * p0t.y - p2t.y * p0t.x;
-    fp_t e2 = p0t.x * p1t.y - p0t.y * p1t.x;
-    // Fall back to double precision test at triangle edges
-    if (sizeof(fp_t) == sizeof(f32) && (e0 == 0 || e1 == 0 || e2 == 0)) {
-        e0 = f32(f64(p1t.x) * f64(p2t.y) - f64(p1t.y) * f64(p2t.x));
-        e1 = f32(f64(p2t.x) * f64(p0t.y) - f64(p2t.y) * f64(p0t.x));
-        e2 = f32(f64(p0t.x) * f64(p1t.y) - f64(p0t.y) * f64(p1t.x));
-    }
-    // Perform triangle edge and determinant tests
-    if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 >0 || e1 > 0 || e2 > 0))
-        return false;
-    fp_t det = e0 + e1 + e2;
-    if (det == 0)
-        return false;
-
-    // Compute scaled hit distance to triangle and test against ray $tMax$ range
-    p0t.z *= Sz;
-    p1t.z *= Sz;
-    p2t.z *= Sz;
-    fp_t tScaled = e0 * p0t.z + e1 * p1t.z + e2 * p2t.z;
-    // NOTE: Probably can be simplified
-    if (det < 0 && (tScaled >= 0 || tScaled < r.tMax * det))
-        return false;
-    else if (det > 0 && (tScaled <= 0 || tScaled > r.tMax * det))
-        return false;
-    // Compute barycentric coordinates and triangle intersection
-    fp_t rcpDet = fp_t(1) / det;
-    fp_t b0 = e0 * rcpDet;
-    fp_t b1 = e1 * rcpDet;
-    fp_t b2 = e2 * rcpDet;
-    fp_t t = tScaled * rcpDet;
-
-//#if PBR_PBR_ENABLE_EFLOAT == 1
-    fp_t maxXt = MaxComponent(Abs(Vector3_t(p0t.x, p1t.x, p2t.x)));
-    fp_t maxYt = MaxComponent(Abs(Vector3_t(p0t.y, p1t.y, p2t.y)));
-    fp_t maxZt = MaxComponent(Abs(Vector3_t(p0t.z, p1t.z, p2t.z)));
-    fp_t deltaX = Gamma(5) * (maxXt + maxZt);
-    fp_t deltaY = Gamma(5) * (maxYt + maxZt);
-    fp_t deltaZ = Gamma(3) * maxZt;
-    
-    fp_t deltaE = fp_t(2) * (Gamma(2) * maxXt * maxYt + deltaY * maxXt + deltaX * maxYt);
-    fp_t maxE = MaxComponent(Abs(Vector3_t(e0, e1, e2)));
-    fp_t deltaT = fp_t(3) * (Gamma(3) * maxE * maxZt + deltaE * maxZt + deltaZ * maxE) * std::abs(rcpDet);
-    if (t <= deltaT)
+    fp_t t, b[3];
+    if (IntersectTriangle(r, p0, p1, p2, t, b) == false)
         return false;
-//#endif
-
 
+    if (coverage == AlphaCoverage::Partial) {
+        Point2_t uv[3];
+        GetUV(uv);
+        if (mask->IsOpaque(uv[0] * b[0] + uv[1] * b[1] + uv[2] * b[2]) == false)
+            return false;
+    }
 
     PBR_STATS_VARIABLE_INCREMENT(stats_nHits)
 
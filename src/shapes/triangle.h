@@ -1,13 +1,14 @@
 #pragma once
 
 #include "../core/shape.h"
+#include "../core/alphamask.h"
+#include "../core/compactvector.hpp"
 #include <memory>
 #include <vector>
 
 
 PBR_NAMESPACE_BEGIN
 
-// TODO: Texture not implemented
 // TODO: Probably this arrays copyieng can be improved using std::array, std::move and I don't know what else. Passing this pointers looks like shit.
 // TODO: May be I need to add move constructor and move assignment, and delete copy constructor and assignment operator just in case.
 struct TriangleMesh
@@ -16,11 +17,20 @@ struct TriangleMesh
     TriangleMesh(const Transform &ObjectToWorld,
                  i32 _nTriangles, const i32 *_vertexIndices,
                  i32 _nVertices, const Point3_t *_positions,
-                 const Vector3_t *_tangents, const Normal3_t *_normals, const Point2_t *_uv
-                 //const std::shared_ptr<Texture<fp_t>> &alphaMask,
-                 //const std::shared_ptr<Texture<fp_t>> &shadingMask,
+                 const Vector3_t *_tangents, const Normal3_t *_normals, const Point2_t *_uv,
+                 const std::shared_ptr<AlphaMask> &_alphaMask = nullptr,
+                 const std::shared_ptr<AlphaMask> &_shadowAlphaMask = nullptr,
+                 bool compactAttributes = false
                  /*const i32 *faceIndices*/);
 
+    // Per vertex attributes, decoded if they are stored in the compact form. Only valid if Has...() is true.
+    bool HasNormals() const { return normals != nullptr || compactNormals != nullptr; }
+    bool HasTangents() const { return tangents != nullptr || compactTangents != nullptr; }
+    bool HasUV() const { return uv != nullptr || compactUV != nullptr; }
+    Normal3_t Normal(i32 vertex) const { return normals != nullptr ? normals[vertex] : Normal3_t(compactNormals[vertex]); }
+    Vector3_t Tangent(i32 vertex) const { return tangents != nullptr ? tangents[vertex] : Vector3_t(compactTangents[vertex]); }
+    Point2_t UV(i32 vertex) const { return uv != nullptr ? uv[vertex] : Point2_t(compactUV[vertex]); }
+
     // TODO: Most likely std::array will be better than std::vector.
     const i32 nTriangles, nVertices;
     // A pointer to an array of vertex indices.
@@ -33,10 +43,22 @@ struct TriangleMesh
     std::unique_ptr<Vector3_t[]> tangents;
     // An optional array of parametric(u,v) values, one per vertex.
     std::unique_ptr<Point2_t[]> uv;
-    // An optional alpha mask texture, which can be used to cut away parts of triangle surfaces.
-    //std::shared_ptr<Texture<fp_t>> alphaMask;
-    //std::shared_ptr<Texture<fp_t>> shadowAlphaMask // DIFFERENCE: Was not presented in the book.
+    // DIFFERENCE: Compact forms of the three arrays above, with compactAttributes they are stored instead of them.
+    //             Normals and tangents keep only the direction, see OctahedralVector, uv is in half precision, see HalfPoint2.
+    std::unique_ptr<OctahedralVector[]> compactNormals;
+    std::unique_ptr<OctahedralVector[]> compactTangents;
+    std::unique_ptr<HalfPoint2[]> compactUV;
+    // An optional alpha mask, which can be used to cut away parts of triangle surfaces.
+    std::shared_ptr<AlphaMask> alphaMask;
+    std::shared_ptr<AlphaMask> shadowAlphaMask; // DIFFERENCE: Was not presented in the book.
+    // Coverage of every triangle by the masks, empty if there is no mask.
+    //   Fully transparent triangles are rejected before the intersection test, fully opaque ones never touch the mask.
+    std::vector<AlphaCoverage> alphaCoverage;
+    std::vector<AlphaCoverage> shadowAlphaCoverage;
     //std::vector<i32> faceIndices; // DIFFERENCE: Was not presented in the book.
+
+private:
+    std::vector<AlphaCoverage> ClassifyTriangles(const AlphaMask &mask) const;
 };
 
 
@@ -52,6 +74,7 @@ public:
     Bounds3_t ObjectBound() const override;
     Bounds3_t WorldBound() const override;
 
+    using Shape::Intersect;
     bool Intersect(const Ray_arg r,
                    fp_t &out_tHit, SurfaceInteraction &out_isect,
                    bool testAlphaTexture = true) const override;
@@ -59,10 +82,13 @@ public:
 
     fp_t Area() const override;
 
+    const TriangleMesh& Mesh() const { return *m_mesh; }
+
 
 private:
     // TODO: Return instead of pointer ?
     void GetUV(Point2_t out_uv[3]) const;
+    i32 TriangleIndex() const { return static_cast<i32>(m_vIndices - m_mesh->vertexIndices.data()) / 3; }
 
 
     std::shared_ptr<TriangleMesh> m_mesh;
@@ -72,11 +98,19 @@ private:
 };
 
 
-// TODO: Texture not implemented, faceIndices was not in the book.
+// Watertight ray/triangle test, shared by all triangle based shapes.
+//   Returns hit distance and barycentric coordinates of the hit point.
+bool IntersectTriangle(const Ray_arg r, const Point3_arg<fp_t> p0, const Point3_arg<fp_t> p1, const Point3_arg<fp_t> p2,
+                       fp_t &out_t, fp_t out_b[3]);
+
+// TODO: faceIndices was not in the book.
 std::vector<std::shared_ptr<Shape>> CreateTriangleMesh(const Transform *ObjectToWorld, const Transform *WorldToObject, bool reverseOrientation,
                                                        i32 nTriangles, const i32 *vertexIndices,
                                                        i32 nVertices, const Point3_t *positions,
-                                                       const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv);
+                                                       const Vector3_t *tangents, const Normal3_t *normals, const Point2_t *uv,
+                                                       const std::shared_ptr<AlphaMask> &alphaMask = nullptr,
+                                                       const std::shared_ptr<AlphaMask> &shadowAlphaMask = nullptr,
+                                                       bool compactAttributes = false);
 
 
 PBR_NAMESPACE_END
@@ -0,0 +1,114 @@
+#include "doctest.h"
+
+#include "core/alphamask.h"
+
+#include <random>
+#include <vector>
+
+
+TEST_CASE("AlphaMask")
+{
+    using namespace pbr;
+    // 3 words per row, the last one is partially padding
+    constexpr i32 width = 130, height = 4;
+    // uv of the center of texel x, y, may be outside of the texture
+    auto u = [](i32 x) { return (x + fp_t(0.5)) / width; };
+    auto v = [](i32 y) { return (y + fp_t(0.5)) / height; };
+
+    SUBCASE("Uniform textures")
+    {
+        const std::vector<fp_t> opaque(width * height, fp_t(1)), transparent(width * height, fp_t(0));
+        const AlphaMask opaqueMask(width, height, opaque.data());
+        const AlphaMask transparentMask(width, height, transparent.data());
+
+        for (const auto &[uvMin, uvMax] : { std::pair(Point2_t(0, 0), Point2_t(1, 1)),
+                                            std::pair(Point2_t(u(10), v(1)), Point2_t(u(100), v(2))),
+                                            std::pair(Point2_t(-3, -3), Point2_t(-2.5, 7)) }) {
+            CHECK_EQ(opaqueMask.Classify(uvMin, uvMax), AlphaCoverage::Opaque);
+            CHECK_EQ(transparentMask.Classify(uvMin, uvMax), AlphaCoverage::Transparent);
+        }
+        CHECK(opaqueMask.IsOpaque(Point2_t(u(129), v(3))));
+        CHECK_FALSE(transparentMask.IsOpaque(Point2_t(u(129), v(3))));
+    }
+
+    // Columns [60, 70) cross the boundary of the first and the second word, column 129 is the last bit before padding,
+    //   texel (100, 2) is a single opaque texel in the middle of the transparent area.
+    std::vector<fp_t> alpha(width * height, fp_t(0));
+    for (i32 y = 0; y < height; ++y) {
+        for (i32 x = 60; x < 70; ++x)
+            alpha[y * width + x] = fp_t(0.75);
+        alpha[y * width + 129] = fp_t(0.5);
+    }
+    alpha[2 * width + 100] = fp_t(1);
+    alpha[0] = fp_t(0.25);
+    const AlphaMask mask(width, height, alpha.data());
+
+    SUBCASE("Lookup")
+    {
+        CHECK(mask.IsOpaque(Point2_t(u(63), v(0))));
+        CHECK(mask.IsOpaque(Point2_t(u(64), v(3))));
+        CHECK(mask.IsOpaque(Point2_t(u(129), v(1))));
+        CHECK(mask.IsOpaque(Point2_t(u(100), v(2))));
+        CHECK_FALSE(mask.IsOpaque(Point2_t(u(59), v(0))));
+        CHECK_FALSE(mask.IsOpaque(Point2_t(u(0), v(0))));
+        CHECK_FALSE(mask.IsOpaque(Point2_t(u(100), v(1))));
+        // Repeated outside of [0,1]^2
+        CHECK(mask.IsOpaque(Point2_t(u(-1), v(-4))));
+        CHECK(mask.IsOpaque(Point2_t(u(100 + 2 * width), v(2 - height))));
+    }
+
+    SUBCASE("Mixed footprints")
+    {
+        // Opaque across the word boundary and inside of one word
+        CHECK_EQ(mask.Classify(Point2_t(u(60), v(0)), Point2_t(u(69), v(3))), AlphaCoverage::Opaque);
+        CHECK_EQ(mask.Classify(Point2_t(u(64), v(1)), Point2_t(u(66), v(2))), AlphaCoverage::Opaque);
+        CHECK_EQ(mask.Classify(Point2_t(u(61), v(0)), Point2_t(u(63), v(0))), AlphaCoverage::Opaque);
+        // Transparent in the first word, and across the second and the third one
+        CHECK_EQ(mask.Classify(Point2_t(u(1), v(0)), Point2_t(u(59), v(3))), AlphaCoverage::Transparent);
+        CHECK_EQ(mask.Classify(Point2_t(u(70), v(0)), Point2_t(u(128), v(1))), AlphaCoverage::Transparent);
+        // Partial at both edges of the opaque columns
+        CHECK_EQ(mask.Classify(Point2_t(u(58), v(0)), Point2_t(u(62), v(0))), AlphaCoverage::Partial);
+        CHECK_EQ(mask.Classify(Point2_t(u(66), v(3)), Point2_t(u(72), v(3))), AlphaCoverage::Partial);
+        // Single opaque texel is found only by the rows that contain it
+        CHECK_EQ(mask.Classify(Point2_t(u(90), v(0)), Point2_t(u(110), v(1))), AlphaCoverage::Transparent);
+        CHECK_EQ(mask.Classify(Point2_t(u(90), v(0)), Point2_t(u(110), v(2))), AlphaCoverage::Partial);
+        CHECK_EQ(mask.Classify(Point2_t(u(100), v(2)), Point2_t(u(100), v(2))), AlphaCoverage::Opaque);
+        // Whole texture
+        CHECK_EQ(mask.Classify(Point2_t(0, 0), Point2_t(1, 1)), AlphaCoverage::Partial);
+    }
+
+    SUBCASE("Wrapped footprints")
+    {
+        // Columns 127...129 and 0...3, 129 is opaque
+        CHECK_EQ(mask.Classify(Point2_t(u(-3), v(1)), Point2_t(u(3), v(2))), AlphaCoverage::Partial);
+        CHECK_EQ(mask.Classify(Point2_t(u(-1), v(1)), Point2_t(u(-1), v(3))), AlphaCoverage::Opaque);
+        // Columns 1...3 of the next and of the previous tile
+        CHECK_EQ(mask.Classify(Point2_t(u(width + 1), v(0)), Point2_t(u(width + 3), v(3))), AlphaCoverage::Transparent);
+        CHECK_EQ(mask.Classify(Point2_t(u(1 - width), v(0)), Point2_t(u(3 - width), v(3))), AlphaCoverage::Transparent);
+        // Rows wrap too, 3 and 0...1 of the opaque columns
+        CHECK_EQ(mask.Classify(Point2_t(u(62), v(-1)), Point2_t(u(67), v(1))), AlphaCoverage::Opaque);
+        CHECK_EQ(mask.Classify(Point2_t(u(-2 * width + 101), v(height + 1)), Point2_t(u(-2 * width + 101), v(height + 2))),
+                 AlphaCoverage::Transparent);
+        CHECK_EQ(mask.Classify(Point2_t(u(99), v(height + 1)), Point2_t(u(101), v(height + 2))), AlphaCoverage::Partial);
+    }
+
+    SUBCASE("Random footprints")
+    {
+        // Classify() must agree with the lookups of every texel in the footprint
+        std::mt19937 rng(29);
+        std::uniform_int_distribution<i32> xDist(-2 * width, 2 * width), yDist(-2 * height, 2 * height);
+        std::uniform_int_distribution<i32> sizeDist(0, 80);
+        for (i32 i = 0; i < 1000; ++i) {
+            const i32 x0 = xDist(rng), y0 = yDist(rng);
+            const i32 x1 = x0 + sizeDist(rng), y1 = y0 + sizeDist(rng) / 20;
+
+            bool anyOpaque = false, anyTransparent = false;
+            for (i32 y = y0; y <= y1; ++y)
+                for (i32 x = x0; x <= x1; ++x)
+                    (mask.IsOpaque(Point2_t(u(x), v(y))) ? anyOpaque : anyTransparent) = true;
+            const AlphaCoverage expected = anyOpaque && anyTransparent ? AlphaCoverage::Partial :
+                                           (anyOpaque ? AlphaCoverage::Opaque : AlphaCoverage::Transparent);
+            CHECK_EQ(mask.Classify(Point2_t(u(x0), v(y0)), Point2_t(u(x1), v(y1))), expected);
+        }
+    }
+}
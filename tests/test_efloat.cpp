@@ -0,0 +1,217 @@
+#include "doctest.h"
+
+#include "core/efloat.hpp"
+#include "core/geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+// NOTE: Reference values are computed in long double from the same inputs, it has at least as many bits as f64,
+//       and errors of the reference are much smaller than the bounds, which grow by a few ulps every operation.
+using Precise = long double;
+
+TEST_CASE_TEMPLATE("EFloat bounds contain precise result", EFloatType, pbr::EFloatT<true>, pbr::EFloatT<false>)
+{
+    using namespace pbr;
+
+    std::mt19937 rng(32);
+    std::uniform_real_distribution<fp_t> uniform(-4, 4), positive(fp_t(0.25), 4), unit(-1, 1);
+
+    // Value with initial error, and the precise value somewhere inside of it
+    auto sample = [&](bool onlyPositive = false) {
+        const fp_t value = onlyPositive ? positive(rng) : uniform(rng);
+        const fp_t error = std::abs(value) * fp_t(1e-5) * (unit(rng) + 1);
+        return std::pair(EFloatType(value, error), Precise(value) + Precise(error) * Precise(unit(rng)));
+    };
+    auto contains = [](EFloatType ef, Precise precise) {
+        return Precise(ef.LowerBound()) <= precise && precise <= Precise(ef.UpperBound());
+    };
+
+    for (i32 i = 0; i < 1000; ++i) {
+        const auto [a, pa] = sample();
+        const auto [b, pb] = sample();
+        const auto [c, pc] = sample(true);
+
+        CHECK(contains(a + b, pa + pb));
+        CHECK(contains(a - b, pa - pb));
+        CHECK(contains(a * b, pa * pb));
+        CHECK(contains(a / c, pa / pc));
+        CHECK(contains(-a, -pa));
+        CHECK(contains(Abs(a), std::abs(pa)));
+        CHECK(contains(Sqrt(c), std::sqrt(pc)));
+        CHECK(contains(fp_t(3) * a - b, 3 * pa - pb));
+
+        // Error of a longer expression accumulates from all of its operations
+        const EFloatType expression = (a * b + c) / (c + Abs(b)) - Sqrt(c * c + a * a);
+        const Precise preciseExpression = (pa * pb + pc) / (pc + std::abs(pb)) - std::sqrt(pc * pc + pa * pa);
+        CHECK(contains(expression, preciseExpression));
+    }
+
+    SUBCASE("Quadratic")
+    {
+        // Coefficients of the ray/sphere intersection, same expressions as in Sphere
+        i32 nSolved = 0;
+        for (i32 i = 0; i < 1000; ++i) {
+            const auto [ox, pox] = sample();
+            const auto [oy, poy] = sample();
+            const auto [oz, poz] = sample();
+            const auto [dx, pdx] = sample();
+            const auto [dy, pdy] = sample();
+            const auto [dz, pdz] = sample();
+            const fp_t radius = positive(rng);
+
+            const EFloatType a = dx * dx + dy * dy + dz * dz;
+            const EFloatType b = fp_t(2) * (dx * ox + dy * oy + dz * oz);
+            const EFloatType c = ox * ox + oy * oy + oz * oz - EFloatType(radius) * EFloatType(radius);
+            const Precise pa = pdx * pdx + pdy * pdy + pdz * pdz;
+            const Precise pb = 2 * (pdx * pox + pdy * poy + pdz * poz);
+            const Precise pc = pox * pox + poy * poy + poz * poz - Precise(radius) * Precise(radius);
+            CHECK(contains(a, pa));
+            CHECK(contains(b, pb));
+            CHECK(contains(c, pc));
+
+            const Precise discriminant = pb * pb - 4 * pa * pc;
+            CHECK(contains(b * b - fp_t(4) * a * c, discriminant));
+
+            EFloatType t0{}, t1{};
+            // Near zero discriminant the sign of the precise one may be different
+            if (Quadratic(a, b, c, t0, t1) == false || discriminant < 0)
+                continue;
+
+            ++nSolved;
+            const Precise q = pb < 0 ? Precise(-0.5) * (pb - std::sqrt(discriminant)) : Precise(-0.5) * (pb + std::sqrt(discriminant));
+            const Precise roots[2] = { std::min(q / pa, pc / q), std::max(q / pa, pc / q) };
+            CHECK(contains(t0, roots[0]));
+            CHECK(contains(t1, roots[1]));
+        }
+        CHECK_GT(nSolved, 100);
+    }
+}
+
+TEST_CASE("RawFloat bounds contain precise result")
+{
+    using namespace pbr;
+
+    std::mt19937 rng(32);
+    std::uniform_real_distribution<fp_t> uniform(-4, 4), positive(fp_t(0.25), 4);
+
+    // NOTE: Cancellation is covered by the ray starting on the surface, see the test below.
+    for (i32 i = 0; i < 1000; ++i) {
+        const fp_t x = uniform(rng), y = uniform(rng), z = positive(rng), w = positive(rng);
+        auto contains = [](RawFloat f, Precise precise) {
+            return Precise(f.LowerBound()) <= precise && precise <= Precise(f.UpperBound());
+        };
+
+        const RawFloat rx(x), ry(y), rz(z), rw(w);
+        CHECK(contains(rx * rx + ry * ry + rz * rz, Precise(x) * x + Precise(y) * y + Precise(z) * z));
+        CHECK(contains(rx * ry / rz, Precise(x) * y / z));
+        CHECK(contains(Sqrt(rz * rw) + rz / rw, std::sqrt(Precise(z) * w) + Precise(z) / w));
+        CHECK(contains(fp_t(2) * Abs(rx) * rw, 2 * std::abs(Precise(x)) * w));
+
+        // (t - z)(t + w) = t^2 + (w - z) t - z w, roots are -w and z
+        RawFloat t0{}, t1{};
+        REQUIRE(Quadratic(RawFloat(1), rw - rz, -(rz * rw), t0, t1));
+        const Precise b = Precise(w) - z, c = -(Precise(z) * w);
+        const Precise q = b < 0 ? Precise(-0.5) * (b - std::sqrt(b * b - 4 * c)) : Precise(-0.5) * (b + std::sqrt(b * b - 4 * c));
+        CHECK(contains(t0, std::min(q, c / q)));
+        CHECK(contains(t1, std::max(q, c / q)));
+    }
+}
+
+
+// Ray starts on the sphere and points inside, c cancels out and the root at the origin is close to 0.
+//   Root with the lower bound above 0 is taken as a hit by the quadrics, so the precise one has to be above 0 too.
+TEST_CASE_TEMPLATE("Quadratic roots of the ray starting on the surface", FloatType, pbr::RawFloat, pbr::EFloatT<false>, pbr::EFloatT<true>)
+{
+    using namespace pbr;
+
+    std::mt19937 rng(32);
+    std::normal_distribution<fp_t> normal;
+    i32 nBehind = 0, nFarHits = 0;
+    for (i32 i = 0; i < 20000; ++i) {
+        const fp_t radius = i % 2 == 0 ? fp_t(1) : fp_t(3.7);
+        const Vector3_t o = radius * Normalize(Vector3_t(normal(rng), normal(rng), normal(rng)));
+        Vector3_t d(normal(rng), normal(rng), normal(rng));
+        if (Dot(d, o) > 0)
+            d = -d;
+
+        const FloatType ox(o.x), oy(o.y), oz(o.z), dx(d.x), dy(d.y), dz(d.z);
+        const FloatType a = dx * dx + dy * dy + dz * dz;
+        const FloatType b = fp_t(2) * (dx * ox + dy * oy + dz * oz);
+        const FloatType c = ox * ox + oy * oy + oz * oz - FloatType(radius) * FloatType(radius);
+        FloatType t0{}, t1{};
+        if (Quadratic(a, b, c, t0, t1) == false)
+            continue;
+
+        const Precise pa = Precise(d.x) * d.x + Precise(d.y) * d.y + Precise(d.z) * d.z;
+        const Precise pb = 2 * (Precise(d.x) * o.x + Precise(d.y) * o.y + Precise(d.z) * o.z);
+        const Precise pc = Precise(o.x) * o.x + Precise(o.y) * o.y + Precise(o.z) * o.z - Precise(radius) * radius;
+        const Precise discriminant = pb * pb - 4 * pa * pc;
+        if (discriminant < 0)
+            continue;
+        const Precise q = pb < 0 ? Precise(-0.5) * (pb - std::sqrt(discriminant)) : Precise(-0.5) * (pb + std::sqrt(discriminant));
+        const Precise roots[2] = { std::min(q / pa, pc / q), std::max(q / pa, pc / q) };
+
+        nBehind += roots[0] <= 0;
+        nFarHits += t1.LowerBound() > 0;
+        if (roots[0] <= 0)
+            CHECK_FALSE(t0.LowerBound() > 0);
+        if (roots[1] <= 0)
+            CHECK_FALSE(t1.LowerBound() > 0);
+    }
+    // Origin is on both sides of the surface, and the other side of the sphere is still hit
+    CHECK_GT(nBehind, 5000);
+    CHECK_GT(nFarHits, 19000);
+}
+
+// NOTE: Lanes are f32, so they're compared with scalar EFloat only when fp_t is f32 too.
+#if PBR_ENABLE_SSE == 1 && PBR_FP_T_F64 == 0
+
+TEST_CASE_TEMPLATE("EFloatN matches scalar EFloat", EFloatType, pbr::EFloat4, pbr::EFloat8)
+{
+    using namespace pbr;
+    constexpr i32 width = EFloatType::width;
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<f32> uniform(-4, 4);
+
+    for (i32 iteration = 0; iteration < 256; ++iteration) {
+        EFloatT<true> a[width], b[width], c[width];
+        for (i32 i = 0; i < width; ++i) {
+            // Coefficients with some error, as they come from the transformed ray
+            a[i] = EFloatT<true>(uniform(rng)) * EFloatT<true>(uniform(rng));
+            b[i] = EFloatT<true>(uniform(rng)) + EFloatT<true>(uniform(rng));
+            c[i] = EFloatT<true>(uniform(rng)) - EFloatT<true>(uniform(rng));
+        }
+
+        EFloatType t0, t1;
+        const i32 hasSolution = MoveMask(Quadratic(EFloatType(a), EFloatType(b), EFloatType(c), t0, t1));
+        const EFloatType sum = EFloatType(a) + EFloatType(b) / EFloatType(c);
+
+        for (i32 i = 0; i < width; ++i) {
+            EFloatT<false> scalarT0{}, scalarT1{};
+            const bool scalarHasSolution = Quadratic(EFloatT<false>(static_cast<f32>(a[i]), a[i].GetAbsoluteError()),
+                                                     EFloatT<false>(static_cast<f32>(b[i]), b[i].GetAbsoluteError()),
+                                                     EFloatT<false>(static_cast<f32>(c[i]), c[i].GetAbsoluteError()),
+                                                     scalarT0, scalarT1);
+            REQUIRE_EQ(((hasSolution >> i) & 1) != 0, scalarHasSolution);
+            if (scalarHasSolution) {
+                CHECK(t0.template Lane<false>(i) == scalarT0);
+                CHECK(t1.template Lane<false>(i) == scalarT1);
+                CHECK_EQ(t0.UpperBound()[i], scalarT0.UpperBound());
+                CHECK_EQ(t1.LowerBound()[i], scalarT1.LowerBound());
+            }
+
+            const EFloatT<true> scalarSum = a[i] + b[i] / c[i];
+            CHECK_EQ(sum.Value()[i], static_cast<f32>(scalarSum));
+            CHECK_EQ(sum.GetAbsoluteError()[i], scalarSum.GetAbsoluteError());
+            // Bounds contain the precise value
+            CHECK(f64(sum.LowerBound()[i]) <= scalarSum.GetPreciseValue());
+            CHECK(f64(sum.UpperBound()[i]) >= scalarSum.GetPreciseValue());
+        }
+    }
+}
+
+#endif
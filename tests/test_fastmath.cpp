@@ -0,0 +1,124 @@
+#include "doctest.h"
+
+#include "core/fastmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace
+{
+
+using namespace pbr;
+
+// Maximum errors documented in fastmath.hpp, against f64 std functions.
+constexpr f64 kATan2MaxError = 2.0e-6;
+constexpr f64 kACosMaxError = 4.4e-7;
+constexpr f64 kSinCosMaxError = 9.3e-8;
+
+constexpr i32 kSweepCount = 1 << 20;
+
+// kSweepCount + 1 evenly spaced values from min to max, both included.
+std::vector<f32> Sweep(f32 min, f32 max)
+{
+    std::vector<f32> values(kSweepCount + 1);
+    for (i32 i = 0; i <= kSweepCount; ++i)
+        values[i] = static_cast<f32>(min + (f64(max) - min) * i / kSweepCount);
+    return values;
+}
+
+template<typename Precise, typename Fast>
+f64 MaxError(const std::vector<f32> &a, const std::vector<f32> &b, Precise precise, Fast fast)
+{
+    f64 maxError = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        maxError = std::max(maxError, std::abs(precise(f64(a[i]), f64(b[i])) - f64(fast(a[i], b[i]))));
+    return maxError;
+}
+
+#if PBR_ENABLE_SSE == 1
+// Number of lanes that aren't bit exact with the scalar function.
+template<typename FastSSE, typename Fast>
+i32 CountSSEMismatches(const std::vector<f32> &a, const std::vector<f32> &b, FastSSE fastSSE, Fast fast)
+{
+    i32 mismatches = 0;
+    for (size_t i = 0; i + 4 <= a.size(); i += 4) {
+        alignas(16) f32 lanes[4];
+        _mm_store_ps(lanes, fastSSE(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+        for (size_t lane = 0; lane < 4; ++lane)
+            mismatches += std::bit_cast<ui32>(lanes[lane]) != std::bit_cast<ui32>(fast(a[i + lane], b[i + lane]));
+    }
+    return mismatches;
+}
+#endif
+
+} // namespace
+
+
+TEST_CASE("fastmath error bounds")
+{
+    SUBCASE("ATan2")
+    {
+        // Points on the unit circle cover all octants, random points in the square cover other magnitudes.
+        std::vector<f32> y, x;
+        for (const f32 angle : Sweep(-constants::pi_t, constants::pi_t)) {
+            y.push_back(std::sin(angle));
+            x.push_back(std::cos(angle));
+        }
+        const std::vector<f32> square = Sweep(-1, 1);
+        for (i32 i = 0; i <= kSweepCount; ++i) {
+            y.push_back(square[i]);
+            x.push_back(square[(i64(i) * 7919) % (kSweepCount + 1)]);
+        }
+        // Axes and the origin
+        for (const f32 v : { -2.f, -0.f, 0.f, 2.f })
+            for (const f32 w : { -2.f, 0.f, 2.f }) {
+                y.push_back(v);
+                x.push_back(w);
+            }
+
+        CHECK_LE(MaxError(y, x, [](f64 a, f64 b) { return std::atan2(a, b); },
+                          [](f32 a, f32 b) { return fastmath::ATan2(a, b); }), kATan2MaxError);
+        CHECK_EQ(fastmath::ATan2(0.f, 0.f), 0.f);
+#if PBR_ENABLE_SSE == 1
+        CHECK_EQ(CountSSEMismatches(y, x, [](__m128 a, __m128 b) { return fastmath::ATan2(a, b); },
+                                    [](f32 a, f32 b) { return fastmath::ATan2(a, b); }), 0);
+#endif
+    }
+
+    SUBCASE("ACos")
+    {
+        const std::vector<f32> x = Sweep(-1, 1);
+        CHECK_LE(MaxError(x, x, [](f64 a, f64) { return std::acos(a); },
+                          [](f32 a, f32) { return fastmath::ACos(a); }), kACosMaxError);
+#if PBR_ENABLE_SSE == 1
+        CHECK_EQ(CountSSEMismatches(x, x, [](__m128 a, __m128) { return fastmath::ACos(a); },
+                                    [](f32 a, f32) { return fastmath::ACos(a); }), 0);
+#endif
+    }
+
+    SUBCASE("Sin and Cos")
+    {
+        const std::vector<f32> angles = Sweep(-8 * constants::pi_t, 8 * constants::pi_t);
+        CHECK_LE(MaxError(angles, angles, [](f64 a, f64) { return std::sin(a); },
+                          [](f32 a, f32) { return fastmath::Sin(a); }), kSinCosMaxError);
+        CHECK_LE(MaxError(angles, angles, [](f64 a, f64) { return std::cos(a); },
+                          [](f32 a, f32) { return fastmath::Cos(a); }), kSinCosMaxError);
+
+        // SinCos() is the same as separate calls
+        i32 sinCosMismatches = 0;
+        for (const f32 angle : angles) {
+            f32 s, c;
+            fastmath::SinCos(angle, s, c);
+            sinCosMismatches += s != fastmath::Sin(angle) || c != fastmath::Cos(angle);
+        }
+        CHECK_EQ(sinCosMismatches, 0);
+#if PBR_ENABLE_SSE == 1
+        CHECK_EQ(CountSSEMismatches(angles, angles, [](__m128 a, __m128) { return fastmath::Sin(a); },
+                                    [](f32 a, f32) { return fastmath::Sin(a); }), 0);
+        CHECK_EQ(CountSSEMismatches(angles, angles, [](__m128 a, __m128) { return fastmath::Cos(a); },
+                                    [](f32 a, f32) { return fastmath::Cos(a); }), 0);
+#endif
+    }
+}
@@ -1,6 +1,9 @@
 #include "doctest.h"
 
 #include "core/geometry.hpp"
+#include "core/compactvector.hpp"
+
+#include <random>
 
 
 // may be try TEST_CASE_TEMPLATE
@@ -11,15 +14,15 @@ TEST_CASE("Vector3")
 {
     using namespace pbr;
 
-    Vector3f v1(-1, -2, -3);
-    Vector3f v2(2, 4, 6);
+    Vector3_t v1(-1, -2, -3);
+    Vector3_t v2(2, 4, 6);
 
     SUBCASE("Constructors")
     {
-        Vector3f v_zero;
+        Vector3_t v_zero;
         CHECK_EQ((v_zero.x == 0 && v_zero.y == 0 && v_zero.z == 0), true);
 
-        Vector3f v_one(1);
+        Vector3_t v_one(1);
         CHECK_EQ((v_one.x == 1 && v_one.y == 1 && v_one.z == 1), true);
 
         CHECK_EQ((v2.x == 2 && v2.y == 4 && v2.z == 6), true);
@@ -37,37 +40,162 @@ TEST_CASE("Vector3")
     }
     SUBCASE("Compound ariphmetic operators (vector,vector)")
     {
-        Vector3f v_t(0);
+        Vector3_t v_t(0);
         v_t += v1;
-        CHECK_EQ(v_t, Vector3f(-1, -2, -3));
+        CHECK_EQ(v_t, Vector3_t(-1, -2, -3));
         v_t -= v2;
-        CHECK_EQ(v_t, Vector3f(-3, -6, -9));
+        CHECK_EQ(v_t, Vector3_t(-3, -6, -9));
     }
     SUBCASE("Compound ariphmetic operators (vector,scalar)")
     {
-        Vector3f v_t(2);
+        Vector3_t v_t(2);
         v_t *= 2;
-        CHECK_EQ(v_t, Vector3f(4));
+        CHECK_EQ(v_t, Vector3_t(4));
         v_t /= -8;
-        CHECK_EQ(v_t, Vector3f(-0.5f));
+        CHECK_EQ(v_t, Vector3_t(-0.5f));
     }
     SUBCASE("Unray ariphmetic operators")
     {
-        CHECK_EQ(-v1, Vector3f(1, 2, 3));
+        CHECK_EQ(-v1, Vector3_t(1, 2, 3));
     }
     SUBCASE("Binary ariphmetic operators (vector,vector)")
     {
-        CHECK_EQ(v1 + v2, Vector3f(1, 2, 3));
-        CHECK_EQ(v1 - v2, Vector3f(-3, -6, -9));
-        CHECK_EQ(v1 * v2, Vector3f(-2, -8, -18));
+        CHECK_EQ(v1 + v2, Vector3_t(1, 2, 3));
+        CHECK_EQ(v1 - v2, Vector3_t(-3, -6, -9));
+        CHECK_EQ(v1 * v2, Vector3_t(-2, -8, -18));
     }
     SUBCASE("Binary ariphmetic operators (vector,scalar)")
     {
-        CHECK_EQ(v1 * -2.f, Vector3f(2, 4, 6));
-        CHECK_EQ(v1 / 2.f, Vector3f(-0.5f, -1, -1.5f));
+        CHECK_EQ(v1 * fp_t(-2), Vector3_t(2, 4, 6));
+        CHECK_EQ(v1 / fp_t(2), Vector3_t(-0.5f, -1, -1.5f));
     }
     SUBCASE("Binary ariphmetic operators (scalar,vector)")
     {
-        CHECK_EQ(-2.f * v1, Vector3f(2, 4, 6));
+        CHECK_EQ(fp_t(-2) * v1, Vector3_t(2, 4, 6));
+    }
+}
+
+TEST_CASE("Vector3A")
+{
+    using namespace pbr;
+    const Vector3_t v1(-1, -2, -3), v2(2, 4, 6.5f);
+    const Vector3A_t a1(v1), a2(v2);
+
+    SUBCASE("Conversions")
+    {
+        CHECK_EQ(Vector3_t(a1), v1);
+        CHECK_EQ(Point3_t(a2), Point3_t(v2));
+        CHECK_EQ(a1.X(), -1);
+        CHECK_EQ(a1.Y(), -2);
+        CHECK_EQ(a1.Z(), -3);
+        CHECK_EQ(a2[2], 6.5f);
+    }
+    SUBCASE("Ariphmetic operators match Vector3")
+    {
+        CHECK_EQ(Vector3_t(a1 + a2), v1 + v2);
+        CHECK_EQ(Vector3_t(a1 - a2), v1 - v2);
+        CHECK_EQ(Vector3_t(a1 * a2), v1 * v2);
+        CHECK_EQ(Vector3_t(a1 * fp_t(-2)), v1 * fp_t(-2));
+        CHECK_EQ(Vector3_t(a2 / fp_t(3)), v2 / fp_t(3));
+        CHECK_EQ(Vector3_t(-a1), -v1);
+    }
+    SUBCASE("Utility functions match Vector3")
+    {
+        CHECK_EQ(Dot(a1, a2), Dot(v1, v2));
+        CHECK_EQ(a2.Length(), v2.Length());
+        CHECK_EQ(Vector3_t(Cross(a1, a2)), Cross(v1, v2));
+        CHECK_EQ(Vector3_t(Normalize(a2)), Normalize(v2));
+        CHECK_EQ(Vector3_t(Abs(a1)), Abs(v1));
+        CHECK_EQ(Vector3_t(Min(a1, a2)), Min(v1, v2));
+        CHECK_EQ(Vector3_t(Max(a1, a2)), Max(v1, v2));
+        CHECK_EQ(MinComponent(a1), MinComponent(v1));
+        CHECK_EQ(MaxComponent(a2), MaxComponent(v2));
+        CHECK_EQ(Vector3_t(Permute(a2, 2, 0, 1)), Permute(v2, 2, 0, 1));
+        // Ties go to the last dimension
+        CHECK_EQ(MaxDimension(a2), MaxDimension(v2));
+        CHECK_EQ(MaxDimension(Vector3A_t(1, 1, 0)), MaxDimension(Vector3_t(1, 1, 0)));
+        CHECK_EQ(MaxDimension(Vector3A_t(1, 0, 1)), MaxDimension(Vector3_t(1, 0, 1)));
+        CHECK_EQ(MaxDimension(Vector3A_t(2, 1, 1)), MaxDimension(Vector3_t(2, 1, 1)));
+    }
+}
+
+TEST_CASE("Bounds3 IntersectP with TraversalRay")
+{
+    using namespace pbr;
+    const Bounds3_t box(Point3_t(-1, -2, 0.5f), Point3_t(2, 1, 3));
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<fp_t> uniform(-4, 4);
+    for (i32 i = 0; i < 4096; ++i) {
+        Ray r(Point3_t(uniform(rng), uniform(rng), uniform(rng)), Vector3_t(uniform(rng), uniform(rng), uniform(rng)));
+        if (i % 4 == 0)
+            r.tMax = std::abs(uniform(rng));
+        const TraversalRay ray(r);
+        CHECK_EQ(ray.dirIsNeg[0], r.direction.x < 0);
+
+        fp_t hit0 = 0, hit1 = 0, cachedHit0 = 0, cachedHit1 = 0;
+        const bool hit = box.IntersectP(r, &hit0, &hit1);
+        REQUIRE_EQ(box.IntersectP(ray, cachedHit0, cachedHit1), hit);
+        if (hit) {
+            // Reciprocal is rounded, so it's not bit exact to the division
+            CHECK(std::abs(cachedHit0 - hit0) <= fp_t(1e-5) * (1 + std::abs(hit0)));
+            CHECK(std::abs(cachedHit1 - hit1) <= fp_t(1e-5) * (1 + std::abs(hit1)));
+        }
+        CHECK_EQ(box.IntersectP(ray), box.IntersectP(r, ray.invDir, ray.dirIsNeg));
+    }
+}
+
+TEST_CASE("Half precision")
+{
+    using namespace pbr;
+    // Every finite half survives the round trip
+    for (ui32 h = 0; h < 0x10000; ++h)
+        if ((h & 0x7C00) != 0x7C00)
+            REQUIRE_EQ(FloatToHalf(HalfToFloat(static_cast<ui16>(h))), h);
+
+    CHECK_EQ(HalfToFloat(FloatToHalf(1.0f)), 1.0f);
+    CHECK_EQ(HalfToFloat(FloatToHalf(-0.5f)), -0.5f);
+    CHECK_EQ(HalfToFloat(FloatToHalf(65504.0f)), 65504.0f);
+    CHECK(std::isinf(HalfToFloat(FloatToHalf(65520.0f))));
+    CHECK(std::isnan(HalfToFloat(FloatToHalf(std::numeric_limits<f32>::quiet_NaN()))));
+    // Ties round to even
+    CHECK_EQ(HalfToFloat(FloatToHalf(1.0f + 1.0f / 2048)), 1.0f);
+    CHECK_EQ(HalfToFloat(FloatToHalf(1.0f + 3.0f / 2048)), 1.0f + 2.0f / 1024);
+    CHECK_EQ(HalfToFloat(FloatToHalf(3.0f / (1 << 25))), 2.0f / (1 << 24));
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<fp_t> uniform(0, 1);
+    for (i32 i = 0; i < 4096; ++i) {
+        const Point2_t p(uniform(rng), uniform(rng));
+        const Point2_t decoded(HalfPoint2{ p });
+        CHECK(std::abs(decoded.x - p.x) <= fp_t(1) / 4096);
+        CHECK(std::abs(decoded.y - p.y) <= fp_t(1) / 4096);
+    }
+}
+
+TEST_CASE("OctahedralVector")
+{
+    using namespace pbr;
+    const Vector3_t axes[] = { Vector3_t(1, 0, 0), Vector3_t(0, 1, 0), Vector3_t(0, 0, 1),
+                               Vector3_t(-1, 0, 0), Vector3_t(0, -1, 0), Vector3_t(0, 0, -1) };
+    for (const Vector3_t &axis : axes)
+        CHECK(Dot(Vector3_t(OctahedralVector(axis)), axis) > fp_t(1) - fp_t(1e-6));
+    // Zero vector has no direction, it's +z instead of NaN
+    CHECK(Dot(Vector3_t(OctahedralVector(Vector3_t(0, 0, 0))), Vector3_t(0, 0, 1)) > fp_t(1) - fp_t(1e-6));
+
+    std::mt19937 rng(11);
+    std::normal_distribution<fp_t> normal;
+    for (i32 i = 0; i < 4096; ++i) {
+        const Vector3_t v(normal(rng), normal(rng), normal(rng));
+        // Length doesn't matter
+        const Vector3_t decoded(OctahedralVector(v * fp_t(3)));
+        CHECK(std::abs(decoded.Length() - 1) < fp_t(1e-5));
+        // 0.005 degrees
+        CHECK(Cross(decoded, Normalize(v)).Length() < fp_t(8.8e-5));
+
+        // Normals are encoded the same way
+        const OctahedralVector encoded(v), encodedNormal(Normal3_t(v.x, v.y, v.z));
+        CHECK_EQ(encodedNormal.x, encoded.x);
+        CHECK_EQ(encodedNormal.y, encoded.y);
     }
 }
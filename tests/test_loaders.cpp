@@ -0,0 +1,410 @@
+#include "doctest.h"
+
+#include "core/mappedfile.h"
+#include "core/parallel.h"
+#include "loaders/objmesh.h"
+#include "loaders/plymesh.h"
+#include "loaders/rawmesh.h"
+#include "shapes/bilinearpatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <process.h>    // _getpid
+#else
+    #include <unistd.h>     // getpid
+#endif
+
+
+namespace
+{
+
+using namespace pbr;
+
+// NOTE: f32 and f64 test binaries run in parallel with ctest -j, so the name has the precision and the process id.
+std::string TempFilePath(const char *name)
+{
+#ifdef _WIN32
+    const i32 pid = _getpid();
+#else
+    const i32 pid = static_cast<i32>(getpid());
+#endif
+    const std::string unique = "f" + std::to_string(8 * sizeof(fp_t)) + "_" + std::to_string(pid) + "_" + name;
+    return (std::filesystem::temp_directory_path() / unique).string();
+}
+
+void WriteFile(const std::string &path, const std::string &content)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+// Appends value in the requested byte order.
+template<typename T>
+void Append(std::string &out, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (bigEndian != (std::endian::native == std::endian::big))
+        std::reverse(bytes, bytes + sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// Binary PLY with f32 positions and faces with uchar sized lists of IndexT.
+template<typename IndexT = i32>
+std::string MakePly(const std::vector<f32> &positions, const std::vector<std::vector<IndexT>> &faces,
+                    bool bigEndian, const char *indexType = "int")
+{
+    std::string ply = "ply\n";
+    ply += bigEndian ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n";
+    ply += "comment test mesh\n";
+    ply += "element vertex " + std::to_string(positions.size() / 3) + "\n";
+    ply += "property float x\nproperty float y\nproperty float z\n";
+    ply += "element face " + std::to_string(faces.size()) + "\n";
+    ply += std::string("property list uchar ") + indexType + " vertex_indices\n";
+    ply += "end_header\n";
+    for (f32 p : positions)
+        Append(ply, p, bigEndian);
+    for (const auto &face : faces) {
+        Append(ply, static_cast<ui8>(face.size()), bigEndian);
+        for (IndexT index : face)
+            Append(ply, index, bigEndian);
+    }
+    return ply;
+}
+
+f64 TotalArea(const std::vector<std::shared_ptr<Shape>> &shapes)
+{
+    f64 area = 0;
+    for (const auto &shape : shapes)
+        area += shape->Area();
+    return area;
+}
+
+// Unit square in z = 0 plane
+const std::vector<f32> squarePositions = { 0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0 };
+
+} // namespace
+
+
+TEST_CASE("LoadPlyMesh")
+{
+    const Transform identity{ Matrix4x4() };
+    const std::string path = TempFilePath("pbr_test_mesh.ply");
+
+    SUBCASE("Binary little and big endian")
+    {
+        for (bool bigEndian : { false, true }) {
+            WriteFile(path, MakePly(squarePositions, { { 0, 1, 2 }, { 0, 2, 3 } }, bigEndian));
+            const auto shapes = LoadPlyMesh(path, &identity, &identity, false);
+            REQUIRE_EQ(shapes.size(), 2);
+            CHECK_EQ(TotalArea(shapes), doctest::Approx(1));
+
+            const Bounds3_t bounds = Union(shapes[0]->WorldBound(), shapes[1]->WorldBound());
+            CHECK_EQ(bounds.pMin, Point3_t(0, 0, 0));
+            CHECK_EQ(bounds.pMax, Point3_t(1, 1, 0));
+        }
+    }
+
+    SUBCASE("Quad splitting")
+    {
+        WriteFile(path, MakePly(squarePositions, { { 0, 1, 2, 3 } }, false));
+        auto shapes = LoadPlyMesh(path, &identity, &identity, false);
+        REQUIRE_EQ(shapes.size(), 2);
+        CHECK_EQ(TotalArea(shapes), doctest::Approx(1));
+
+        shapes = LoadPlyMesh(path, &identity, &identity, false, true);
+        REQUIRE_EQ(shapes.size(), 1);
+        CHECK_NE(dynamic_cast<const BilinearPatch*>(shapes[0].get()), nullptr);
+        CHECK_EQ(TotalArea(shapes), doctest::Approx(1));
+    }
+
+    SUBCASE("Mixed polygons")
+    {
+        // Sizes differ, so faces go through the slow path, pentagon is a fan of 3 triangles
+        const std::vector<f32> positions = { 0, 0, 0,  2, 0, 0,  2, 1, 0,  1, 2, 0,  0, 1, 0 };
+        WriteFile(path, MakePly(positions, { { 0, 1, 2 }, { 0, 1, 2, 4 }, { 0, 1, 2, 3, 4 } }, true));
+        auto shapes = LoadPlyMesh(path, &identity, &identity, false);
+        CHECK_EQ(shapes.size(), 1 + 2 + 3);
+
+        shapes = LoadPlyMesh(path, &identity, &identity, false, true);
+        CHECK_EQ(shapes.size(), 1 + 1 + 3);
+    }
+
+    SUBCASE("Other index types")
+    {
+        WriteFile(path, MakePly<ui16>(squarePositions, { { 0, 1, 2, 3 } }, true, "ushort"));
+        CHECK_EQ(LoadPlyMesh(path, &identity, &identity, false).size(), 2);
+
+        WriteFile(path, MakePly<ui32>(squarePositions, { { 0, 1, 2, 3 } }, false, "uint"));
+        CHECK_EQ(LoadPlyMesh(path, &identity, &identity, false).size(), 2);
+    }
+
+    SUBCASE("Large mesh")
+    {
+        // More faces than in one ParallelFor() chunk of the fast path
+        constexpr i32 n = 260;
+        std::vector<f32> positions;
+        for (i32 y = 0; y <= n; ++y)
+            for (i32 x = 0; x <= n; ++x)
+                positions.insert(positions.end(), { f32(x) / n, f32(y) / n, 0 });
+        std::vector<std::vector<i32>> faces;
+        for (i32 y = 0; y < n; ++y)
+            for (i32 x = 0; x < n; ++x) {
+                const i32 v = y * (n + 1) + x;
+                faces.push_back({ v, v + 1, v + n + 2, v + n + 1 });
+            }
+        WriteFile(path, MakePly(positions, faces, false));
+
+        const auto shapes = LoadPlyMesh(path, &identity, &identity, false);
+        REQUIRE_EQ(shapes.size(), 2 * n * n);
+        CHECK_EQ(TotalArea(shapes), doctest::Approx(1).epsilon(1e-4));
+    }
+
+    SUBCASE("Invalid files")
+    {
+        CHECK(LoadPlyMesh(TempFilePath("pbr_test_missing.ply"), &identity, &identity, false).empty());
+
+        // Float index lists are not interpreted as integers
+        WriteFile(path, MakePly<f32>(squarePositions, { { 0, 1, 2 } }, false, "float"));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+        WriteFile(path, MakePly<f64>(squarePositions, { { 0, 1, 2, 3 } }, true, "double"));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+
+        WriteFile(path, MakePly(squarePositions, { { 0, 1, 4 } }, false));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+
+        // ASCII is not supported
+        WriteFile(path, "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+                        "element face 1\nproperty list uchar int vertex_indices\nend_header\n"
+                        "0 0 0\n1 0 0\n0 1 0\n3 0 1 2\n");
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+
+        const std::string valid = MakePly(squarePositions, { { 0, 1, 2 }, { 0, 2, 3 } }, false);
+        const std::size_t headerSize = valid.find("end_header\n") + std::strlen("end_header\n");
+
+        WriteFile(path, "plx" + valid.substr(3));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+        // Truncated header
+        WriteFile(path, valid.substr(0, headerSize - 4));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+        // Truncated vertices
+        WriteFile(path, valid.substr(0, headerSize + 20));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+        // Truncated faces
+        WriteFile(path, valid.substr(0, valid.size() - 1));
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+
+        std::string malformed = valid;
+        malformed.replace(malformed.find("property float y"), std::strlen("property float y"), "property quad y");
+        WriteFile(path, malformed);
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+
+        malformed = valid;
+        malformed.replace(malformed.find("list uchar"), std::strlen("list uchar"), "list float");
+        WriteFile(path, malformed);
+        CHECK(LoadPlyMesh(path, &identity, &identity, false).empty());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("LoadObjMesh")
+{
+    const Transform identity{ Matrix4x4() };
+    const std::string path = TempFilePath("pbr_test_mesh.obj");
+    const std::string square = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n";
+    const std::string squareUV = "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n";
+
+    auto load = [&](const std::string &content, bool quadsAsPatches = false) {
+        WriteFile(path, content);
+        return LoadObjMesh(path, &identity, &identity, false, quadsAsPatches);
+    };
+    auto mesh = [](const std::vector<std::shared_ptr<Shape>> &shapes) -> const TriangleMesh& {
+        return static_cast<const Triangle&>(*shapes[0]).Mesh();
+    };
+
+    SUBCASE("Relative indices and comments")
+    {
+        const auto shapes = load("# square\n" + square + "f -4 -3 -2 # first half\nf 1 3 4# second half\n");
+        REQUIRE_EQ(shapes.size(), 2);
+        CHECK_EQ(TotalArea(shapes), doctest::Approx(1));
+        CHECK_EQ(mesh(shapes).nVertices, 4);
+        CHECK_FALSE(mesh(shapes).HasUV());
+        CHECK_FALSE(mesh(shapes).HasNormals());
+
+        // Relative indices refer to the elements before the face, not to the end of file
+        CHECK_EQ(load(square + "f -4 -3 -2\nv 5 5 5\n").size(), 1);
+    }
+
+    SUBCASE("Quads")
+    {
+        CHECK_EQ(load(square + "f 1 2 3 4\n").size(), 2);
+        const auto shapes = load(square + "f 1 2 3 4\n", true);
+        REQUIRE_EQ(shapes.size(), 1);
+        CHECK_NE(dynamic_cast<const BilinearPatch*>(shapes[0].get()), nullptr);
+        CHECK_EQ(TotalArea(shapes), doctest::Approx(1));
+    }
+
+    SUBCASE("Texture coordinates and normals")
+    {
+        auto shapes = load(square + squareUV + "vn 0 0 1\nf 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n");
+        REQUIRE_EQ(shapes.size(), 2);
+        CHECK_EQ(mesh(shapes).nVertices, 4);
+        CHECK(mesh(shapes).HasUV());
+        CHECK(mesh(shapes).HasNormals());
+        for (i32 v = 0; v < 4; ++v) {
+            CHECK_EQ(mesh(shapes).UV(v), Point2_t(mesh(shapes).positions[v].x, mesh(shapes).positions[v].y));
+            CHECK_EQ(mesh(shapes).Normal(v), Normal3_t(0, 0, 1));
+        }
+
+        // One corner without uv, so uv is dropped for the whole mesh, and 1//1 is the same vertex as 1/1/1
+        shapes = load(square + squareUV + "vn 0 0 1\nf 1/1/1 2/2/1 3/3/1\nf 1//1 3/3/1 4/4/1\n");
+        REQUIRE_EQ(shapes.size(), 2);
+        CHECK_EQ(mesh(shapes).nVertices, 4);
+        CHECK_FALSE(mesh(shapes).HasUV());
+        CHECK(mesh(shapes).HasNormals());
+
+        shapes = load(square + squareUV + "f 1/1 2/2 3/3\nf 1/1 3/3 4\n");
+        REQUIRE_EQ(shapes.size(), 2);
+        CHECK_EQ(mesh(shapes).nVertices, 4);
+        CHECK_FALSE(mesh(shapes).HasUV());
+        CHECK_FALSE(mesh(shapes).HasNormals());
+    }
+
+    SUBCASE("Deduplication")
+    {
+        // Position 1 with two different uv is two vertices, repeated triples are shared
+        const auto shapes = load(square + squareUV + "vt 0.5 0.5\nf 1/1 2/2 3/3\nf 1/5 3/3 4/4\nf 3/-3 4/-2 1/-1\n");
+        REQUIRE_EQ(shapes.size(), 3);
+        CHECK_EQ(mesh(shapes).nVertices, 5);
+        CHECK(mesh(shapes).HasUV());
+        const std::vector<i32> &indices = mesh(shapes).vertexIndices;
+        CHECK_NE(indices[0], indices[3]);
+        CHECK_EQ(indices[2], indices[4]);
+        CHECK_EQ(indices[6], indices[2]);
+        CHECK_EQ(indices[7], indices[5]);
+        CHECK_EQ(indices[8], indices[3]);
+    }
+
+    SUBCASE("Invalid files")
+    {
+        CHECK(LoadObjMesh(TempFilePath("pbr_test_missing.obj"), &identity, &identity, false).empty());
+        CHECK(load(square + "f 1 2\n").empty());
+        CHECK(load(square + "f 1 2 5\n").empty());
+        CHECK(load(square + "f 0 1 2\n").empty());
+        CHECK(load(square + "f -5 1 2\n").empty());
+        CHECK(load(square + "f 1 2 x\n").empty());
+        CHECK(load("v 0 0\n").empty());
+        CHECK(load(square).empty());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("RawMesh")
+{
+    const Transform identity{ Matrix4x4() };
+    const std::string path = TempFilePath("pbr_test_mesh.pbrmesh");
+
+    const i32 indices[] = { 0, 1, 2,  0, 2, 3 };
+    const Point3_t positions[] = { Point3_t(0, 0, 0), Point3_t(2, 0, 0), Point3_t(2, 1, 0), Point3_t(0, 1, 0) };
+    const Point2_t uv[] = { Point2_t(0, 0), Point2_t(1, 0), Point2_t(1, 1), Point2_t(0, 1) };
+    REQUIRE(WriteRawMesh(path, 2, indices, 4, positions, nullptr, nullptr, uv));
+
+    const auto shapes = LoadRawMesh(path, &identity, &identity, false);
+    REQUIRE_EQ(shapes.size(), 2);
+    CHECK_EQ(TotalArea(shapes), doctest::Approx(2));
+    const Bounds3_t bounds = Union(shapes[0]->WorldBound(), shapes[1]->WorldBound());
+    CHECK_EQ(bounds.pMin, Point3_t(0, 0, 0));
+    CHECK_EQ(bounds.pMax, Point3_t(2, 1, 0));
+
+    SUBCASE("Invalid files")
+    {
+        std::string content;
+        {
+            MappedFile file;
+            REQUIRE(file.Open(path));
+            content.assign(reinterpret_cast<const char*>(file.Data()), file.Size());
+        }
+
+        WriteFile(path, content.substr(0, sizeof(RawMeshHeader) - 1));
+        CHECK(LoadRawMesh(path, &identity, &identity, false).empty());
+        WriteFile(path, content.substr(0, content.size() - 1));
+        CHECK(LoadRawMesh(path, &identity, &identity, false).empty());
+
+        std::string corrupted = content;
+        corrupted[0] = 'X';
+        WriteFile(path, corrupted);
+        CHECK(LoadRawMesh(path, &identity, &identity, false).empty());
+
+        corrupted = content;
+        const ui32 floatSize = sizeof(fp_t) == 4 ? 8 : 4;
+        std::memcpy(corrupted.data() + offsetof(RawMeshHeader, floatSize), &floatSize, sizeof(floatSize));
+        WriteFile(path, corrupted);
+        CHECK(LoadRawMesh(path, &identity, &identity, false).empty());
+
+        const i32 invalidIndices[] = { 0, 1, 2,  0, 2, 4 };
+        REQUIRE(WriteRawMesh(path, 2, invalidIndices, 4, positions, nullptr, nullptr, nullptr));
+        CHECK(LoadRawMesh(path, &identity, &identity, false).empty());
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile")
+{
+    const std::string path = TempFilePath("pbr_test_mapped.bin");
+    std::string content(10000, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i)
+        content[i] = static_cast<char>(i * 7);
+    WriteFile(path, content);
+
+    MappedFile file;
+    CHECK_FALSE(file.IsOpen());
+    REQUIRE(file.Open(path));
+    CHECK(file.IsOpen());
+    REQUIRE_EQ(file.Size(), content.size());
+    CHECK_EQ(std::memcmp(file.Data(), content.data(), content.size()), 0);
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(file.Data()) % 4096, 0);
+
+    file.Close();
+    CHECK_FALSE(file.IsOpen());
+    CHECK_EQ(file.Size(), 0);
+
+    CHECK_FALSE(file.Open(TempFilePath("pbr_test_missing.bin")));
+    // Empty files cannot be mapped
+    WriteFile(path, "");
+    CHECK_FALSE(file.Open(path));
+    CHECK_FALSE(file.IsOpen());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("ParallelFor")
+{
+    CHECK_GE(NumSystemCores(), 1);
+
+    for (i64 count : { 0, 1, 99, 100, 101, 12345 }) {
+        std::vector<std::atomic<i32>> visited(static_cast<std::size_t>(count));
+        std::atomic<i64> nCalls = 0;
+        ParallelFor(count, 100, [&](i64 begin, i64 end) {
+            CHECK_LT(begin, end);
+            CHECK_LE(end - begin, 100);
+            for (i64 i = begin; i < end; ++i)
+                ++visited[i];
+            ++nCalls;
+        });
+
+        CHECK_EQ(nCalls, (count + 99) / 100);
+        CHECK(std::all_of(visited.begin(), visited.end(), [](const std::atomic<i32> &v) { return v == 1; }));
+    }
+}
@@ -0,0 +1,146 @@
+#include "doctest.h"
+
+#include "core/memory.h"
+#include "core/parallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("MemoryArena")
+{
+    using namespace pbr;
+
+    SUBCASE("Small blocks")
+    {
+        MemoryArena arena(1024);
+        CHECK_EQ(arena.TotalAllocated(), 0);
+
+        i32 *a = arena.Alloc<i32>(100, true);
+        f64 *b = arena.Alloc<f64>(3, false);
+        CHECK_EQ(a[99], 0);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(b) % alignof(f64), 0);
+        CHECK(reinterpret_cast<ui8*>(b) >= reinterpret_cast<ui8*>(a + 100));
+        CHECK_EQ(arena.TotalAllocated(), 1024);
+
+        // Larger than the block size gets its own block
+        ui8 *c = arena.Alloc<ui8>(4000, false);
+        std::memset(c, 1, 4000);
+        CHECK_EQ(arena.TotalAllocated(), 1024 + 4000);
+
+        // The same allocations after Reset() take the same blocks
+        for (i32 i = 0; i < 3; ++i) {
+            arena.Reset();
+            CHECK_EQ(arena.Alloc<i32>(100, false), a);
+            CHECK_EQ(arena.Alloc<f64>(3, false), b);
+            CHECK_EQ(arena.Alloc<ui8>(4000, false), c);
+        }
+        CHECK_EQ(arena.TotalAllocated(), 1024 + 4000);
+    }
+
+    SUBCASE("Huge pages")
+    {
+        MemoryArena arena(4096, true);
+        ui8 *a = arena.Alloc<ui8>(100, false);
+        std::memset(a, 1, 100);
+        CHECK_EQ(arena.TotalAllocated(), PBR_HUGE_PAGE_SIZE);
+#ifdef PBR_HAVE_MMAP
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(a) % PBR_HUGE_PAGE_SIZE, 0);
+#endif
+        // The whole huge page is used before the next block
+        ui8 *b = arena.Alloc<ui8>(PBR_HUGE_PAGE_SIZE / 2, false);
+        CHECK_EQ(b, a + 112);
+        ui8 *c = arena.Alloc<ui8>(PBR_HUGE_PAGE_SIZE, false);
+        std::memset(c, 1, PBR_HUGE_PAGE_SIZE);
+        CHECK_EQ(arena.TotalAllocated(), 2 * PBR_HUGE_PAGE_SIZE);
+    }
+}
+
+TEST_CASE("MemoryArenaPool")
+{
+    using namespace pbr;
+    MemoryArenaPool pool(4096);
+    CHECK_EQ(&pool.Get(), &pool.Get());
+
+    // Every chunk writes its own index to its memory, other threads must not overwrite it.
+    std::atomic<i32> nErrors = 0;
+    for (i32 pass = 0; pass < 3; ++pass) {
+        ParallelFor(256, 1, [&](i64 begin, i64 end) {
+            MemoryArena &arena = pool.Get();
+            for (i64 i = begin; i < end; ++i) {
+                arena.Reset();
+                i64 *data = arena.Alloc<i64>(1000, false);
+                for (i32 j = 0; j < 1000; ++j)
+                    data[j] = i;
+                for (i32 j = 0; j < 1000; ++j)
+                    if (data[j] != i)
+                        ++nErrors;
+            }
+        });
+    }
+    CHECK_EQ(nErrors, 0);
+    CHECK_LE(pool.Size(), NumSystemCores());
+
+    // Arenas of the exited threads are reused by the next threads
+    for (i32 pass = 0; pass < 3; ++pass) {
+        std::vector<std::thread> threads;
+        for (i32 i = 0; i < 4; ++i)
+            threads.emplace_back([&pool]() { pool.Get().Alloc<i64>(10, false); });
+        for (auto &thread : threads)
+            thread.join();
+    }
+    CHECK_LE(pool.Size(), 5);
+
+    pool.ResetAll();
+    const size_t total = pool.TotalAllocated();
+    pool.Get().Alloc<i64>(1000, false);
+    CHECK_EQ(pool.TotalAllocated(), total);
+}
+
+TEST_CASE("ArenaMemoryResource")
+{
+    using namespace pbr;
+    MemoryArena arena(4096);
+    for (std::size_t align : { 1, 8, 16, 64, 256, 1024 }) {
+        arena.AllocBytes(1);
+        void *ptr = arena.AllocBytes(100, align);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(ptr) % align, 0);
+    }
+
+    ArenaMemoryResource resource(arena);
+    ArenaMemoryResource other(arena);
+    CHECK(resource.is_equal(other));
+    {
+        std::pmr::vector<i32> values(&resource);
+        std::pmr::list<f64> list(&resource);
+        for (i32 i = 0; i < 1000; ++i) {
+            values.push_back(i);
+            list.push_back(i);
+        }
+        CHECK_EQ(values[999], 999);
+        CHECK_EQ(list.back(), 999);
+    }
+    const size_t total = arena.TotalAllocated();
+    CHECK_GT(total, 0);
+
+    MonotonicArenaResource monotonic(4096);
+    CHECK_FALSE(monotonic.is_equal(resource));
+    size_t monotonicTotal = 0;
+    for (i32 pass = 0; pass < 3; ++pass) {
+        {
+            std::pmr::vector<i64> values(&monotonic);
+            values.resize(10000);
+            values.back() = pass;
+            values.shrink_to_fit();
+        }
+        monotonic.Release();
+        // Blocks are kept, the next passes allocate nothing new
+        if (pass == 0)
+            monotonicTotal = monotonic.Arena().TotalAllocated();
+        CHECK_EQ(monotonic.Arena().TotalAllocated(), monotonicTotal);
+    }
+}
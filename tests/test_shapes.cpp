@@ -0,0 +1,521 @@
+#include "doctest.h"
+
+#include "shapes/bilinearpatch.h"
+#include "shapes/cylinder.h"
+#include "shapes/hyperboloid.h"
+#include "shapes/loopsubdiv.h"
+#include "shapes/paraboloid.h"
+#include "shapes/sphere.h"
+#include "shapes/sphereset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+
+
+TEST_CASE("Hyperboloid")
+{
+    using namespace pbr;
+    const Transform identity{ Matrix4x4() };
+    // x^2 + y^2 - z^2 = 1, waist of radius 1 at z = 0
+    const Point3_t point1(1, -1, -1), point2(1, 1, 1);
+    const Hyperboloid full(&identity, &identity, false, point1, point2, 360);
+
+    SUBCASE("Hit point")
+    {
+        const Ray r(Point3_t(5, 0, 0), Vector3_t(-1, 0, 0));
+        fp_t tHit;
+        SurfaceInteraction isect;
+        REQUIRE(full.Intersect(r, tHit, isect, true));
+        CHECK(tHit == doctest::Approx(4).epsilon(1e-5));
+        CHECK(isect.point.x == doctest::Approx(1).epsilon(1e-5));
+        CHECK(std::abs(isect.point.y) < fp_t(1e-5));
+        CHECK(std::abs(isect.point.z) < fp_t(1e-5));
+        CHECK(full.IsIntersecting(r, true));
+
+        // Point on the surface at z = 0.5, r^2 = 1.25
+        const Ray diagonal(Point3_t(0, 0, 0.5f), Normalize(Vector3_t(1, 1, 0)));
+        REQUIRE(full.Intersect(diagonal, tHit, isect, true));
+        CHECK(tHit == doctest::Approx(std::sqrt(1.25)).epsilon(1e-5));
+    }
+
+    SUBCASE("Phi clipping")
+    {
+        // Phi is measured from the segment point at the height of the hit, at z = 0 it's (1, 0, 0)
+        const Hyperboloid quarter(&identity, &identity, false, point1, point2, 90);
+        const Ray r(Point3_t(-5, 0, 0), Vector3_t(1, 0, 0));
+        fp_t tHit;
+        SurfaceInteraction isect;
+        // First hit at (-1, 0, 0) has phi = pi, so the far one at (1, 0, 0) is taken
+        REQUIRE(quarter.Intersect(r, tHit, isect, true));
+        CHECK(tHit == doctest::Approx(6).epsilon(1e-5));
+        CHECK(isect.uv.x == doctest::Approx(0).epsilon(1e-4));
+
+        // Both hits at phi = 3 * pi / 2 and pi / 2 of the ray along y, only the second is inside
+        const Ray alongY(Point3_t(0, -5, 0), Vector3_t(0, 1, 0));
+        REQUIRE(quarter.Intersect(alongY, tHit, isect, true));
+        CHECK(tHit == doctest::Approx(6).epsilon(1e-5));
+        const Hyperboloid small(&identity, &identity, false, point1, point2, 45);
+        CHECK_FALSE(small.IsIntersecting(alongY, true));
+    }
+
+    SUBCASE("Z range")
+    {
+        // Surface exists at z = 2 (r^2 = 5), but it's outside of the segment
+        const Ray above(Point3_t(5, 0, 2), Vector3_t(-1, 0, 0));
+        CHECK_FALSE(full.IsIntersecting(above, true));
+        fp_t tHit;
+        SurfaceInteraction isect;
+        CHECK_FALSE(full.Intersect(above, tHit, isect, true));
+
+        // Inside the range near the end
+        const Ray inside(Point3_t(5, 0, 0.9f), Vector3_t(-1, 0, 0));
+        REQUIRE(full.Intersect(inside, tHit, isect, true));
+        CHECK(isect.point.z == doctest::Approx(0.9).epsilon(1e-5));
+    }
+
+    SUBCASE("Area")
+    {
+        // Surface of revolution r(z) = sqrt(1 + z^2), dA = 2 * pi * r * sqrt(1 + r'^2) dz = 2 * pi * sqrt(1 + 2 * z^2) dz
+        constexpr i32 n = 100000;
+        f64 area = 0;
+        for (i32 i = 0; i < n; ++i) {
+            const f64 z = -1 + 2 * (i + 0.5) / n;
+            area += 2 * std::numbers::pi * std::sqrt(1 + 2 * z * z) * 2 / n;
+        }
+        CHECK(full.Area() == doctest::Approx(area).epsilon(1e-4));
+
+        const Hyperboloid half(&identity, &identity, false, point1, point2, 180);
+        CHECK(half.Area() == doctest::Approx(area / 2).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("LRUCache")
+{
+    using namespace pbr;
+    LRUCache<i32, i32> cache(3);
+
+    for (i32 key = 1; key <= 3; ++key)
+        cache.Insert(key, std::make_shared<const i32>(10 * key), 1);
+    CHECK_EQ(cache.Size(), 3);
+
+    // 1 becomes the most recently used, so 2 is the first to go
+    REQUIRE(cache.Find(1));
+    cache.Insert(4, std::make_shared<const i32>(40), 1);
+    CHECK_EQ(cache.Evictions(), 1);
+    CHECK_FALSE(cache.Find(2));
+    CHECK_EQ(*cache.Find(1), 10);
+    CHECK_EQ(*cache.Find(3), 30);
+    CHECK_EQ(*cache.Find(4), 40);
+
+    // Order is 4, 3, 1 now, entry of size 2 evicts two of them
+    cache.Insert(5, std::make_shared<const i32>(50), 2);
+    CHECK_EQ(cache.Evictions(), 3);
+    CHECK_FALSE(cache.Find(1));
+    CHECK_FALSE(cache.Find(3));
+    CHECK(cache.Find(4));
+    CHECK_EQ(cache.Size(), 3);
+
+    // Existing value is kept, too big value is returned but not stored
+    CHECK_EQ(*cache.Insert(4, std::make_shared<const i32>(-1), 1), 40);
+    CHECK_EQ(*cache.Insert(6, std::make_shared<const i32>(60), 4), 60);
+    CHECK_FALSE(cache.Find(6));
+    CHECK_EQ(cache.Size(), 3);
+    CHECK_EQ(cache.Hits(), 5);
+    CHECK_EQ(cache.Misses(), 4);
+
+    cache.Clear();
+    CHECK_EQ(cache.Size(), 0);
+    CHECK_FALSE(cache.Find(5));
+}
+
+TEST_CASE("LoopSubdiv")
+{
+    using namespace pbr;
+    const Transform identity{ Matrix4x4() };
+    // Octahedron, every vertex has valence 4
+    const Point3_t positions[] = { Point3_t(1, 0, 0), Point3_t(-1, 0, 0), Point3_t(0, 1, 0),
+                                   Point3_t(0, -1, 0), Point3_t(0, 0, 1), Point3_t(0, 0, -1) };
+    const i32 indices[] = { 0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,
+                            2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5 };
+    auto cache = std::make_shared<TessellationCache>(std::size_t(64) << 20);
+    const auto shapes = CreateLoopSubdiv(&identity, &identity, false, 8, indices, 6, positions, 2, 4, cache);
+    REQUIRE_EQ(shapes.size(), 8);
+    const auto &patch = static_cast<const SubdivisionPatch&>(*shapes[0]);
+
+    SUBCASE("Vertex and face counts")
+    {
+        // Every step splits a face into 4 and adds a vertex per edge, so triangle of n = 2^level segments per side
+        //   has (n + 1)(n + 2) / 2 vertices and n^2 faces.
+        for (i32 level = 0; level <= 4; ++level) {
+            const auto tessellation = patch.GetTessellation(level);
+            const i32 n = 1 << level;
+            CHECK_EQ(tessellation->level, level);
+            CHECK_EQ(tessellation->positions.size(), (n + 1) * (n + 2) / 2);
+            CHECK_EQ(tessellation->uv.size(), tessellation->positions.size());
+            CHECK_EQ(tessellation->vertexIndices.size(), 3 * n * n);
+            CHECK_EQ(tessellation->nodeBounds.size(), TessellatedPatch::NodeOffset(level + 1));
+        }
+    }
+
+    SUBCASE("Limit surface")
+    {
+        // Limit of valence 4 vertex is p / 2 + sum of neighbours / 8, neighbours of every octahedron vertex sum to 0.
+        //   Corners of the patch are the limits of control vertices at any level.
+        for (i32 level = 0; level <= 3; ++level) {
+            const auto tessellation = patch.GetTessellation(level);
+            const Bounds3_t bounds = patch.WorldBound();
+            for (std::size_t v = 0; v < tessellation->positions.size(); ++v) {
+                const Point3_t &p = tessellation->positions[v];
+                const Point2_t &uv = tessellation->uv[v];
+                CHECK(Inside(p, bounds));
+                CHECK_LE(Distance(p, Point3_t(0, 0, 0)), fp_t(0.5) + fp_t(1e-5));
+                if (uv == Point2_t(0, 0))
+                    CHECK_LT(Distance(p, Point3_t(0.5, 0, 0)), fp_t(1e-5));
+                if (uv == Point2_t(1, 0))
+                    CHECK_LT(Distance(p, Point3_t(0, 0.5, 0)), fp_t(1e-5));
+                if (uv == Point2_t(1, 1))
+                    CHECK_LT(Distance(p, Point3_t(0, 0, 0.5)), fp_t(1e-5));
+            }
+        }
+
+        fp_t tHit;
+        SurfaceInteraction isect;
+        const Ray r(Point3_t(2, 2, 2), Vector3_t(-1, -1, -1));
+        REQUIRE(patch.Intersect(r, tHit, isect, true));
+        CHECK(patch.IsIntersecting(r, true));
+        const fp_t distance = Distance(isect.point, Point3_t(0, 0, 0));
+        CHECK_GT(distance, fp_t(0.25));
+        CHECK_LT(distance, fp_t(0.5));
+        CHECK_LT(Distance(r(tHit), isect.point), fp_t(1e-4));
+        CHECK_FALSE(patch.IsIntersecting(Ray(Point3_t(2, 2, 2), Vector3_t(1, 1, 1)), true));
+    }
+
+    SUBCASE("Cache eviction")
+    {
+        // Room for exactly two patches of the same level
+        const std::size_t patchSize = patch.GetTessellation(3)->SizeBytes();
+        auto smallCache = std::make_shared<TessellationCache>(2 * patchSize);
+        const auto patches = CreateLoopSubdiv(&identity, &identity, false, 8, indices, 6, positions, 3, 3, smallCache);
+
+        patches[0]->Area();
+        patches[1]->Area();
+        CHECK_EQ(smallCache->Size(), 2 * patchSize);
+        CHECK_EQ(smallCache->Evictions(), 0);
+
+        // Patch 0 is used again, so patch 1 is evicted by patch 2
+        patches[0]->Area();
+        patches[2]->Area();
+        CHECK_EQ(smallCache->Evictions(), 1);
+        const i64 misses = smallCache->Misses();
+        patches[0]->Area();
+        patches[2]->Area();
+        CHECK_EQ(smallCache->Misses(), misses);
+        patches[1]->Area();
+        CHECK_EQ(smallCache->Misses(), misses + 1);
+        CHECK_EQ(smallCache->Evictions(), 2);
+    }
+}
+
+TEST_CASE("SphereSet")
+{
+    using namespace pbr;
+    // Object space of the set is scaled uniformly and moved, brute force spheres are built straight in world space.
+    const Transform setToWorld = Translate(Vector3_t(1, -2, 3)) * Scale(2, 2, 2);
+    const Transform worldToSet = Inverse(setToWorld);
+    constexpr i32 nSpheres = 300;
+
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<fp_t> position(-5, 5), radius(fp_t(0.1), fp_t(0.6)), unit(-1, 1);
+    std::vector<Point3_t> centers;
+    std::vector<fp_t> radii;
+    for (i32 i = 0; i < nSpheres; ++i) {
+        centers.emplace_back(position(rng), position(rng), position(rng));
+        radii.push_back(radius(rng));
+    }
+    const SphereSet set(&setToWorld, &worldToSet, false, nSpheres, centers.data(), radii.data());
+    REQUIRE_EQ(set.SphereCount(), nSpheres);
+
+    std::vector<Transform> toWorld, toObject;
+    std::vector<Sphere> spheres;
+    std::vector<Point3_t> worldCenters;
+    toWorld.reserve(nSpheres);
+    toObject.reserve(nSpheres);
+    spheres.reserve(nSpheres);
+    for (i32 i = 0; i < nSpheres; ++i) {
+        worldCenters.push_back(setToWorld(centers[i]));
+        toWorld.push_back(Translate(worldCenters[i] - Point3_t(0, 0, 0)));
+        toObject.push_back(Inverse(toWorld.back()));
+        const fp_t r = 2 * radii[i];
+        spheres.emplace_back(&toWorld.back(), &toObject.back(), false, r, -r, r, 360);
+    }
+
+    fp_t totalArea = 0;
+    for (const Sphere &sphere : spheres)
+        totalArea += sphere.Area();
+    CHECK_EQ(set.Area(), doctest::Approx(totalArea).epsilon(1e-4));
+
+    i32 nHits = 0;
+    for (i32 i = 0; i < 2000; ++i) {
+        // Half of the rays start inside of the cloud
+        const fp_t scale = i % 2 == 0 ? fp_t(30) : fp_t(5);
+        const Point3_t origin = setToWorld(Point3_t(unit(rng) * scale, unit(rng) * scale, unit(rng) * scale));
+        const Point3_t target = setToWorld(Point3_t(position(rng), position(rng), position(rng)));
+        const Ray r(origin, target - origin);
+
+        // Sphere reports conservative hits within the error bounds of the discriminant, so the answer for grazing rays
+        //   may differ from the set, they are skipped.
+        const Vector3_t direction = Normalize(r.direction);
+        bool grazing = false;
+        for (i32 s = 0; s < nSpheres; ++s) {
+            const Vector3_t toCenter = worldCenters[s] - origin;
+            const fp_t distance = (toCenter - direction * Dot(toCenter, direction)).Length();
+            grazing |= std::abs(distance - 2 * radii[s]) < fp_t(1e-4) * (toCenter.Length() + 1);
+        }
+        if (grazing)
+            continue;
+
+        i32 closest = -1;
+        fp_t tClosest = constants::infinity;
+        SurfaceInteraction closestIsect;
+        for (i32 s = 0; s < nSpheres; ++s) {
+            fp_t t;
+            SurfaceInteraction isect;
+            if (spheres[s].Intersect(r, t, isect, true) && t < tClosest) {
+                closest = s;
+                tClosest = t;
+                closestIsect = isect;
+            }
+        }
+
+        fp_t tHit;
+        SurfaceInteraction isect;
+        const bool hit = set.Intersect(r, tHit, isect, true);
+        REQUIRE_EQ(hit, closest >= 0);
+        CHECK_EQ(set.IsIntersecting(r, true), hit);
+        if (hit == false)
+            continue;
+
+        ++nHits;
+        CHECK_EQ(tHit, doctest::Approx(tClosest).epsilon(1e-4));
+        // Hit point is on the same sphere
+        const fp_t distance = Distance(isect.point, worldCenters[closest]);
+        CHECK_EQ(distance, doctest::Approx(2 * radii[closest]).epsilon(1e-3));
+        // NOTE: Far from the origin Sphere solves the quadratic with large cancellation error, before the point is reprojected.
+        CHECK_LT(Distance(isect.point, closestIsect.point), fp_t(1e-4) * (Distance(origin, isect.point) + 1));
+    }
+    CHECK_GT(nHits, 200);
+}
+
+TEST_CASE("BilinearPatch")
+{
+    using namespace pbr;
+    const Transform identity{ Matrix4x4() };
+    fp_t tHit;
+    SurfaceInteraction isect;
+
+    SUBCASE("Planar")
+    {
+        // Rectangle [0,2]x[0,1] in z = 0, uv from the mesh are (2x, 2y)
+        const Point3_t positions[] = { Point3_t(0, 0, 0), Point3_t(2, 0, 0), Point3_t(2, 1, 0), Point3_t(0, 1, 0) };
+        const Point2_t uv[] = { Point2_t(0, 0), Point2_t(4, 0), Point2_t(4, 2), Point2_t(0, 2) };
+        i32 indices[4];
+        QuadToPatchIndices(0, 1, 2, 3, indices);
+        const auto plain = CreateBilinearPatchMesh(&identity, &identity, false, 1, indices, 4, positions, nullptr, nullptr);
+        const auto textured = CreateBilinearPatchMesh(&identity, &identity, false, 1, indices, 4, positions, nullptr, uv);
+        CHECK_EQ(plain[0]->Area(), doctest::Approx(2));
+
+        for (const auto &[x, y] : { std::pair(fp_t(0.5), fp_t(0.5)), std::pair(fp_t(1.75), fp_t(0.125)), std::pair(fp_t(0.01), fp_t(0.99)) }) {
+            const Ray r(Point3_t(x, y, 5), Vector3_t(0, 0, -1));
+            REQUIRE(plain[0]->Intersect(r, tHit, isect, true));
+            CHECK_EQ(tHit, doctest::Approx(5));
+            CHECK_EQ(isect.point.x, doctest::Approx(x));
+            CHECK_EQ(isect.point.y, doctest::Approx(y));
+            CHECK_EQ(isect.point.z, doctest::Approx(0));
+            CHECK_EQ(isect.uv.x, doctest::Approx(x / 2));
+            CHECK_EQ(isect.uv.y, doctest::Approx(y));
+            CHECK(plain[0]->IsIntersecting(r, true));
+
+            REQUIRE(textured[0]->Intersect(r, tHit, isect, true));
+            CHECK_EQ(isect.uv.x, doctest::Approx(2 * x));
+            CHECK_EQ(isect.uv.y, doctest::Approx(2 * y));
+
+            // Oblique ray from below hits the same point
+            const Ray below(Point3_t(x - 1, y + 2, -4), Vector3_t(1, -2, 4));
+            REQUIRE(plain[0]->Intersect(below, tHit, isect, true));
+            CHECK_EQ(tHit, doctest::Approx(1));
+            CHECK_EQ(isect.uv.x, doctest::Approx(x / 2));
+            CHECK_EQ(isect.uv.y, doctest::Approx(y));
+        }
+
+        // Outside of the rectangle, behind the origin, parallel to the plane and too short
+        CHECK_FALSE(plain[0]->IsIntersecting(Ray(Point3_t(2.1, 0.5, 5), Vector3_t(0, 0, -1)), true));
+        CHECK_FALSE(plain[0]->IsIntersecting(Ray(Point3_t(1, -0.1, 5), Vector3_t(0, 0, -1)), true));
+        CHECK_FALSE(plain[0]->IsIntersecting(Ray(Point3_t(1, 0.5, 5), Vector3_t(0, 0, 1)), true));
+        CHECK_FALSE(plain[0]->IsIntersecting(Ray(Point3_t(-1, 0.5, 0.5), Vector3_t(1, 0, 0)), true));
+        CHECK_FALSE(plain[0]->IsIntersecting(Ray(Point3_t(1, 0.5, 5), Vector3_t(0, 0, -1), 4.9), true));
+    }
+
+    SUBCASE("Twisted")
+    {
+        // Hyperbolic paraboloid z = x * y over [0,1]^2, u = x and v = y
+        const Point3_t positions[] = { Point3_t(0, 0, 0), Point3_t(1, 0, 0), Point3_t(0, 1, 0), Point3_t(1, 1, 1) };
+        const i32 indices[] = { 0, 1, 2, 3 };
+        const auto patch = CreateBilinearPatchMesh(&identity, &identity, false, 1, indices, 4, positions, nullptr, nullptr);
+
+        for (const auto &[x, y] : { std::pair(fp_t(0.5), fp_t(0.5)), std::pair(fp_t(0.9), fp_t(0.2)), std::pair(fp_t(0.25), fp_t(0.75)) }) {
+            const Ray r(Point3_t(x, y, 5), Vector3_t(0, 0, -1));
+            REQUIRE(patch[0]->Intersect(r, tHit, isect, true));
+            CHECK_EQ(tHit, doctest::Approx(5 - x * y));
+            CHECK_EQ(isect.point.z, doctest::Approx(x * y));
+            CHECK_EQ(isect.uv.x, doctest::Approx(x));
+            CHECK_EQ(isect.uv.y, doctest::Approx(y));
+        }
+
+        // Ray along x at y = 0.5 meets z = x / 2 at x = 0.6
+        Ray r(Point3_t(-1, 0.5, 0.3), Vector3_t(1, 0, 0));
+        REQUIRE(patch[0]->Intersect(r, tHit, isect, true));
+        CHECK_EQ(tHit, doctest::Approx(1.6));
+        CHECK_EQ(isect.uv.x, doctest::Approx(0.6));
+        CHECK_EQ(isect.uv.y, doctest::Approx(0.5));
+
+        // Random oblique rays, hit point must be on the surface and match its uv
+        std::mt19937 rng(30);
+        std::uniform_real_distribution<fp_t> unit(0, 1), offset(-3, 3);
+        i32 nHits = 0;
+        for (i32 i = 0; i < 200; ++i) {
+            const Point3_t target(unit(rng), unit(rng), 0);
+            const Point3_t p(target.x, target.y, target.x * target.y);
+            const Point3_t origin(p.x + offset(rng), p.y + offset(rng), p.z + 3);
+            if (patch[0]->Intersect(Ray(origin, p - origin), tHit, isect, true) == false)
+                continue;
+            ++nHits;
+            CHECK_LE(tHit, fp_t(1) + fp_t(1e-4));
+            CHECK_EQ(isect.point.z, doctest::Approx(isect.point.x * isect.point.y).epsilon(1e-3));
+            CHECK_EQ(isect.uv.x, doctest::Approx(isect.point.x).epsilon(1e-3));
+            CHECK_EQ(isect.uv.y, doctest::Approx(isect.point.y).epsilon(1e-3));
+        }
+        // Ray to the point on the surface can't miss it
+        CHECK_EQ(nHits, 200);
+    }
+}
+
+TEST_CASE("Quadric bounds")
+{
+    using namespace pbr;
+    const Transform identity{ Matrix4x4() };
+    const Transform toWorld = Translate(Vector3_t(3, -1, 2)) * Rotate(37, Vector3_t(1, 2, 3)) * Scale(1, 2, fp_t(0.5));
+    const Transform toObject = Inverse(toWorld);
+
+    std::mt19937 rng(35);
+    std::uniform_real_distribution<fp_t> unit(0, 1);
+    constexpr i32 nSamples = 2000;
+
+    // Surface is given by its radius at z, points are sampled on it with the ends of z and phi ranges included
+    auto checkContainment = [&](const Shape &objectShape, const Shape &worldShape, fp_t zMin, fp_t zMax, fp_t phiMax,
+                                const auto &radiusAt) {
+        const Bounds3_t objectBound = objectShape.ObjectBound();
+        const Bounds3_t worldBound = worldShape.WorldBound();
+        // Full sphere has its own WorldBound(), so it's checked with identity transform too
+        const Bounds3_t identityWorldBound = objectShape.WorldBound();
+        // Rounding of the transformed point may take it a bit further than the transformed corners of the box
+        fp_t pad = 0;
+        for (i32 axis = 0; axis < 3; ++axis)
+            pad = std::max({ pad, std::abs(worldBound.pMin[axis]), std::abs(worldBound.pMax[axis]) });
+        pad *= Gamma(8);
+        const Bounds3_t paddedWorldBound(worldBound.pMin - Vector3_t(pad, pad, pad), worldBound.pMax + Vector3_t(pad, pad, pad));
+
+        const fp_t phiMaxRadians = Radians(phiMax);
+        for (i32 i = 0; i < nSamples; ++i) {
+            const fp_t z = i < 4 ? (i % 2 == 0 ? zMin : zMax) : zMin + (zMax - zMin) * unit(rng);
+            const fp_t phi = i < 4 ? phiMaxRadians * (i / 2) : phiMaxRadians * unit(rng);
+            const fp_t radius = radiusAt(z);
+            const Point3_t p(radius * std::cos(phi), radius * std::sin(phi), z);
+
+            CHECK(Inside(p, objectBound));
+            CHECK(Inside(p, identityWorldBound));
+            const Point3_t pWorld = toWorld(p);
+            CHECK(Inside(pWorld, paddedWorldBound));
+        }
+    };
+
+    SUBCASE("Sphere")
+    {
+        for (const auto &[zMin, zMax, phiMax] : { std::tuple(fp_t(-2), fp_t(2), fp_t(360)),
+                                                 std::tuple(fp_t(-2), fp_t(2), fp_t(100)),
+                                                 std::tuple(fp_t(0.5), fp_t(1.5), fp_t(360)),
+                                                 std::tuple(fp_t(-1.9), fp_t(-0.3), fp_t(200)),
+                                                 std::tuple(fp_t(-1), fp_t(1.2), fp_t(290)),
+                                                 std::tuple(fp_t(0.8), fp_t(2), fp_t(45)) }) {
+            CAPTURE(zMin);
+            CAPTURE(zMax);
+            CAPTURE(phiMax);
+            const Sphere objectSphere(&identity, &identity, false, 2, zMin, zMax, phiMax);
+            const Sphere worldSphere(&toWorld, &toObject, false, 2, zMin, zMax, phiMax);
+            checkContainment(objectSphere, worldSphere, zMin, zMax, phiMax,
+                             [](fp_t z) { return std::sqrt(std::max(fp_t(0), 4 - z * z)); });
+        }
+
+        // Full sphere uses the exact box of the ellipsoid, which must be tight too
+        const Sphere full(&toWorld, &toObject, false, 2, -2, 2, 360);
+        const Bounds3_t bound = full.WorldBound();
+        Bounds3_t sampled(toWorld(Point3_t(0, 0, 2)));
+        for (i32 i = 0; i < 20000; ++i) {
+            const fp_t z = 2 * (2 * unit(rng) - 1), phi = 2 * constants::pi_t * unit(rng);
+            const fp_t radius = std::sqrt(std::max(fp_t(0), 4 - z * z));
+            sampled = Union(sampled, toWorld(Point3_t(radius * std::cos(phi), radius * std::sin(phi), z)));
+        }
+        CHECK(Inside(sampled.pMin, bound));
+        CHECK(Inside(sampled.pMax, bound));
+        for (i32 axis = 0; axis < 3; ++axis) {
+            CHECK_EQ(bound.pMin[axis], doctest::Approx(sampled.pMin[axis]).epsilon(0.01));
+            CHECK_EQ(bound.pMax[axis], doctest::Approx(sampled.pMax[axis]).epsilon(0.01));
+        }
+    }
+
+    SUBCASE("Cylinder")
+    {
+        for (const auto &[zMin, zMax, phiMax] : { std::tuple(fp_t(-1), fp_t(1), fp_t(360)),
+                                                 std::tuple(fp_t(0), fp_t(3), fp_t(90)),
+                                                 std::tuple(fp_t(-2), fp_t(-1), fp_t(135)),
+                                                 std::tuple(fp_t(0.5), fp_t(0.7), fp_t(300)) }) {
+            CAPTURE(phiMax);
+            const Cylinder objectCylinder(&identity, &identity, false, fp_t(1.5), zMin, zMax, phiMax);
+            const Cylinder worldCylinder(&toWorld, &toObject, false, fp_t(1.5), zMin, zMax, phiMax);
+            checkContainment(objectCylinder, worldCylinder, zMin, zMax, phiMax, [](fp_t) { return fp_t(1.5); });
+        }
+    }
+
+    SUBCASE("Paraboloid")
+    {
+        for (const auto &[zMin, zMax, phiMax] : { std::tuple(fp_t(0), fp_t(2), fp_t(360)),
+                                                 std::tuple(fp_t(0.5), fp_t(2), fp_t(180)),
+                                                 std::tuple(fp_t(1), fp_t(1.5), fp_t(250)),
+                                                 std::tuple(fp_t(0), fp_t(1), fp_t(30)) }) {
+            CAPTURE(phiMax);
+            const Paraboloid objectParaboloid(&identity, &identity, false, 1, zMin, zMax, phiMax);
+            const Paraboloid worldParaboloid(&toWorld, &toObject, false, 1, zMin, zMax, phiMax);
+            // Radius is 1 at zMax
+            const fp_t top = zMax;
+            checkContainment(objectParaboloid, worldParaboloid, zMin, zMax, phiMax,
+                             [top](fp_t z) { return std::sqrt(std::max(fp_t(0), z / top)); });
+        }
+    }
+
+    SUBCASE("RevolutionBounds")
+    {
+        // Sector that starts at negative angle and crosses two axes
+        const fp_t phiStart = Radians(fp_t(-30)), phiEnd = Radians(fp_t(200));
+        const Bounds3_t bounds = RevolutionBounds(1, 2, phiStart, phiEnd, -1, 1);
+        for (i32 i = 0; i < nSamples; ++i) {
+            const fp_t r = 1 + unit(rng), phi = phiStart + (phiEnd - phiStart) * unit(rng);
+            CHECK(Inside(Point3_t(r * std::cos(phi), r * std::sin(phi), 2 * unit(rng) - 1), bounds));
+        }
+        CHECK_EQ(bounds.pMax.x, doctest::Approx(2).epsilon(1e-4));
+        CHECK_EQ(bounds.pMax.y, doctest::Approx(2).epsilon(1e-4));
+        CHECK_EQ(bounds.pMin.x, doctest::Approx(-2).epsilon(1e-4));
+        CHECK_EQ(bounds.pMin.y, doctest::Approx(2 * std::sin(Radians(fp_t(-30)))).epsilon(1e-4));
+    }
+}
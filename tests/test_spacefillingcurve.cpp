@@ -0,0 +1,105 @@
+#include "doctest.h"
+
+#include "core/spacefillingcurve.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+TEST_CASE("Morton codes")
+{
+    using namespace pbr;
+
+    static_assert(EncodeMorton2<ui32>(1, 0) == 1 && EncodeMorton2<ui32>(0, 1) == 2 && EncodeMorton2<ui32>(3, 3) == 15);
+    static_assert(EncodeMorton3<ui32>(1, 1, 1) == 7 && EncodeMorton3<ui64>(0, 0, 1) == 4);
+    CHECK_EQ(EncodeMorton2<ui32>(0xFFFF, 0xFFFF), 0xFFFFFFFFu);
+    CHECK_EQ(EncodeMorton2<ui64>(0xFFFFFFFF, 0), 0x5555555555555555ull);
+    CHECK_EQ(EncodeMorton3<ui32>(0x3FF, 0x3FF, 0x3FF), 0x3FFFFFFFu);
+    CHECK_EQ(EncodeMorton3<ui64>(0, 0, 0x1FFFFF), 0x1249249249249249ull << 2);
+    // Coordinates are truncated
+    CHECK_EQ(EncodeMorton3<ui32>(0x400, 0, 0), 0u);
+
+    std::mt19937 rng(3);
+    for (i32 i = 0; i < 1000; ++i) {
+        const ui32 x = rng(), y = rng(), z = rng();
+        ui32 dx, dy, dz;
+        DecodeMorton2(EncodeMorton2<ui32>(x, y), dx, dy);
+        REQUIRE((dx == (x & 0xFFFF) && dy == (y & 0xFFFF)));
+        DecodeMorton2(EncodeMorton2<ui64>(x, y), dx, dy);
+        REQUIRE((dx == x && dy == y));
+        DecodeMorton3(EncodeMorton3<ui32>(x, y, z), dx, dy, dz);
+        REQUIRE((dx == (x & 0x3FF) && dy == (y & 0x3FF) && dz == (z & 0x3FF)));
+        DecodeMorton3(EncodeMorton3<ui64>(x, y, z), dx, dy, dz);
+        REQUIRE((dx == (x & 0x1FFFFF) && dy == (y & 0x1FFFFF) && dz == (z & 0x1FFFFF)));
+        // Constant evaluated fallback gives the same codes as pdep
+        REQUIRE_EQ(EncodeMorton3<ui64>(x, y, z), detail::SpreadBits3<ui64>(x) | detail::SpreadBits3<ui64>(y) << 1 | detail::SpreadBits3<ui64>(z) << 2);
+    }
+}
+
+TEST_CASE_TEMPLATE("Hilbert codes", Key, ui32, ui64)
+{
+    using namespace pbr;
+
+    CHECK_EQ(EncodeHilbert2<Key>(0, 0), Key(0));
+    CHECK_EQ(EncodeHilbert3<Key>(0, 0, 0), Key(0));
+
+    // Consecutive indices are neighbours
+    ui32 px, py, pz, qx, qy, qz;
+    DecodeHilbert2<Key>(0, px, py);
+    for (Key index = 1; index < 4096; ++index) {
+        DecodeHilbert2<Key>(index, qx, qy);
+        REQUIRE_EQ(std::abs(i64(qx) - i64(px)) + std::abs(i64(qy) - i64(py)), 1);
+        REQUIRE_EQ(EncodeHilbert2<Key>(qx, qy), index);
+        px = qx;
+        py = qy;
+    }
+    DecodeHilbert3<Key>(0, px, py, pz);
+    for (Key index = 1; index < 4096; ++index) {
+        DecodeHilbert3<Key>(index, qx, qy, qz);
+        REQUIRE_EQ(std::abs(i64(qx) - i64(px)) + std::abs(i64(qy) - i64(py)) + std::abs(i64(qz) - i64(pz)), 1);
+        REQUIRE_EQ(EncodeHilbert3<Key>(qx, qy, qz), index);
+        px = qx;
+        py = qy;
+        pz = qz;
+    }
+
+    // Round trip of the whole range
+    std::mt19937 rng(7);
+    const ui32 mask2 = KeyBits2<Key> == 32 ? ~0u : (1u << KeyBits2<Key>) - 1, mask3 = (1u << KeyBits3<Key>) - 1;
+    for (i32 i = 0; i < 1000; ++i) {
+        const ui32 x = rng(), y = rng(), z = rng();
+        DecodeHilbert2<Key>(EncodeHilbert2<Key>(x, y), qx, qy);
+        REQUIRE((qx == (x & mask2) && qy == (y & mask2)));
+        DecodeHilbert3<Key>(EncodeHilbert3<Key>(x, y, z), qx, qy, qz);
+        REQUIRE((qx == (x & mask3) && qy == (y & mask3) && qz == (z & mask3)));
+    }
+}
+
+TEST_CASE_TEMPLATE("RadixSort matches std::stable_sort", Key, ui32, ui64)
+{
+    using namespace pbr;
+
+    std::mt19937_64 rng(11);
+    for (const i32 count : { 0, 1, 100, 300000 }) {
+        // All the bits, and only the low ones with a lot of duplicates
+        for (const Key mask : { ~Key(0), Key(0x3FF) }) {
+            std::vector<Key> keys(count);
+            std::vector<i32> values(count);
+            std::vector<std::pair<Key, i32>> expected(count);
+            for (i32 i = 0; i < count; ++i) {
+                keys[i] = static_cast<Key>(rng()) & mask;
+                values[i] = i;
+                expected[i] = { keys[i], i };
+            }
+            std::stable_sort(expected.begin(), expected.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+            RadixSort(std::span(keys), std::span(values));
+            for (i32 i = 0; i < count; ++i) {
+                REQUIRE_EQ(keys[i], expected[i].first);
+                REQUIRE_EQ(values[i], expected[i].second);
+            }
+        }
+    }
+}
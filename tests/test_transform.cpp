@@ -33,3 +33,287 @@
 //    }*/
 //
 //}
+
+
+#include "doctest.h"
+
+#include "core/transform.hpp"
+#include "core/transformcache.h"
+#include "core/animatedtransform.h"
+#include "core/parallel.h"
+
+#include <cstring>
+#include <vector>
+
+TEST_CASE("Transform classification")
+{
+    using namespace pbr;
+
+    CHECK(Transform(Matrix4x4()).IsIdentity());
+    CHECK_EQ(Translate(Vector3_t(1, 2, 3)).type, TransformType::Translation);
+    CHECK_EQ((Translate(Vector3_t(1, 2, 3)) * Scale(2, 3, 4)).type, TransformType::ScaleTranslation);
+    CHECK_EQ((Translate(Vector3_t(1, 2, 3)) * Rotate(30, Vector3_t(1, 1, 0))).type, TransformType::Rigid);
+    CHECK_EQ((Scale(2, 2, 2) * RotateX(30)).type, TransformType::General);
+
+    SUBCASE("Fast paths match the general one")
+    {
+        const Transform transforms[] = { Transform(Matrix4x4()),
+                                         Translate(Vector3_t(1, -2, 3)),
+                                         Translate(Vector3_t(1, -2, 3)) * Scale(2, -3, 0.5f),
+                                         Translate(Vector3_t(1, -2, 3)) * RotateY(70) };
+        const Point3_t p(0.5f, -7, 3);
+        const Vector3_t v(-2, 0.25f, 1);
+        const Normal3_t n(0.3f, 0.4f, -0.5f);
+        for (const Transform &t : transforms) {
+            Transform general = t;
+            general.type = TransformType::General;
+
+            CHECK_EQ(Distance(t(p), general(p)), doctest::Approx(0));
+            CHECK_EQ((t(v) - general(v)).Length(), doctest::Approx(0));
+            Normal3_t tn = t(n), gn = general(n);
+            CHECK_EQ(Vector3_t(tn.x - gn.x, tn.y - gn.y, tn.z - gn.z).Length(), doctest::Approx(0));
+
+            Vector3_t pError, generalError;
+            t(p, pError);
+            general(p, generalError);
+            CHECK(pError.x <= generalError.x);
+            CHECK(pError.y <= generalError.y);
+            CHECK(pError.z <= generalError.z);
+        }
+    }
+}
+
+TEST_CASE("Matrix4x4")
+{
+    using namespace pbr;
+
+    const Matrix4x4 m1(1, 2, 3, 4,
+                       1, 2, 1, 2,
+                       4, 5, 6, 2,
+                       3, 4, 3, 4);
+    const Matrix4x4 m2(0, 1, 0, 2,
+                       -1, 0, 0, 0,
+                       0, 0, 2, 1,
+                       1, 0, 0, 1);
+
+    // Elements of the product of m and its inverse are checked against identity.
+    auto CheckInverse = [](const Matrix4x4 &m, const Matrix4x4 &inverse, fp_t tolerance) {
+        const Matrix4x4 identity = Mul(m, inverse);
+        for (i32 i = 0; i < 4; ++i)
+            for (i32 j = 0; j < 4; ++j)
+                CHECK(std::abs(identity[i][j] - (i == j ? fp_t(1) : fp_t(0))) <= tolerance);
+    };
+
+    SUBCASE("Mul and Transpose")
+    {
+        const Matrix4x4 product = Mul(m1, m2);
+        for (i32 i = 0; i < 4; ++i)
+            for (i32 j = 0; j < 4; ++j) {
+                fp_t expected = 0;
+                for (i32 k = 0; k < 4; ++k)
+                    expected += m1[i][k] * m2[k][j];
+                CHECK_EQ(product[i][j], expected);
+                CHECK_EQ(Transpose(m1)[i][j], m1[j][i]);
+            }
+    }
+    SUBCASE("Inverse of general matrices")
+    {
+        CheckInverse(m1, Inverse(m1), 1e-5f);
+        CheckInverse(m2, Inverse(m2), 1e-5f);
+        // Perspective projection with near 0.01 and far 1000
+        const fp_t f = 1000, n = 0.01f;
+        const Matrix4x4 perspective(1, 0, 0, 0,
+                                    0, 1, 0, 0,
+                                    0, 0, f / (f - n), -f * n / (f - n),
+                                    0, 0, 1, 0);
+        CheckInverse(perspective, Inverse(perspective), 1e-5f);
+    }
+    SUBCASE("Inverse of affine matrices")
+    {
+        const Transform t = Translate(Vector3_t(100, -20, 3)) * Rotate(37, Vector3_t(1, 2, 3)) * Scale(0.5f, 2, 4);
+        CheckInverse(t.m, t.mInv, 1e-5f);
+        CheckInverse(t.m, Inverse(t.m), 1e-5f);
+        const Matrix4x4 translation = Translate(Vector3_t(1, -2, 3)).m;
+        const Matrix4x4 inverse = Inverse(translation);
+        CHECK_EQ(inverse[0][3], -1);
+        CHECK_EQ(inverse[1][3], 2);
+        CHECK_EQ(inverse[2][3], -3);
+        CHECK_EQ(inverse[3][3], 1);
+    }
+}
+
+TEST_CASE("AffineTransform matches Transform")
+{
+    using namespace pbr;
+
+    CHECK(sizeof(AffineTransform) < sizeof(Transform));
+
+    const Transform transforms[] = { Transform(Matrix4x4()),
+                                     Translate(Vector3_t(1, -2, 3)),
+                                     Translate(Vector3_t(1, -2, 3)) * Scale(2, -3, 0.5f),
+                                     Translate(Vector3_t(1, -2, 3)) * RotateY(70),
+                                     Translate(Vector3_t(1, -2, 3)) * Rotate(30, Vector3_t(1, 1, 2)) * Scale(2, 3, 4) };
+    const Point3_t p(0.5f, -7, 3);
+    const Vector3_t v(-2, 0.25f, 1);
+    const Normal3_t n(0.3f, 0.4f, -0.5f);
+    const Bounds3_t b(Point3_t(-1, 0, 2), Point3_t(3, 1, 5));
+    const Ray r(p, v);
+    for (const Transform &t : transforms) {
+        const AffineTransform affine(t);
+        CHECK_EQ(affine.type, t.type);
+        CHECK_EQ(affine.SwapsHandedness(), t.SwapsHandedness());
+        CHECK_EQ(affine(p), t(p));
+        CHECK_EQ(affine(v), t(v));
+        CHECK_EQ(affine(n), t(n));
+
+        Vector3_t pError, affinePError, vError, affineVError;
+        CHECK_EQ(affine(p, affinePError), t(p, pError));
+        CHECK_EQ(affinePError, pError);
+        CHECK_EQ(affine(v, affineVError), t(v, vError));
+        CHECK_EQ(affineVError, vError);
+
+        const Bounds3_t tb = t(b), affineB = affine(b);
+        CHECK_EQ(affineB.pMin, tb.pMin);
+        CHECK_EQ(affineB.pMax, tb.pMax);
+        const Ray tr = t(r), affineR = affine(r);
+        CHECK_EQ(affineR.origin, tr.origin);
+        CHECK_EQ(affineR.direction, tr.direction);
+        CHECK_EQ(affineR.tMax, tr.tMax);
+
+        // Composition and inverse stay affine
+        const AffineTransform composed = affine * Inverse(affine);
+        CHECK_EQ(Distance(composed(p), p), doctest::Approx(0).epsilon(1e-4));
+        CHECK_EQ(static_cast<Transform>(affine).type, t.type);
+    }
+}
+
+TEST_CASE("Batched transforms match operator()")
+{
+    using namespace pbr;
+
+    const Matrix4x4 perspective(1, 0, 0, 0,
+                                0, 1, 0, 0,
+                                0, 0, 2, -1,
+                                0, 0, 1, 0);
+    const Transform transforms[] = { Transform(Matrix4x4()),
+                                     Translate(Vector3_t(1, -2, 3)),
+                                     Translate(Vector3_t(1, -2, 3)) * Scale(2, -3, 0.5f),
+                                     Translate(Vector3_t(1, -2, 3)) * RotateY(70),
+                                     Translate(Vector3_t(1, -2, 3)) * Rotate(30, Vector3_t(1, 1, 2)) * Scale(2, 3, 4),
+                                     Transform(perspective) };
+
+    // Odd count, so the scalar tail is tested too
+    constexpr i32 count = 1027;
+    std::vector<Point3_t> points;
+    std::vector<Vector3_t> vectors;
+    std::vector<Normal3_t> normals;
+    std::vector<Bounds3_t> bounds;
+    for (i32 i = 0; i < count; ++i) {
+        const fp_t a = fp_t(i) / count;
+        points.emplace_back(a * 10 - 3, 5 - a, a * a + 2);
+        vectors.emplace_back(-a, a * 3, 1 - a);
+        normals.emplace_back(a, 1 - a * 2, a * 0.5f);
+        bounds.emplace_back(points.back(), points.back() + vectors.back());
+    }
+
+    for (const Transform &t : transforms) {
+        std::vector<Point3_t> outPoints(count);
+        std::vector<Vector3_t> outVectors(count);
+        std::vector<Normal3_t> outNormals(count);
+        std::vector<Bounds3_t> outBounds(count);
+        t(std::span<const Point3_t>(points), std::span(outPoints));
+        t(std::span<const Vector3_t>(vectors), std::span(outVectors));
+        t(std::span<const Normal3_t>(normals), std::span(outNormals));
+        t(std::span<const Bounds3_t>(bounds), std::span(outBounds));
+        for (i32 i = 0; i < count; ++i) {
+            REQUIRE_EQ(outPoints[i], t(points[i]));
+            REQUIRE_EQ(outVectors[i], t(vectors[i]));
+            REQUIRE_EQ(outNormals[i], t(normals[i]));
+            REQUIRE_EQ(outBounds[i].pMin, t(bounds[i]).pMin);
+            REQUIRE_EQ(outBounds[i].pMax, t(bounds[i]).pMax);
+        }
+
+        // In place
+        std::vector<Point3_t> inPlace = points;
+        t(std::span<const Point3_t>(inPlace), std::span(inPlace));
+        CHECK(inPlace == outPoints);
+    }
+}
+
+TEST_CASE("TransformCache interns equal matrices")
+{
+    using namespace pbr;
+
+    TransformCache cache;
+    const Transform t = Translate(Vector3_t(1, 2, 3)) * Rotate(30, Vector3_t(0, 1, 1));
+    const Transform *t0, *inv0, *t1, *inv1;
+    cache.Lookup(t.m, t0, inv0);
+    cache.Lookup(Transform(t.m), t1, inv1);
+    CHECK_EQ(t0, t1);
+    CHECK_EQ(inv0, inv1);
+    CHECK(std::memcmp(t0->m.m, t.m.m, sizeof(t.m.m)) == 0);
+    CHECK(std::memcmp(inv0->m.m, t0->mInv.m, sizeof(t.m.m)) == 0);
+    CHECK_EQ(cache.Size(), 2);
+
+    // Inverse is interned as well
+    cache.Lookup(inv0->m, t1, inv1);
+    CHECK_EQ(t1, inv0);
+    CHECK_EQ(inv1, t0);
+
+    // Identity is its own inverse
+    cache.Lookup(Transform(Matrix4x4()), t1, inv1);
+    CHECK_EQ(t1, inv1);
+    CHECK_EQ(cache.Size(), 3);
+
+    // Every thread gets the same pointers
+    constexpr i32 count = 4096;
+    std::vector<const Transform *> pointers(count);
+    ParallelFor(count, 64, [&](i64 begin, i64 end) {
+        for (i64 i = begin; i < end; ++i) {
+            const Transform *inverse;
+            cache.Lookup(Scale(1, 2, fp_t(i % 8 + 1)).m, pointers[i], inverse);
+        }
+    });
+    for (i32 i = 8; i < count; ++i)
+        REQUIRE_EQ(pointers[i], pointers[i % 8]);
+}
+
+TEST_CASE("AnimatedTransform decomposition and motion bounds")
+{
+    using namespace pbr;
+
+    // Decomposition gives back the matrix
+    const Transform start = Translate(Vector3_t(1, -2, 3)) * Rotate(40, Vector3_t(1, 2, 3)) * Scale(2, 1, fp_t(0.5));
+    Vector3_t T;
+    Quaternion R;
+    Matrix4x4 S;
+    AnimatedTransform::Decompose(start.m, T, R, S);
+    const Transform recomposed = Translate(T) * R.ToTransform() * Transform(S);
+    for (i32 i = 0; i < 4; ++i)
+        for (i32 j = 0; j < 4; ++j)
+            CHECK(std::abs(recomposed.m[i][j] - start.m[i][j]) <= fp_t(1e-5));
+
+    // Box is sampled densely along the motion, samples have to be inside, and the bounds have to be tight
+    const Transform end = Translate(Vector3_t(-3, 4, 1)) * Rotate(160, Vector3_t(0, 1, 1)) * Scale(1, 3, 1);
+    const AnimatedTransform animated(&start, 1, &end, 2);
+    const Bounds3_t box(Point3_t(-1, 0, 2), Point3_t(2, 1, 3));
+    const Bounds3_t motionBounds = animated.MotionBounds(box);
+
+    Bounds3_t sampled;
+    for (i32 i = 0; i <= 4096; ++i) {
+        const fp_t time = 1 + fp_t(i) / 4096;
+        for (i32 corner = 0; corner < 8; ++corner)
+            sampled = Union(sampled, Bounds3_t(animated(time, box.Corner(corner))));
+    }
+    const fp_t tolerance = fp_t(1e-3) * MaxComponent(motionBounds.Diagonal());
+    for (i32 axis = 0; axis < 3; ++axis) {
+        CHECK(sampled.pMin[axis] >= motionBounds.pMin[axis] - tolerance);
+        CHECK(sampled.pMax[axis] <= motionBounds.pMax[axis] + tolerance);
+        CHECK(sampled.pMin[axis] - motionBounds.pMin[axis] <= tolerance);
+        CHECK(motionBounds.pMax[axis] - sampled.pMax[axis] <= tolerance);
+    }
+
+    // Ends are the transforms themselves
+    CHECK_EQ(animated(1, box.pMax), start(box.pMax));
+    CHECK_EQ(animated(2, box.pMax), end(box.pMax));
+}